@@ -9,10 +9,13 @@
  *	- -i INFILE or --infile=INFILE : GP2 input file. Default value INFILE = SLCLog.GP2
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -o OUTFILE or --outfile=OUTFILE : OSP binary output file. Default value OUTFILE = DATA.OSP
  *	- -T TOTIME or --totime=TOTIME : To time (hh:mm:sec). Default value TOTIME = 23:59:59
  *	- -t FROMTIME or --fromtime=FROMTIME : From time (hh:mm:sec). Default value FROMTIME = 00:00:00
  *	- -w WMSG or --wmsg=WMSG : Wanted messages MIDs (a comma separated list, ALL, RINEX,  or RINEX,list. Default value WMSG = RINEX
+ *	- -W WORKERS or --workers=WORKERS : Number of worker threads converting chunks of lines of the input file. Default value WORKERS = 0 (as many as hardware threads)
+ *	- -x or --index : Write the index file of the OSP binary output file. Default value INDEX=FALSE
  *<p>
  *Copyright 2015 Francisco Cancillo
  *<p>
@@ -30,14 +33,30 @@
  *V1.0	|2/2015	|First release
  *V1.1	|2/2016	|Minor improvements for logging messages
  *V1.2	|2/2016	|Reviewed to run on Linux
+ *V1.3	|10/2026	|Added option to write the OSP index file
+ *		|		|Added option to dump performance counters at exit
+ *V1.4	|10/2026	|Input file is mapped in memory, and lines are parsed without sscanf / mktime, decoding hex bytes with a lookup table
+ *		|		|Chunks of lines are converted using worker threads, writing messages in the input order
+ *		|		|The list of wanted MIDs is a table indexed by MID
  */
 
 #include <string.h>
 #include <time.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "PerfCounters.h"
+#include "OSPIndex.h"
+#include "Utilities.h"
 
 using namespace std;
 
@@ -45,33 +64,44 @@ using namespace std;
 ///The command line format
 const string CMDLINE = "GP2toOSP.exe {options}";
 ///The current program version
-const string MYVER = " V1.2";
+const string MYVER = " V1.4";
 //@cond DUMMY
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int INFILE, OUTFILE, HELP, LOGLEVEL, FROMDATE, TODATE, FROMTIME, TOTIME, WMSG;
+int INFILE, OUTFILE, HELP, INDEX, LOGLEVEL, PERFOUT, FROMDATE, TODATE, FROMTIME, TOTIME, WMSG, WORKERS;
 //Metavariables for operators
 //n/a
 //Constraints used in this program
 #define MSGSIZE 2050		//2048 (max payload size) + 2 (payload len)
-#define WMSGSIZE 100		//the wanted message list maximum size
 #define GP2SIZE 34 + MSGSIZE*3 + 12 + 1 + 1	//time tag chars + masg chars + (checksum + tail) + lf + null
 #define START1 160	//0xA0	//OSP messages from/to receiver are preceded by the synchro
 #define START2 162	//0xA2	//sequence of two bytes with values START1, START2
 #define END1 176	//0XB0	//OSP messages from/to receiver are followed by the end
 #define END2 179	//0XB3	//sequence of two bytes with values END1, END2
+#define GP2CHUNKSIZE 1048576	//the approximate size in bytes of the chunks of lines converted by each worker
+#define GP2CHUNKSAHEAD 4		//the number of chunks per worker that can be converted ahead of the chunk being written
 //variables and objects
-char GP2line[GP2SIZE];			//a buffer for a line from the GP2 input file
-unsigned char OSPmsg[MSGSIZE];	//a buffer to place the output binary OSP message
-int OSPmsgSize = 0;				//current message size
-//the list of OSP messages useful to obtain RINEX data
-unsigned char WANTEDMsg[WMSGSIZE] = {2,6,7,56,8,11,12,15,28,50,64,75,0};
+//the table of OSP messages wanted, indexed by MID. Initially, the ones useful to obtain RINEX data
+bool WANTEDMsg[256];
+const unsigned char RINEXMsg[] = {2,6,7,56,8,11,12,15,28,50,64,75};
+//the value of each hexadecimal digit char, or 0xFF for other chars
+unsigned char HEXVal[256];
+///A chunk of lines of the input file, and the OSP messages extracted from them
+struct GP2Chunk {
+	const char* begin;		//the first char of the chunk in the input file contents
+	const char* end;		//the char after the last one of the chunk
+	vector<unsigned char> osp;	//the OSP messages extracted (payload length and payload of each one)
+	int nMessages;			//the number of messages extracted
+	bool done;				//true when the chunk has been converted
+};
 //prototypes of functions defined in this module
-int extractMsgs(Logger*, FILE *, time_t, time_t, FILE *);
+int extractMsgs(Logger*, FILE *, time_t, time_t, FILE *, OSPIndex*, int);
+int convertLines(Logger*, const char*, const char*, time_t, time_t, vector<unsigned char> &);
+const char* findToken(const char*, const char*, const char*);
 bool wantedMsg(unsigned char);
+bool parseTime(const char*, const char*, time_t &);
 time_t dt2time (string);
-bool checkInterval(string, time_t, time_t);
 void addWANTED(string);
 //@endcond 
 
@@ -121,15 +151,18 @@ int main(int argc, char* argv[]) {
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	WORKERS = parser.addOption("-W", "--workers", "WORKERS", "Number of worker threads converting the input file (0 = hardware threads)", "0");
 	WMSG = parser.addOption("-w", "--wmsg", "WMSG", "Wanted mesages MIDs (a comma separated list, ALL, RINEX,  or RINEX,list", "RINEX");
 	FROMTIME = parser.addOption("-t", "--fromtime", "FROMTIME", "From time (hh:mm:sec)", "00:00:00");
 	TOTIME = parser.addOption("-T", "--totime", "TOTIME", "To time (hh:mm:sec)", "23:59:59");
 	OUTFILE = parser.addOption("-o", "--outfile", "OUTFILE", "OSP binary output file", "DATA.OSP");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
 	INFILE = parser.addOption("-i", "--infile", "INFILE", "GP2 input file", "SLCLog.GP2");
 	FROMDATE = parser.addOption("-d", "--fromdate", "FROMDATE", "From date (dd/mm/aaaa)", "01/01/2014");
 	TODATE = parser.addOption("-D", "--todate", "TODATE", "To date (dd/mm/aaaa)", "31/12/2020");
+	INDEX = parser.addOption("-x", "--index", "INDEX", "Write the index file of the OSP binary output file", false);
 	/// 3- Parses arguments in the command line extracting options and operators
 	try {
 		parser.parseArgs(argc, argv);
@@ -144,18 +177,29 @@ int main(int argc, char* argv[]) {
 		parser.usage("Generates an OSP file from a SP2 data file containing SiRF IV receiver messages", CMDLINE);
 		return 0;
 	}
-	/// 4- Sets logging level stated in option
+	/// 4- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 5- Sets the list of wanted messages
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
+	/// 5- Sets the table of wanted messages, and the table of hexadecimal digit values
 	string s = parser.getStrOpt (WMSG);
-	if (s.compare("ALL") == 0) WANTEDMsg[0] = 0;
+	for (int i=0; i<256; i++) WANTEDMsg[i] = s.compare("ALL") == 0;
+	for (unsigned int i=0; i<sizeof RINEXMsg; i++) WANTEDMsg[RINEXMsg[i]] = true;
+	if (s.compare("ALL") == 0) { }
 	else if (s.compare("RINEX") == 0) { }
 	else if (s.find("RINEX,") == 0) addWANTED(s.substr(6));
 	else addWANTED(s);
+	for (int i=0; i<256; i++) HEXVal[i] = 0xFF;
+	for (int i=0; i<10; i++) HEXVal['0' + i] = i;
+	for (int i=0; i<6; i++) HEXVal['A' + i] = HEXVal['a' + i] = 10 + i;
 	//log list of message wanted
 	s = string ("MID messages to OSP: ");
-	if (WANTEDMsg[0] == 0) s += "ALL";
-	else for (int i=0; i<WMSGSIZE && WANTEDMsg[i] != 0; i++) s += " " + to_string((long long) WANTEDMsg[i]);
+	if (parser.getStrOpt(WMSG).compare("ALL") == 0) s += "ALL";
+	else {
+		for (unsigned int i=0; i<sizeof RINEXMsg; i++) if (WANTEDMsg[RINEXMsg[i]]) s += " " + to_string((long long) RINEXMsg[i]);
+		for (int i=1; i<256; i++)
+			if (WANTEDMsg[i] && (memchr(RINEXMsg, i, sizeof RINEXMsg) == NULL)) s += " " + to_string((long long) i);
+	}
 	log.info(s);
 	/// 6- Sets start and end time of the time interval for messages wanted 
 	time_t startTime, endTime;
@@ -178,10 +222,14 @@ int main(int argc, char* argv[]) {
 		return 3;
 	}
 	/// 9- Extracts/verifies/filters line by line messages from the SP2 file and translate/write them into OSP format
-	int n = extractMsgs(&log, inFile, startTime, endTime, outFile);
+	OSPIndex ospIdx;
+	int n = extractMsgs(&log, inFile, startTime, endTime, outFile, parser.getBoolOpt(INDEX)? &ospIdx : NULL, stoi(parser.getStrOpt(WORKERS)));
 	log.info("End of data extraction. Messages extracted: " + to_string((long long) n));
 	fclose(inFile);
 	fclose(outFile);
+	/// 10- Writes the index file, if requested
+	if (parser.getBoolOpt(INDEX) && !ospIdx.save(OSPIndex::indexFileName(parser.getStrOpt(OUTFILE))))
+		log.severe("Cannot create the index file for " + parser.getStrOpt(OUTFILE));
 	return 0;
 }
 //@cond DUMMY
@@ -189,82 +237,223 @@ int main(int argc, char* argv[]) {
  * extracts OSP messages contained in a SLCog.gp2 input file and writes them into a OSP binary output file.
  * Only messages having a time tag included in the time interval [fromT, toT] are extracted.
  * Only messages having a "wanted" MID are extracted.
+ *<p>The input file is mapped in memory (or loaded into memory where mapping is not available), and split in chunks of lines.
+ * Chunks are converted by worker threads (see convertLines), and the messages extracted are written in the same order they have in
+ * the input file. Workers do not convert chunks too far ahead of the one being written, to limit memory used.
+ * If the file cannot be loaded in memory, it is converted reading it in chunks.
  *
  * @param plog a pointer to the error logger
  * @param inFile the gp2 input file with GPS receiver messages
  * @param fromT defines the start of the time interval for messages to be extracted
  * @param toT defines the end of the time interval
  * @param outFile the output OSP file to place binary messages
+ * @param pIdx the index where messages written are added, or NULL if no index is requested
+ * @param nWorkers the number of worker threads (1 to convert lines sequentially, 0 or negative to use hardware threads)
  * @return the number of OSP messages extracted
  */
-int extractMsgs(Logger* plog, FILE *inFile, time_t fromT, time_t toT, FILE *outFile) {
-	char *header, *tail;
-	unsigned int ui, payloadLen, computedCheck, messageCheck, nbytesRead;
-	string timeTag;
+int extractMsgs(Logger* plog, FILE *inFile, time_t fromT, time_t toT, FILE *outFile, OSPIndex* pIdx, int nWorkers) {
+	const char* contents = NULL;	//the input file contents in memory
+	size_t size = 0;
+	bool mapped = false;
 	int nMessages = 0;
+	/// 1- Maps (or loads) the input file in memory
+#ifndef _WIN32
+	struct stat fileStat;
+	void* addr;
+	if ((fstat(fileno(inFile), &fileStat) == 0) && (fileStat.st_size > 0)
+			&& ((addr = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(inFile), 0)) != MAP_FAILED)) {
+		madvise(addr, fileStat.st_size, MADV_SEQUENTIAL);
+		contents = (const char*) addr;
+		size = fileStat.st_size;
+		mapped = true;
+	}
+#endif
+	vector<char> buffer;
+	if (contents == NULL) {
+		size_t n;
+		//data are read directly at the end of the buffer, growing it a chunk each time
+		do {
+			buffer.resize(size + GP2CHUNKSIZE);
+			n = fread(&buffer[size], 1, GP2CHUNKSIZE, inFile);
+			size += n;
+		} while (n > 0);
+		buffer.resize(size);
+		contents = buffer.empty()? "" : &buffer[0];
+	}
+	/// 2- Splits contents in chunks at line boundaries
+	vector<GP2Chunk> chunks;
+	const char* end = contents + size;
+	const char* pos = contents;
+	const char* eol;
+	while (pos < end) {
+		GP2Chunk chunk;
+		chunk.begin = pos;
+		if ((size_t) (end - pos) <= GP2CHUNKSIZE) pos = end;
+		else if ((eol = (const char*) memchr(pos + GP2CHUNKSIZE, '\n', end - pos - GP2CHUNKSIZE)) == NULL) pos = end;
+		else pos = eol + 1;
+		chunk.end = pos;
+		chunk.nMessages = 0;
+		chunk.done = false;
+		chunks.push_back(chunk);
+	}
+	/// 3- Starts the workers converting chunks, if more than one is requested
+	if (nWorkers <= 0) nWorkers = (int) thread::hardware_concurrency();
+	if ((size_t) nWorkers > chunks.size()) nWorkers = (int) chunks.size();
+	size_t nextChunk = 0;		//the next chunk to convert
+	size_t writeChunk = 0;		//the chunk being written
+	size_t maxAhead = (nWorkers > 1? nWorkers : 1) * GP2CHUNKSAHEAD;
+	bool abort = false;
+	mutex chunkMutex;
+	condition_variable chunkDone, chunkWritten;
+	vector<thread> workers;
+	if (nWorkers > 1) {
+		for (int i = 0; i < nWorkers; i++) workers.push_back(thread([&] {
+			size_t n;
+			for (;;) {
+				{	//take the next chunk to convert, waiting while it would be too far ahead
+					unique_lock<mutex> lock(chunkMutex);
+					chunkWritten.wait(lock, [&] {return abort || (nextChunk >= chunks.size()) || (nextChunk < writeChunk + maxAhead);});
+					if (abort || (nextChunk >= chunks.size())) return;
+					n = nextChunk++;
+				}
+				chunks[n].nMessages = convertLines(plog, chunks[n].begin, chunks[n].end, fromT, toT, chunks[n].osp);
+				lock_guard<mutex> lock(chunkMutex);
+				chunks[n].done = true;
+				chunkDone.notify_all();
+			}
+		}));
+	}
+	/// 4- Writes the messages extracted from each chunk, in order, adding them to the index if requested
+	for (writeChunk = 0; writeChunk < chunks.size(); ) {
+		GP2Chunk &chunk = chunks[writeChunk];
+		if (workers.empty()) chunk.nMessages = convertLines(plog, chunk.begin, chunk.end, fromT, toT, chunk.osp);
+		else {
+			unique_lock<mutex> lock(chunkMutex);
+			chunkDone.wait(lock, [&chunk] {return chunk.done;});
+		}
+		if (!chunk.osp.empty() && (fwrite(&chunk.osp[0], 1, chunk.osp.size(), outFile) != chunk.osp.size())) {
+			plog->severe("Cannot writte to binary output file");
+			nMessages = -nMessages - 4;
+			break;
+		}
+		if (pIdx != NULL)
+			for (size_t i = 0; i + 2 <= chunk.osp.size(); i += ((chunk.osp[i] << 8) | chunk.osp[i+1]) + 2)
+				pIdx->addMessage(&chunk.osp[i+2], (chunk.osp[i] << 8) | chunk.osp[i+1]);
+		nMessages += chunk.nMessages;
+		vector<unsigned char>().swap(chunk.osp);
+		lock_guard<mutex> lock(chunkMutex);
+		writeChunk++;
+		chunkWritten.notify_all();
+	}
+	{
+		lock_guard<mutex> lock(chunkMutex);
+		abort = true;
+		chunkWritten.notify_all();
+	}
+	for (vector<thread>::iterator it = workers.begin(); it != workers.end(); it++) it->join();
+#ifndef _WIN32
+	if (mapped) munmap((void*) contents, size);
+#endif
+	return nMessages;
+}
 
-	//read input file line by line: each line shall be an OSP message
-	while (fgets(GP2line, GP2SIZE, inFile) != NULL) {
-		timeTag = string(GP2line, 23);
+/**convertLines
+ * extracts the OSP messages contained in the given lines of a SLCog.gp2 input file, appending them to the given output buffer.
+ * Only messages having a time tag included in the time interval [fromT, toT] are extracted.
+ * Only messages having a "wanted" MID are extracted.
+ * Lines longer than the maximum allowed are split as if they were read with fgets.
+ *
+ * @param plog a pointer to the error logger
+ * @param begin the first char of the lines to convert
+ * @param end the char after the last line to convert
+ * @param fromT defines the start of the time interval for messages to be extracted
+ * @param toT defines the end of the time interval
+ * @param osp the buffer where the messages extracted (payload length and payload) are appended
+ * @return the number of OSP messages extracted
+ */
+int convertLines(Logger* plog, const char* begin, const char* end, time_t fromT, time_t toT, vector<unsigned char> &osp) {
+	PERF_SCOPE("GP2toOSP::convertLines");
+	unsigned char OSPmsg[MSGSIZE];	//a buffer to place the message extracted
+	const char *line, *lineEnd, *header, *tail;
+	unsigned int payloadLen, computedCheck, messageCheck, nbytesRead;
+	unsigned char hi, lo;
+	time_t tag;
+	int nMessages = 0;
+///a macro to get the time tag of the current line for logging messages
+#define TIME_TAG string(line, lineEnd - line < 23? lineEnd - line : 23)
+	for (line = begin; line < end; line = lineEnd) {
+		//get the next line, as fgets would do with a GP2SIZE buffer
+		if ((lineEnd = (const char*) memchr(line, '\n', end - line)) == NULL) lineEnd = end;
+		else lineEnd++;
+		if (lineEnd - line > GP2SIZE - 1) lineEnd = line + GP2SIZE - 1;
 		//check if line time tag is in the wanted time interval
-		if (!checkInterval(GP2line, fromT, toT)) {
-			plog->finest(timeTag + " Time tag outside interval");
+		if (!parseTime(line, lineEnd, tag) || (tag < fromT) || (toT < tag)) {
+			LOG_FINEST(plog, TIME_TAG + " Time tag outside interval");
 			continue;
 		}
-		header = strstr(GP2line, "A0 A2");	//find header
-		tail =  strstr(header+5, "B0 B3");	//find tail
+		header = findToken(line, lineEnd, "A0 A2");	//find header
+		tail = header == NULL? NULL : findToken(header + 5, lineEnd, "B0 B3");	//find tail
 		if (header==NULL || tail==NULL) {	//log this error
-			plog->warning(timeTag + " No message header or tailer");
+			plog->warning(TIME_TAG + " No message header or tailer");
 			continue;
 		}
 		//get message data: length, payload, checksum
 		header += 6;	//points now to the first mesage byte
 		nbytesRead = 0;	//the counter for message bytes read
 		while (header<tail && nbytesRead<MSGSIZE) {	//extract all message bytes
-			if (sscanf(header, "%x", &ui)==1) {
-				OSPmsg[nbytesRead] = ui;
-				header += 3;
-				nbytesRead++;
-			}
-			else header = tail;
+			if (((hi = HEXVal[(unsigned char) header[0]]) | (lo = HEXVal[(unsigned char) header[1]])) == 0xFF) break;
+			OSPmsg[nbytesRead] = (hi << 4) | lo;
+			header += 3;
+			nbytesRead++;
 		}
 		//check message length
 		if (nbytesRead>=MSGSIZE || nbytesRead<=4) {
-			plog->warning(timeTag + " No message data");
+			plog->warning(TIME_TAG + " No message data");
 			continue;
 		}
 		payloadLen = (OSPmsg[0] << 8) | OSPmsg[1];
 		if (nbytesRead != payloadLen+4) {
-			plog->warning(timeTag + " PayloadLen=" + to_string((long long) payloadLen) +
+			plog->warning(TIME_TAG + " PayloadLen=" + to_string((long long) payloadLen) +
 								"<>"  + to_string((long long) nbytesRead-4) + "=BytesRead" );
 			continue;
 		}
 		//verify checksum
 		computedCheck = 0;
-		for (unsigned int i=0; i<payloadLen; i++) {
-			computedCheck += OSPmsg[i+2];
-			computedCheck &= 0x7FFF;
-		}
+		for (unsigned int i=0; i<payloadLen; i++) computedCheck += OSPmsg[i+2];
+		computedCheck &= 0x7FFF;
 		messageCheck = (OSPmsg[payloadLen+2] << 8) | OSPmsg[payloadLen+3];
 		if (computedCheck != messageCheck) {
-			plog->warning(timeTag + " Wrong checksum");
+			plog->warning(TIME_TAG + " Wrong checksum");
 			continue;
 		}
 		//check if message MID is in the list of wanted ones
 		if (wantedMsg(OSPmsg[2])) {
-			//printf("wt|");
-			//wanted, write it to the OSP output file
-			if (fwrite(OSPmsg, 1, payloadLen+2, outFile) == payloadLen+2) nMessages++;
-			else {
-				plog->severe("Cannot writte to binary output file");
-				return -nMessages - 4;
-				break;
-			}
-			plog->fine(timeTag + " written MID " + to_string((long long) OSPmsg[2]));
+			//wanted, append it to the OSP output
+			osp.insert(osp.end(), OSPmsg, OSPmsg + payloadLen + 2);
+			nMessages++;
+			LOG_FINE(plog, TIME_TAG + " written MID " + to_string((long long) OSPmsg[2]));
 		}
-		else plog->finest(timeTag + " skipped MID " + to_string((long long) OSPmsg[2]));
+		else LOG_FINEST(plog, TIME_TAG + " skipped MID " + to_string((long long) OSPmsg[2]));
 	}
 	return nMessages;
+#undef TIME_TAG
+}
+
+/**findToken
+ * finds the first occurrence of the given token in the given chars (which are not null terminated).
+ *
+ *@param from the first char where the token is searched
+ *@param end the char after the last one where the token is searched
+ *@param token the null terminated token to find
+ *@return a pointer to the first char of the token found, or NULL if not found
+ **/
+const char* findToken(const char* from, const char* end, const char* token) {
+	size_t len = strlen(token);
+	while ((from + len <= end) && ((from = (const char*) memchr(from, token[0], end - from - len + 1)) != NULL)) {
+		if (memcmp(from, token, len) == 0) return from;
+		from++;
+	}
+	return NULL;
 }
 
 /**wantedMsg
@@ -274,51 +463,52 @@ int extractMsgs(Logger* plog, FILE *inFile, time_t fromT, time_t toT, FILE *outF
  *@return true if current message is in the list, false otherwise
  **/
 bool wantedMsg(unsigned char mid) {
-	if (WANTEDMsg[0] == 0) return true;
-	for (int i=0; i<WMSGSIZE && WANTEDMsg[i]!=0; i++)
-		if (WANTEDMsg[i] == mid) return true;
-	return false;
+	return WANTEDMsg[mid];
+}
+
+/**parseTime
+ * converts date and time at the beginning of the given chars to a time_t value, without using sscanf or mktime.
+ * Fields are parsed as sscanf would do with the format "%d/%d/%d %d:%d:%d", and the date and time are converted
+ * as UTC ones (see daysFromCivil). Chars after the seconds field (like milliseconds) are ignored.
+ *
+ *@param from the first char of the date and time, having format dd/mm/yyyy hh:mm:ss
+ *@param end the char after the last one that can be parsed
+ *@param value the given time as a time_t value
+ *@return true if date and time have been converted, false otherwise
+ **/
+bool parseTime(const char* from, const char* end, time_t &value) {
+	static const char SEPARATORS[] = "// ::";
+	int fields[6];
+	bool negative;
+	for (int i = 0; i < 6; i++) {
+		if (i > 0) {	//the separator preceding the field: a blank matches any number of white spaces
+			if (SEPARATORS[i-1] != ' ') {
+				if ((from >= end) || (*from != SEPARATORS[i-1])) return false;
+				from++;
+			}
+		}
+		while ((from < end) && isspace((unsigned char) *from)) from++;
+		negative = (from < end) && (*from == '-');
+		if ((from < end) && ((*from == '-') || (*from == '+'))) from++;
+		if ((from >= end) || !isdigit((unsigned char) *from)) return false;
+		for (fields[i] = 0; (from < end) && isdigit((unsigned char) *from); from++) fields[i] = fields[i] * 10 + (*from - '0');
+		if (negative) fields[i] = -fields[i];
+	}
+	value = (time_t) daysFromCivil(fields[2], fields[1], fields[0]) * 86400 + fields[3] * 3600 + fields[4] * 60 + fields[5];
+	return true;
 }
 
 /**dt2time
- * converts date and time from the input line time tag string to a time_t value.
+ * converts date and time from the input line time tag string to a time_t value (see parseTime).
  *
  *@param dateAndTime a string having format dd/mm/yyyy hh:mm:ss
  *@return the given time as a time_t value, or -1 if date or time cannot be converted
  **/
 time_t dt2time (string dateAndTime) {
-	int a, b, c, d, e, f;
-	struct tm *timeinfo;
-	time_t rawtime;
-	time(&rawtime);
-	timeinfo = localtime(&rawtime);
-	if (sscanf(dateAndTime.c_str(), "%d/%d/%d %d:%d:%d", &a, &b, &c, &d, &e, &f) == 6) {
-		timeinfo->tm_mday = a;
-		timeinfo->tm_mon = b - 1;
-		timeinfo->tm_year = c - 1900;
-		timeinfo->tm_hour = d;
-		timeinfo->tm_min = e;
-		timeinfo->tm_sec = f;
-		return mktime(timeinfo);
-	}
+	time_t value;
+	if (parseTime(dateAndTime.c_str(), dateAndTime.c_str() + dateAndTime.size(), value)) return value;
 	return -1;	//wrong date or time
 }
-/**checkInterval
- * checks if the time tag provided is in the given time interval  [fromT, toT].
- *
- *@param timeTag the time tag string of the current line
- *@param fromT the initial time of the interval
- *@param toT the final time of the interval
- *@return true if the line time tag is in the time interval [fromT, toT], false otherwyse
- **/
- bool checkInterval(string timeTag, time_t fromT, time_t toT) {
-	bool result = false;
-	time_t tag = dt2time(timeTag);
-	if (tag != -1) {
-		result = (fromT <= tag) && (tag <= toT);
-		}
-	return result;
-}
 
 /**addWANTED
  * adds a list of comma separated MIDs to the "wanted" message list.
@@ -328,14 +518,13 @@ time_t dt2time (string dateAndTime) {
  void addWANTED(string midList) {
 	 char mids[301];
 	 char *ptok;
-	 int nextPos;
+	 int mid;
 
-	 for (nextPos=0; nextPos<WMSGSIZE && WANTEDMsg[nextPos]!=0; nextPos++);
 	 strncpy(mids, midList.c_str(), 300);
+	 mids[300] = 0;
 	 ptok = strtok(mids, ",;.:");
 	 while (ptok != NULL) {
-		WANTEDMsg[nextPos] = atoi(ptok);
-		if (nextPos<WMSGSIZE && WANTEDMsg[nextPos]!=0) nextPos++;
+		if ((mid = atoi(ptok)) > 0) WANTEDMsg[mid & 0xFF] = true;
 		ptok = strtok(NULL, ",;.:");
 	 }
  }
@@ -0,0 +1,571 @@
+/** @file MultiRXtoOSP.cpp
+ * Contains the command line program to capture concurrently OSP message data from several SiRF IV receivers and store them
+ * in one OSP binary file per receiver.
+ *<p>
+ *Usage:
+ *<p>MultiRXtoOSP {options}
+ *<p>Options are:
+ *	- -b BAUD or --baud=BAUD : Serial port baud rate for OSP data (1200, 2400, 4800, 9600, 38400, 57600 or 115200). Receivers are commanded to send OSP data at this rate. Default value BAUD = 57600
+ *	- -d DURATION or --duration=DURATION : Duration of acquisition period, in minutes. Default value DURATION = 5
+ *	- -e or --ephemeris : Request ephemeris data (MID15, MID70). Default value EPHEM=TRUE
+ *	- -f PREFIX or --prefix=PREFIX : Prefix (path) for the OSP binary output file names. Default value PREFIX = (empty)
+ *	- -g or --G50bps : Request 50bps nav messages (MID8). Default value G50BPS=FALSE
+ *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -i OBSINT or --interval=OBSINT : Observation interval (in seconds) for epoch data. Default value OBSINT = 5
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
+ *	- -p PORTS or --ports=PORTS : Comma separated list of serial port names where receivers are connected. Default value PORTS = /dev/ttyUSB0
+ *	- -s MID or --stop=MID : MID (Message ID) ending each epoch, used for epoch statistics. Default value MID = 7
+ *	- -t STATINT or --stats=STATINT : Interval (in seconds) to log port statistics. Default value STATINT = 60
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ *		|		|Added option to dump performance counters at exit
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "PerfCounters.h"
+#include "Utilities.h"
+//from SerialTxRx
+#include "SerialTxRx.h"
+//standard
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <chrono>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#endif
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "MultiRXtoOSP {options}";
+const string MYVER = " V1.0";
+///Default baud rate for NMEA ASCII data transfers
+const int NMEAbRate = 9600;
+///Bit rates that can be used by receivers in unknown state
+const int bRates[] = {NMEAbRate, 57600, 1200, 2400, 4800, 38400, 115200, 0};
+///Time in seconds to wait for a correct message when probing a protocol, and after commanding a receiver to change its mode
+#define PROBEWAIT 5
+#define SWITCHWAIT 3
+///The maximum number of port events to get in each wait, and the maximum waiting time in milliseconds
+#define MAXEVENTS 16
+#define MAXWAIT 1000
+///The size of the output file stream buffer of each port
+#define OUTFILEBUF 65536
+//arguments for SiRF receiver commands, built from the OSP baud rate stated
+//NMEA cmd args to change mode from NMEA to OSP at the OSP baud rate (like 0,57600,8,1,0)
+string cmdNMEA100;
+//OSP cmd args to set the OSP baud rate (like 00 00 E1 00 08 01 00 00 for 57600 bps), 8 data bits, 1 stop bit, no parity
+string cmdOSP134;
+///The parser object to store options and operators passed in the comman line
+ArgParser parser;
+//Metavariables for options
+int BAUD, DURATION, PREFIX, G50BPS, HELP, EPHEM, OBSINT, LOGLEVEL, PERFOUT, PORTS, MID, STATINT;
+
+struct MSGwrite {
+	int msgId;
+	string payload;
+	int base;
+	string comment;
+
+	MSGwrite(int id, string pld, int bs, string exp) {
+		msgId = id;
+		payload = pld;
+		base = bs;
+		comment = exp;
+	}
+};
+vector <MSGwrite> lstWmsg;
+
+typedef chrono::steady_clock::time_point TimePoint;
+//States of the receiver port
+enum rxState {PROBEOSP=0, PROBENMEA, WAITSWITCH, CAPTURE, DONE, FAILED};
+
+struct RxPort {
+	string name;		//the serial port name
+	SerialTxRx port;	//the object used to communicate with the receiver
+	rxState state;		//the current state
+	TimePoint deadline;	//the time limit for the current state
+	bool switched;		//true if commands to change receiver mode to OSP have been sent
+	bool broadcast;		//true if commands to change mode to OSP have been sent at all baud rates
+	FILE* outFile;		//the OSP binary output file
+	int error;			//the error status of the output file: 0 (no error), 5 (cannot be created) or 6 (write error)
+	string fileName;	//the output file name
+	TimePoint start;	//the time when capture started
+	unsigned long long bytes;	//statistics: bytes received in capture state
+	unsigned long long lastBytes;	//bytes received up to the last statistics log
+	unsigned long msgs;			//correct messages recorded
+	unsigned long epochs;		//epochs recorded
+	unsigned long chkErrors;	//messages with checksum error
+	unsigned long lenErrors;	//messages with length out of margin
+	unsigned long skipped;		//bytes skipped out of messages
+};
+//@endcond
+#ifndef _WIN32
+//functions in this file
+void setProbe(RxPort*, rxState, int, Logger*);
+void onData(RxPort*, int, Logger*);
+void onDeadline(RxPort*, int, Logger*);
+bool startCapture(RxPort*, Logger*);
+void endCapture(RxPort*, rxState, Logger*);
+void logStats(RxPort*, double, Logger*);
+
+///Set by the signal handler when the process shall end
+volatile sig_atomic_t stopRequested = 0;
+void onSignal(int) {
+	stopRequested = 1;
+}
+
+/**main
+ * gets the command line arguments, set parameters accordingly and triggers the concurrent data acquisition from the receivers.
+ * Several SiRFIV GPS receivers can be connected to the serial ports stated. Ports are managed from a single event loop
+ * waiting (with epoll) for data available in any of them. Each port follows its own sequence of states:
+ *	- Probes if the receiver is sending OSP messages at the OSP baud rate
+ *	- If not, probes if it is sending NMEA messages at 9600 bps. If so, sends the NMEA command to change to OSP mode
+ *		and waits some seconds before probing OSP again
+ *	- If not, sends the commands to change to OSP mode at all baud rates, waits, and probes OSP again
+ *	- When the receiver is sending OSP messages, sends to it the setup commands (as the RXtoOSP command does), creates
+ *		the OSP binary output file for the port, and captures the messages received to it during the duration stated
+ *<p>Waits for receivers changing their mode do not block the process: other ports are probed or captured meanwhile.
+ * The sequence of commands sent to a receiver is the one SynchroRX uses to set OSP mode.
+ *<p>Output files are named with the prefix given, the base name of the port and the capture start time
+ * (i.e. ttyUSB0_20150126_205513.OSP). Their format is the one of RXtoOSP output files.
+ *<p>Capture statistics of each port (bytes, throughput, messages, epochs and errors) are logged periodically and at the end.
+ * Capture can be stopped before its duration with SIGINT or SIGTERM.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when opening and setting any communication port
+ *		- (3) any receiver is not sending OSP messages
+ *		- (5) error has occurred when creating any binary output OSP file
+ *		- (6) error has occurred when writing data read from any receiver
+ */
+int main(int argc, char** argv) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	MID = parser.addOption("-s", "--stop", "MID", "MID (Message ID) ending each epoch, used for epoch statistics", "7");
+	STATINT = parser.addOption("-t", "--stats", "STATINT", "Interval (in seconds) to log port statistics", "60");
+	PORTS = parser.addOption("-p", "--ports", "PORTS", "Comma separated list of serial port names where receivers are connected", "/dev/ttyUSB0");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
+	OBSINT = parser.addOption("-i", "--interval", "OBSINT", "Observation interval (in seconds) for epoch data", "5");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	G50BPS = parser.addOption("-g", "--G50bps", "G50BPS", "Request 50bps nav messages (MID8)", false);
+	PREFIX = parser.addOption("-f", "--prefix", "PREFIX", "Prefix (path) for the OSP binary output file names", "");
+	EPHEM = parser.addOption("-e", "--ephemeris", "EPHEM", "Request ephemeris data (MID15, MID70)", true);
+	DURATION = parser.addOption("-d", "--duration", "DURATION", "Duration of acquisition period, in minutes", "5");
+	BAUD = parser.addOption("-b", "--baud", "BAUD", "Serial port baud rate for OSP data", "57600");
+	/// 3- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("captures concurrently OSP message data from several SiRF IV receivers and stores them in OSP binary files", CMDLINE);
+		return 0;
+	}
+	/// 4- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
+	/// 5- Gets parameters from options and builds the sequence of setup commands to send to receivers
+	int obsIntl = stoi(parser.getStrOpt(OBSINT));
+	int ospBaud = stoi(parser.getStrOpt(BAUD));
+	bool baudValid = false;
+	for (int i = 0; bRates[i] != 0; i++) if (bRates[i] == ospBaud) baudValid = true;
+	if (!baudValid) {
+		parser.usage("Argument error: baud rate not allowed " + parser.getStrOpt(BAUD), CMDLINE);
+		log.severe("Baud rate not allowed " + parser.getStrOpt(BAUD));
+		return 1;
+	}
+	char cmdBuffer[40];
+	sprintf(cmdBuffer, "0,%d,8,1,0", ospBaud);
+	cmdNMEA100 = string(cmdBuffer);
+	sprintf(cmdBuffer, "%02X %02X %02X %02X 08 01 00 00", (ospBaud >> 24) & 0xFF, (ospBaud >> 16) & 0xFF, (ospBaud >> 8) & 0xFF, ospBaud & 0xFF);
+	cmdOSP134 = string(cmdBuffer);
+	int duration = stoi(parser.getStrOpt(DURATION)) * 60;
+	int stopMID = stoi(parser.getStrOpt(MID));
+	int statIntl = stoi(parser.getStrOpt(STATINT));
+	if (statIntl <= 0) statIntl = duration > 0? duration : 60;
+	lstWmsg.push_back(MSGwrite(166, "02 00 " + to_string((long long) obsIntl) + " 00 00 00 00", 10, "Enable all massesges at the interval stated"));
+	lstWmsg.push_back(MSGwrite(166, "04 00 00 00 00 00 00", 16, "Disable debug msgs"));
+	lstWmsg.push_back(MSGwrite(166, "00 1D 00 00 00 00 00", 16, "Disable navigation debug message 29"));
+	lstWmsg.push_back(MSGwrite(166, "00 1E 00 00 00 00 00", 16, "Disable navigation debug message 30"));
+	lstWmsg.push_back(MSGwrite(166, "00 1F 00 00 00 00 00", 16, "Disable navigation debug message 31"));
+	lstWmsg.push_back(MSGwrite(166, "00 04 00 00 00 00 00", 16, "Disable message 4 navigation"));
+	if (!parser.getBoolOpt(G50BPS))
+		lstWmsg.push_back(MSGwrite(166, "00 08 00 00 00 00 00", 16, "Disable message 8 50 BPD data"));
+	lstWmsg.push_back(MSGwrite(166, "00 40 00 00 00 00 00", 16, "Disable message 64 aux measurements data"));
+	lstWmsg.push_back(MSGwrite(166, "00 32 00 00 00 00 00", 16, "Disable message 50 SBAS stat"));
+	lstWmsg.push_back(MSGwrite(166, "00 29 00 00 00 00 00", 16, "Disable message 41 Geodetic nav"));
+	lstWmsg.push_back(MSGwrite(132, "00", 16, "Poll Software Version. Answer in MID6"));
+	lstWmsg.push_back(MSGwrite(152, "00", 16, "Poll Navigation parameters. Answer in MID19"));
+	if (parser.getBoolOpt(EPHEM)) {
+		for (int i = 0; i < 3; i++) lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
+		for (int i = 0; i < 3; i++)
+			lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
+	}
+	/// 6- Opens the ports stated, sets them in non blocking mode, and adds them to the set of ports to wait for
+	int status = 0;
+	int epfd = epoll_create1(0);
+	if (epfd == -1) {
+		log.severe("Cannot create the port event set: " + string(strerror(errno)));
+		return 2;
+	}
+	vector<RxPort*> rxPorts;
+	vector<string> portNames = getTokens(parser.getStrOpt(PORTS), ',');
+	for (vector<string>::iterator it = portNames.begin(); it != portNames.end(); it++) {
+		if (it->empty()) continue;
+		RxPort* prx = new RxPort();
+		prx->name = *it;
+		prx->switched = prx->broadcast = false;
+		prx->outFile = NULL;
+		prx->error = 0;
+		try {
+			prx->port.openPort(prx->name);
+			int fd = prx->port.getHandle();
+			if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == -1) throw string("Cannot set non blocking mode");
+			struct epoll_event ev;
+			ev.events = EPOLLIN;
+			ev.data.ptr = prx;
+			if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1) throw string("Cannot wait for port events: ") + strerror(errno);
+			setProbe(prx, PROBEOSP, ospBaud, &log);
+		} catch (string error) {
+			log.severe(prx->name + ": " + error);
+			prx->state = FAILED;
+			status = 2;
+		}
+		rxPorts.push_back(prx);
+	}
+	/// 7- Waits for port data and state deadlines, and processes them, until all ports have finished or a stop is requested
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	struct epoll_event events[MAXEVENTS];
+	TimePoint nextStats = chrono::steady_clock::now() + chrono::seconds(statIntl);
+	int nEvents, waitTime;
+	bool active = true;
+	while (active && !stopRequested) {
+		//compute the time to wait up to the nearest deadline
+		TimePoint now = chrono::steady_clock::now();
+		TimePoint nearest = nextStats;
+		for (vector<RxPort*>::iterator it = rxPorts.begin(); it != rxPorts.end(); it++)
+			if (((*it)->state < DONE) && ((*it)->deadline < nearest)) nearest = (*it)->deadline;
+		waitTime = (int) chrono::duration_cast<chrono::milliseconds>(nearest - now).count();
+		if (waitTime < 0) waitTime = 0;
+		if (waitTime > MAXWAIT) waitTime = MAXWAIT;
+		nEvents = epoll_wait(epfd, events, MAXEVENTS, waitTime);
+		if ((nEvents == -1) && (errno != EINTR)) {
+			log.severe("Error waiting for port events: " + string(strerror(errno)));
+			break;
+		}
+		for (int i = 0; i < nEvents; i++) {
+			RxPort* prx = (RxPort*) events[i].data.ptr;
+			onData(prx, stopMID, &log);
+			if ((prx->state < DONE) && (events[i].events & (EPOLLHUP | EPOLLERR))) {
+				log.warning(prx->name + ": port closed or in error");
+				endCapture(prx, prx->state == CAPTURE? DONE : FAILED, &log);
+			}
+			if (prx->state >= DONE) epoll_ctl(epfd, EPOLL_CTL_DEL, prx->port.getHandle(), NULL);
+		}
+		//process deadlines elapsed and log statistics when it is time to do it
+		now = chrono::steady_clock::now();
+		active = false;
+		for (vector<RxPort*>::iterator it = rxPorts.begin(); it != rxPorts.end(); it++) {
+			if (((*it)->state < DONE) && ((*it)->deadline <= now)) {
+				if ((*it)->state == CAPTURE) endCapture(*it, DONE, &log);
+				else onDeadline(*it, ospBaud, &log);
+				if ((*it)->state >= DONE) epoll_ctl(epfd, EPOLL_CTL_DEL, (*it)->port.getHandle(), NULL);
+			}
+			if ((*it)->state < DONE) active = true;
+		}
+		if (now >= nextStats) {
+			for (vector<RxPort*>::iterator it = rxPorts.begin(); it != rxPorts.end(); it++)
+				if ((*it)->state == CAPTURE) logStats(*it, (double) statIntl, &log);
+			nextStats = now + chrono::seconds(statIntl);
+		}
+	}
+	if (stopRequested) log.info("Stop requested");
+	/// 8- Ends captures in progress, logs final statistics of each port, and computes the exit status
+	for (vector<RxPort*>::iterator it = rxPorts.begin(); it != rxPorts.end(); it++) {
+		if ((*it)->state == CAPTURE) endCapture(*it, DONE, &log);
+		else if ((*it)->state < DONE) endCapture(*it, FAILED, &log);
+		if (((*it)->state == FAILED) && (status == 0)) status = 3;
+		if ((*it)->error > status) status = (*it)->error;
+		(*it)->port.closePort();
+		delete *it;
+	}
+	close(epfd);
+	return status;
+}
+
+/**setProbe
+ * sets the port at the given baud rate, to probe if the receiver is sending messages of the protocol associated to the given state.
+ *
+ *@param prx the receiver port
+ *@param state the probe state: PROBEOSP or PROBENMEA
+ *@param baud the baud rate to set
+ *@param plog the pointer to the Logger
+ */
+void setProbe(RxPort* prx, rxState state, int baud, Logger* plog) {
+	prx->port.setPortParams(baud, 0);
+	prx->state = state;
+	prx->deadline = chrono::steady_clock::now() + chrono::seconds(PROBEWAIT);
+	plog->info(prx->name + ": probing " + (state == PROBEOSP? "OSP" : "NMEA") + " messages at " + to_string((long long) baud));
+}
+
+/**onData
+ * processes the messages in the port input buffer, and reads and processes the data available in the port,
+ * according to the port state:
+ *	- when probing a protocol, a correct message of it changes the state (to capture or to wait receiver mode change)
+ *	- when waiting a receiver mode change, data are discarded
+ *	- when capturing, correct messages are recorded in the output file and statistics are updated
+ *
+ *@param prx the receiver port
+ *@param stopMID the MID ending each epoch
+ *@param plog the pointer to the Logger
+ */
+void onData(RxPort* prx, int stopMID, Logger* plog) {
+	unsigned char paylenBuff[2];
+	unsigned long ignored = 0;
+	int result;
+	try {
+		do {
+			switch (prx->state) {
+			case PROBEOSP:
+				while ((result = prx->port.takeOSPmsg(ignored)) > 0);
+				if (result == 0) {
+					LOG_FINE(plog, prx->name + ": OSP message received: MID=" + to_string((long long) prx->port.payBuff[0]));
+					if (!startCapture(prx, plog)) return;
+				}
+				break;
+			case PROBENMEA:
+				while ((result = prx->port.takeNMEAmsg(ignored)) > 0);
+				if (result == 0) {
+					LOG_FINE(plog, prx->name + ": NMEA message received: " + string((char*) prx->port.payBuff));
+					plog->info(prx->name + ": receiver in NMEA mode. Sends NMEA 100 to change to OSP: " + cmdNMEA100);
+					prx->port.writeNMEAcmd(100, cmdNMEA100);
+					prx->switched = true;
+					prx->state = WAITSWITCH;
+					prx->deadline = chrono::steady_clock::now() + chrono::seconds(SWITCHWAIT);
+					return;
+				}
+				break;
+			case WAITSWITCH:
+				while (prx->port.takeOSPmsg(ignored) != -1);
+				break;
+			case CAPTURE:
+				while ((result = prx->port.takeOSPmsg(prx->skipped)) != -1) {
+					switch (result) {
+					case 0:
+						prx->bytes += prx->port.payloadLen + 8;
+						prx->msgs++;
+						if (prx->port.payBuff[0] == stopMID) prx->epochs++;
+						paylenBuff[0] = prx->port.paylenBuff[0];
+						paylenBuff[1] = prx->port.paylenBuff[1];
+						if ((fwrite(paylenBuff, 1, 2, prx->outFile) != 2) ||
+							(fwrite(prx->port.payBuff, 1, prx->port.payloadLen, prx->outFile) != prx->port.payloadLen)) {
+							plog->severe(prx->name + ": write error in " + prx->fileName);
+							prx->error = 6;
+							endCapture(prx, FAILED, plog);
+							return;
+						}
+						break;
+					case 1:
+						prx->bytes += prx->port.payloadLen + 8;
+						prx->chkErrors++;
+						LOG_FINE(plog, prx->name + ": OSP<" + to_string((long long) prx->port.payBuff[0]) + "> Error in checksum");
+						break;
+					case 3:
+						prx->lenErrors++;
+						LOG_FINE(plog, prx->name + ": Error. Length out of margin");
+						break;
+					}
+				}
+				break;
+			default:
+				break;
+			}
+		} while ((prx->state < DONE) && prx->port.fillInput());
+	} catch (string error) {
+		plog->severe(prx->name + ": " + error);
+		endCapture(prx, FAILED, plog);
+	}
+}
+
+/**onDeadline
+ * changes the port state when the time limit of the current state has elapsed without the event waited for:
+ *	- probing OSP messages failed: probes NMEA messages, or broadcasts commands to change to OSP mode, or fails
+ *	- probing NMEA messages failed: broadcasts commands to change to OSP mode
+ *	- waiting receiver mode change finished: probes OSP messages
+ *
+ *@param prx the receiver port
+ *@param ospBaud the baud rate for OSP data
+ *@param plog the pointer to the Logger
+ */
+void onDeadline(RxPort* prx, int ospBaud, Logger* plog) {
+	int baud, timeout;
+	bool rawMode;
+	try {
+		switch (prx->state) {
+		case PROBEOSP:
+			plog->info(prx->name + ": receiver not sending OSP");
+			if (!prx->switched) {
+				setProbe(prx, PROBENMEA, NMEAbRate, plog);
+				return;
+			}
+			//after a mode change command has failed, broadcast commands
+			//falls through
+		case PROBENMEA:
+			if (prx->broadcast) {
+				plog->severe(prx->name + ": unable to set the receiver in OSP mode");
+				endCapture(prx, FAILED, plog);
+				return;
+			}
+			plog->info(prx->name + ": iterate over all baud rates trying to set receiver in OSP mode at " + to_string((long long) ospBaud) + " bps");
+			for (int i = 0; bRates[i] != 0; i++) {
+				prx->port.setPortParams(bRates[i], 0);
+				prx->port.writeNMEAcmd(100, cmdNMEA100);
+				prx->port.writeNMEAcmd(100, cmdNMEA100);
+				prx->port.writeOSPcmd(134, cmdOSP134);
+				prx->port.writeOSPcmd(134, cmdOSP134);
+				prx->port.getPortParams(baud, timeout, rawMode);
+				LOG_FINE(plog, prx->name + ": NMEA and OSP commands sent at BaudRate " + to_string((long long) baud));
+			}
+			prx->switched = prx->broadcast = true;
+			prx->state = WAITSWITCH;
+			prx->deadline = chrono::steady_clock::now() + chrono::seconds(SWITCHWAIT);
+			break;
+		case WAITSWITCH:
+			setProbe(prx, PROBEOSP, ospBaud, plog);
+			break;
+		default:
+			break;
+		}
+	} catch (string error) {
+		plog->severe(prx->name + ": " + error);
+		endCapture(prx, FAILED, plog);
+	}
+}
+
+/**startCapture
+ * sends the setup commands to the receiver, creates the OSP binary output file for the port and sets the capture state.
+ * The output file name is built from the prefix given, the port base name and the current time.
+ *
+ *@param prx the receiver port
+ *@param plog the pointer to the Logger
+ *@return true if the capture has been started, false if the output file cannot be created
+ */
+bool startCapture(RxPort* prx, Logger* plog) {
+	time_t rawtime;
+	char timeTag[40];
+	for (vector<MSGwrite>::iterator it = lstWmsg.begin() ; it != lstWmsg.end(); ++it) {
+		try {
+			LOG_CONFIG(plog, prx->name + ": W OSP<" + to_string((long long) it->msgId) + "> b" + to_string((long long) it->base) +" pld:"+ it->payload + ". " + it->comment);
+			prx->port.writeOSPcmd(it->msgId, it->payload, it->base);
+		} catch (string error) {	//an error has occurred when setting receiver
+			plog->severe(prx->name + ": " + error);
+		}
+	}
+	time(&rawtime);
+	strftime(timeTag, sizeof timeTag, "_%Y%m%d_%H%M%S.OSP", localtime(&rawtime));
+	size_t pos = prx->name.find_last_of("/\\");
+	prx->fileName = parser.getStrOpt(PREFIX) + (pos == string::npos? prx->name : prx->name.substr(pos + 1)) + timeTag;
+	if ((prx->outFile = fopen(prx->fileName.c_str(), "wb")) == NULL) {
+		plog->severe(prx->name + ": cannot create the binary output file " + prx->fileName);
+		prx->error = 5;
+		endCapture(prx, FAILED, plog);
+		return false;
+	}
+	setvbuf(prx->outFile, NULL, _IOFBF, OUTFILEBUF);
+	prx->bytes = prx->lastBytes = 0;
+	prx->msgs = prx->epochs = prx->chkErrors = prx->lenErrors = prx->skipped = 0;
+	prx->start = chrono::steady_clock::now();
+	prx->deadline = prx->start + chrono::seconds(stoi(parser.getStrOpt(DURATION)) * 60);
+	prx->state = CAPTURE;
+	plog->info(prx->name + ": capturing OSP messages to " + prx->fileName);
+	return true;
+}
+
+/**endCapture
+ * ends the processing of the port setting the given final state. If it was capturing, closes the output file and logs
+ * the final statistics.
+ *
+ *@param prx the receiver port
+ *@param state the final state: DONE or FAILED
+ *@param plog the pointer to the Logger
+ */
+void endCapture(RxPort* prx, rxState state, Logger* plog) {
+	if (prx->state == CAPTURE) {
+		prx->lastBytes = 0;		//final statistics give the mean throughput
+		logStats(prx, chrono::duration<double>(chrono::steady_clock::now() - prx->start).count(), plog);
+		if (fclose(prx->outFile) != 0) {
+			plog->severe(prx->name + ": write error closing " + prx->fileName);
+			prx->error = 6;
+			state = FAILED;
+		}
+		prx->outFile = NULL;
+		plog->info(prx->name + ": Acq End; nMsgs:" + to_string((long long) prx->msgs) + " nEpochs:" + to_string((long long) prx->epochs));
+	}
+	prx->state = state;
+}
+
+/**logStats
+ * logs the capture statistics of the port: bytes received and throughput since the last log, messages recorded,
+ * epochs, errors and bytes skipped.
+ *
+ *@param prx the receiver port
+ *@param seconds the time elapsed since the last log
+ *@param plog the pointer to the Logger
+ */
+void logStats(RxPort* prx, double seconds, Logger* plog) {
+	char textBuf[300];
+	sprintf(textBuf, "%s: bytes=%llu (%.0f B/s) msgs=%lu epochs=%lu chkErrors=%lu lenErrors=%lu skipped=%lu",
+		prx->name.c_str(), prx->bytes, seconds > 0? (prx->bytes - prx->lastBytes) / seconds : 0.0,
+		prx->msgs, prx->epochs, prx->chkErrors, prx->lenErrors, prx->skipped);
+	plog->info(string(textBuf));
+	prx->lastBytes = prx->bytes;
+}
+#else
+/**main
+ * informs that this command is not available: concurrent acquisition uses epoll, only available on Linux.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return (2) as ports cannot be managed
+ */
+int main(int argc, char** argv) {
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	log.severe("MultiRXtoOSP is only available on Linux. Use RXtoOSP for each receiver");
+	return 2;
+}
+#endif
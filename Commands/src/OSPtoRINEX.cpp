@@ -7,22 +7,38 @@
  *	- -b or --bias : Apply receiver clock bias to measurements and time. Default value TRUE
  *	- -c or --glo50bps : Use MID8 GLONASS 50bps data to generate GLONASS navigation file, instead of MID70. Default value FALSE
  *	- -d or --gps50bps : Use MID8 GPS 50bps data to generate nav file, instead of MID15. Default value FALSE
+ *	- -e BATCH or --batch=BATCH : Convert all OSP files (named *.OSP) in the given directory, or listed in the given text file (a file name per line). Default value: no batch
+ *	- -f FROMT or --fromtime=FROMT : Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec). Default value: 1st epoch in the input file
+ *	- -g FANOUT or --fanout=FANOUT : Additional observation files to generate from the same input (comma separated list of VER[:PREFIX[:SELLST]], see below). Default value: none
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
  *	- -i MINSV or --minsv=MINSV : Minimun satellites in a fix to acquire observations. Default value MINSV = 4
  *	- -j ANTN or --antnum=ANTN : Receiver antenna number. Default value ANTN = Antenna#
  *	- -k ANTT or --antype=ANTT : Receiver antenna type. Default value ANTT = AntennaType
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -m MRKNAM or --mrkname=MRKNAM : Marker name. Default value MRKNAM = MRKNAM
  *	- -n or --nav : Generate RINEX navigation file. Default value FALSE
  *	- -o OBSERVER or --observer=OBSERVER : Observer name. Default value OBSERVER = OBSERVER
  *	- -p PGM or --program=PGM : Program used to generate RINEX file. Default value OSPtoRINEX
  *	- -q RUNBY or --runby=RUNBY : Who runs the RINEX file generator. Default value RUNBY = RUNBY
  *	- -r RINEX or --rinex=RINEX : RINEX file name prefix. Default value RINEX = PNT1
+ *	- -S JOBS or --serve=JOBS : Run conversion jobs read from the given input (--serve=- for the standard input) as a server, see below. Default value: no server
  *	- -s SYSLST or --selsys=SYSLST : List of additional systems to GPS (R or S or R,S) to be included in the RINEX files. Default value an empty list
+ *	- -t TOT or --totime=TOT : Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec). Default value: last epoch in the input file
  *	- -u MRKNUM or --mrknum=MRKNUM : Marker number. Default value MRKNUM = MRKNUM
  *	- -v VER or --ver=VER : RINEX version to generate (V210, V300). Default value VER = V210
+ *	- -w WORKERS or --workers=WORKERS : Number of worker threads used in batch conversions. Default value WORKERS = 0 (as many as hardware threads)
+ *	- -x or --index : Use the index file of the OSP input file, creating it if it does not exist. Default value FALSE
  *	- -y AGENCY or --agency=AGENCY : Agency name. Default value AGENCY = AGENCY
  *Default value for operator is: DATA.OSP 
+ *<p>Each additional observation file in FANOUT is stated by the RINEX version to generate (V210 or V302), the file name prefix (by default, the
+ * RINEX option value), and a list of system-satellites or system-observables (ver.3.02 notation) to select, separated by +
+ * (like V302:PNTG:G+GC1C). OSP messages are decoded once for all the observation files generated.
+ * Errors in additional files are logged and these files skipped: the main observation file is generated anyway.
+ *<p>When JOBS is given, the program runs as a long lived server of conversion jobs (see JobServer). Each input line contains a job
+ * identifier followed by the options and operator of a conversion, as they would be given in the command line (without JOBS,
+ * LOGLEVEL and PERFOUT, which are stated for the server). A reply line with the job identifier, its exit status, elapsed time and
+ * result is written to the standard output when each job ends. Jobs are run using WORKERS threads.
  *<p>
  *Copyright 2015 Francisco Cancillo
  *<p>
@@ -43,13 +59,23 @@
  *				|Added capability to generate GLONASS navigation files
  *				|Added capability to generate multiple navigation files in V2.10
  *V2.1	|2/2018	|Reviewed to run on Linux
+ *V2.2	|10/2026	|Header, GLONASS parameters and epoch data acquired in a single pass of the input file
+ *				|Added options to use an OSP index file and to select epochs in a time window
+ *				|Added batch conversion of several OSP files using worker threads
+ *				|Added option to dump performance counters at exit
+ *				|Added option to generate several observation files from the same input
+ *				|Added server mode to run conversion jobs in a long lived process
  */
 
 //from CommonClasses
 #include "ArgParser.h"
+#include "BatchRunner.h"
+#include "JobServer.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "Utilities.h"
 #include "GNSSdataFromOSP.h"
+#include "OSPIndex.h"
 #include "RinexData.h"
 
 
@@ -63,20 +89,35 @@ const string THISPRG = "OSPtoRINEX";
 ///The command line format
 const string CMDLINE = THISPRG + ".exe {options} [OSPfilename]";
 ///Current program version
-const string MYVER = " V2.1 ";
+const string MYVER = " V2.2 ";
 ///A common message
 const string FILENOK = "Cannot open or create file ";
 ///The receiver name
 const string RECEIVER_NAME = "SiRF";
-//The parser object to store options and operators passed in the comman line
-ArgParser parser;
-//Metavariables for options
-int AGENCY, APPEND, ANTN, ANTT, APBIAS, MID8G, MID8R, HELP, LOGLEVEL, NAVI, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, RINEX, RUNBY, SELSYS, TOFO, VER;
+//Metavariables for options (set once in main before any conversion starts)
+int AGENCY, APPEND, ANTN, ANTT, APBIAS, BATCH, FANOUT, FROMT, MID8G, MID8R, HELP, INDEX, LOGLEVEL, PERFOUT, NAVI, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, RINEX, RUNBY, SELSYS, SERVE, TOFO, TOT, VER, WORKERS;
 //Metavariables for operators
 int OSPF;
+///An additional observation file generated from the same input data
+struct FanoutSink {
+	RinexData::RINEXversion version;	//the RINEX version of the file
+	string prefix;			//the file name prefix
+	vector<string> selSat;	//the system-satellites selected
+	vector<string> selObs;	//the system-observables selected
+	RinexData* rinex;		//the object used to print the file
+	FILE* outFile;			//the file, or NULL if not open
+	string outFileName;
+};
 //functions in this file
-int generateRINEX(FILE*, Logger*);
-void prinfNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
+int runJob(const ArgParser &, int, char**, Logger*, string &);
+int runConversion(ArgParser &, Logger*, string &);
+int convertOSPfile(ArgParser &, const string &, bool, double, bool, double, Logger*, string &);
+int generateRINEX(ArgParser &, FILE*, OSPIndex*, double, double, Logger*);
+void prinfNavFile(ArgParser &, RinexData &, RinexData::RINEXversion, char, Logger*);
+bool openFanoutSinks(ArgParser &, const string &, vector<FanoutSink> &, Logger*);
+bool openFanoutSink(const string &, const string &, FanoutSink &, Logger*);
+void printFanoutEpoch(vector<FanoutSink> &, RinexData &, Logger*);
+void closeFanoutSinks(vector<FanoutSink> &);
 //@endcond 
 /**main
  * gets the command line arguments, sets parameters accordingly and triggers the data acquisition to generate RINEX files.
@@ -93,15 +134,19 @@ void prinfNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
  *		- (1) an error has been detected in arguments
  *		- (2) error when opening the input file
  *		- (3) error when creating output files or no epoch data exist
+ *<p>In batch conversions the exit status is the greatest one of the files converted, and in server mode the greatest one of the jobs run.
  */
 int main(int argc, char* argv[]) {
 	/**The main process sequence follows:*/
-	/// 1- Defines and sets the error logger object
+	/// 1- Defines and sets the error logger object, and the parser object to store options and operators passed in the command line
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + COMPDATE + string(" START"));
+	ArgParser parser;
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
 	AGENCY = parser.addOption("-y", "--agency", "AGENCY", "Agency name", "AGENCY");
+	WORKERS = parser.addOption("-w", "--workers", "WORKERS", "Number of worker threads for batch conversions (0 = hardware threads)", "0");
 	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V302)", "V210");
 	MRKNUM = parser.addOption("-u", "--mrknum", "MRKNUM", "Marker number", "MRKNUM");
+	SERVE = parser.addOption("-S", "--serve", "JOBS", "Run as a server the conversion jobs read from the given input (--serve=- for stdin)", "");
 	SELSYS = parser.addOption("-s", "--selsys", "SELSYS", "Systems from input in addition to GPS (R,S or R or S)", "");
 	RINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "PNT1");
 	RUNBY = parser.addOption("-q", "--runby", "RUNBY", "Who runs the RINEX file generation", "RUNBY");
@@ -110,16 +155,23 @@ int main(int argc, char* argv[]) {
 	NAVI = parser.addOption("-n", "--nRINEX", "NAVI", "Generate RINEX navigation file", false);
 	MRKNAM = parser.addOption("-m", "--mrkname", "MRKNAM", "Marker name", "MRKNAM");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	ANTT = parser.addOption("-k", "--antype", "ANTT", "Receiver antenna type", "AntennaType");
 	ANTN = parser.addOption("-j", "--antnum", "ANTN", "Receiver antenna number", "Antenna#");
 	MINSV = parser.addOption("-i", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	FANOUT = parser.addOption("-g", "--fanout", "FANOUT", "Additional observation files to generate (comma separated list of VER[:PREFIX[:SEL+SEL...]], like V302:PNTG:G+GC1C)", "");
 	MID8G = parser.addOption("-d", "--gps50bps", "MID8G", "Use MID8 GPS 50bps data to generate nav file", false);
 	MID8R = parser.addOption("-c", "--glo50bps", "MID8R", "Use MID8 GLONASS 50bps data to generate nav file", false);
 	APBIAS = parser.addOption("-b", "--bias", "APBIAS", "Apply receiver clock bias to measurements (and time)", true);
 	APPEND = parser.addOption("-a", "--aend", "APPEND", "Append end-of-file comment lines to Rinex file", false);
+	BATCH = parser.addOption("-e", "--batch", "BATCH", "Convert all OSP files in the given directory or list file", "");
+	FROMT = parser.addOption("-f", "--fromtime", "FROMT", "Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	TOT = parser.addOption("-t", "--totime", "TOT", "Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	INDEX = parser.addOption("-x", "--index", "INDEX", "Use the OSP file index (created if not existing)", false);
 	/// 3- Setups the default values for operators in the command line
 	OSPF = parser.addOperator("DATA.OSP");
+	const ArgParser jobParser(parser);	//a parser without arguments, to be copied for each job in server mode
 	/// 4- Parses arguments in the command line extracting options and operators
 	try {
 		parser.parseArgs(argc, argv);
@@ -135,32 +187,181 @@ int main(int argc, char* argv[]) {
 		parser.usage("Generates RINEX files from an OSP data file containing SiRF IV receiver messages", CMDLINE);
 		return 0;
 	}
-	/// 5- Sets logging level stated in option
+	/// 5- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 6- Opens the OSP binary file
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
+	/// 6- If server mode is requested, runs the conversion jobs read from the given input using worker threads
+	string aStr = parser.getStrOpt(SERVE);
+	if (!aStr.empty()) {
+		FILE* jobsFile = aStr.compare("-") == 0? stdin : fopen(aStr.c_str(), "r");
+		if (jobsFile == NULL) {
+			log.severe(FILENOK + aStr);
+			return 2;
+		}
+		JobServer server(stoi(parser.getStrOpt(WORKERS)), string(argv[0]), &log);
+		int status = server.serve(jobsFile, stdout, [&](int jobArgc, char** jobArgv, string &result) {
+			return runJob(jobParser, jobArgc, jobArgv, &log, result);
+		});
+		if (jobsFile != stdin) fclose(jobsFile);
+		return status;
+	}
+	/// 7- Otherwise performs the conversion requested in the command line
+	string result;
+	return runConversion(parser, &log, result);
+}
+
+/**runJob performs a conversion job received in server mode.
+ *<p>The job arguments are parsed using a copy of the given parser, and the conversion requested is performed as it would be
+ * performed from the command line. It can be called from several threads at the same time.
+ *
+ *@param jobParser the ArgParser with the options defined and without arguments parsed
+ *@param argc the number of job arguments, including the program name
+ *@param argv the job arguments, as per main
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status as described for main
+ */
+int runJob(const ArgParser &jobParser, int argc, char** argv, Logger* plog, string &result) {
+	ArgParser parser(jobParser);
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		result = "Argument error: " + error;
+		return 1;
+	}
+	if (parser.getBoolOpt(HELP) || !parser.getStrOpt(SERVE).empty()) {
+		result = "Argument error: help and server options cannot be used in jobs";
+		return 1;
+	}
+	plog->info(parser.showOptValues());
+	plog->info(parser.showOpeValues());
+	return runConversion(parser, plog, result);
+}
+
+/**runConversion performs the conversion requested in the options and operator of the given parser: a batch conversion,
+ * or the conversion of the OSP file given as operator, selecting epochs in the time window stated.
+ *
+ *@param parser the ArgParser containing the options and operator of the conversion. Its data are only read
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status as described for main
+ */
+int runConversion(ArgParser &parser, Logger* plog, string &result) {
+	/**The runConversion process sequence follows:*/
+	/// 1- Sets 1st and last epoch time tags (if selected from / to epochs time)
+	bool fromTime = false, toTime = false;
+	double fromTimeTag = 0.0, toTimeTag = 0.0;
+	int week, year, month, day, hour, minute;
+	double tow, second;
+	string aStr = parser.getStrOpt(FROMT);
+	if (!aStr.empty()) {
+		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
+			result = "Cannot state 'from time' for the time interval";
+			plog->severe(result);
+			return 1;
+		}
+		setWeekTow (year, month, day, hour, minute, second, week, tow);
+		fromTimeTag = getSecsGPSEphe(week, tow);
+		fromTime = true;
+	}
+	aStr = parser.getStrOpt(TOT);
+	if (!aStr.empty()) {
+		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
+			result = "Cannot state 'to time' for the time interval";
+			plog->severe(result);
+			return 1;
+		}
+		setWeekTow (year, month, day, hour, minute, second, week, tow);
+		toTimeTag = getSecsGPSEphe(week, tow);
+		toTime = true;
+	}
+	/// 2- If batch conversion is requested, converts all the files in the directory or list given using worker threads
+	aStr = parser.getStrOpt(BATCH);
+	if (!aStr.empty()) {
+		vector<string> files;
+		try {
+			files = BatchRunner::getFileList(aStr, BatchRunner::isOSPfileName);
+		} catch (string error) {
+			result = error;
+			plog->severe(error);
+			return 2;
+		}
+		BatchRunner batch(stoi(parser.getStrOpt(WORKERS)), plog);
+		result = "Batch of files converted: " + to_string((long long) files.size());
+		return batch.run(files, [&](const string &fileName, string &fileResult) {
+			return convertOSPfile(parser, fileName, fromTime, fromTimeTag, toTime, toTimeTag, plog, fileResult);
+		});
+	}
+	/// 3- Otherwise converts the OSP file given in the command line
+	return convertOSPfile(parser, parser.getOperator(OSPF), fromTime, fromTimeTag, toTime, toTimeTag, plog, result);
+}
+
+/**convertOSPfile generates the RINEX files for the given OSP file, using the options in the parser.
+ *<p>It uses its own objects to acquire data and print RINEX files, and can be called from several threads at the same time.
+ * Errors and the conversion result are logged, and the result is also given in the result param.
+ *
+ *@param parser the ArgParser containing the options in the command line. Its data are only read
+ *@param fileName the name of the OSP binary file
+ *@param fromTime true when epochs shall be selected from fromTimeTag
+ *@param fromTimeTag the start of the time window for epochs to acquire
+ *@param toTime true when epochs shall be selected before toTimeTag
+ *@param toTimeTag the end of the time window for epochs to acquire
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status (0, 2 or 3) as described for main
+ */
+int convertOSPfile(ArgParser &parser, const string &fileName, bool fromTime, double fromTimeTag, bool toTime, double toTimeTag, Logger* plog, string &result) {
+	/// 1- Opens the OSP binary file
 	FILE* inFile;
-	string fileName = parser.getOperator (OSPF);
 	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
-		log.severe(FILENOK + fileName);
+		result = FILENOK + fileName;
+		plog->severe(result);
 		return 2;
 	}
-	/// 7- Calls generateRINEX to generate RINEX files extracting data from messages in the binary OSP file
-	int n = generateRINEX(inFile, &log);
-	log.info("End of RINEX generation. Epochs read: " + to_string((long long) n));
+	/// 2- If requested, or a time window is selected, loads the OSP file index, or builds it when not available or not matching the file.
+	/// The index is used only when a time window is selected
+	OSPIndex ospIdx;
+	OSPIndex* pIdx = NULL;
+	if (parser.getBoolOpt(INDEX) || fromTime || toTime) {
+		string idxName = OSPIndex::indexFileName(fileName);
+		if (ospIdx.load(idxName, inFile)) plog->info("Using OSP index file " + idxName);
+		else {
+			if (!ospIdx.build(inFile)) plog->warning("Truncated message at the end of " + fileName);
+			if (parser.getBoolOpt(INDEX)) {
+				if (ospIdx.save(idxName)) plog->info("Created OSP index file " + idxName);
+				else plog->warning(FILENOK + idxName);
+			}
+		}
+		if (fromTime || toTime) pIdx = &ospIdx;
+		if (!toTime) toTimeTag = getSecsGPSEphe(9999, 0.0);
+	}
+	/// 3- Calls generateRINEX to generate RINEX files extracting data from messages in the binary OSP file
+	int n = generateRINEX(parser, inFile, pIdx, fromTimeTag, toTimeTag, plog);
+	result = "Epochs read: " + to_string((long long) n);
+	plog->info("End of RINEX generation. " + result);
 	fclose(inFile);
 	return n>0? 0:3;
 }
+
 /**generateRINEX iterates over the input OSP file processing GNSS receiver messages to extract RINEX data and print them.
+ *<p>When an index of the input file is given, navigation data are acquired from all navigation messages in the file,
+ * and epoch data only from the epochs in the given time window.
  *
+ *@param parser the ArgParser containing the options in the command line
  *@param inFile is the FILE containing the binary OSP messages
+ *@param pIdx point to the index of the input file, or NULL if not available
+ *@param fromTag the start of the time window for epochs to acquire (used only with index)
+ *@param toTag the end of the time window for epochs to acquire (used only with index)
  *@param plog point to the Logger
  *@return the number of epochs read in the inFile
  */
-int generateRINEX(FILE* inFile, Logger* plog) {
+int generateRINEX(ArgParser &parser, FILE* inFile, OSPIndex* pIdx, double fromTag, double toTag, Logger* plog) {
 	/**The generateRINEX process sequence follows:*/
 	int epochCount;		//to count the number of epochs processed
 	string outFileName;	//the output file name for RINEX files
 	FILE* obsFile;		//the file where RINEX observation data will be printed
+	vector<FanoutSink> sinks;	//the additional observation files requested
 	vector<string> selSys;	//the selected systems
 	vector<string> selObs;	//the empty selected observations
 	vector<string> observables = getTokens("C1C,L1C,D1C,S1C", ',');	//the defined observables in OSP
@@ -194,39 +395,53 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 	}
 	/// 2- Setups the GNSSdataFromOSP object used to extract message data from the OSP file
 	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), inFile, plog);
-	/// 3- Starts data acquisition extracting RINEX header data located in the binary file
-	if(!gnssAcq.acqHeaderData(rinex)) {
+	/// 3- If an index is available, acquires navigation data and GLONASS parameters (if needed) from the indexed messages
+	/// and positions the input file at the time window selected
+	if (pIdx != NULL) {
+		gnssAcq.setIndex(pIdx);
+		gnssAcq.acqIndexedData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R), glonassSel);
+		glonassSel = false;
+		if (!gnssAcq.setTimeWindow(fromTag, toTag)) plog->warning("Time window for epochs not stated");
+	}
+	/// 4- Acquires in a single pass of the binary file RINEX header data, GLONASS parameters (if needed) and epoch data
+	if(!gnssAcq.acqAllData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R), glonassSel)) {
 		plog->warning("All, or some header data not acquired");
 	};
-	if (glonassSel) gnssAcq.acqGLOparams();
-	/// 4- For the observation RINEX file, generate the filename in standard format, create it, print header,
+	/// 5- For the observation RINEX file, generates the filename in standard format, creates it and prints its header
 	outFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
 	if ((obsFile = fopen(outFileName.c_str(), "w")) == NULL) {
 		plog->severe(FILENOK + outFileName);
 		return 0;
 	}
+	epochCount = 0;
 	try {
 		rinex.printObsHeader(obsFile);
-	/// and iterate over the binary OSP file extracting epoch by epoch data and printing them
-		epochCount = 0;
-		rewind(inFile);
-		while (gnssAcq.acqEpochData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R))) {
+		fflush(obsFile);
+		/// 6- Creates the additional observation files requested, if any, printing their headers from the one printed
+		if (!openFanoutSinks(parser, outFileName, sinks, plog)) plog->warning("Some additional observation files not generated");
+		/// 7- Iterates over the epochs acquired, printing them in the observation file and in the additional ones
+		while (gnssAcq.getBufferedEpoch(rinex)) {
+			printFanoutEpoch(sinks, rinex, plog);
 			rinex.printObsEpoch(obsFile);
 			epochCount++;
 		}
-		if (parser.getBoolOpt(APPEND)) rinex.printObsEOF(obsFile);
+		if (parser.getBoolOpt(APPEND)) {
+			rinex.printObsEOF(obsFile);
+			for (vector<FanoutSink>::iterator it = sinks.begin(); it != sinks.end(); it++) it->rinex->printObsEOF(it->outFile);
+		}
 	} catch (string error) {
 		plog->severe(error);
 	}
+	closeFanoutSinks(sinks);
 	fclose(obsFile);
-	/// 5- If navigation RINEX file requested, generate the filename in standard format, create it, print header,
+	/// 8- If navigation RINEX file requested, generate the filename in standard format, create it, print header,
 	if (prtNav) {
 		if (rinexVer == RinexData::V302) {
-			prinfNavFile(rinex, rinexVer, 'M', plog);
+			prinfNavFile(parser, rinex, rinexVer, 'M', plog);
 		}
 		else {
 			for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) {
-				prinfNavFile(rinex, rinexVer, it->at(0), plog);
+				prinfNavFile(parser, rinex, rinexVer, it->at(0), plog);
 			}
 		}
 	}
@@ -236,13 +451,14 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 /**prinfNavFile prints a RINEX navigation file from the navigation data stored stored in the given RinexData object.
  *File format will be according the given version, and for the given satellite system if version to be generated is 2.10.
  *
+ *@param parser the ArgParser containing the options in the command line
  *@param rinex is the RinexData object containing navigation data for the file to be printed
  *@param ver is the RINEX version of the file to be generated
  *@param sysId is the identification of the satellite system data to be printed. Only relevant for version 2.10 files.
  *@param plog a pointer to the Logger object where logging messages will be printed
  */
 
-void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
+void prinfNavFile(ArgParser &parser, RinexData &rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
 	FILE* navFile;		//the file where RINEX navigation data will be printed
 	string outFileName;	//the output file name for RINEX files
 	char fnameSfx;
@@ -275,3 +491,127 @@ void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Log
 	}
 	fclose(navFile);
 }
+
+/**openFanoutSinks creates the additional observation files requested in the FANOUT option, and prints their headers.
+ *<p>Each file is printed using its own RINEX object, with the version and filtering data requested, and the header data read from
+ * the observation file already printed. Epochs data are copied to these objects from the one where they are acquired.
+ *<p>Additional files that cannot be created are logged and not included in sinks: the other ones are generated anyway.
+ *
+ *@param parser the ArgParser containing the options in the command line
+ *@param obsFileName the name of the RINEX observation file whose header has been printed
+ *@param sinks the additional files opened, with their RINEX objects
+ *@param plog point to the Logger
+ *@return true if all the additional files requested have been created, false otherwise
+ */
+bool openFanoutSinks(ArgParser &parser, const string &obsFileName, vector<FanoutSink> &sinks, Logger* plog) {
+	vector<string> specs = getTokens(parser.getStrOpt(FANOUT), ',');
+	vector<string> fields, selTokens;
+	bool allOpen = true;
+	for (vector<string>::iterator it = specs.begin(); it != specs.end(); it++) {
+		FanoutSink sink;
+		fields = getTokens(*it, ':');
+		if (fields.empty() || ((fields[0].compare("V210") != 0) && (fields[0].compare("V302") != 0))) {
+			plog->warning("Ignored additional file with unknown RINEX version: " + *it);
+			continue;
+		}
+		sink.version = fields[0].compare("V302") == 0? RinexData::V302 : RinexData::V210;
+		sink.prefix = (fields.size() > 1) && !fields[1].empty()? fields[1] : parser.getStrOpt(RINEX);
+		if (fields.size() > 2) {
+			selTokens = getTokens(fields[2], '+');
+			for (vector<string>::iterator itSel = selTokens.begin(); itSel != selTokens.end(); itSel++)
+				if (itSel->size() == 4) sink.selObs.push_back(*itSel);
+				else sink.selSat.push_back(*itSel);
+		}
+		sink.rinex = new RinexData(sink.version, plog);
+		sink.outFile = NULL;
+		if (openFanoutSink(obsFileName, *it, sink, plog)) sinks.push_back(sink);
+		else {
+			plog->severe("Additional observation file " + *it + " not generated");
+			delete sink.rinex;
+			allOpen = false;
+		}
+	}
+	return allOpen;
+}
+
+/**openFanoutSink creates an additional observation file, and prints its header from the one of the observation file printed.
+ *
+ *@param obsFileName the name of the RINEX observation file whose header has been printed
+ *@param spec the specification of the additional file in the FANOUT option
+ *@param sink the additional file to open, with its RINEX object and filtering data
+ *@param plog point to the Logger
+ *@return true if the file has been created and its header printed, false otherwise (the file is not left open)
+ */
+bool openFanoutSink(const string &obsFileName, const string &spec, FanoutSink &sink, Logger* plog) {
+	FILE* inFile;
+	int week;
+	double tow;
+	string aStr;
+	RinexData &rinex = *sink.rinex;
+	if ((inFile = fopen(obsFileName.c_str(), "r")) == NULL) {
+		plog->severe(FILENOK + obsFileName);
+		return false;
+	}
+	try {
+		rinex.readRinexHeader(inFile);
+	}  catch (string error) {
+		plog->severe(error);
+		fclose(inFile);
+		return false;
+	}
+	fclose(inFile);
+	if (rinex.getHdLnData(RinexData::TOFO, week, tow, aStr)) rinex.setEpochTime(week, tow);
+	if (!rinex.setFilter(sink.selSat, sink.selObs))
+		plog->warning("Error in some data filtering parameters of " + spec + ". Erroneous data ignored");
+	sink.outFileName = rinex.getObsFileName(sink.prefix);
+	if ((sink.outFile = fopen(sink.outFileName.c_str(), "w")) == NULL) {
+		plog->severe(FILENOK + sink.outFileName);
+		return false;
+	}
+	try {
+		rinex.printObsHeader(sink.outFile);
+	}  catch (string error) {
+		plog->severe(error);
+		fclose(sink.outFile);
+		sink.outFile = NULL;
+		remove(sink.outFileName.c_str());
+		return false;
+	}
+	rinex.clearHeaderData();
+	return true;
+}
+
+/**printFanoutEpoch prints in the additional observation files the current epoch of the given RINEX object, before it is printed
+ * (and its data filtered) by this object.
+ *<p>Additional files where the epoch cannot be printed are logged, closed and removed from sinks: the other ones are printed anyway.
+ *
+ *@param sinks the additional files, with their RINEX objects
+ *@param rinex the RINEX object containing the epoch acquired
+ *@param plog point to the Logger
+ */
+void printFanoutEpoch(vector<FanoutSink> &sinks, RinexData &rinex, Logger* plog) {
+	vector<FanoutSink>::iterator it = sinks.begin();
+	while (it != sinks.end()) {
+		try {
+			if (it->rinex->copyObsEpoch(rinex)) it->rinex->printObsEpoch(it->outFile);
+			it++;
+		} catch (string error) {
+			plog->severe(error + ". Incomplete additional observation file " + it->outFileName);
+			fclose(it->outFile);
+			delete it->rinex;
+			it = sinks.erase(it);
+		}
+	}
+}
+
+/**closeFanoutSinks closes the additional observation files, and releases their RINEX objects.
+ *
+ *@param sinks the additional files, with their RINEX objects
+ */
+void closeFanoutSinks(vector<FanoutSink> &sinks) {
+	for (vector<FanoutSink>::iterator it = sinks.begin(); it != sinks.end(); it++) {
+		if (it->outFile != NULL) fclose(it->outFile);
+		delete it->rinex;
+	}
+	sinks.clear();
+}
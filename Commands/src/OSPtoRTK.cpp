@@ -6,7 +6,9 @@
  *<p>Options are:
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -m MINSV or --minsv=MINSV : Minimum satellites in a fix to acquire solution data. Default value MINSV = 4
+ *	- -s or --stream : Read the OSP file only once, printing the header when the first block of solutions is written and updating its times at the end. Default value STREAM = FALSE
  * Default values for operators are: DATA.OSP 
  *<p>
  *Copyright 2015 Francisco Cancillo
@@ -25,11 +27,15 @@
  *V1.0	|2/2015	|First release
  *V1.1	|2/2016	|Minor improvements for logging messages
  *V1.2	|2/2018	|Reviewed to run on Linux
+ *V1.3	|10/2026	|Added option to dump performance counters at exit
+ *V1.4	|10/2026	|Solutions are rendered into a buffer written in large blocks
+ *		|		|Added streaming mode: the OSP file is read once, skipping messages without RTK data, and header times are patched at the end
  */
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "RTKobservation.h"
 #include "GNSSdataFromOSP.h"
 #include "OSPMessage.h"
@@ -39,18 +45,19 @@ using namespace std;
 //@cond DUMMY
 ///The command line format
 const string CMDLINE = "OSPtoRTK {options} [OSPfileName]";
-const string MYVER = " V1.2";
+const string MYVER = " V1.4";
 ///The receiver name
 const string RECEIVER_NAME = "SiRF";
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int HELP, LOGLEVEL, MINSV;
+int HELP, LOGLEVEL, PERFOUT, MINSV, STREAM;
 //Metavariables for operators
 int OSPF;
 //@endcond 
 //functions in this module
 void generateRTKobs(FILE*, FILE*, string, string, Logger*);
+void streamRTKobs(FILE*, FILE*, string, string, Logger*);
 
 /**main
  * gets the command line arguments, set parameters accordingly and triggers the data acquisition to generate the RTK file.
@@ -71,7 +78,9 @@ int main(int argc, char** argv) {
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
 	MINSV = parser.addOption("-m", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
+	STREAM = parser.addOption("-s", "--stream", "STREAM", "Read the OSP file once, patching the header times at the end", false);
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
 	/// 3- Setups the default values for operators in the command line
 	OSPF = parser.addOperator("DATA.OSP");
@@ -89,8 +98,10 @@ int main(int argc, char** argv) {
 		parser.usage("Generates a RTK file with positioning data extracted from a OSP data file", CMDLINE);
 		return 0;
 	}
-	/// 5- Sets logging level stated in option
+	/// 5- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
 	/// 6- Opens the OSP binary file
 	FILE* inFile;
 	string fileName = parser.getOperator (OSPF);
@@ -105,8 +116,9 @@ int main(int argc, char** argv) {
 		log.severe("Cannot create file " + rtkFileName);
 		return 3;
 	}
-	/// 8- Generates RTK file calling generateRTKobs to extract data from messages in the binary OSP file and print them
-	generateRTKobs(inFile, rtkFile, fileName, string(argv[0]) + MYVER, &log);
+	/// 8- Generates RTK file calling generateRTKobs (or streamRTKobs in streaming mode) to extract data from messages in the binary OSP file and print them
+	if (parser.getBoolOpt(STREAM)) streamRTKobs(inFile, rtkFile, fileName, string(argv[0]) + MYVER, &log);
+	else generateRTKobs(inFile, rtkFile, fileName, string(argv[0]) + MYVER, &log);
     fclose(inFile);
     fclose(rtkFile);
 	return 0;
@@ -136,11 +148,66 @@ void generateRTKobs(FILE* inFile, FILE* rtkFile, string inFileName, string prgNa
 	/// 4- Prints RTK file header
 	rtko.printHeader(rtkFile);
 	rewind(inFile);
-	/// 6- Iterates over the binary OSP file extracting epoch by epoch solution data and printing them
+	/// 6- Iterates over the binary OSP file extracting epoch by epoch solution data and printing them in blocks
+	OutputBuffer solutions;
 	while (gnssAcq.acqEpochData(rtko)) {
-		rtko.printSolution(rtkFile);
+		rtko.printSolution(solutions);
+		if (solutions.size() >= OUTBUFBLOCKSIZE) solutions.write(rtkFile);
 		nEpochs++;
 	}
+	solutions.write(rtkFile);
+	plog->info("End of data extraction. Epochs read: " + to_string((long long) nEpochs));
+}
+
+/**streamRTKobs
+ * reads once the input OSP file extracting RTK positioning data, and prints them.
+ * Only messages containing RTK data are decoded. Solutions are rendered into a buffer written in large blocks.
+ * The header is printed before the first block, with the masks acquired so far, and its start and end times are patched when
+ * all solutions have been acquired. If the file contains only one block, the header is printed at the end with all data known.
+ *
+ * @param inFile the  pointer to the input OSP binary FILE
+ * @param rtkFile the  pointer to the output RTK FILE. It shall be positionable
+ * @param inFileName the  name of the input OSP binary FILE
+ * @param prgName the program name
+ * @param plog the pointer to the logger
+ */
+void streamRTKobs(FILE* inFile, FILE* rtkFile, string inFileName, string prgName, Logger* plog) {
+	/**The streamRTKobs process sequence follows:*/
+	int nEpochs = 0;		//to count the number of epochs processed
+	bool maskSet = false;		//the masks have been acquired
+	bool headerMaskSet = false;	//the masks were acquired when the header was printed
+	bool headerPrinted = false;
+	OutputBuffer solutions;
+	/// 1- Setups the GNSSdataFromOSP object used to extract data from the binary file
+	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), true, inFile, plog);
+	/// 2- Setups the RTKobservation object where extracted RTK data from the binary file will be placed 
+	RTKobservation rtko(prgName, inFileName);
+	/// 3- Iterates over the binary OSP file extracting solution data, stating header times, and rendering solutions
+	while (gnssAcq.acqRTKsolution(rtko, maskSet)) {
+		if (nEpochs == 0) rtko.setStartTime();
+		rtko.setEndTime();
+		rtko.printSolution(solutions);
+		nEpochs++;
+		/// 4- When a block of solutions has been rendered, writes it, printing before the header if not done yet
+		if (solutions.size() >= OUTBUFBLOCKSIZE) {
+			if (!headerPrinted) {
+				rtko.printHeader(rtkFile);
+				headerPrinted = true;
+				headerMaskSet = maskSet;
+			}
+			solutions.write(rtkFile);
+		}
+	}
+	/// 5- Prints the header, or patches its times if already printed, and writes the last solutions
+	if (headerPrinted) {
+		solutions.write(rtkFile);
+		if (!rtko.patchHeaderTimes(rtkFile)) plog->severe("Cannot update header times in the RTK file");
+		if (maskSet && !headerMaskSet) plog->warning("Mask data acquired after printing the RTK header");
+	} else {
+		rtko.printHeader(rtkFile);
+		solutions.write(rtkFile);
+	}
+	if (!maskSet || (nEpochs == 0)) plog->warning("All, or some header data not acquired");
 	plog->info("End of data extraction. Epochs read: " + to_string((long long) nEpochs));
 }
 
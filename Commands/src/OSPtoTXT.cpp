@@ -5,7 +5,9 @@
  *<p>OSPtoTXT.exe {options} [OSPfileName]
  *<p>Options are:
  *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -m MIDS or --mids=MIDS : Comma separated list of the MIDs of messages to dump. Messages with other MIDs are skipped. Default value: all MIDs
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *Default values for operators are: DATA.OSP 
  *<p>
  *Copyright 2015 Francisco Cancillo
@@ -24,12 +26,23 @@
  *V1.0	|2/2015	|First release
  *V1.1	|2/2016	|Minor changes to improve logging
  *V1.2	|2/2018	|Reviewed to run on Linux
+ *V1.3	|10/2026	|Added option to dump performance counters at exit
+ *V1.4	|10/2026	|Messages are printed by functions dispatched by MID, decoding fixed layout messages using OSPDecoder
+ *		|		|Messages shorter than expected are logged instead of aborting the program
+ *V1.5	|10/2026	|Messages are rendered into a buffer written in large blocks, and read from the OSP file in blocks
+ *		|		|Added option to dump only messages with the given MIDs, skipping the others without decoding them
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "OSPMessage.h"
+#include "OSPDecoder.h"
+#include "OutputBuffer.h"
 #include "Utilities.h"
 
 using namespace std;
@@ -38,16 +51,33 @@ using namespace std;
 ///The command line format
 const string CMDLINE = "OSPtoTXT.exe {options} [OSPfileName]";
 ///The current version of this program
-const string MYVER = " V1.2";
+const string MYVER = " V1.5";
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
-int HELP, LOGLEVEL;	//the metavariables for the command line options 
+int HELP, LOGLEVEL, PERFOUT, MIDS;	//the metavariables for the command line options 
 //Metavariables for operators
 int OSPF;		//metavariables for the command line operands
 //@endcond 
 //functions in this file
-int extractMsgs(FILE* , Logger*);
+bool setSelectedMIDs(string, bool*);
+int extractMsgs(FILE* , const bool*, Logger*);
+///The type of functions printing the payload data of a message
+typedef bool (*MsgPrinter)(OSPMessage &, OutputBuffer &);
+void setPrinters(OSPDispatchTable<MsgPrinter> &);
+bool printMID2(OSPMessage &, OutputBuffer &);
+bool printMID6(OSPMessage &, OutputBuffer &);
+bool printMID7(OSPMessage &, OutputBuffer &);
+bool printMID8(OSPMessage &, OutputBuffer &);
+bool printMID11(OSPMessage &, OutputBuffer &);
+bool printMID12(OSPMessage &, OutputBuffer &);
+bool printMID15(OSPMessage &, OutputBuffer &);
+bool printMID28(OSPMessage &, OutputBuffer &);
+bool printMID50(OSPMessage &, OutputBuffer &);
+bool printSID(OSPMessage &, OutputBuffer &);
+bool printMID68(OSPMessage &, OutputBuffer &);
+bool printMID75(OSPMessage &, OutputBuffer &);
+bool printMID255(OSPMessage &, OutputBuffer &);
 
 /**main
  * gets the command line arguments, set parameters accordingly and performs the data acquisition for printing them.
@@ -57,6 +87,7 @@ int extractMsgs(FILE* , Logger*);
  *  - Message identification (MID, in decimal) and payload length for all messages
  *  - Payload parameter values for relevant messages used to generate RINEX or RTK files (MIDs 2, 6, 7, 8, 11, 12, 15, 28, 50, 56, 64, 68, 75)
  *  - Payload bytes in hexadecimal, for MID 255
+ * Only messages with the MIDs stated in the MIDS option are dumped, if given.
  * Output data are sent to the standard output (stdout file), which could be redirected.
  *
  *@param argc the number of arguments passed from the command line
@@ -71,13 +102,17 @@ int main(int argc, char* argv[]) {
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	MIDS = parser.addOption("-m", "--mids", "MIDS", "Comma separated list of MIDs of the messages to dump (all if not given)", "");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
 	/// 3- Setups the default values for operators in the command line
 	OSPF = parser.addOperator("DATA.OSP");
 	/// 4- Parses arguments in the command line extracting options and operators
+	bool selected[256];
 	try {
 		parser.parseArgs(argc, argv);
+		if (!setSelectedMIDs(parser.getStrOpt(MIDS), selected)) throw string("Incorrect MID list in ") + parser.getStrOpt(MIDS);
 	}  catch (string error) {
 		parser.usage("Argument error: " + error, CMDLINE);
 		log.severe(error);
@@ -89,8 +124,10 @@ int main(int argc, char* argv[]) {
 		parser.usage("Dumps contents of a OSP binary data files to the standard out", CMDLINE);
 		return 0;
 	}
-	/// 5- Sets logging level stated in option
+	/// 5- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
 	/// 6- Opens the OSP binary file
 	FILE* inFile;
 	string fileName = parser.getOperator (OSPF);
@@ -99,136 +136,299 @@ int main(int argc, char* argv[]) {
 		return 2;
 	}
 	/// 7- Call extractMsgs to extract messages from the binary OSP file and print contents
-	int n = extractMsgs(inFile, &log);
+	int n = extractMsgs(inFile, parser.getStrOpt(MIDS).empty()? NULL : selected, &log);
 	fclose(inFile);
 	log.info("End of data extraction. Messages read: " + to_string((long long) n));
 	return 0;
 }
 
+/**setSelectedMIDs states in the given table the MIDs of messages to dump from a comma separated list of MIDs.
+ *
+ * @param midList the list of MIDs (i.e. "2,7,28")
+ * @param selected the table with 256 entries where the MIDs selected are set to true, and the rest to false
+ * @return true if the list is correct, false otherwise (values not in the 0-255 margin)
+ */
+bool setSelectedMIDs(string midList, bool* selected) {
+	size_t pos = 0, end;
+	char* endNum;
+	long mid;
+	memset(selected, 0, 256 * sizeof(bool));
+	if (midList.empty()) return true;
+	while (pos <= midList.size()) {
+		end = midList.find(',', pos);
+		if (end == string::npos) end = midList.size();
+		string item = midList.substr(pos, end - pos);
+		mid = strtol(item.c_str(), &endNum, 10);
+		if (item.empty() || (*endNum != 0) || (mid < 0) || (mid > 255)) return false;
+		selected[mid] = true;
+		pos = end + 1;
+	}
+	return true;
+}
+
 /**extractMsgs
  * extracts OSP messages contained in a OSP binary file and prints relevant data to stdout.
- * The OSP binary file contain OSP messages (see SiRF IV ICD for details) 
+ * The OSP binary file contain OSP messages (see SiRF IV ICD for details).
+ * The file is read in blocks, and printed data are rendered into a buffer written to stdout in large blocks.
  *
  * @param inFile the pointer to the OSP binary FILE to read
+ * @param selected the table with 256 entries stating the MIDs of messages to print. The rest are skipped using their length, without decoding them.
+ *		If NULL, all messages are printed
  * @param plog the pointer to the Logger object
  * @return the number of messages read
  */
-int extractMsgs(FILE* inFile, Logger* plog) {
+int extractMsgs(FILE* inFile, const bool* selected, Logger* plog) {
 	OSPMessage message;
+	OSPDispatchTable<MsgPrinter> printers;
+	MsgPrinter printer;
+	OutputBuffer out;
 	int mid;
 	int nMessages = 0;
+	int nSkipped = 0;
+	bool printed;
+	setPrinters(printers);
 	///For each input message, the following data are printed:
-	while (message.fill(inFile)) {
+	while (selected == NULL? message.fillFromBlock(inFile) : message.fillFromBlock(inFile, selected, nSkipped)) {
 		nMessages++;
 		mid = message.get();
 		/// - for all messages, MID and payload length
-		printf("MID:%3d;Ln:%3d;", mid, message.payloadLen());
-		switch (mid) {
-		case 2:		/// - MID 2, solution data: X, Y, Z, vX, vY, vZ, week, TOW and satellites used
-			printf("X:%8d;",message.getInt());
-			printf("Y:%8d;",message.getInt());
-			printf("Z:%8d;",message.getInt());
-			printf("vX:%4hd;",message.getShort());
-			printf("vY:%4hd;",message.getShort());
-			printf("vZ:%4hd;",message.getShort());
-			message.get(); //skip Mode 1
-			message.get(); //skip HDOP2
-			message.get(); //skip Mode 2
-			printf("wk:%4hu;",message.getUShort());
-			printf("TOW:%6u;",message.getUInt());
-			printf("SVs:%2d",message.get());
-			break;
-		case 6:		/// - MID 6: SiRF and customer versions
-			unsigned int lsirf, lcust;
-			lsirf = message.get();
-			lcust = message.get();
-			printf("SiRF ver:");
-			while (lsirf-- > 0) printf("%c", message.get());
-			printf(";Cust ver:");
-			while (lcust-- > 0) printf("%c", message.get());
-			break;
-		case 7:		/// - MID 7, Clock Status Data: week, TOW, satellites used, drift, bias, and EsT
-			printf("ewk:%3hu;", message.getUShort());
-			printf("TOW:%6u;", message.getUInt());
-			printf("SVs:%2d;", message.get());
-			printf("drft:%8u;", message.getUInt());
-			printf("bias:%8u;", message.getUInt());
-			printf("EsT:%8u", message.getUInt());
-			break;
-		case 8:		/// - MID 8, 50 BPS Data: 10 words subframe in hexadecimal
-			printf("ch:%2d;", message.get());
-			printf("SV:%2d;", message.get());
-			unsigned int word[10];
-			for(int i=0; i<10; i++) word[i] = message.getUInt();
-			printf("TOW:%6u;sfr:%2u;pg:%2u;\n\t",
-					(word[1]>>13) & 0x1FFFF,
-					(word[1]>>8) & 0x07,
-					(word[2]>>24) & 0x3F );
-			for(int i=0; i<10; i++) printf("%08X;", word[i]);
-			break;
-		case 11:	/// - MID 11, Command Acknowledgment
-			printf("ack:%3d", message.get());
-			break;
-		case 12:	/// - MID 12, Command Negative Acknowledgment
-			printf("nack:%3d", message.get());
-			break;
-		case 15:	/// - MID 15, Ephemeris Data with compact subframes 1, 2 & 3, in response to poll
-			printf("SV:%2d\n", message.get());
-			for(int i=0; i<3; i++) {
-				printf("\t");
-				for (int j=0; j<15; j++) printf(" %04hX", message.getUShort());
-				printf("\n");
+		out.putStr("MID:");
+		out.putInt(mid, 3);
+		out.putStr(";Ln:");
+		out.putInt(message.payloadLen(), 3);
+		out.putChar(';');
+		/// - relevant payload data, printed by the function stated for its MID (see setPrinters)
+		if ((printer = printers.get(mid)) != NULL) {
+			try {
+				printed = printer(message, out);
+			} catch (int error) {
+				printed = false;
 			}
-			break;
-		case 28:	/// - MID 28, Navigation Library Measurement Data
-			printf("Ch:%2d;", message.get());
-			printf("Ttg:%8u;", message.getUInt());
-			printf("SV:%2d;", message.get());
-			printf("Tsw:%14.3f;", message.getDouble());
-			printf("Psr:%14.3f;", message.getDouble());
-			printf("Cfr:%14.3f;", message.getFloat());
-			printf("Cph:%14.3f;", message.getDouble());
-			printf("Trk:%3hu;", message.getUShort());
-			printf("Syn:%02X\n", message.get());
-			printf("\tCN0:");
-			for (int i=0; i<10; i++) printf("%3d;", message.get());
-			printf("\n\tDri:%5hu", message.getUShort());
-			break;
-		case 50:	/// - MID 50, SBAS Parameters
-			printf("SBASsv:%3d;", message.get());
-			printf("Md:%3d;", message.get());
-			printf("Tout:%3d;", message.get());
-			printf("Flg:%02X", message.get());
-			break;
-		case 56:	/// - MID 56: Extended Ephemeris Data-reserved use
-			printf("SID:%3d;", message.get());
-           	break;
-		case 64:	//Navigation Library Messages
-			printf("SID:%3d", message.get());
-			break;
-		case 67:	/// - MID 67, Multi-constellation Navigation Data (SiRFV)
-			printf("SID:%3d", message.get());
-			break;
-		case 68:	/// - MID 68, Measurement Engine. Wraps the content of another OSP message and outputs it to SiRFLive
-			printf("Wraps:%3d", message.get());
-			break;
-		case 70:	/// -MID 70 GLONASS almanac/ephemeris response to MID 212
-			printf("SID:%3d", message.get());
-			break;
-		case 75:	/// - MID 75, ACK/NACK/ERROR Notification 
-			printf("SID:%2d;", message.get());
-			printf(" echo to MID%2d ", message.get());
-			printf("SID%2d:", message.get());
-			printf("%02x", message.get());
-			break;
-		case 255:	/// - MID 255, ASCII Development Data Output
-			for(unsigned int i=0; i<message.payloadLen()-1; i++)  printf("%c", message.get());
-			break;
-		default:
-			break;
+			if (!printed) plog->warning("MID" + to_string((long long) mid) + " error getting data after end of message: "
+				+ to_string((long long) message.payloadLen()));
+		}
+		out.putChar('\n');
+		if (out.size() >= OUTBUFBLOCKSIZE) out.write(stdout);
+	}
+	out.write(stdout);
+	if (selected != NULL) plog->info("Messages skipped: " + to_string((long long) nSkipped));
+	return nMessages + nSkipped;
+}
+
+/**setPrinters states in the given table the function printing the payload data for each MID.
+ * The MIDs not stated have only their MID and payload length printed.
+ *
+ * @param printers the dispatch table where printing functions are set
+ */
+void setPrinters(OSPDispatchTable<MsgPrinter> &printers) {
+	printers.set(2, printMID2);
+	printers.set(6, printMID6);
+	printers.set(7, printMID7);
+	printers.set(8, printMID8);
+	printers.set(11, printMID11);
+	printers.set(12, printMID12);
+	printers.set(15, printMID15);
+	printers.set(28, printMID28);
+	printers.set(50, printMID50);
+	printers.set(56, printSID);
+	printers.set(64, printSID);
+	printers.set(67, printSID);
+	printers.set(68, printMID68);
+	printers.set(70, printSID);
+	printers.set(75, printMID75);
+	printers.set(255, printMID255);
+}
+
+//@cond DUMMY
+//Functions rendering payload data into the output buffer. The message cursor is placed after the MID. They return false when the payload
+//is shorter than expected, or throw the integer error given by OSPMessage
+//@endcond
+/// - MID 2, solution data: X, Y, Z, vX, vY, vZ, week, TOW and satellites used
+bool printMID2(OSPMessage &message, OutputBuffer &out) {
+	OSPMID2Data mid2;
+	if (!OSPMID2Layout::decode(message, mid2)) return false;
+	out.putStr("X:");
+	out.putInt(mid2.x, 8);
+	out.putStr(";Y:");
+	out.putInt(mid2.y, 8);
+	out.putStr(";Z:");
+	out.putInt(mid2.z, 8);
+	out.putStr(";vX:");
+	out.putInt(mid2.vX, 4);
+	out.putStr(";vY:");
+	out.putInt(mid2.vY, 4);
+	out.putStr(";vZ:");
+	out.putInt(mid2.vZ, 4);
+	out.putStr(";wk:");
+	out.putInt(mid2.week, 4);
+	out.putStr(";TOW:");
+	out.putInt((unsigned int) mid2.tow, 6);
+	out.putStr(";SVs:");
+	out.putInt(mid2.svs, 2);
+	return true;
+}
+
+/// - MID 6: SiRF and customer versions
+bool printMID6(OSPMessage &message, OutputBuffer &out) {
+	unsigned int lsirf, lcust;
+	lsirf = message.get();
+	lcust = message.get();
+	out.putStr("SiRF ver:");
+	while (lsirf-- > 0) out.putChar((char) message.get());
+	out.putStr(";Cust ver:");
+	while (lcust-- > 0) out.putChar((char) message.get());
+	return true;
+}
+
+/// - MID 7, Clock Status Data: week, TOW, satellites used, drift, bias, and EsT
+bool printMID7(OSPMessage &message, OutputBuffer &out) {
+	OSPMID7Data mid7;
+	if (!OSPMID7Layout::decode(message, mid7)) return false;
+	out.putStr("ewk:");
+	out.putInt(mid7.week, 3);
+	out.putStr(";TOW:");
+	out.putInt(mid7.tow, 6);
+	out.putStr(";SVs:");
+	out.putInt(mid7.svs, 2);
+	out.putStr(";drft:");
+	out.putInt(mid7.drift, 8);
+	out.putStr(";bias:");
+	out.putInt(mid7.bias, 8);
+	out.putStr(";EsT:");
+	out.putInt(mid7.estGPStime, 8);
+	return true;
+}
+
+/// - MID 8, 50 BPS Data: 10 words subframe in hexadecimal
+bool printMID8(OSPMessage &message, OutputBuffer &out) {
+	OSPMID8Data mid8;
+	if (!OSPMID8Layout::decode(message, mid8)) return false;
+	out.putStr("ch:");
+	out.putInt(mid8.channel, 2);
+	out.putStr(";SV:");
+	out.putInt(mid8.sv, 2);
+	out.putStr(";TOW:");
+	out.putInt((mid8.words[1]>>13) & 0x1FFFF, 6);
+	out.putStr(";sfr:");
+	out.putInt((mid8.words[1]>>8) & 0x07, 2);
+	out.putStr(";pg:");
+	out.putInt((mid8.words[2]>>24) & 0x3F, 2);
+	out.putStr(";\n\t");
+	for(int i=0; i<10; i++) {
+		out.putHex(mid8.words[i], 8);
+		out.putChar(';');
+	}
+	return true;
+}
+
+/// - MID 11, Command Acknowledgment
+bool printMID11(OSPMessage &message, OutputBuffer &out) {
+	out.putStr("ack:");
+	out.putInt(message.get(), 3);
+	return true;
+}
+
+/// - MID 12, Command Negative Acknowledgment
+bool printMID12(OSPMessage &message, OutputBuffer &out) {
+	out.putStr("nack:");
+	out.putInt(message.get(), 3);
+	return true;
+}
+
+/// - MID 15, Ephemeris Data with compact subframes 1, 2 & 3, in response to poll
+bool printMID15(OSPMessage &message, OutputBuffer &out) {
+	OSPMID15Data mid15;
+	if (!OSPMID15Layout::decode(message, mid15)) return false;
+	out.putStr("SV:");
+	out.putInt(mid15.sv, 2);
+	out.putChar('\n');
+	for(int i=0; i<3; i++) {
+		out.putChar('\t');
+		for (int j=0; j<15; j++) {
+			out.putChar(' ');
+			out.putHex(mid15.navW[i*15+j], 4);
 		}
-		printf("\n");
+		out.putChar('\n');
+	}
+	return true;
+}
+
+/// - MID 28, Navigation Library Measurement Data
+bool printMID28(OSPMessage &message, OutputBuffer &out) {
+	OSPMID28Data mid28;
+	if (!OSPMID28Layout::decode(message, mid28)) return false;
+	out.putStr("Ch:");
+	out.putInt(mid28.channel, 2);
+	out.putStr(";Ttg:");
+	out.putInt(mid28.timeTag, 8);
+	out.putStr(";SV:");
+	out.putInt(mid28.sv, 2);
+	out.putStr(";Tsw:");
+	out.putFixed(mid28.gpsSWtime, 14, 3);
+	out.putStr(";Psr:");
+	out.putFixed(mid28.pseudorange, 14, 3);
+	out.putStr(";Cfr:");
+	out.putFixed(mid28.carrierFrequency, 14, 3);
+	out.putStr(";Cph:");
+	out.putFixed(mid28.carrierPhase, 14, 3);
+	out.putStr(";Trk:");
+	out.putInt(mid28.timeInTrack, 3);
+	out.putStr(";Syn:");
+	out.putHex(mid28.syncFlags, 2);
+	out.putStr("\n\tCN0:");
+	for (int i=0; i<10; i++) {
+		out.putInt(mid28.cn0[i], 3);
+		out.putChar(';');
 	}
-	return nMessages;
+	out.putStr("\n\tDri:");
+	out.putInt(mid28.deltaRangeInterval, 5);
+	return true;
+}
+
+/// - MID 50, SBAS Parameters
+bool printMID50(OSPMessage &message, OutputBuffer &out) {
+	out.putStr("SBASsv:");
+	out.putInt(message.get(), 3);
+	out.putStr(";Md:");
+	out.putInt(message.get(), 3);
+	out.putStr(";Tout:");
+	out.putInt(message.get(), 3);
+	out.putStr(";Flg:");
+	out.putHex(message.get(), 2);
+	return true;
+}
+
+/// - MID 56: Extended Ephemeris Data-reserved use, MID 64 Navigation Library Messages, MID 67 Multi-constellation Navigation Data (SiRFV),
+/// MID 70 GLONASS almanac/ephemeris response to MID 212: the SID
+bool printSID(OSPMessage &message, OutputBuffer &out) {
+	out.putStr("SID:");
+	out.putInt(message.get(), 3);
+	if (message.payloadData()[0] == 56) out.putChar(';');
+	return true;
 }
 
+/// - MID 68, Measurement Engine. Wraps the content of another OSP message and outputs it to SiRFLive
+bool printMID68(OSPMessage &message, OutputBuffer &out) {
+	out.putStr("Wraps:");
+	out.putInt(message.get(), 3);
+	return true;
+}
+
+/// - MID 75, ACK/NACK/ERROR Notification 
+bool printMID75(OSPMessage &message, OutputBuffer &out) {
+	out.putStr("SID:");
+	out.putInt(message.get(), 2);
+	out.putStr("; echo to MID");
+	out.putInt(message.get(), 2);
+	out.putStr(" SID");
+	out.putInt(message.get(), 2);
+	out.putChar(':');
+	out.putHex(message.get(), 2, false);
+	return true;
+}
+
+/// - MID 255, ASCII Development Data Output
+bool printMID255(OSPMessage &message, OutputBuffer &out) {
+	for(unsigned int i=0; i<message.payloadLen()-1; i++) out.putChar((char) message.get());
+	return true;
+}
@@ -7,6 +7,7 @@
  *	- -f BFILE or --binfile=BFILE : OSP binary output file. Default value BFILE = DATA.OSP
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *Default value for operator is: RXMESSAGES.PKT
  *
  *Copyright 2016 Francisco Cancillo
@@ -24,14 +25,18 @@
  *------+-------+------------------
  *V1.0	|2/2016	|First release
  *V1.1	|2/2018	|Reviewed to run on Linux
+ *V1.2	|10/2026	|Input data read in chunks into a buffer where packets are framed
+ *		|		|Added option to dump performance counters at exit
  */
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "Utilities.h"
 
 #include <stdio.h>
+#include <string.h>
 
 using namespace std;
 
@@ -45,20 +50,28 @@ using namespace std;
 int filterPkts(Logger* plog);
 bool synchOSPmsg(FILE* inFile);
 int readOSPmsg(FILE* inFile);
+bool fillInput(FILE* inFile);
+bool getInput(FILE* inFile, unsigned char* dest, unsigned int n);
+unsigned int ospChecksum(const unsigned char* payload, unsigned int length);
 
 ///The maximum size in bytes of any message payload
 #define MAXPAYLOADSIZE 2048
 unsigned char payloadBuf[MAXPAYLOADSIZE];	//buffer for the OSP message payload
 unsigned char payloadLnBuf[2];				//buffer for the OSP message payload length
 unsigned int payloadLength;					//the payload length in bytes of current message
+///The size of the buffer where input data are read in chunks
+#define INBUFSIZE 65536
+unsigned char inBuf[INBUFSIZE];			//buffer for input data read
+unsigned int inPos = 0;					//the position in inBuf of the next byte to process
+unsigned int inEnd = 0;					//the position in inBuf after the last byte read
 
 ///The command line format
 const string CMDLINE = "PacketToOSP.exe {options} [PacketsFilename]";
-const string MYVER = " V1.1";
+const string MYVER = " V1.2";
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int BFILE, HELP, LOGLEVEL;
+int BFILE, HELP, LOGLEVEL, PERFOUT;
 //Metavariables for operators
 int PKTF;
 //@endcond 
@@ -89,6 +102,7 @@ int main(int argc, char** argv) {
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
 	BFILE = parser.addOption("-f", "--binfile", "BFILE", "OSP binary output file", "DATA.OSP");
 	/// 3- Setups the default values for operators in the command line
@@ -107,8 +121,10 @@ int main(int argc, char** argv) {
 		parser.usage("Extract payload data from a binary file containing SiRF receiver message packets, and store them into an OSP binary file", CMDLINE);
 		return 0;
 	}
-	/// 5- Sets logging level stated in option
+	/// 5- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
 	/// 6- Filter input binary receiver packets generating output OSP messages
 	return filterPkts(&log);
 }
@@ -119,8 +135,9 @@ int main(int argc, char** argv) {
  *@return 0 if no error occurred when reading or writting, the related error code otherwise 
  */
 int filterPkts(Logger* plog) {
+///a macro to build the text tagging messages logged for the current packet. It is built only when needed
+#define PKT_TAG ("Packet " + to_string((long long) nPkt) + " OSP <" + to_string((long long) payloadBuf[0]) + "," + to_string((long long) payloadLength) + "> ")
 	int anInt;
-	string logMsg;
 	int nMsgWrite = 0;
 	int nPkt = 0;
 	/// 6.1- Opens the messages binary input file;
@@ -141,28 +158,27 @@ int filterPkts(Logger* plog) {
 	while (synchOSPmsg(inFile)) {
 		nPkt++;
 		anInt = readOSPmsg(inFile);
-		logMsg = "Packet " + to_string((long long) nPkt) + " OSP <" + to_string((long long) payloadBuf[0]) + "," + to_string((long long) payloadLength) + "> ";
 		switch (anInt) {
 		case 0:	//packet is correct. Update counters and write message to OSP file
 			nMsgWrite++;
 			if ((fwrite(payloadLnBuf, 1, 2, outFile) != 2) ||
 				(fwrite(payloadBuf, 1, payloadLength, outFile) != payloadLength)) {
-				plog->severe(logMsg + "Write error in message " + to_string((long long) nMsgWrite));
+				plog->severe(PKT_TAG + "Write error in message " + to_string((long long) nMsgWrite));
 				return 5;
 			}
-			plog->finest(logMsg + "to msg " + to_string((long long) nMsgWrite));
+			LOG_FINEST(plog, PKT_TAG + "to msg " + to_string((long long) nMsgWrite));
 			break;
 		case 1:
-			plog->warning(logMsg + "Error in checksum");
+			plog->warning(PKT_TAG + "Error in checksum");
 			break;
 		case 2:
-			plog->warning(logMsg + "Error reading payload");
+			plog->warning(PKT_TAG + "Error reading payload");
 			break;
 		case 3:
-			plog->warning(logMsg + "Error length too big");
+			plog->warning(PKT_TAG + "Error length too big");
 			break;
 		case 4:
-			plog->warning(logMsg + "Error reading payload length");
+			plog->warning(PKT_TAG + "Error reading payload length");
 			break;
 		default:
 			break;
@@ -170,40 +186,33 @@ int filterPkts(Logger* plog) {
 	}
 	plog->info("Packets read:" + to_string((long long) nPkt) + " Messages written:" + to_string((long long) nMsgWrite));
 	return 0;
+#undef PKT_TAG
 }
 
 /**synchroOSPmsg skips bytes from input until start of OSP message is reached.
  * Note that start of OSP message is preceded by the sequence of the two bytes START1 (A0) START2 (A2)
+ *<p>START1 bytes are searched in the input buffer, and more data are read from the input file when needed.
  *
  *@param inFile the input binary FILE containing OSP packets 
  *@return true if the sequence START1 START2 has been detected, false when EOF has been reached
  */
 bool synchOSPmsg(FILE* inFile) {
-	unsigned int inData = 0;
-	//A state machine automata is used to skip bytes from input until START1 START2 appears
-	//States: 1=is waiting to START1; 2=is waiting for STAR2; 3=START1+START2 detected
-	int state = 1;
-	while (state!=3) {
-		if (fread(&inData, 1, 1, inFile) == 1) {
-			switch (state) {
-			case 1:
-				switch (inData) {
-				case START1:	state = 2; break;
-				case START2:	break;
-				default:		break;
-				}
-				break;
-			case 2:
-				switch (inData) {
-				case START1:	break;
-				case START2:	state = 3; break;
-				default:		state = 1; break;
-				}
-			}
+	unsigned char* start;
+	for (;;) {
+		if ((inEnd - inPos < 2) && !fillInput(inFile)) return false;
+		start = (unsigned char*) memchr(inBuf + inPos, START1, inEnd - inPos);
+		if (start == NULL) {
+			inPos = inEnd;
+			continue;
+		}
+		inPos = (unsigned int) (start - inBuf);
+		if (inEnd - inPos < 2) continue;	//the byte after START1 is not yet read
+		if (inBuf[inPos + 1] == START2) {
+			inPos += 2;
+			return true;
 		}
-		else return false;
+		inPos++;
 	}
-	return true;
 }
 
 /**readOSPmsg reads a OSP message from the input file and put ist payload data into a buffer.
@@ -218,7 +227,7 @@ bool synchOSPmsg(FILE* inFile) {
  */
 int readOSPmsg(FILE* inFile) {
 	payloadLength = 0;
-	if (fread(payloadLnBuf, 1, 2, inFile) != 2) {
+	if (!getInput(inFile, payloadLnBuf, 2)) {
 		return 4;
 	}
 	payloadLength = (payloadLnBuf[0] << 8) | payloadLnBuf[1];	//numbers in msg are big endians
@@ -226,20 +235,72 @@ int readOSPmsg(FILE* inFile) {
 		return 3;
 	}
 	//read payload data plus checkum (2 bytes)
-	if (fread(payloadBuf, 1, payloadLength + 2, inFile) != (payloadLength + 2)) {
+	if (!getInput(inFile, payloadBuf, payloadLength + 2)) {
 		return 2;
 	}
-	//compute checksum of payload contents
-	unsigned int computedCheck = payloadBuf[0];
-	for (unsigned int i=1; i<payloadLength; i++) {
-		computedCheck += payloadBuf[i];
-		computedCheck &= 0x7FFF;
-	}
-	//get checksum received after message payload
+	//compute checksum of payload contents and compare with the one received after message payload
 	unsigned int messageCheck = (payloadBuf[payloadLength] << 8) | payloadBuf[payloadLength+1];
-	if (computedCheck != messageCheck) {
+	if (ospChecksum(payloadBuf, payloadLength) != messageCheck) {
 		return 1;	//checksum does not match!
 	}
 	return 0;
 }
 
+/**fillInput reads from the input file a chunk of data into the input buffer.
+ * Bytes pending to be processed are moved to the beginning of the buffer before reading.
+ *
+ *@param inFile the input binary FILE containing OSP packets 
+ *@return true if any byte has been read, false otherwise (EOF or read error)
+ */
+bool fillInput(FILE* inFile) {
+	size_t nBytesRead;
+	if (inPos > 0) {
+		memmove(inBuf, inBuf + inPos, inEnd - inPos);
+		inEnd -= inPos;
+		inPos = 0;
+	}
+	if (inEnd >= INBUFSIZE) return false;
+	nBytesRead = fread(inBuf + inEnd, 1, INBUFSIZE - inEnd, inFile);
+	inEnd += (unsigned int) nBytesRead;
+	return nBytesRead > 0;
+}
+
+/**getInput gets from the input buffer the given number of bytes, reading from the input file when needed.
+ *
+ *@param inFile the input binary FILE containing OSP packets 
+ *@param dest the place where bytes will be copied
+ *@param n the number of bytes to get
+ *@return true if the n bytes have been got, false otherwise (EOF or read error)
+ */
+bool getInput(FILE* inFile, unsigned char* dest, unsigned int n) {
+	unsigned int nBytes;
+	while (n > 0) {
+		if ((inPos == inEnd) && !fillInput(inFile)) return false;
+		nBytes = inEnd - inPos < n? inEnd - inPos : n;
+		memcpy(dest, inBuf + inPos, nBytes);
+		inPos += nBytes;
+		dest += nBytes;
+		n -= nBytes;
+	}
+	return true;
+}
+
+/**ospChecksum computes the checksum of the given OSP payload: the 15 bits sum of its bytes.
+ * As the sum is truncated to 15 bits, it is computed using four partial sums, truncated at the end.
+ *
+ *@param payload the payload bytes
+ *@param length the payload length
+ *@return the checksum value
+ */
+unsigned int ospChecksum(const unsigned char* payload, unsigned int length) {
+	unsigned int sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+	unsigned int i = 0;
+	for (; i + 4 <= length; i += 4) {
+		sum0 += payload[i];
+		sum1 += payload[i+1];
+		sum2 += payload[i+2];
+		sum3 += payload[i+3];
+	}
+	for (; i < length; i++) sum0 += payload[i];
+	return (sum0 + sum1 + sum2 + sum3) & 0x7FFF;
+}
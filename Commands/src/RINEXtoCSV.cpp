@@ -3,13 +3,21 @@
  *<p>Usage:
  *<p>RINEXtoCSV.exe {options} InputRINEXfilename
  *<p>Options are:
+ *	- -b or --binary : Epoch data are written to binary columnar files (suffix .COL, see ColumnarFile) instead of CSV files. Default value BINARY=FALSE
  *	- -f FROMT or --fromtime=FROMT : Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: 1st epoch in the input file
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -o OBSLST or --selobs=OBSLST : List of selected system-observables (ver.3.01 notation) from input (a comma separated list, like GC1C,GL1C). Default value is all selected.
  *	- -p OBS2LST or --selobs2=OBS2LST : List of selected system-observables (ver.2.10 notation) from input (comma separated list, like GC1,GL1,GL2). Default value is all selected.
  *	- -s SATLST or --selsat=SATLST : List of selected system-satellites from input (comma separated list, like G01,G02). Default value is all selected.
+ *	- -S JOBS or --serve=JOBS : Run conversion jobs read from the given input (--serve=- for the standard input) as a server, see below. Default value: no server
  *	- -t TOT or --totime=TOT : Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: last epoch in the input file
+ *	- -w WORKERS or --workers=WORKERS : Number of worker threads used to parse epochs of observation files, or to run jobs in server mode. Default value WORKERS = 0 (as many as hardware threads)
+ *<p>When JOBS is given, the program runs as a long lived server of conversion jobs (see JobServer). Each input line contains a job
+ * identifier followed by the options and operator of a conversion, as they would be given in the command line (without JOBS,
+ * LOGLEVEL and PERFOUT, which are stated for the server). A reply line with the job identifier, its exit status, elapsed time and
+ * result is written to the standard output when each job ends.
  *<p>
  *Copyright 2016 Francisco Cancillo
  *<p>
@@ -26,12 +34,24 @@
  *------+-------+------------------
  *V1.0	|2/2016	|First release
  *V1.1	|2/2018	|Reviewed to run on Linux
+ *V1.2	|10/2026	|Input observation files are read mapped in memory
+ *		|		|CSV lines are rendered in an output buffer and printed for each epoch
+ *		|		|Epochs of observation files are parsed using worker threads
+ *V1.3	|10/2026	|Epoch data can be written to binary columnar files
+ *		|		|Input files can be in Compact RINEX format, and compressed with gzip (named *.gz)
+ *		|		|Added option to dump performance counters at exit
+ *		|		|Epochs out of the time interval selected are not read from mapped input files
+ *		|		|Added server mode to run conversion jobs in a long lived process
  */
 //from CommonClasses
 #include "ArgParser.h"
+#include "JobServer.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "Utilities.h"
 #include "RinexData.h"
+#include "OutputBuffer.h"
+#include "ColumnarFile.h"
 
 using namespace std;
 
@@ -39,11 +59,11 @@ using namespace std;
 ///The command line format
 const string CMDLINE = "RINEXtoCSV.exe {options} InputRINEXfilename";
 ///The program current version
-const string MYVER = " V1.1";
+const string MYVER = " V1.3";
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
-int AEND, BIAS, FROMT, GPS, HELP, LOGLEVEL, MINSV, SELOBS3, SELOBS2, SELSAT, TOT;
+int AEND, BIAS, BINARY, FROMT, GPS, HELP, LOGLEVEL, PERFOUT, MINSV, SELOBS3, SELOBS2, SELSAT, SERVE, TOT, WORKERS;
 //Metavariables for operators
 int INRINEX;
 //@endcond 
@@ -52,19 +72,33 @@ struct TimeIntervalParams {
 	bool fromTime, toTime;
 	double fromTimeTag, toTimeTag;
 };
+///A data type to define where navigation data lines are rendered: CSV text, or a binary columnar table
+struct NavOutput {
+	OutputBuffer csv;		//the place where the CSV line is rendered, when no columnar table is used
+	ColumnarFile* table;	//the columnar table where values are put, or NULL for CSV output
+	int column;				//the next column to put values in the current row of the table
+};
 //functions in this file
+int runJob(const ArgParser &, int, char**, Logger*, string &);
+int convertRINEXfile(ArgParser &, Logger*, string &);
 int generateHeaderCSV(FILE*, RinexData &, Logger*);
-int generateObsCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateGPSNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateGalNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateGloNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateSBASNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
+int generateObsCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, bool, Logger*);
+int generateGPSNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, bool, Logger*);
+int generateGalNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, bool, Logger*);
+int generateGloNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, bool, Logger*);
+int generateSBASNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, bool, Logger*);
+void startNavOutput(NavOutput &, FILE*, const string &);
+void putNavCSVtime(NavOutput &, char, int, int, double);
+void putNavCSVvalues(NavOutput &, const double*, int);
+void endNavLine(NavOutput &, FILE*);
 
 /**main
  * gets the command line arguments, set parameters accordingly and triggers the data acquisition to generate CSV files.
  * Input data are contained in a RINEX observation or navigation file containing header and epoch data.
  * The output is a CSV (Comma Separated Values) text data file. This type of files can be used to import data to some available
  * application (like MS Excel).
+ * Optionally, epoch data can be written to a binary columnar file, with the same columns the CSV file would have, to be loaded
+ * by analysis tools without parsing text (see ColumnarFile for a description of its format).
  * A detailed definition of the RINEX format can be found in the document "RINEX: The Receiver Independent Exchange
  * Format Version 2.10" from Werner Gurtner; Astronomical Institute; University of Berne. An updated document exists
  * also for Version 3.01.
@@ -80,25 +114,27 @@ int generateSBASNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*)
  *		- (5) there were format errors in epoch data or no epoch data exist
  *		- (6) error when creating output file
  *		- (7) inconsistent data in RINEX VERSION header record
+ *<p>In server mode the exit status is the greatest one of the jobs run.
  */
 int main(int argc, char* argv[]) {
-	int anInt;		//a general purpose int variable
-	string aStr;	//a general purpose string variable
-	string fileName;
-	double aDouble;	//a general purpose double variable
 	/**The main process sequence follows:*/
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	WORKERS = parser.addOption("-w", "--workers", "WORKERS", "Number of worker threads to parse epochs (0 = hardware threads)", "0");
 	TOT = parser.addOption("-t", "--totime=TOT", "TOT", "Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	SERVE = parser.addOption("-S", "--serve", "JOBS", "Run as a server the conversion jobs read from the given input (--serve=- for stdin)", "");
 	SELSAT = parser.addOption("-s", "--selsat", "SELSAT", "Select system-satellite from input (comma separated list of sys-prn, like G01,G02)", "");
 	SELOBS2 = parser.addOption("-p", "--selobs2", "SELOBS2", "Select system-observable (ver.2.10 notation) from input (comma separated list, like C1,L1,L2)", "");
 	SELOBS3 = parser.addOption("-o", "--selobs", "SELOBS3", "Select system-observable (ver.3.01 notation) from input (comma separated list, like GC1C,GL1C)", "");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
 	FROMT = parser.addOption("-f", "--fromtime=FROMT", "FROMT", "Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	BINARY = parser.addOption("-b", "--binary", "BINARY", "Write epoch data to binary columnar files (.COL) instead of CSV", false);
 	/// 3- Setups the default values for operators in the command line
 	INRINEX = parser.addOperator("RINEX.DAT");
+	const ArgParser jobParser(parser);	//a parser without arguments, to be copied for each job in server mode
 	/// 4- Parses arguments in the command line extracting options and operators
 	try {
 		parser.parseArgs(argc, argv);
@@ -114,16 +150,80 @@ int main(int argc, char* argv[]) {
 		parser.usage("Parses and read the given observation RINEX file generating a CSV ot TXT file with the requested characteristics", CMDLINE);
 		return 0;
 	}
-	/// 5- Sets logging level stated in option. Default level is INFO
+	/// 5- Sets logging level stated in option. Default level is INFO. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 7 - Set 1st and last epoch time tags (if selected from / to epochs time) 
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
+	/// 6- If server mode is requested, runs the conversion jobs read from the given input using worker threads
+	string aStr = parser.getStrOpt(SERVE);
+	if (!aStr.empty()) {
+		FILE* jobsFile = aStr.compare("-") == 0? stdin : fopen(aStr.c_str(), "r");
+		if (jobsFile == NULL) {
+			log.severe("Cannot open file " + aStr);
+			return 2;
+		}
+		JobServer server(stoi(parser.getStrOpt(WORKERS)), string(argv[0]), &log);
+		int status = server.serve(jobsFile, stdout, [&](int jobArgc, char** jobArgv, string &result) {
+			return runJob(jobParser, jobArgc, jobArgv, &log, result);
+		});
+		if (jobsFile != stdin) fclose(jobsFile);
+		return status;
+	}
+	/// 7- Otherwise converts the RINEX file given in the command line
+	string result;
+	return convertRINEXfile(parser, &log, result);
+}
+
+/**runJob performs a conversion job received in server mode.
+ *<p>The job arguments are parsed using a copy of the given parser, and the conversion requested is performed as it would be
+ * performed from the command line. It can be called from several threads at the same time.
+ *
+ *@param jobParser the ArgParser with the options defined and without arguments parsed
+ *@param argc the number of job arguments, including the program name
+ *@param argv the job arguments, as per main
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status as described for main
+ */
+int runJob(const ArgParser &jobParser, int argc, char** argv, Logger* plog, string &result) {
+	ArgParser parser(jobParser);
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		result = "Argument error: " + error;
+		return 1;
+	}
+	if (parser.getBoolOpt(HELP) || !parser.getStrOpt(SERVE).empty()) {
+		result = "Argument error: help and server options cannot be used in jobs";
+		return 1;
+	}
+	plog->info(parser.showOptValues());
+	plog->info(parser.showOpeValues());
+	return convertRINEXfile(parser, plog, result);
+}
+
+/**convertRINEXfile generates the CSV or binary columnar files for the RINEX file given as operator in the parser, using its options.
+ *<p>It uses its own objects to read and print data, and can be called from several threads at the same time.
+ *
+ *@param parser the ArgParser containing the options and operator of the conversion. Its data are only read
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status as described for main
+ */
+int convertRINEXfile(ArgParser &parser, Logger* plog, string &result) {
+	int anInt;		//a general purpose int variable
+	string fileName;
+	double aDouble;	//a general purpose double variable
+	/**The convertRINEXfile process sequence follows:*/
+	/// 1- Set 1st and last epoch time tags (if selected from / to epochs time) 
 	TimeIntervalParams timeInterval;
 	int week, year, month, day, hour, minute;
 	double tow, second;
-	aStr = parser.getStrOpt(FROMT);
+	string aStr = parser.getStrOpt(FROMT);
 	if (!aStr.empty()) {
 		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
-			log.severe("Cannot state 'from time' for the time interval");
+			result = "Cannot state 'from time' for the time interval";
+			plog->severe(result);
 			return 1;
 		}
 		setWeekTow (year, month, day, hour, minute, second, week, tow);
@@ -133,50 +233,57 @@ int main(int argc, char* argv[]) {
 	aStr = parser.getStrOpt(TOT);
 	if (!aStr.empty()) {
 		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
-			log.severe("Cannot state 'to time' for the time interval");
+			result = "Cannot state 'to time' for the time interval";
+			plog->severe(result);
 			return 1;
 		}
 		setWeekTow (year, month, day, hour, minute, second, week, tow);
 		timeInterval.toTimeTag = getSecsGPSEphe(week, tow);
 		timeInterval.toTime = true;
 	} else timeInterval.toTime = false;
-	/// 7- Opens the RINEX input file passed as operator
+	/// 2- Opens the RINEX input file passed as operator
 	FILE* inFile;
 	fileName = parser.getOperator(INRINEX);
-	if ((inFile = fopen(fileName.c_str(), "r")) == NULL) {
-		log.severe("Cannot open file " + fileName);
+	string inFileName = fileName;	//fileName is changed below to build output file names
+	if ((inFile = openStream(inFileName, false)) == NULL) {
+		result = "Cannot open file " + fileName;
+		plog->severe(result);
 		return 2;
 	}
-	/// 8- Create a RINEX object and extract header data from the RINEX input file
-	RinexData rinex(RinexData::VTBD, &log);
+	/// 3- Create a RINEX object and extract header data from the RINEX input file
+	RinexData rinex(RinexData::VTBD, plog);
 	char fileType = ' ';
 	char sysId = ' ';
 	try {
 		rinex.readRinexHeader(inFile);
 		if (!rinex.getHdLnData(RinexData::INFILEVER, aDouble, fileType, sysId)) {
-			log.severe("This RINEX input file version cannot be processed");
-			fclose(inFile);
+			result = "This RINEX input file version cannot be processed";
+			plog->severe(result);
+			closeStream(inFile, inFileName);
 			return 3;
 		}
 	}  catch (string error) {
-		log.severe(error);
-		fclose(inFile);
+		result = error;
+		plog->severe(result);
+		closeStream(inFile, inFileName);
 		return 3;
 	}
-	/// 9 - Set filtering parameters passed in options, if any
+	/// 4- Set filtering parameters passed in options, if any
 	//convert obsV2Tokens to V3 and append them to obsTokens
 	vector<string> obsV2Tokens = getTokens(parser.getStrOpt(SELOBS2), ',');
 	vector<string> obsTokens = getTokens(parser.getStrOpt(SELOBS3), ',');
 	for (vector<string>::iterator it = obsV2Tokens.begin(); it != obsV2Tokens.end(); it++) {
 		aStr = rinex.obsV2toV3((*it).substr(1));
-		if (aStr.empty()) log.warning("Filtering data: ignored unknown V2 observable " + aStr);
+		if (aStr.empty()) plog->warning("Filtering data: ignored unknown V2 observable " + aStr);
 		else obsTokens.push_back((*it).substr(0,1) + aStr);
 	}
 	//verify coherence of SELSAT w.r.t. fileType and system identifier
 	vector<string> selsat = getTokens(parser.getStrOpt(SELSAT), ',');
 	if (fileType == 'N' && sysId == 'M') {
 		if (selsat.empty()) {
-			log.severe("File is Navigation type 'M', and no sytem was selected.");
+			result = "File is Navigation type 'M', and no sytem was selected.";
+			plog->severe(result);
+			closeStream(inFile, inFileName);
 			return 4;
 		} else {
 			//state sysId as per the 1st satellite selected
@@ -184,80 +291,100 @@ int main(int argc, char* argv[]) {
 		}
 	}
 	if (!rinex.setFilter(selsat, obsTokens))
-		log.warning("Ignored inconsistent data filtering parameters for observation files.");
-	/// 10 - Create output file for header data (suffix name _HDR.CSV), print them, and close output file
+		plog->warning("Ignored inconsistent data filtering parameters for observation files.");
+	/// 5- Create output file for header data (suffix name _HDR.CSV), print them, and close output file
 	FILE* outFile;
 	size_t anIdx;
 	while ((anIdx = fileName.find('.')) != string::npos) fileName.replace(anIdx, 1, 1, '_'); 	//replace . by _ in fileName
 	aStr = fileName + "_HDR.CSV";
 	if ((outFile = fopen(aStr.c_str(), "w")) == NULL) {
-		log.severe("Cannot create file " + aStr);
+		result = "Cannot create file " + aStr;
+		plog->severe(result);
 		return 6;
 	}
-	generateHeaderCSV(outFile, rinex, &log);
+	generateHeaderCSV(outFile, rinex, plog);
 	fclose(outFile);
 	rinex.clearHeaderData();
-	/// 11 - Create output file for observation or navigation data
+	/// 6- Create output file for observation or navigation data, in CSV or binary columnar format
+	bool binary = parser.getBoolOpt(BINARY);
+	string suffix = binary? ".COL" : ".CSV";
+	const char* outMode = binary? "wb" : "w";
 	switch (fileType) {
 	case 'O':
-		/// 11.1- If observation file, create output file (suffix name _OBS.CSV), and epoch by epoch read its data and print them. Close output file
-		aStr = fileName + "_OBS.CSV";
-		if ((outFile = fopen(aStr.c_str(), "w")) == NULL) {
-			log.severe("Cannot create file " + aStr);
+		/// 6.1- If observation file, create output file (suffix name _OBS.CSV or .COL), and epoch by epoch read its data and print them. Close output file
+		aStr = fileName + "_OBS" + suffix;
+		if ((outFile = fopen(aStr.c_str(), outMode)) == NULL) {
+			result = "Cannot create file " + aStr;
+			plog->severe(result);
 			return 6;
 		}
-		anInt = generateObsCSV(inFile, outFile, rinex, timeInterval, &log);
+		//when mapped, epochs out of the time interval are not read, seeking the first one and limiting the last one
+		if (!rinex.mapInputFile(inFile)) plog->info("Input file not mapped in memory. Epochs will be read from file stream");
+		else {
+			if (timeInterval.fromTime) rinex.seekObsEpoch(timeInterval.fromTimeTag);
+			if (timeInterval.toTime) rinex.limitObsEpochs(timeInterval.toTimeTag);
+			if (stoi(parser.getStrOpt(WORKERS)) != 1) rinex.setParallelRead(stoi(parser.getStrOpt(WORKERS)));
+		}
+		anInt = generateObsCSV(inFile, outFile, rinex, timeInterval, binary, plog);
 		fclose(outFile);
 		break;
 	case 'N':
-		/// 11.2 - If navigation file, create output file (suffix name _xxxNAV.CSV), and epoch by epoch read its data and print them. Close output file
+		/// 6.2- If navigation file, create output file (suffix name _xxxNAV.CSV or .COL), and epoch by epoch read its data and print them. Close output file
 		switch (sysId) {
 		case 'G':
-			aStr = fileName + "_GPSNAV.CSV";
-			if ((outFile = fopen(aStr.c_str(), "w")) == NULL) {
-			log.severe("Cannot create file " + aStr);
+			aStr = fileName + "_GPSNAV" + suffix;
+			if ((outFile = fopen(aStr.c_str(), outMode)) == NULL) {
+			result = "Cannot create file " + aStr;
+			plog->severe(result);
 			return 6;
 			}
-			anInt = generateGPSNavCSV(inFile, outFile, rinex, timeInterval, &log);
+			anInt = generateGPSNavCSV(inFile, outFile, rinex, timeInterval, binary, plog);
 			fclose(outFile);
 			break;
 		case 'E':
-			aStr = fileName + "_GALNAV.CSV";
-			if ((outFile = fopen(aStr.c_str(), "w")) == NULL) {
-				log.severe("Cannot create file " + aStr);
+			aStr = fileName + "_GALNAV" + suffix;
+			if ((outFile = fopen(aStr.c_str(), outMode)) == NULL) {
+				result = "Cannot create file " + aStr;
+				plog->severe(result);
 				return 6;
 			}
-			anInt = generateGalNavCSV(inFile, outFile, rinex, timeInterval, &log);
+			anInt = generateGalNavCSV(inFile, outFile, rinex, timeInterval, binary, plog);
 			fclose(outFile);
 			break;
 		case 'R':
-			aStr = fileName + "_GLONAV.CSV";
-			if ((outFile = fopen(aStr.c_str(), "w")) == NULL) {
-				log.severe("Cannot create file " + aStr);
+			aStr = fileName + "_GLONAV" + suffix;
+			if ((outFile = fopen(aStr.c_str(), outMode)) == NULL) {
+				result = "Cannot create file " + aStr;
+				plog->severe(result);
 				return 6;
 			}
-			anInt = generateGloNavCSV(inFile, outFile, rinex, timeInterval, &log);
+			anInt = generateGloNavCSV(inFile, outFile, rinex, timeInterval, binary, plog);
 			fclose(outFile);
 			break;
 		case 'S':
-			aStr = fileName + "_SBASNAV.CSV";
-			if ((outFile = fopen(aStr.c_str(), "w")) == NULL) {
-				log.severe("Cannot create file " + aStr);
+			aStr = fileName + "_SBASNAV" + suffix;
+			if ((outFile = fopen(aStr.c_str(), outMode)) == NULL) {
+				result = "Cannot create file " + aStr;
+				plog->severe(result);
 				return 6;
 			}
-			anInt = generateSBASNavCSV(inFile, outFile, rinex, timeInterval, &log);
+			anInt = generateSBASNavCSV(inFile, outFile, rinex, timeInterval, binary, plog);
 			fclose(outFile);
 			break;
 		default:	//should not happen
-			log.severe("Unexpected system type for navigation file");
+			result = "Unexpected system type for navigation file";
+			plog->severe(result);
 			return 7;
 		}
 		break;
 	default:
-			log.severe("Unexpected file type, different from Observation or Navigation");
+			result = "Unexpected file type, different from Observation or Navigation";
+			plog->severe(result);
 			return 7;
 	}
-	fclose(inFile);
+	closeStream(inFile, inFileName);
+	result = "Epochs read: " + to_string((long long) anInt);
+	plog->info("End of CSV generation. " + result);
 	return anInt>0? 0:5;
 }
 
@@ -335,16 +462,109 @@ bool timeInInterval(double epochT, TimeIntervalParams &timeInterval) {
 	return true;
 }
 
+/**startNavOutput prints the heading line of a navigation data CSV file, or defines the columns of the binary columnar table.
+ * Columns are named as in the heading line: the first four (system, satellite, week and TOW) have their own types, and the
+ * remaining ones are broadcast orbit values.
+ *
+ *@param nav the navigation data output to start. If its table is not NULL, columns are defined in it
+ *@param out the output file where the CSV heading line is printed
+ *@param heading the heading line of the CSV file, with comma separated column names
+*/
+void startNavOutput(NavOutput &nav, FILE* out, const string &heading) {
+	nav.column = 0;
+	if (nav.table == NULL) {
+		fprintf(out, "%s\n", heading.c_str());
+		return;
+	}
+	vector<string> names = getTokens(heading, ',');
+	for (unsigned int i = 0; i < names.size(); i++)
+		switch (i) {
+		case 0:
+			nav.table->addColumn(names[i], ColumnarFile::CHAR);
+			break;
+		case 1:
+			nav.table->addColumn(names[i], ColumnarFile::INT16);
+			break;
+		case 2:
+			nav.table->addColumn(names[i], ColumnarFile::INT32);
+			break;
+		default:
+			nav.table->addColumn(names[i], ColumnarFile::DOUBLE);
+			break;
+		}
+}
+
+/**putNavCSVtime renders in the output buffer the first fields of a navigation data CSV line, as "%c,%d,%d,%lf" would do,
+ * or puts them in the first columns of the current row of the binary table.
+ *
+ *@param nav the navigation data output where fields are rendered
+ *@param sys the system identification
+ *@param sat the satellite number
+ *@param week the GPS week of the epoch
+ *@param tow the GPS time of week of the epoch
+*/
+void putNavCSVtime(NavOutput &nav, char sys, int sat, int week, double tow) {
+	if (nav.table != NULL) {
+		nav.table->putChar(0, sys);
+		nav.table->putInt(1, sat);
+		nav.table->putInt(2, week);
+		nav.table->putDouble(3, tow);
+		nav.column = 4;
+		return;
+	}
+	nav.csv.putChar(sys);
+	nav.csv.putChar(',');
+	nav.csv.putInt(sat);
+	nav.csv.putChar(',');
+	nav.csv.putInt(week);
+	nav.csv.putChar(',');
+	nav.csv.putFixed(tow, 0, 6);
+}
+
+/**putNavCSVvalues renders in the output buffer the given broadcast orbit values, each one as ",%19.12E" would do,
+ * or puts them in the next columns of the current row of the binary table.
+ *
+ *@param nav the navigation data output where values are rendered
+ *@param values the place where the values to render are
+ *@param n the number of values to render
+*/
+void putNavCSVvalues(NavOutput &nav, const double* values, int n) {
+	for (int i = 0; i < n; i++) {
+		if (nav.table != NULL) {
+			nav.table->putDouble(nav.column++, values[i]);
+		} else {
+			nav.csv.putChar(',');
+			nav.csv.putExp(values[i], 19, 12);
+		}
+	}
+}
+
+/**endNavLine finishes the navigation data line: prints the CSV line rendered, or ends the current row of the binary table.
+ *
+ *@param nav the navigation data output
+ *@param out the output file where the CSV line is printed
+*/
+void endNavLine(NavOutput &nav, FILE* out) {
+	if (nav.table != NULL) {
+		nav.table->endRow();
+		nav.column = 0;
+		return;
+	}
+	nav.csv.putChar('\n');
+	nav.csv.write(out);
+}
+
 /**generateObsCSV prints observation data in CVS format
  *
  *@param inFile the already open input RINEX observation file, positioned just after the End of Header record, in the first epoch 
  *@param outFile the already open print stream where header data will be printed in CVS format
  *@param rinex the RINEX data object, source of data to be printed
  *@param timeInterval the values defining the interval and the limits to be checked
+ *@param binary if true, data are written to a binary columnar table instead of CSV lines
  *@param plog a pointer to a Logger to be used to record logging messages
  *@return  the number of epochs transferred to the CSV file
  */
-int generateObsCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+int generateObsCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, bool binary, Logger* plog) {
 	int anInt;		//a general purpose int variable
 	string aStr;	//a general purpose string variable
 	double aDouble;	//a general purpose double variable
@@ -353,20 +573,61 @@ int generateObsCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalPa
 	double tow, value, tTag;
 	string obsType;
 	int nrec = 0;
+	OutputBuffer csv;	//the place where CSV lines for each epoch are rendered
+	ColumnarFile table(outFile);	//the binary table where observations are put, if requested
 	plog->finer("Print CSV observation epochs:");
 	try {
-		fprintf(outFile, "Week,TOW,Sys,Sat,Obs,Value,LoL,Strg\n");
+		if (binary) {
+			table.addColumn("Week", ColumnarFile::INT32);
+			table.addColumn("TOW", ColumnarFile::DOUBLE);
+			table.addColumn("Sys", ColumnarFile::CHAR);
+			table.addColumn("Sat", ColumnarFile::INT16);
+			table.addColumn("Obs", ColumnarFile::STRING, 3);
+			table.addColumn("Value", ColumnarFile::DOUBLE);
+			table.addColumn("LoL", ColumnarFile::INT8);
+			table.addColumn("Strg", ColumnarFile::INT8);
+		} else fprintf(outFile, "Week,TOW,Sys,Sat,Obs,Value,LoL,Strg\n");
 		while ((rdStat = rinex.readObsEpoch(inFile)) != 0) {
 			if (rdStat == 1 && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterObsData()) {	//Epoch observables and data are well formatted and it remains data after filtering
 				nrec++;
 				for (unsigned int index = 0; rinex.getObsData(sys, sat, obsType, value, lol, strg, tTag, index); index++) {
-					fprintf(outFile, "%d,%lf,%c,%d,%s,%lf,%d,%d\n", week, tow, sys, sat, obsType.c_str(), value, lol, strg);
+					if (binary) {
+						table.putInt(0, week);
+						table.putDouble(1, tow);
+						table.putChar(2, sys);
+						table.putInt(3, sat);
+						table.putStr(4, obsType);
+						table.putDouble(5, value);
+						table.putInt(6, lol);
+						table.putInt(7, strg);
+						table.endRow();
+						continue;
+					}
+					//render the line as "%d,%lf,%c,%d,%s,%lf,%d,%d\n"
+					csv.putInt(week);
+					csv.putChar(',');
+					csv.putFixed(tow, 0, 6);
+					csv.putChar(',');
+					csv.putChar(sys);
+					csv.putChar(',');
+					csv.putInt(sat);
+					csv.putChar(',');
+					csv.putStr(obsType);
+					csv.putChar(',');
+					csv.putFixed(value, 0, 6);
+					csv.putChar(',');
+					csv.putInt(lol);
+					csv.putChar(',');
+					csv.putInt(strg);
+					csv.putChar('\n');
 				}
+				if (!binary) csv.write(outFile);
 			}
 		}
 	} catch (string error) {
 		plog->severe(error);
 	}
+	if (binary && !table.close()) plog->severe("Error writing binary columnar data");
 	plog->finer("Obs epochs to CSV:" + to_string((long long) nrec));
 	return nrec;
 }
@@ -377,10 +638,11 @@ int generateObsCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalPa
  *@param outFile the already open print stream where header data will be printed in CVS format
  *@param rinex the RINEX data object, source of data to be printed
  *@param timeInterval the values defining the interval and the limits to be checked
+ *@param binary if true, data are written to a binary columnar table instead of CSV lines
  *@param plog a pointer to a Logger to be used to record logging messages
  *@return  the exit status
  */
-int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, bool binary, Logger* plog) {
 	int anInt;		//a general purpose int variable
 	string aStr;	//a general purpose string variable
 	double aDouble;	//a general purpose double variable
@@ -388,19 +650,21 @@ int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
 	int week, rdStat, sat;
 	double tow, tTag, bo[8][4];
 	int nrec = 0;
+	NavOutput nav;		//the place where CSV lines are rendered, or the binary table where values are put
+	ColumnarFile table(outFile);
+	nav.table = binary? &table : NULL;
 	plog->finer("Print CSV GPS navigation epochs:");
 	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Codes on L2,GPS Week,L2 P flag,SV accuracy,SV health,TGD,IODC,Transm. time,Fit interval\n");
+		startNavOutput(nav, outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Codes on L2,GPS Week,L2 P flag,SV accuracy,SV health,TGD,IODC,Transm. time,Fit interval");
 		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
 			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
 				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'G') {
 					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 7; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					for (int j = 0; j != 2; j++) fprintf(outFile, ",%19.12E", bo[7][j]);
-					fprintf(outFile, "\n");
+					putNavCSVtime(nav, sys, sat, week, tow);
+					putNavCSVvalues(nav, bo[0] + 1, 3);
+					putNavCSVvalues(nav, bo[1], 6 * 4);		//broadcast orbits 1 to 6
+					putNavCSVvalues(nav, bo[7], 2);
+					endNavLine(nav, outFile);
 					rinex.clearNavData();
 				} else plog->warning("Expected GPS epoch, but selected an " + string(1, sys) + " sat.");
 			}
@@ -409,6 +673,7 @@ int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
 	} catch (string error) {
 		plog->severe(error);
 	}
+	if (binary && !table.close()) plog->severe("Error writing binary columnar data");
 	plog->finer("GPS nav. epochs to CSV:" + to_string((long long) nrec));
 	return nrec;
 }
@@ -419,10 +684,11 @@ int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
  *@param outFile the already open print stream where header data will be printed in CVS format
  *@param rinex the RINEX data object, source of data to be printed
  *@param timeInterval the values defining the interval and the limits to be checked
+ *@param binary if true, data are written to a binary columnar table instead of CSV lines
  *@param plog a pointer to a Logger to be used to record logging messages
  *@return  the exit status
  */
-int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, bool binary, Logger* plog) {
 	int anInt;		//a general purpose int variable
 	string aStr;	//a general purpose string variable
 	double aDouble;	//a general purpose double variable
@@ -430,20 +696,23 @@ int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
 	int week, rdStat, sat;
 	double tow, tTag, bo[8][4];
 	int nrec = 0;
+	NavOutput nav;		//the place where CSV lines are rendered, or the binary table where values are put
+	ColumnarFile table(outFile);
+	nav.table = binary? &table : NULL;
 	plog->finer("Print CSV Galileo navigation epochs:");
 	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Data sources,Gal Week,SISA,SV health,BGD E5a/E1,BGD E5b/E1,Transm. time\n");
+		startNavOutput(nav, outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Data sources,Gal Week,SISA,SV health,BGD E5a/E1,BGD E5b/E1,Transm. time");
 		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
 			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
 				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'E') {
 					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 5; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					for (int j = 0; j != 3; j++) fprintf(outFile, ",%19.12E", bo[5][j]);
-					for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[6][j]);
-					fprintf(outFile, ",%19.12E\n", bo[7][0]);
+					putNavCSVtime(nav, sys, sat, week, tow);
+					putNavCSVvalues(nav, bo[0] + 1, 3);
+					putNavCSVvalues(nav, bo[1], 4 * 4);		//broadcast orbits 1 to 4
+					putNavCSVvalues(nav, bo[5], 3);
+					putNavCSVvalues(nav, bo[6], 4);
+					putNavCSVvalues(nav, bo[7], 1);
+					endNavLine(nav, outFile);
 					rinex.clearNavData();
 				} else plog->warning("Expected GALILEO epoch, but selected an " + string(1, sys) + " sat.");
 			}
@@ -452,6 +721,7 @@ int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
 	} catch (string error) {
 		plog->severe(error);
 	}
+	if (binary && !table.close()) plog->severe("Error writing binary columnar data");
 	plog->finer("Galileo nav. epochs to CSV:" + to_string((long long) nrec));
 	return nrec;
 }
@@ -462,10 +732,11 @@ int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
  *@param outFile the already open print stream where header data will be printed in CVS format
  *@param rinex the RINEX data object, source of data to be printed
  *@param timeInterval the values defining the interval and the limits to be checked
+ *@param binary if true, data are written to a binary columnar table instead of CSV lines
  *@param plog a pointer to a Logger to be used to record logging messages
  *@return  the exit status
  */
-int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, bool binary, Logger* plog) {
 	int anInt;		//a general purpose int variable
 	string aStr;	//a general purpose string variable
 	double aDouble;	//a general purpose double variable
@@ -473,18 +744,20 @@ int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
 	int week, rdStat, sat;
 	double tow, tTag, bo[8][4];
 	int nrec = 0;
+	NavOutput nav;		//the place where CSV lines are rendered, or the binary table where values are put
+	ColumnarFile table(outFile);
+	nav.table = binary? &table : NULL;
 	plog->finer("Print CSV GLONASS navigation epochs:");
 	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,-TauN,+GammaN,Msg.frm.t,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.frq.,Sat.Z,Sat.vel.Z,Sat.acc.Z,Age\n");
+		startNavOutput(nav, outFile, "Sys,Sat,Week,TOW,-TauN,+GammaN,Msg.frm.t,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.frq.,Sat.Z,Sat.vel.Z,Sat.acc.Z,Age");
 		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
 			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
 				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'R') {
 					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 4; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					fprintf(outFile, "\n");
+					putNavCSVtime(nav, sys, sat, week, tow);
+					putNavCSVvalues(nav, bo[0] + 1, 3);
+					putNavCSVvalues(nav, bo[1], 3 * 4);		//broadcast orbits 1 to 3
+					endNavLine(nav, outFile);
 					rinex.clearNavData();
 				} else plog->warning("Expected GLONASS epoch, but selected an " + string(1, sys) + " sat.");
 			}
@@ -493,6 +766,7 @@ int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
 	} catch (string error) {
 		plog->severe(error);
 	}
+	if (binary && !table.close()) plog->severe("Error writing binary columnar data");
 	plog->finer("GLONASS nav. epochs to CSV:" + to_string((long long) nrec));
 	return nrec;
 }
@@ -503,10 +777,11 @@ int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterva
  *@param outFile the already open print stream where header data will be printed in CVS format
  *@param rinex the RINEX data object, source of data to be printed
  *@param timeInterval the values defining the interval and the limits to be checked
+ *@param binary if true, data are written to a binary columnar table instead of CSV lines
  *@param plog a pointer to a Logger to be used to record logging messages
  *@return  the exit status
  */
-int generateSBASNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+int generateSBASNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, bool binary, Logger* plog) {
 	int anInt;		//a general purpose int variable
 	string aStr;	//a general purpose string variable
 	double aDouble;	//a general purpose double variable
@@ -514,18 +789,20 @@ int generateSBASNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterv
 	int week, rdStat, sat;
 	double tow, tTag, bo[8][4];
 	int nrec = 0;
+	NavOutput nav;		//the place where CSV lines are rendered, or the binary table where values are put
+	ColumnarFile table(outFile);
+	nav.table = binary? &table : NULL;
 	plog->finer("Print CSV SBAS navigation epochs:");
 	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,aGf0,aGf1,Transm.time,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.URA,Sat.Z,Sat.vel.Z,Sat.acc.Z,IODN\n");
+		startNavOutput(nav, outFile, "Sys,Sat,Week,TOW,aGf0,aGf1,Transm.time,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.URA,Sat.Z,Sat.vel.Z,Sat.acc.Z,IODN");
 		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
 			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
 				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'S') {
 					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 4; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					fprintf(outFile, "\n");
+					putNavCSVtime(nav, sys, sat, week, tow);
+					putNavCSVvalues(nav, bo[0] + 1, 3);
+					putNavCSVvalues(nav, bo[1], 3 * 4);		//broadcast orbits 1 to 3
+					endNavLine(nav, outFile);
 					rinex.clearNavData();
 				} else plog->warning("Expected SBAS epoch, but selected an " + string(1, sys) + " sat.");
 			}
@@ -533,6 +810,7 @@ int generateSBASNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeInterv
 	} catch (string error) {
 		plog->severe(error);
 	}
+	if (binary && !table.close()) plog->severe("Error writing binary columnar data");
 	plog->finer("GBAS nav. epochs to CSV:" + to_string((long long) nrec));
 	return nrec;
 }
@@ -3,17 +3,36 @@
  *<p>Usage:
  *<p>RINEXtoRINEX.exe {options} InputRINEXfilename
  *<p>Options are:
+ *	- -e BATCH or --batch=BATCH : Convert all RINEX files in the given directory, or listed in the given text file (a file name per line). Default value: no batch
  *	- -f FROMT or --fromtime=FROMT : Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: 1st epoch in the input file
  *	- -k or --skipe : Skip epochs with erroneus data. Default value false
+ *	- -g FANOUT or --fanout=FANOUT : Additional observation files to generate from the same input (comma separated list of VER[:PREFIX[:SELLST]], see below). Default value: none
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -m MERGE or --merge=MERGE : Merge the RINEX observation files in the given directory, or listed in the given text file, into one output file. Default value: no merge
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -o OBSLST or --selobs=OBSLST : List of selected system-observables (ver.3.02 notation) from input (a comma separated list, like GC1C,GL1C). Default value is all selected.
  *	- -p OBS2LST or --selobs2=OBS2LST : List of selected system-observables (ver.2.10 notation) from input (comma separated list, like GC1,GL1,GL2). Default value is all selected.
  *	- -r RINEX or --rinex=RINEX : Output RINEX file name prefix. Default value RINEX = RTOR
  *	- -s SATLST or --selsat=SATLST : List of selected system-satellites from input (comma separated list, like G01,G02). Default value is all selected.
+ *	- -S JOBS or --serve=JOBS : Run conversion jobs read from the given input (--serve=- for the standard input) as a server, see below. Default value: no server
  *	- -t TOT or --totime=TOT : Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: last epoch in the input file
  *	- -u RUNBY or --runby=RUNBY : Who runs the RINEX file generation. Default value: Not specified
  *	- -v VER or --ver=VER : RINEX version to generate (V210, V302). Default value VER = TBD (same as input)
+ *	- -w WORKERS or --workers=WORKERS : Number of worker threads used in batch conversions, or to parse epochs of a single observation file. Default value WORKERS = 0 (as many as hardware threads)
+ *	- -x or --compact : Generate observation files in Compact RINEX format (Hatanaka). Default value false
+ *	- -z or --gzip : Compress with gzip the files generated. Default value false
+ *<p>Input files in Compact RINEX format, and input files compressed with gzip (named *.gz), are decoded on the fly.
+ *<p>Each additional observation file in FANOUT is stated by the RINEX version to generate (V210 or V302), the file name prefix (by default, the
+ * RINEX option value), and a list of system-satellites or system-observables (ver.3.02 notation) to select, separated by +
+ * (like V302:PNTG:G+GC1C+GL1C). Input epochs are read once for all the observation files generated.
+ * Errors in additional files are logged and these files skipped: the main observation file is generated anyway.
+ *<p>When merging, epochs of all input files are printed in time order. Epochs with the same time tag in several files are printed once
+ * (data from the first file in the list are taken).
+ *<p>When JOBS is given, the program runs as a long lived server of conversion jobs (see JobServer). Each input line contains a job
+ * identifier followed by the options and operator of a conversion, as they would be given in the command line (without JOBS,
+ * LOGLEVEL and PERFOUT, which are stated for the server). A reply line with the job identifier, its exit status, elapsed time and
+ * result is written to the standard output when each job ends. Jobs are run using WORKERS threads.
  *<p>
  *Copyright 2016 Francisco Cancillo
  *<p>
@@ -31,26 +50,60 @@
  *------+-------+------------------
  *V1.0	|2/2016	|First release
  *V1.1	|2/2018	|Reviewed to run on Linux
+ *V1.2	|10/2026	|Input observation files are read mapped in memory
+ *				|Added batch conversion of several RINEX files using worker threads
+ *				|Epochs of a single observation file are parsed using worker threads
+ *V1.3	|10/2026	|Added reading and generation of Compact RINEX and gzip compressed files
+ *				|Added option to dump performance counters at exit
+ *				|Added merge of several observation files into a single one
+ *				|Epochs out of the time interval selected are not read from mapped input files
+ *				|Added option to generate several observation files from the same input
+ *				|Added server mode to run conversion jobs in a long lived process
  */
 //from CommonClasses
 #include "ArgParser.h"
+#include "BatchRunner.h"
+#include "JobServer.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "Utilities.h"
 #include "RinexData.h"
 
+#include <math.h>
+#include <queue>
+
 using namespace std;
 
 //@cond DUMMY
 ///The command line format
 const string CMDLINE = "RINEXtoRINEX.exe {options} InputRINEXfilename";
 ///The program current version
-const string MYVER = " V1.1";
-///The parser object to store options and operators passed in the comman line
-ArgParser parser;
-//Metavariables for options
-int AEND, BIAS, FROMT, GPS, HELP, LOGLEVEL, MINSV, OUTRINEX, RUNBY, SELOBS3, SELOBS2, SELSAT, SKIPE, TOT, VER;
+const string MYVER = " V1.3";
+//Metavariables for options (set once in main before any conversion starts)
+int AEND, BATCH, BIAS, COMPACT, FANOUT, FROMT, GPS, GZIP, HELP, LOGLEVEL, MERGE, PERFOUT, MINSV, OUTRINEX, RUNBY, SELOBS3, SELOBS2, SELSAT, SERVE, SKIPE, TOT, VER, WORKERS;
 //Metavariables for operators
 int INRINEX;
+///An additional observation file generated from the same input data
+struct FanoutSink {
+	RinexData::RINEXversion version;	//the RINEX version of the file
+	string prefix;			//the file name prefix
+	vector<string> selSat;	//the system-satellites selected
+	vector<string> selObs;	//the system-observables selected
+	RinexData* rinex;		//the object used to print the file
+	FILE* outFile;			//the file, or NULL if not open
+	string outFileName;
+};
+//functions in this file
+int runJob(const ArgParser &, int, char**, Logger*, string &);
+int runConversion(ArgParser &, Logger*, string &);
+int convertRINEXfile(ArgParser &, const string &, bool, double, bool, double, int, Logger*, string &);
+int printRINEXfile(ArgParser &, FILE*, const string &, bool, double, bool, double, int, Logger*, string &);
+bool openFanoutSinks(ArgParser &, const string &, vector<FanoutSink> &, Logger*);
+bool openFanoutSink(ArgParser &, const string &, const string &, FanoutSink &, Logger*);
+void printFanoutEpoch(vector<FanoutSink> &, RinexData &, Logger*);
+void closeFanoutSinks(vector<FanoutSink> &);
+int mergeRINEXfiles(ArgParser &, const vector<string> &, bool, double, bool, double, Logger*, string &);
+int readMergeEpoch(RinexData &, FILE*, bool, double, bool, double, bool, double &, int &, int &, int &, Logger*);
 //@endcond 
 
 /**main
@@ -71,25 +124,36 @@ int INRINEX;
  *		- (4) error in data filtering parameters
  *		- (5) there were format errors in epoch data or no epoch data exist
  *		- (6) error when creating output file
+ *<p>In batch conversions the exit status is the greatest one of the files converted, and in server mode the greatest one of the jobs run.
  */
 int main(int argc, char* argv[]) {
 	/**The main process sequence follows:*/
-	/// 1 - Defines and sets the error logger object
+	/// 1 - Defines and sets the error logger object, and the parser object to store options and operators passed in the command line
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	ArgParser parser;
 	/// 2 - Setups the valid options in the command line. They will be used by the argument/option parser
+	GZIP = parser.addOption("-z", "--gzip", "GZIP", "Compress with gzip the files generated", false);
+	COMPACT = parser.addOption("-x", "--compact", "COMPACT", "Generate observation files in Compact RINEX format", false);
+	WORKERS = parser.addOption("-w", "--workers", "WORKERS", "Number of worker threads for batch conversions or epoch parsing (0 = hardware threads)", "0");
 	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V302)", "TBD");
 	RUNBY = parser.addOption("-u", "--runby", "RUNBY", "Who runs the RINEX file generation", "Run by");
 	TOT = parser.addOption("-t", "--totime", "TOT", "Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	SERVE = parser.addOption("-S", "--serve", "JOBS", "Run as a server the conversion jobs read from the given input (--serve=- for stdin)", "");
 	SELSAT = parser.addOption("-s", "--selsat", "SELSAT", "Select system-satellite from input (comma separated list of sys{-prn}, like G,R or G01,G02)", "");
 	OUTRINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "RTOR");
 	SELOBS2 = parser.addOption("-p", "--selobs2", "SELOBS2", "Select system-observable (ver.2.10 notation) from input (comma separated list, like C1,L1,L2)", "");
 	SELOBS3 = parser.addOption("-o", "--selobs", "SELOBS3", "Select system-observable (ver.3.02 notation) from input (comma separated list, like GC1C,GL1C)", "");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	MERGE = parser.addOption("-m", "--merge", "MERGE", "Merge the observation files in the given directory or list file into one output file", "");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	FANOUT = parser.addOption("-g", "--fanout", "FANOUT", "Additional observation files to generate (comma separated list of VER[:PREFIX[:SEL+SEL...]], like V302:PNTG:G+GC1C)", "");
 	SKIPE = parser.addOption("-k", "--skipe", "SKIPE", "Skip epochs with erroneous data", false);
+	BATCH = parser.addOption("-e", "--batch", "BATCH", "Convert all RINEX files in the given directory or list file", "");
 	FROMT = parser.addOption("-f", "--fromtime", "FROMT", "Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
 	/// 3- Setups the default values for operators in the command line
 	INRINEX = parser.addOperator("RINEX.DAT");
+	const ArgParser jobParser(parser);	//a parser without arguments, to be copied for each job in server mode
 	/// 4 - Parses arguments in the command line extracting options and operators
 	try {
 		parser.parseArgs(argc, argv);
@@ -104,17 +168,78 @@ int main(int argc, char* argv[]) {
 		parser.usage("Parses and read the given observation RINEX file generating a new file with the requested characteristics", CMDLINE);
 		return 0;
 	}
-	/// 5 - Sets logging level stated in option. Default level is INFO
+	/// 5 - Sets logging level stated in option. Default level is INFO. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 6 - Set 1st and last epoch time tags (if selected from / to epochs time) 
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
+	/// 6 - If server mode is requested, runs the conversion jobs read from the given input using worker threads
+	string aStr = parser.getStrOpt(SERVE);
+	if (!aStr.empty()) {
+		FILE* jobsFile = aStr.compare("-") == 0? stdin : fopen(aStr.c_str(), "r");
+		if (jobsFile == NULL) {
+			log.severe("Cannot open file " + aStr);
+			return 2;
+		}
+		JobServer server(stoi(parser.getStrOpt(WORKERS)), string(argv[0]), &log);
+		int status = server.serve(jobsFile, stdout, [&](int jobArgc, char** jobArgv, string &result) {
+			return runJob(jobParser, jobArgc, jobArgv, &log, result);
+		});
+		if (jobsFile != stdin) fclose(jobsFile);
+		return status;
+	}
+	/// 7 - Otherwise performs the conversion requested in the command line
+	string result;
+	return runConversion(parser, &log, result);
+}
+
+/**runJob performs a conversion job received in server mode.
+ *<p>The job arguments are parsed using a copy of the given parser, and the conversion requested is performed as it would be
+ * performed from the command line. It can be called from several threads at the same time.
+ *
+ *@param jobParser the ArgParser with the options defined and without arguments parsed
+ *@param argc the number of job arguments, including the program name
+ *@param argv the job arguments, as per main
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status as described for main
+ */
+int runJob(const ArgParser &jobParser, int argc, char** argv, Logger* plog, string &result) {
+	ArgParser parser(jobParser);
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		result = "Argument error: " + error;
+		return 1;
+	}
+	if (parser.getBoolOpt(HELP) || !parser.getStrOpt(SERVE).empty()) {
+		result = "Argument error: help and server options cannot be used in jobs";
+		return 1;
+	}
+	plog->info(parser.showOptValues());
+	plog->info(parser.showOpeValues());
+	return runConversion(parser, plog, result);
+}
+
+/**runConversion performs the conversion requested in the options and operator of the given parser: a batch conversion, a merge,
+ * or the conversion of the RINEX file given as operator, selecting epochs in the time window stated.
+ *
+ *@param parser the ArgParser containing the options and operator of the conversion. Its data are only read
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status as described for main
+ */
+int runConversion(ArgParser &parser, Logger* plog, string &result) {
+	/**The runConversion process sequence follows:*/
+	/// 1 - Set 1st and last epoch time tags (if selected from / to epochs time) 
 	bool fromTime = false, toTime = false;
-	double fromTimeTag, toTimeTag;
+	double fromTimeTag = 0.0, toTimeTag = 0.0;
 	int week, year, month, day, hour, minute;
 	double tow, second;
 	string aStr = parser.getStrOpt(FROMT);
 	if (!aStr.empty()) {
 		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
-			log.severe("Cannot state 'from time' for the time interval");
+			result = "Cannot state 'from time' for the time interval";
+			plog->severe(result);
 			return 1;
 		}
 		setWeekTow (year, month, day, hour, minute, second, week, tow);
@@ -124,52 +249,132 @@ int main(int argc, char* argv[]) {
 	aStr = parser.getStrOpt(TOT);
 	if (!aStr.empty()) {
 		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
-			log.severe("Cannot state 'to time' for the time interval");
+			result = "Cannot state 'to time' for the time interval";
+			plog->severe(result);
 			return 1;
 		}
 		setWeekTow (year, month, day, hour, minute, second, week, tow);
 		toTimeTag = getSecsGPSEphe(week, tow);
 		toTime = true;
 	}
-	/// 7 - Opens the RINEX input file
+	/// 2 - If batch conversion is requested, converts all the files in the directory or list given using worker threads.
+	/// Each file is parsed sequentially by its worker
+	aStr = parser.getStrOpt(BATCH);
+	if (!aStr.empty()) {
+		vector<string> files;
+		try {
+			files = BatchRunner::getFileList(aStr, BatchRunner::isRINEXfileName);
+		} catch (string error) {
+			result = error;
+			plog->severe(error);
+			return 2;
+		}
+		BatchRunner batch(stoi(parser.getStrOpt(WORKERS)), plog);
+		result = "Batch of files converted: " + to_string((long long) files.size());
+		return batch.run(files, [&](const string &fileName, string &fileResult) {
+			return convertRINEXfile(parser, fileName, fromTime, fromTimeTag, toTime, toTimeTag, 1, plog, fileResult);
+		});
+	}
+	/// 3 - If merge is requested, merges the observation files in the directory or list given into one output file
+	aStr = parser.getStrOpt(MERGE);
+	if (!aStr.empty()) {
+		vector<string> files;
+		try {
+			files = BatchRunner::getFileList(aStr, BatchRunner::isRINEXobsFileName);
+		} catch (string error) {
+			result = error;
+			plog->severe(error);
+			return 2;
+		}
+		return mergeRINEXfiles(parser, files, fromTime, fromTimeTag, toTime, toTimeTag, plog, result);
+	}
+	/// 4 - Otherwise converts the RINEX file given in the command line, parsing its epochs using worker threads
+	return convertRINEXfile(parser, parser.getOperator(INRINEX), fromTime, fromTimeTag, toTime, toTimeTag, stoi(parser.getStrOpt(WORKERS)), plog, result);
+}
+
+/**convertRINEXfile generates a new RINEX file from the given input RINEX file, using the options in the parser.
+ *<p>It uses its own objects to read and print RINEX files, and can be called from several threads at the same time.
+ * Errors and the conversion result are logged, and the result is also given in the result param.
+ *
+ *@param parser the ArgParser containing the options in the command line. Its data are only read
+ *@param fileName the name of the input RINEX file
+ *@param fromTime true when epochs shall be selected from fromTimeTag
+ *@param fromTimeTag the start of the time window for epochs to select
+ *@param toTime true when epochs shall be selected before toTimeTag
+ *@param toTimeTag the end of the time window for epochs to select
+ *@param readWorkers the number of worker threads to parse epochs of observation files (1 to parse them sequentially, 0 to use hardware threads)
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status (0, 2 to 6) as described for main
+ */
+int convertRINEXfile(ArgParser &parser, const string &fileName, bool fromTime, double fromTimeTag, bool toTime, double toTimeTag, int readWorkers, Logger* plog, string &result) {
+	/// 1 - Opens the RINEX input file
 	FILE* inFile;
-	string fileName = parser.getOperator (INRINEX);
-	if ((inFile = fopen(fileName.c_str(), "r")) == NULL) {
-		log.severe("Cannot open file " + fileName);
+	if ((inFile = openStream(fileName, false)) == NULL) {
+		result = "Cannot open file " + fileName;
+		plog->severe(result);
 		return 2;
 	}
-	/// 8 - Create a RINEX object, and extract header data from the RINEX input file
+	/// 2 - Calls printRINEXfile to read and print RINEX data, and closes the input file
+	int status = printRINEXfile(parser, inFile, fileName, fromTime, fromTimeTag, toTime, toTimeTag, readWorkers, plog, result);
+	closeStream(inFile, fileName);
+	return status;
+}
+
+/**printRINEXfile reads header and epoch data from the given input RINEX file, and prints the new RINEX file with them.
+ *
+ *@param parser the ArgParser containing the options in the command line
+ *@param inFile the input RINEX file, already open. It can be a Compact RINEX file
+ *@param fileName the name of the input RINEX file, used to read again its header for the additional observation files requested
+ *@param fromTime true when epochs shall be selected from fromTimeTag
+ *@param fromTimeTag the start of the time window for epochs to select
+ *@param toTime true when epochs shall be selected before toTimeTag
+ *@param toTimeTag the end of the time window for epochs to select
+ *@param readWorkers the number of worker threads to parse epochs of observation files (1 to parse them sequentially, 0 to use hardware threads)
+ *@param plog point to the Logger
+ *@param result a text to be filled with the conversion result
+ *@return the exit status (0, 3 to 6) as described for main
+ */
+int printRINEXfile(ArgParser &parser, FILE* inFile, const string &fileName, bool fromTime, double fromTimeTag, bool toTime, double toTimeTag, int readWorkers, Logger* plog, string &result) {
+	/**The printRINEXfile process sequence follows:*/
+	int week, minute;
+	double tow;
+	string aStr;
+	/// 1 - Create a RINEX object, and extract header data from the RINEX input file
 	RinexData::RINEXversion rinexVer = RinexData::V210;		//default version is 2.10
 	aStr = parser.getStrOpt(VER);
 	if (aStr.compare("TBD") == 0) rinexVer = RinexData::VTBD;
 	else if (aStr.compare("V302") == 0) rinexVer = RinexData::V302;
-	RinexData rinex(rinexVer, &log);
+	RinexData rinex(rinexVer, plog);
+	rinex.setCompactOutput(parser.getBoolOpt(COMPACT));
 	double aDouble;
 	char fileType = ' ';
 	char sysId = ' ';
 	try {
 		rinex.readRinexHeader(inFile);
 		if (!rinex.getHdLnData(RinexData::INFILEVER, aDouble, fileType, sysId)) {
-			log.severe("This RINEX input file version cannot be processed");
+			result = "This RINEX input file version cannot be processed";
+			plog->severe(result);
 			return 3;
 		}
 		rinex.setHdLnData(RinexData::RUNBY, "RINEXtoRINEX", parser.getStrOpt(RUNBY));
 	}  catch (string error) {
-		log.severe(error);
+		result = error;
+		plog->severe(result);
 		return 3;
 	}
-	/// 9 - Set filtering parameters for systems, satellites and/or observables, if any
+	/// 2 - Set filtering parameters for systems, satellites and/or observables, if any
 	vector<string> obsV2Tokens = getTokens(parser.getStrOpt(SELOBS2), ',');
 	vector<string> obsTokens = getTokens(parser.getStrOpt(SELOBS3), ',');
 	string observable;
 	//convert obsV2Tokens to V3 and append them to obsTokens
 	for (vector<string>::iterator it = obsV2Tokens.begin(); it != obsV2Tokens.end(); it++) {
 		observable = rinex.obsV2toV3((*it).substr(1));
-		if (observable.empty()) log.warning("Filtering data: ignored unknown V2 observable " + observable);
+		if (observable.empty()) plog->warning("Filtering data: ignored unknown V2 observable " + observable);
 		else obsTokens.push_back((*it).substr(0,1) + observable);
 	}
 	if (!rinex.setFilter(getTokens(parser.getStrOpt(SELSAT), ','), obsTokens))
-		log.warning("Error in some data filtering parameters. Erroneous data ignored");
+		plog->warning("Error in some data filtering parameters. Erroneous data ignored");
 	bool skipe;
 	string outFileName;
 	FILE* outFile;
@@ -177,40 +382,53 @@ int main(int argc, char* argv[]) {
 	int badCount = 0;
 	int skipCount = 0;
 	int anInt;
+	vector<FanoutSink> sinks;
+	//the suffix appended to file names generated when they are compressed
+	string gzSfx = parser.getBoolOpt(GZIP)? ".gz" : "";
 	switch (fileType) {
 	case 'O':
 		try {
-		/// 10.0 - If observation file, generate a RINEX observation filename for the new ouput file and open it
+		/// 3.0 - If observation file, generate a RINEX observation filename for the new ouput file and open it
 			//Set the time of the 1st observation as current epoch time
 			if (rinex.getHdLnData(RinexData::TOFO, anInt, aDouble, outFileName)) rinex.setEpochTime(anInt, aDouble);
-			else log.warning("Time of first observation not set. File name will not be standard");
-			outFileName = rinex.getObsFileName(parser.getStrOpt(OUTRINEX));
-			if ((outFile = fopen(outFileName.c_str(), "w")) == NULL) {
-				log.severe("Cannot create file " + outFileName);
+			else plog->warning("Time of first observation not set. File name will not be standard");
+			outFileName = rinex.getObsFileName(parser.getStrOpt(OUTRINEX)) + gzSfx;
+			if ((outFile = openStream(outFileName, true)) == NULL) {
+				result = "Cannot create file " + outFileName;
+				plog->severe(result);
 				return 6;
 			}
-		/// 10.1 -  prints new RINEX header ...
+		/// 3.1 -  prints new RINEX header, and the headers of the additional observation files requested, if any ...
 			rinex.printObsHeader(outFile);
-		/// 10.2 - ... and iterate over input file extracting epoch by epoch data and printing them
+			if (!openFanoutSinks(parser, fileName, sinks, plog)) plog->warning("Some additional observation files not generated");
+		/// 3.2 - ... and iterate over input file extracting epoch by epoch data and printing them (observation epochs also in the additional files)
 			rinex.clearHeaderData();
+			//when mapped, epochs out of the time interval are not read, seeking the first one and limiting the last one
+			if (!rinex.mapInputFile(inFile)) plog->info("Input file not mapped in memory. Epochs will be read from file stream");
+			else {
+				if (fromTime) rinex.seekObsEpoch(fromTimeTag);
+				if (toTime) rinex.limitObsEpochs(toTimeTag);
+				if (readWorkers != 1) rinex.setParallelRead(readWorkers);
+			}
 			skipe = parser.getBoolOpt(SKIPE);
 			while ((anInt = rinex.readObsEpoch(inFile)) != 0) {
 				if (fromTime) {
 					rinex.getEpochTime(week, tow, aDouble, minute);
 					if (fromTimeTag > getSecsGPSEphe(week, tow)) {
-						log.finer("Epoch before interval");
+						plog->finer("Epoch before interval");
 						continue;
 					}
 				}
 				if (toTime) {
 					rinex.getEpochTime(week, tow, aDouble, minute);
 					if (toTimeTag <= getSecsGPSEphe(week, tow)) {
-						log.finer("Epoch after interval");
+						plog->finer("Epoch after interval");
 						continue;
 					}
 				}
 				switch (anInt) {
 				case 1:
+					printFanoutEpoch(sinks, rinex, plog);
 					rinex.printObsEpoch(outFile);
 					goodCount++;
 					break;
@@ -221,6 +439,7 @@ int main(int argc, char* argv[]) {
 					break;
 				case 3:
 					if (!skipe) {
+						printFanoutEpoch(sinks, rinex, plog);
 						rinex.printObsEpoch(outFile);
 						skipCount++;
 					}
@@ -239,26 +458,30 @@ int main(int argc, char* argv[]) {
 				}
 			}
 		} catch (string error) {
-			log.severe(error + string(". Incomplete RINEX obs. file"));
-			fclose(outFile);
+			result = error + string(". Incomplete RINEX obs. file");
+			plog->severe(result);
+			closeFanoutSinks(sinks);
+			closeStream(outFile, outFileName);
 			return 5;
 		}
-		fclose(outFile);
+		closeFanoutSinks(sinks);
+		closeStream(outFile, outFileName);
 		break;
 	case 'N':
 	case 'G':
 	case 'E':
 	case 'R':
 		try {
-		/// 11.0 - If navigation file, generate a RINEX navigation filename for the new ouput file and open it
-			outFileName = rinex.getNavFileName(parser.getStrOpt (OUTRINEX));
-			if ((outFile = fopen(outFileName.c_str(), "w")) == NULL) {
-				log.severe("Cannot create file " + outFileName);
+		/// 4.0 - If navigation file, generate a RINEX navigation filename for the new ouput file and open it
+			outFileName = rinex.getNavFileName(parser.getStrOpt (OUTRINEX)) + gzSfx;
+			if ((outFile = openStream(outFileName, true)) == NULL) {
+				result = "Cannot create file " + outFileName;
+				plog->severe(result);
 				return 6;
 			}
-		/// 11.1 - If navigation file, prints new RINEX header ...
+		/// 4.1 - If navigation file, prints new RINEX header ...
 			rinex.printNavHeader(outFile);
-		/// 11.2 - ... and iterate over input file extracting epoch by epoch data and printing them
+		/// 4.2 - ... and iterate over input file extracting epoch by epoch data and printing them
 			while (((anInt = rinex.readNavEpoch(inFile)) != 0) && (anInt != 9)) {
 				switch (anInt) {
 				case 1: //Epoch navigation data are well formatted. They have been stored. They  belong to the current epoch
@@ -275,18 +498,405 @@ int main(int argc, char* argv[]) {
 			}
 
 		} catch (string error) {
-			log.severe(error + string(". Incomplete RINEX nav. file"));
-			fclose(outFile);
+			result = error + string(". Incomplete RINEX nav. file");
+			plog->severe(result);
+			closeStream(outFile, outFileName);
 			return 5;
 		}
-		fclose(outFile);
+		closeStream(outFile, outFileName);
 		break;
 	default:
 		break;
 	}
-	fclose(inFile);
-	log.info("End of RINEX generation. Epochs: good=" + to_string((long long) goodCount)
+	result = "Epochs: good=" + to_string((long long) goodCount)
+			+ " bad=" + to_string((long long) badCount)
+			+ " skiped=" +  to_string((long long) skipCount);
+	if (!sinks.empty()) result += " additional files=" + to_string((long long) sinks.size());
+	plog->info("End of RINEX generation. " + result);
+	return goodCount>0? 0:5;
+}
+
+/**openFanoutSinks creates the additional observation files requested in the FANOUT option, and prints their headers.
+ *<p>Each file is printed using its own RINEX object, with the version and filtering data requested, and the header data read
+ * again from the input file. Epochs data are copied to these objects from the one reading the input file (see printFanoutEpoch).
+ *<p>Additional files that cannot be created are logged and not included in sinks: the other ones are generated anyway.
+ *
+ *@param parser the ArgParser containing the options in the command line
+ *@param fileName the name of the input RINEX observation file
+ *@param sinks the additional files opened, with their RINEX objects
+ *@param plog point to the Logger
+ *@return true if all the additional files requested have been created, false otherwise
+ */
+bool openFanoutSinks(ArgParser &parser, const string &fileName, vector<FanoutSink> &sinks, Logger* plog) {
+	vector<string> specs = getTokens(parser.getStrOpt(FANOUT), ',');
+	vector<string> fields, selTokens;
+	bool allOpen = true;
+	for (vector<string>::iterator it = specs.begin(); it != specs.end(); it++) {
+		FanoutSink sink;
+		fields = getTokens(*it, ':');
+		if (fields.empty() || ((fields[0].compare("V210") != 0) && (fields[0].compare("V302") != 0))) {
+			plog->warning("Ignored additional file with unknown RINEX version: " + *it);
+			continue;
+		}
+		sink.version = fields[0].compare("V302") == 0? RinexData::V302 : RinexData::V210;
+		sink.prefix = (fields.size() > 1) && !fields[1].empty()? fields[1] : parser.getStrOpt(OUTRINEX);
+		if (fields.size() > 2) {
+			selTokens = getTokens(fields[2], '+');
+			for (vector<string>::iterator itSel = selTokens.begin(); itSel != selTokens.end(); itSel++)
+				if (itSel->size() == 4) sink.selObs.push_back(*itSel);
+				else sink.selSat.push_back(*itSel);
+		}
+		sink.rinex = new RinexData(sink.version, plog);
+		sink.outFile = NULL;
+		if (openFanoutSink(parser, fileName, *it, sink, plog)) sinks.push_back(sink);
+		else {
+			plog->severe("Additional observation file " + *it + " not generated");
+			delete sink.rinex;
+			allOpen = false;
+		}
+	}
+	return allOpen;
+}
+
+/**openFanoutSink creates an additional observation file, and prints its header from the one of the input file.
+ *
+ *@param parser the ArgParser containing the options in the command line
+ *@param fileName the name of the input RINEX observation file
+ *@param spec the specification of the additional file in the FANOUT option
+ *@param sink the additional file to open, with its RINEX object and filtering data
+ *@param plog point to the Logger
+ *@return true if the file has been created and its header printed, false otherwise (the file is not left open)
+ */
+bool openFanoutSink(ArgParser &parser, const string &fileName, const string &spec, FanoutSink &sink, Logger* plog) {
+	FILE* inFile;
+	int week;
+	double tow;
+	string aStr;
+	RinexData &rinex = *sink.rinex;
+	rinex.setCompactOutput(parser.getBoolOpt(COMPACT));
+	if ((inFile = openStream(fileName, false)) == NULL) {
+		plog->severe("Cannot open file " + fileName);
+		return false;
+	}
+	try {
+		rinex.readRinexHeader(inFile);
+	}  catch (string error) {
+		plog->severe(error);
+		closeStream(inFile, fileName);
+		return false;
+	}
+	closeStream(inFile, fileName);
+	rinex.setHdLnData(RinexData::RUNBY, "RINEXtoRINEX", parser.getStrOpt(RUNBY));
+	if (rinex.getHdLnData(RinexData::TOFO, week, tow, aStr)) rinex.setEpochTime(week, tow);
+	if (!rinex.setFilter(sink.selSat, sink.selObs))
+		plog->warning("Error in some data filtering parameters of " + spec + ". Erroneous data ignored");
+	sink.outFileName = rinex.getObsFileName(sink.prefix) + (parser.getBoolOpt(GZIP)? ".gz" : "");
+	if ((sink.outFile = openStream(sink.outFileName, true)) == NULL) {
+		plog->severe("Cannot create file " + sink.outFileName);
+		return false;
+	}
+	try {
+		rinex.printObsHeader(sink.outFile);
+	}  catch (string error) {
+		plog->severe(error);
+		closeStream(sink.outFile, sink.outFileName);
+		sink.outFile = NULL;
+		remove(sink.outFileName.c_str());
+		return false;
+	}
+	rinex.clearHeaderData();
+	return true;
+}
+
+/**printFanoutEpoch prints in the additional observation files the current epoch of the given RINEX object, before it is printed
+ * (and its data filtered) by this object.
+ *<p>Additional files where the epoch cannot be printed are logged, closed and removed from sinks: the other ones are printed anyway.
+ *
+ *@param sinks the additional files, with their RINEX objects
+ *@param rinex the RINEX object containing the epoch read from the input file
+ *@param plog point to the Logger
+ */
+void printFanoutEpoch(vector<FanoutSink> &sinks, RinexData &rinex, Logger* plog) {
+	vector<FanoutSink>::iterator it = sinks.begin();
+	while (it != sinks.end()) {
+		try {
+			if (it->rinex->copyObsEpoch(rinex)) it->rinex->printObsEpoch(it->outFile);
+			it++;
+		} catch (string error) {
+			plog->severe(error + ". Incomplete additional observation file " + it->outFileName);
+			closeStream(it->outFile, it->outFileName);
+			delete it->rinex;
+			it = sinks.erase(it);
+		}
+	}
+}
+
+/**closeFanoutSinks closes the additional observation files, and releases their RINEX objects.
+ *
+ *@param sinks the additional files, with their RINEX objects
+ */
+void closeFanoutSinks(vector<FanoutSink> &sinks) {
+	for (vector<FanoutSink>::iterator it = sinks.begin(); it != sinks.end(); it++) {
+		if (it->outFile != NULL) closeStream(it->outFile, it->outFileName);
+		delete it->rinex;
+	}
+	sinks.clear();
+}
+
+/**mergeRINEXfiles generates a new RINEX observation file merging epochs from the given input RINEX observation files, using the options in the parser.
+ *<p>Input files are read at the same time, epoch by epoch, and the epoch with the earliest time tag is printed each time.
+ * Only the current epoch of each input file is kept in memory. Epochs with the same time tag in several files are printed once,
+ * taking the data from the first file in the list. Input files are assumed to be sorted by time, and epochs found out of order are
+ * printed where found. Observable types of the output file are the ones in all input files, and other header data are taken from
+ * the first one. Special event epochs are not merged.
+ *
+ *@param parser the ArgParser containing the options in the command line. Its data are only read
+ *@param files the names of the input RINEX observation files
+ *@param fromTime true when epochs shall be selected from fromTimeTag
+ *@param fromTimeTag the start of the time window for epochs to select
+ *@param toTime true when epochs shall be selected before toTimeTag
+ *@param toTimeTag the end of the time window for epochs to select
+ *@param plog point to the Logger
+ *@param result a text to be filled with the merge result
+ *@return the exit status (0, 2 to 6) as described for main
+ */
+int mergeRINEXfiles(ArgParser &parser, const vector<string> &files, bool fromTime, double fromTimeTag, bool toTime, double toTimeTag, Logger* plog, string &result) {
+	/**The mergeRINEXfiles process sequence follows:*/
+	int week, anInt;
+	double tow, aDouble;
+	char fileType, sysId;
+	string aStr;
+	vector<string> obsTypes;
+	if (files.empty()) {
+		result = "No files to merge";
+		plog->severe(result);
+		return 2;
+	}
+	/// 1 - Opens each input file and reads its header using its own RINEX object
+	vector<FILE*> inFiles;
+	vector<RinexData*> readers;
+	int status = 0;
+	for (vector<string>::const_iterator it = files.begin(); (it != files.end()) && (status == 0); it++) {
+		FILE* inFile;
+		if ((inFile = openStream(*it, false)) == NULL) {
+			result = "Cannot open file " + *it;
+			status = 2;
+			break;
+		}
+		RinexData* reader = new RinexData(RinexData::VTBD, plog);
+		inFiles.push_back(inFile);
+		readers.push_back(reader);
+		try {
+			reader->readRinexHeader(inFile);
+			if (!reader->getHdLnData(RinexData::INFILEVER, aDouble, fileType, sysId) || (fileType != 'O')) {
+				result = "File " + *it + " is not a RINEX observation file that can be merged";
+				status = 3;
+			} else if (!reader->mapInputFile(inFile)) plog->info("File " + *it + " not mapped in memory. Epochs will be read from file stream");
+			else {
+				if (fromTime) reader->seekObsEpoch(fromTimeTag);
+				if (toTime) reader->limitObsEpochs(toTimeTag);
+			}
+		}  catch (string error) {
+			result = error;
+			status = 3;
+		}
+	}
+	/// 2 - Sets the header of the output file from the header of the 1st input file, adding the observable types of the others,
+	/// and the first and last observation times of all of them
+	RinexData::RINEXversion rinexVer = RinexData::V210;		//default version is 2.10
+	aStr = parser.getStrOpt(VER);
+	if (aStr.compare("TBD") == 0) rinexVer = RinexData::VTBD;
+	else if (aStr.compare("V302") == 0) rinexVer = RinexData::V302;
+	RinexData rinex(rinexVer, plog);
+	rinex.setCompactOutput(parser.getBoolOpt(COMPACT));
+	FILE* inFile = NULL;
+	if ((status == 0) && ((inFile = openStream(files[0], false)) == NULL)) {
+		result = "Cannot open file " + files[0];
+		status = 2;
+	}
+	if (status == 0) {
+		try {
+			rinex.readRinexHeader(inFile);
+			string timeSys;
+			bool allTOLO = true;
+			int firstWeek = 0, lastWeek = 0;
+			double firstTow = 0.0, lastTow = 0.0;
+			for (vector<RinexData*>::iterator it = readers.begin(); it != readers.end(); it++) {
+				//append observable types. Values are given for valid indexes, even when header records were not read
+				for (unsigned int i = 0; ; i++) {
+					sysId = ' ';
+					(*it)->getHdLnData(RinexData::SYS, sysId, obsTypes, i);
+					if (sysId == ' ') break;
+					rinex.setHdLnData(RinexData::SYS, sysId, obsTypes);
+				}
+				if ((*it)->getHdLnData(RinexData::TOFO, week, tow, aStr)
+						&& ((it == readers.begin()) || (getSecsGPSEphe(week, tow) < getSecsGPSEphe(firstWeek, firstTow)))) {
+					firstWeek = week;
+					firstTow = tow;
+					timeSys = aStr;
+				}
+				if (!(*it)->getHdLnData(RinexData::TOLO, week, tow, aStr)) allTOLO = false;
+				else if ((it == readers.begin()) || (getSecsGPSEphe(week, tow) > getSecsGPSEphe(lastWeek, lastTow))) {
+					lastWeek = week;
+					lastTow = tow;
+				}
+			}
+			if (allTOLO) {
+				rinex.setEpochTime(lastWeek, lastTow);
+				rinex.setHdLnData(RinexData::TOLO);
+			}
+			if (rinex.getHdLnData(RinexData::TOFO, week, tow, aStr)) {
+				rinex.setEpochTime(firstWeek, firstTow);
+				rinex.setHdLnData(RinexData::TOFO, timeSys);
+			} else plog->warning("Time of first observation not set. File name will not be standard");
+			rinex.setHdLnData(RinexData::RUNBY, "RINEXtoRINEX", parser.getStrOpt(RUNBY));
+			rinex.setHdLnData(RinexData::COMM, "Merged from " + to_string((long long) files.size()) + " files");
+		}  catch (string error) {
+			result = error;
+			status = 3;
+		}
+		closeStream(inFile, files[0]);
+	}
+	if (status != 0) {
+		plog->severe(result);
+		for (unsigned int i = 0; i < readers.size(); i++) {
+			closeStream(inFiles[i], files[i]);
+			delete readers[i];
+		}
+		return status;
+	}
+	/// 3 - Set filtering parameters for systems, satellites and/or observables, if any
+	vector<string> obsV2Tokens = getTokens(parser.getStrOpt(SELOBS2), ',');
+	vector<string> obsTokens = getTokens(parser.getStrOpt(SELOBS3), ',');
+	string observable;
+	//convert obsV2Tokens to V3 and append them to obsTokens
+	for (vector<string>::iterator it = obsV2Tokens.begin(); it != obsV2Tokens.end(); it++) {
+		observable = rinex.obsV2toV3((*it).substr(1));
+		if (observable.empty()) plog->warning("Filtering data: ignored unknown V2 observable " + observable);
+		else obsTokens.push_back((*it).substr(0,1) + observable);
+	}
+	if (!rinex.setFilter(getTokens(parser.getStrOpt(SELSAT), ','), obsTokens))
+		plog->warning("Error in some data filtering parameters. Erroneous data ignored");
+	/// 4 - Generates a RINEX observation filename for the new output file, opens it and prints the header
+	string outFileName = rinex.getObsFileName(parser.getStrOpt(OUTRINEX)) + (parser.getBoolOpt(GZIP)? ".gz" : "");
+	FILE* outFile;
+	int goodCount = 0;
+	int badCount = 0;
+	int skipCount = 0;
+	int dupCount = 0;
+	int eventCount = 0;
+	if ((outFile = openStream(outFileName, true)) == NULL) {
+		result = "Cannot create file " + outFileName;
+		status = 6;
+	} else try {
+		rinex.printObsHeader(outFile);
+		rinex.clearHeaderData();
+		/// 5 - Reads the 1st epoch of each input file, and keeps a heap of input files ordered by the time tag of their current epoch
+		bool skipe = parser.getBoolOpt(SKIPE);
+		priority_queue<pair<double, int>, vector<pair<double, int> >, greater<pair<double, int> > > nextEpochs;
+		for (unsigned int i = 0; i < readers.size(); i++)
+			if (readMergeEpoch(*readers[i], inFiles[i], fromTime, fromTimeTag, toTime, toTimeTag, skipe, aDouble, badCount, skipCount, eventCount, plog) != 0)
+				nextEpochs.push(make_pair(aDouble, i));
+		/// 6 - Iterates printing the earliest epoch and reading the next one from its file, until all files are exhausted
+		bool printed = false;
+		double lastTag = 0.0;
+		double tTag, bias;
+		int sat, lol, strg, sysIx, obsIx;
+		while (!nextEpochs.empty()) {
+			pair<double, int> next = nextEpochs.top();
+			nextEpochs.pop();
+			RinexData* reader = readers[next.second];
+			if (printed && (fabs(next.first - lastTag) < 0.0005)) {
+				plog->fine("Epoch duplicated in " + files[next.second] + ". Ignored");
+				dupCount++;
+			} else {
+				if (printed && (next.first < lastTag)) plog->warning("Epoch out of order in " + files[next.second]);
+				rinex.clearObsData();
+				reader->getEpochTime(week, tow, bias, anInt);
+				rinex.setEpochTime(week, tow, bias, anInt);
+				for (unsigned int i = 0; reader->getObsData(sysId, sat, aStr, aDouble, lol, strg, tTag, i); i++)
+					if (rinex.getObsIndex(sysId, aStr, sysIx, obsIx)) rinex.saveObsData(sysIx, sat, obsIx, aDouble, lol, strg, tTag);
+				rinex.printObsEpoch(outFile);
+				goodCount++;
+				printed = true;
+				lastTag = next.first;
+			}
+			if (readMergeEpoch(*reader, inFiles[next.second], fromTime, fromTimeTag, toTime, toTimeTag, skipe, aDouble, badCount, skipCount, eventCount, plog) != 0)
+				nextEpochs.push(make_pair(aDouble, next.second));
+		}
+	} catch (string error) {
+		result = error + string(". Incomplete RINEX obs. file");
+		status = 5;
+	}
+	if (outFile != NULL) closeStream(outFile, outFileName);
+	for (unsigned int i = 0; i < readers.size(); i++) {
+		closeStream(inFiles[i], files[i]);
+		delete readers[i];
+	}
+	if (status != 0) {
+		plog->severe(result);
+		return status;
+	}
+	result = "Epochs: good=" + to_string((long long) goodCount)
 			+ " bad=" + to_string((long long) badCount)
-			+ " skiped=" +  to_string((long long) skipCount));
+			+ " skiped=" +  to_string((long long) skipCount)
+			+ " duplicated=" +  to_string((long long) dupCount)
+			+ " events=" +  to_string((long long) eventCount);
+	plog->info("End of RINEX merge. " + result);
 	return goodCount>0? 0:5;
 }
+
+/**readMergeEpoch reads from the given input file the next observation epoch to be merged, skipping the ones not selected.
+ *
+ *@param reader the RINEX object used to read the input file
+ *@param inFile the input RINEX file
+ *@param fromTime true when epochs shall be selected from fromTimeTag
+ *@param fromTimeTag the start of the time window for epochs to select
+ *@param toTime true when epochs shall be selected before toTimeTag
+ *@param toTimeTag the end of the time window for epochs to select
+ *@param skipe true when epochs with erroneous data shall be skipped
+ *@param tTag the time tag of the epoch read
+ *@param badCount the counter of epochs with errors, to be updated
+ *@param skipCount the counter of epochs with errors not skipped, to be updated
+ *@param eventCount the counter of special event epochs not merged, to be updated
+ *@param plog point to the Logger
+ *@return the readObsEpoch status of the epoch read (1 or 3), or 0 when the end of file has been reached
+ */
+int readMergeEpoch(RinexData &reader, FILE* inFile, bool fromTime, double fromTimeTag, bool toTime, double toTimeTag, bool skipe,
+					double &tTag, int &badCount, int &skipCount, int &eventCount, Logger* plog) {
+	int status, week, flag;
+	double tow, bias;
+	while ((status = reader.readObsEpoch(inFile)) != 0) {
+		tTag = reader.getEpochTime(week, tow, bias, flag);
+		if (fromTime && (fromTimeTag > tTag)) {
+			plog->finer("Epoch before interval");
+			continue;
+		}
+		if (toTime && (toTimeTag <= tTag)) {
+			plog->finer("Epoch after interval");
+			continue;
+		}
+		switch (status) {
+		case 1:
+			return status;
+		case 3:
+			badCount++;
+			if (!skipe) {
+				skipCount++;
+				return status;
+			}
+			break;
+		case 2:
+		case 5:
+		case 6:
+		case 7:
+			plog->info("Special event epoch not merged");
+			eventCount++;
+			reader.clearHeaderData();
+			break;
+		default:
+			badCount++;
+		}
+	}
+	return status;
+}
@@ -0,0 +1,716 @@
+/** @file RXBenchmark.cpp
+ * Contains the command line program to measure the performance of the data processing stages of the RXtoRINEX tools
+ * using the sample files in the Data directory, and to check that their outputs do not change.
+ *<p>Usage:
+ *<p>RXBenchmark.exe {options} [DataDirectory]
+ *<p>Options are:
+ *	- -b BINDIR or --bindir=BINDIR : Directory containing the commands run in end-to-end stages (OSPtoRINEX, RINEXtoCSV, GP2toOSP, PacketToOSP). Default value: the directory of this program
+ *	- -c CHECK or --check=CHECK : Check the digests of the stage outputs against the ones saved in the given file. Default value: no check
+ *	- -g STAGES or --stages=STAGES : Stages to run (a comma separated list of stage names, see below). Default value: all stages
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
+ *	- -n SCALE or --scale=SCALE : Number of times the sample data are replayed to build the input of each stage. Default value SCALE = 1
+ *	- -s SAVE or --save=SAVE : Save in the given file the digests of the stage outputs. Default value: not saved
+ *	- -w WORKDIR or --workdir=WORKDIR : Directory where stage inputs and outputs are written. Default value WORKDIR = BENCHWORK
+ *	- -x STAGE or --inproc=STAGE : Run only the given in-process stage in this process (used internally to measure each stage in its own process). Default value: none
+ *<p>Default value for operator is: Data
+ *<p>Stages are:
+ *	- ospdecode : acquisition of all data from an OSP file into a RinexData object (GNSSdataFromOSP::acqAllData and getBufferedEpoch)
+ *	- osptorinex : the OSPtoRINEX command generating observation and navigation files
+ *	- obsread2, obsread3 : reading of V2.10 / V3.02 observation files (RinexData::readObsEpoch)
+ *	- navread2, navread3 : reading of V2.10 / V3.02 navigation files (RinexData::readNavEpoch)
+ *	- obsprint2, obsprint3 : printing of V2.10 / V3.02 observation files (RinexData::printObsEpoch; only print time is measured)
+ *	- navprint2, navprint3 : printing of V2.10 / V3.02 navigation files (RinexData::printNavEpoch; only print time is measured)
+ *	- rinextocsv : the RINEXtoCSV command converting a V3.02 observation file
+ *	- gp2toosp : the GP2toOSP command converting a GP2 debug file
+ *	- packettoosp : the PacketToOSP command converting a file of receiver message packets
+ *<p>The input of each stage is built in the work directory from a sample file, replayed SCALE times: OSP, GP2 and packet files are
+ * concatenated, and the epochs of RINEX files are repeated after their header. Inputs are kept, and reused in later runs with the same scale.
+ *<p>Each stage runs in its own process, from the work directory. For each stage they are reported: the input size, the number of
+ * items processed (messages, epochs, lines or packets), the elapsed time, the items and MB of input processed per second,
+ * and the peak resident memory of the process.
+ *<p>Files existing in the work directory before the run are kept: only the outputs created by the stages are removed, before
+ * running the next stage and at the end of the run.
+ *<p>The outputs of each stage are the files it creates in the work directory. They are identified by a digest of their contents
+ * excluding the lines containing the run date (PGM / RUN BY / DATE records and equivalent ones). Digests saved using the current
+ * tools can be checked after changing them: any difference in an output is reported, and the exit status is 4.
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ *		|		|Added option to dump performance counters at exit
+ *		|		|Only files created by the run are removed from the work directory
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <direct.h>
+#else
+#include <unistd.h>
+#include <limits.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#endif
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "BatchRunner.h"
+#include "Logger.h"
+#include "PerfCounters.h"
+#include "Utilities.h"
+#include "GNSSdataFromOSP.h"
+#include "OSPMessage.h"
+#include "RinexData.h"
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "RXBenchmark.exe {options} [DataDirectory]";
+///The program current version
+const string MYVER = " V1.0";
+///The name of the file where in-process stages write their results
+const string RESULTFILE = "BENCH.RES";
+///The prefix of the stage input files built in the work directory
+const string INPUTPFX = "BENCH_";
+//Metavariables for options
+int BINDIR, CHECK, HELP, INPROC, LOGLEVEL, PERFOUT, SAVE, SCALE, STAGES, WORKDIR;
+//Metavariables for operators
+int DATADIR;
+///The sample files used to build the stage inputs
+enum SampleId {OSPS = 0, GP2S, PKTS, OBS2S, OBS3S, NAV2S, NAV3S, NSAMPLES};
+struct Sample {
+	const char* path;	//the sample file path, relative to the data directory
+	const char* unit;	//the items counted in the sample
+	bool isRinex;		//true if it is a RINEX file (its header is not replayed)
+};
+const Sample SAMPLES[NSAMPLES] = {
+	{"Windows/SiRFV/20160303_235441.OSP", "msgs", false},
+	{"Ubuntu/SLCLog.gp2", "lines", false},
+	{"Ubuntu/log_2016.02.06_06.pkt", "packets", false},
+	{"Windows/SiRFV/PNT1063w54.16O", "epochs", true},
+	{"Windows/SiRFV/PNT105---_R_20160632254_00U_01S_GO.rnx", "epochs", true},
+	{"Windows/SiRFV/PNT1063x59.16N", "epochs", true},
+	{"Windows/SiRFV/PNT100---_R_20160632359_00U_GN.rnx", "epochs", true}
+};
+///The stages measured. Stages without command are run in-process (see runInProcess)
+struct Stage {
+	const char* name;	//the stage name
+	SampleId input;		//the sample used to build its input
+	const char* command;	//the command to run, or NULL if the stage is run in-process
+	const char* args;	//the command arguments (separated by blanks). {IN} is replaced by the input file name
+};
+const Stage STAGELIST[] = {
+	{"ospdecode", OSPS, NULL, NULL},
+	{"osptorinex", OSPS, "OSPtoRINEX", "-n -s R,S -r BNCH {IN}"},
+	{"obsread2", OBS2S, NULL, NULL},
+	{"obsread3", OBS3S, NULL, NULL},
+	{"navread2", NAV2S, NULL, NULL},
+	{"navread3", NAV3S, NULL, NULL},
+	{"obsprint2", OBS2S, NULL, NULL},
+	{"obsprint3", OBS3S, NULL, NULL},
+	{"navprint2", NAV2S, NULL, NULL},
+	{"navprint3", NAV3S, NULL, NULL},
+	{"rinextocsv", OBS3S, "RINEXtoCSV", "{IN}"},
+	{"gp2toosp", GP2S, "GP2toOSP", "-i {IN} -o BNCH.OSP -d 01/01/1980 -D 31/12/2099"},
+	{"packettoosp", PKTS, "PacketToOSP", "-f BNCH.OSP {IN}"}
+};
+const int NSTAGES = sizeof STAGELIST / sizeof STAGELIST[0];
+///Labels of records containing the run date, excluded from output digests
+const char* RUNDATELABELS[] = {"PGM / RUN BY / DATE", "CRINEX PROG / DATE", "RUNBY,", "% program"};
+//functions in this file
+string fullPath(const string &);
+string fileBaseName(const string &);
+long long fileSize(const string &);
+bool makeDir(const string &);
+long long countItems(SampleId, const string &, Logger*);
+bool buildInput(SampleId, const string &, const string &, int, Logger*);
+int runProcess(const vector<string> &, const string &, double &, double &);
+int runInProcess(const string &, const string &, Logger*);
+unsigned long long fileDigest(const string &);
+//@endcond
+
+/**main
+ * gets the command line arguments, builds the input of each stage selected, runs the stages measuring their performance,
+ * and computes, saves or checks the digests of their outputs.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when creating the work directory or building the stage inputs
+ *		- (3) some stage failed (it could not be run or its exit status was not 0)
+ *		- (4) the outputs of some stage are different from the ones checked
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1 - Defines and sets the error logger object, and the parser object to store options and operators passed in the command line
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	ArgParser parser;
+	/// 2 - Setups the valid options in the command line. They will be used by the argument/option parser
+	INPROC = parser.addOption("-x", "--inproc", "INPROC", "Run only the given in-process stage in this process", "");
+	WORKDIR = parser.addOption("-w", "--workdir", "WORKDIR", "Directory where stage inputs and outputs are written", "BENCHWORK");
+	SAVE = parser.addOption("-s", "--save", "SAVE", "Save in the given file the digests of stage outputs", "");
+	SCALE = parser.addOption("-n", "--scale", "SCALE", "Number of times sample data are replayed to build stage inputs", "1");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	STAGES = parser.addOption("-g", "--stages", "STAGES", "Stages to run (comma separated list of stage names)", "");
+	CHECK = parser.addOption("-c", "--check", "CHECK", "Check output digests against the ones saved in the given file", "");
+	BINDIR = parser.addOption("-b", "--bindir", "BINDIR", "Directory of the commands run in end-to-end stages (default: the one of this program)", "");
+	/// 3 - Setups the default values for operators in the command line
+	DATADIR = parser.addOperator("Data");
+	/// 4 - Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Measures the performance of data processing stages using the sample files, and checks their outputs", CMDLINE);
+		return 0;
+	}
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	/// 5 - If an in-process stage is requested, runs it and ends. It is called from the benchmark process, in the work directory
+	string aStr = parser.getStrOpt(INPROC);
+	if (!aStr.empty()) return runInProcess(aStr, parser.getOperator(DATADIR), &log);
+	/// 6 - Gets the stages selected and the scale
+	int scale = atoi(parser.getStrOpt(SCALE).c_str());
+	if (scale < 1) {
+		log.severe("Wrong scale " + parser.getStrOpt(SCALE));
+		return 1;
+	}
+	vector<int> selStages;
+	vector<string> tokens = getTokens(parser.getStrOpt(STAGES), ',');
+	for (int i = 0; i < NSTAGES; i++)
+		if (tokens.empty() || (find(tokens.begin(), tokens.end(), string(STAGELIST[i].name)) != tokens.end())) selStages.push_back(i);
+	for (vector<string>::iterator it = tokens.begin(); it != tokens.end(); it++) {
+		bool found = false;
+		for (int i = 0; i < NSTAGES; i++) if (it->compare(STAGELIST[i].name) == 0) found = true;
+		if (!found) {
+			log.severe("Unknown stage " + *it);
+			return 1;
+		}
+	}
+	/// 7 - Loads the digests to check, if requested
+	map<string, unsigned long long> checkDigests;	//digests by stage and output file name
+	bool checkOutputs = !parser.getStrOpt(CHECK).empty();
+	char lineBuffer[1024];
+	char name[512];
+	unsigned long long digest;
+	FILE* digestFile;
+	if (checkOutputs) {
+		if ((digestFile = fopen(parser.getStrOpt(CHECK).c_str(), "r")) == NULL) {
+			log.severe("Cannot open digests file " + parser.getStrOpt(CHECK));
+			return 1;
+		}
+		while (fgets(lineBuffer, sizeof lineBuffer, digestFile) != NULL) {
+			if (lineBuffer[0] == '#') {
+				if ((sscanf(lineBuffer, "# scale %511s", name) == 1) && (atoi(name) != scale))
+					log.warning("Digests to check were saved with scale " + string(name));
+				continue;
+			}
+			if (sscanf(lineBuffer, "%511s %llx", name, &digest) == 2) checkDigests[string(name)] = digest;
+		}
+		fclose(digestFile);
+	}
+	/// 8 - Creates the work directory, and builds the inputs of the stages selected from the samples
+	string dataDir = fullPath(parser.getOperator(DATADIR));
+	string workDir = parser.getStrOpt(WORKDIR);
+	if (!makeDir(workDir)) {
+		log.severe("Cannot create work directory " + workDir);
+		return 2;
+	}
+	workDir = fullPath(workDir);
+	vector<string> keptNames;	//the names of the files in the work directory not to be removed: existing ones and stage inputs
+	vector<string> files = BatchRunner::getFileList(workDir);
+	for (vector<string>::iterator itf = files.begin(); itf != files.end(); itf++) keptNames.push_back(fileBaseName(*itf));
+	string binDir = parser.getStrOpt(BINDIR);
+	string selfPath = fullPath(argv[0]);
+	if (binDir.empty()) {
+		size_t sepPos = selfPath.find_last_of("/\\");
+		binDir = sepPos == string::npos? "." : selfPath.substr(0, sepPos);
+	}
+	binDir = fullPath(binDir);
+	long long sampleItems[NSAMPLES];
+	bool inputBuilt[NSAMPLES];
+	vector<string> inputNames;	//the names of the input files in the work directory
+	for (int i = 0; i < NSAMPLES; i++) {
+		inputBuilt[i] = false;
+		inputNames.push_back(INPUTPFX + fileBaseName(SAMPLES[i].path));
+		keptNames.push_back(inputNames.back());
+	}
+	for (vector<int>::iterator it = selStages.begin(); it != selStages.end(); it++) {
+		SampleId sid = STAGELIST[*it].input;
+		if (inputBuilt[sid]) continue;
+		aStr = dataDir + "/" + SAMPLES[sid].path;
+		if (((sampleItems[sid] = countItems(sid, aStr, &log)) < 0) || !buildInput(sid, aStr, workDir + "/" + inputNames[sid], scale, &log)) {
+			log.severe("Cannot build stage input from sample " + aStr);
+			return 2;
+		}
+		inputBuilt[sid] = true;
+	}
+	/// 9 - Runs each stage selected in its own process, reports its performance, and computes the digests of its outputs
+	vector<string> args;
+	vector<string> digestLines;
+	double seconds, peakMB, inputMB;
+	long long items;
+	int status, exitStatus = 0;
+	FILE* resultFile;
+	string outName, checkResult;
+	printf("%-12s %10s %12s %-8s %10s %12s %10s %12s  %s\n", "STAGE", "INPUT MB", "ITEMS", "UNIT", "SECONDS", "ITEMS/S", "MB/S", "PEAK RSS MB", "OUTPUT");
+	for (vector<int>::iterator it = selStages.begin(); it != selStages.end(); it++) {
+		const Stage &stage = STAGELIST[*it];
+		//remove outputs of previous stages
+		files = BatchRunner::getFileList(workDir);
+		for (vector<string>::iterator itf = files.begin(); itf != files.end(); itf++)
+			if (find(keptNames.begin(), keptNames.end(), fileBaseName(*itf)) == keptNames.end()) remove(itf->c_str());
+		//set the command line of the stage process
+		args.clear();
+		if (stage.command == NULL) {
+			args.push_back(selfPath);
+			args.push_back("-l");
+			args.push_back(parser.getStrOpt(LOGLEVEL));
+			args.push_back("-x");
+			args.push_back(stage.name);
+			args.push_back(inputNames[stage.input]);
+		} else {
+#ifdef _WIN32
+			args.push_back(binDir + "/" + stage.command + ".exe");
+#else
+			args.push_back(binDir + "/" + stage.command);
+#endif
+			tokens = getTokens(stage.args, ' ');
+			for (vector<string>::iterator itt = tokens.begin(); itt != tokens.end(); itt++)
+				args.push_back(itt->compare("{IN}") == 0? inputNames[stage.input] : *itt);
+		}
+		//run it and get its results
+		items = sampleItems[stage.input] * scale;
+		status = runProcess(args, workDir, seconds, peakMB);
+		if (stage.command == NULL) {
+			if ((resultFile = fopen((workDir + "/" + RESULTFILE).c_str(), "r")) == NULL) status = -1;
+			else {
+				if (fscanf(resultFile, "%lf %lld", &seconds, &items) != 2) status = -1;
+				if (items < 0) items = sampleItems[stage.input] * scale;
+				fclose(resultFile);
+				remove((workDir + "/" + RESULTFILE).c_str());
+			}
+		}
+		if (status != 0) {
+			log.severe(string("Stage ") + stage.name + " failed. Exit status: " + to_string((long long) status));
+			exitStatus = 3;
+		}
+		//compute the digests of its outputs, and check them if requested
+		checkResult = status != 0? "FAILED" : checkOutputs? "OK" : "-";
+		files = BatchRunner::getFileList(workDir);
+		int nOutputs = 0;
+		for (vector<string>::iterator itf = files.begin(); itf != files.end(); itf++) {
+			outName = fileBaseName(*itf);
+			if ((find(keptNames.begin(), keptNames.end(), outName) != keptNames.end()) || (outName.compare("LogFile.txt") == 0)) continue;
+			digest = fileDigest(*itf);
+			aStr = string(stage.name) + "/" + outName;
+			sprintf(lineBuffer, "%-60s %016llx", aStr.c_str(), digest);
+			digestLines.push_back(string(lineBuffer));
+			nOutputs++;
+			if (checkOutputs) {
+				map<string, unsigned long long>::iterator itd = checkDigests.find(aStr);
+				if ((itd == checkDigests.end()) || (itd->second != digest)) {
+					log.severe("Output " + aStr + (itd == checkDigests.end()? " not found in digests checked" : " is different"));
+					if (status == 0) checkResult = "DIFFERENT";
+				}
+				if (itd != checkDigests.end()) checkDigests.erase(itd);
+			}
+		}
+		if (checkOutputs)
+			for (map<string, unsigned long long>::iterator itd = checkDigests.begin(); itd != checkDigests.end(); itd++)
+				if (itd->first.compare(0, strlen(stage.name) + 1, string(stage.name) + "/") == 0) {
+					log.severe("Output " + itd->first + " not generated");
+					if (status == 0) checkResult = "DIFFERENT";
+				}
+		if ((checkResult.compare("DIFFERENT") == 0) && (exitStatus == 0)) exitStatus = 4;
+		//report the stage results
+		inputMB = fileSize(workDir + "/" + inputNames[stage.input]) / 1e6;
+		if (seconds <= 0.0) seconds = 1e-9;
+		sprintf(lineBuffer, "%-12s %10.2f %12lld %-8s %10.3f %12.0f %10.2f %12.1f  %d files %s",
+			stage.name, inputMB, items, SAMPLES[stage.input].unit, seconds, items / seconds, inputMB / seconds, peakMB, nOutputs, checkResult.c_str());
+		printf("%s\n", lineBuffer);
+		fflush(stdout);
+		log.info(lineBuffer);
+	}
+	/// 10 - Removes the outputs of the last stage
+	files = BatchRunner::getFileList(workDir);
+	for (vector<string>::iterator itf = files.begin(); itf != files.end(); itf++)
+		if (find(keptNames.begin(), keptNames.end(), fileBaseName(*itf)) == keptNames.end()) remove(itf->c_str());
+	/// 11 - Saves the digests of outputs, if requested
+	if (!parser.getStrOpt(SAVE).empty()) {
+		if ((digestFile = fopen(parser.getStrOpt(SAVE).c_str(), "w")) == NULL) {
+			log.severe("Cannot create digests file " + parser.getStrOpt(SAVE));
+			return 1;
+		}
+		fprintf(digestFile, "# scale %d\n", scale);
+		for (vector<string>::iterator itl = digestLines.begin(); itl != digestLines.end(); itl++) fprintf(digestFile, "%s\n", itl->c_str());
+		fclose(digestFile);
+	}
+	return exitStatus;
+}
+
+/**fullPath gives the absolute path of the given file or directory.
+ *
+ *@param path the file or directory path
+ *@return the absolute path, or the given one if it cannot be computed
+ */
+string fullPath(const string &path) {
+	string result = path;
+#ifdef _WIN32
+	char buffer[_MAX_PATH];
+	if (_fullpath(buffer, path.c_str(), _MAX_PATH) != NULL) result = string(buffer);
+#else
+	char* buffer = realpath(path.c_str(), NULL);
+	if (buffer != NULL) {
+		result = string(buffer);
+		free(buffer);
+	}
+#endif
+	return result;
+}
+
+/**fileBaseName gives the name of the given file without its directory.
+ *
+ *@param path the file path
+ *@return the file name
+ */
+string fileBaseName(const string &path) {
+	size_t sepPos = path.find_last_of("/\\");
+	return sepPos == string::npos? path : path.substr(sepPos + 1);
+}
+
+/**fileSize gives the size in bytes of the given file.
+ *
+ *@param fileName the file name
+ *@return the file size, or -1 if it cannot be accessed
+ */
+long long fileSize(const string &fileName) {
+#ifdef _WIN32
+	struct _stati64 fileStat;
+	if (_stati64(fileName.c_str(), &fileStat) != 0) return -1;
+#else
+	struct stat fileStat;
+	if (stat(fileName.c_str(), &fileStat) != 0) return -1;
+#endif
+	return (long long) fileStat.st_size;
+}
+
+/**makeDir creates the given directory, if it does not exist.
+ *
+ *@param dirName the directory name
+ *@return true if the directory exists or has been created, false otherwise
+ */
+bool makeDir(const string &dirName) {
+	struct stat fileStat;
+	if (stat(dirName.c_str(), &fileStat) == 0) return (fileStat.st_mode & S_IFMT) == S_IFDIR;
+#ifdef _WIN32
+	return _mkdir(dirName.c_str()) == 0;
+#else
+	return mkdir(dirName.c_str(), 0755) == 0;
+#endif
+}
+
+/**countItems counts the items (messages, lines, packets or epochs) contained in the given sample file.
+ *
+ *@param sid the sample identification
+ *@param fileName the sample file name
+ *@param plog point to the Logger
+ *@return the number of items, or -1 if the sample cannot be read
+ */
+long long countItems(SampleId sid, const string &fileName, Logger* plog) {
+	long long n = 0;
+	int c, prev = 0, status;
+	FILE* inFile;
+	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) return -1;
+	switch (sid) {
+	case OSPS: {
+		OSPMessage message;
+		while (message.fillFromBlock(inFile)) n++;
+		break;
+	}
+	case GP2S:
+		while ((c = getc(inFile)) != EOF) if (c == '\n') n++;
+		break;
+	case PKTS:	//packets start with the sequence A0 A2
+		while ((c = getc(inFile)) != EOF) {
+			if ((prev == 0xA0) && (c == 0xA2)) n++;
+			prev = c;
+		}
+		break;
+	default: {
+		RinexData rinex(RinexData::VTBD, plog);
+		try {
+			rinex.readRinexHeader(inFile);
+			if ((sid == OBS2S) || (sid == OBS3S)) {
+				while (rinex.readObsEpoch(inFile) != 0) n++;
+			} else {
+				while (((status = rinex.readNavEpoch(inFile)) != 0) && (status != 9)) n++;
+			}
+		} catch (string error) {
+			plog->severe(error);
+			n = -1;
+		}
+		break;
+	}
+	}
+	fclose(inFile);
+	return n;
+}
+
+/**buildInput builds a stage input replaying the given sample file. OSP, GP2 and packet files are concatenated the given
+ * number of times. For RINEX files the header is copied once, and the epochs are repeated the given number of times.
+ * If the input already exists having the size expected, it is not built again.
+ *
+ *@param sid the sample identification
+ *@param sampleName the sample file name
+ *@param inputName the stage input file name
+ *@param scale the number of times sample data are replayed
+ *@param plog point to the Logger
+ *@return true if the input exists or has been built, false otherwise
+ */
+bool buildInput(SampleId sid, const string &sampleName, const string &inputName, int scale, Logger* plog) {
+	FILE* sampleFile;
+	FILE* inputFile;
+	size_t headerLen = 0, n;
+	long long size = fileSize(sampleName);
+	if (size <= 0) return false;
+	//read the sample contents
+	vector<char> contents((size_t) size);
+	if ((sampleFile = fopen(sampleName.c_str(), "rb")) == NULL) return false;
+	n = fread(contents.data(), 1, contents.size(), sampleFile);
+	fclose(sampleFile);
+	if (n != contents.size()) return false;
+	//for RINEX files, the header ends with the END OF HEADER record
+	if (SAMPLES[sid].isRinex) {
+		const char* eohLabel = "END OF HEADER";
+		vector<char>::iterator it = search(contents.begin(), contents.end(), eohLabel, eohLabel + strlen(eohLabel));
+		if (it == contents.end()) return false;
+		it = find(it, contents.end(), '\n');
+		headerLen = it == contents.end()? contents.size() : (it - contents.begin()) + 1;
+	}
+	long long expected = (long long) headerLen + (long long) (contents.size() - headerLen) * scale;
+	if (fileSize(inputName) == expected) {
+		plog->info("Using stage input " + inputName);
+		return true;
+	}
+	if ((inputFile = fopen(inputName.c_str(), "wb")) == NULL) return false;
+	bool good = fwrite(contents.data(), 1, headerLen, inputFile) == headerLen;
+	for (int i = 0; good && (i < scale); i++)
+		good = fwrite(contents.data() + headerLen, 1, contents.size() - headerLen, inputFile) == contents.size() - headerLen;
+	if (fclose(inputFile) != 0) good = false;
+	if (good) plog->info("Built stage input " + inputName + " Bytes:" + to_string(expected));
+	return good;
+}
+
+/**runProcess runs the given command in the given working directory, waiting until it finishes.
+ *
+ *@param args the command to run (its path) and its arguments
+ *@param dir the working directory of the process
+ *@param seconds the elapsed time of the process
+ *@param peakMB the peak resident memory of the process in MB, or 0 if it is not known
+ *@return the exit status of the process, or -1 if it could not be run
+ */
+int runProcess(const vector<string> &args, const string &dir, double &seconds, double &peakMB) {
+	int status = -1;
+	seconds = peakMB = 0.0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+#ifdef _WIN32
+	string cmdLine;
+	for (vector<string>::const_iterator it = args.begin(); it != args.end(); it++) {
+		if (it != args.begin()) cmdLine += " ";
+		cmdLine += "\"" + *it + "\"";
+	}
+	STARTUPINFOA si;
+	PROCESS_INFORMATION pi;
+	PROCESS_MEMORY_COUNTERS pmc;
+	DWORD exitCode;
+	ZeroMemory(&si, sizeof si);
+	si.cb = sizeof si;
+	vector<char> cmdBuffer(cmdLine.begin(), cmdLine.end());
+	cmdBuffer.push_back(0);
+	if (!CreateProcessA(NULL, cmdBuffer.data(), NULL, NULL, FALSE, 0, NULL, dir.c_str(), &si, &pi)) return -1;
+	WaitForSingleObject(pi.hProcess, INFINITE);
+	if (GetExitCodeProcess(pi.hProcess, &exitCode)) status = (int) exitCode;
+	if (GetProcessMemoryInfo(pi.hProcess, &pmc, sizeof pmc)) peakMB = pmc.PeakWorkingSetSize / 1e6;
+	CloseHandle(pi.hProcess);
+	CloseHandle(pi.hThread);
+#else
+	vector<char*> argv;
+	for (vector<string>::const_iterator it = args.begin(); it != args.end(); it++) argv.push_back((char*) it->c_str());
+	argv.push_back(NULL);
+	fflush(stdout);
+	pid_t pid = fork();
+	if (pid < 0) return -1;
+	if (pid == 0) {		//the child process
+		if (chdir(dir.c_str()) == 0) execv(argv[0], argv.data());
+		_exit(127);
+	}
+	struct rusage usage;
+	int waitStatus;
+	if (wait4(pid, &waitStatus, 0, &usage) != pid) return -1;
+	if (WIFEXITED(waitStatus)) status = WEXITSTATUS(waitStatus);
+#ifdef __APPLE__
+	peakMB = usage.ru_maxrss / 1e6;		//in bytes
+#else
+	peakMB = usage.ru_maxrss / 1e3;		//in kilobytes
+#endif
+#endif
+	seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return status;
+}
+
+/**runInProcess runs the given in-process stage using the given input file, and writes in the RESULTFILE the time measured
+ * and the number of items processed. Outputs are written in the current directory.
+ *
+ *@param stage the stage name
+ *@param inputName the input file name
+ *@param plog point to the Logger
+ *@return the exit status: 0 if the stage has been run, 2 if the input cannot be opened, 3 if the stage failed
+ */
+int runInProcess(const string &stage, const string &inputName, Logger* plog) {
+	typedef chrono::steady_clock Clock;
+	long long items = 0;
+	double seconds = 0.0;
+	int status;
+	FILE* inFile;
+	FILE* outFile = NULL;
+	Clock::time_point start;
+	if ((inFile = openStream(inputName, false)) == NULL) {
+		plog->severe("Cannot open file " + inputName);
+		return 2;
+	}
+	try {
+		if (stage.compare("ospdecode") == 0) {
+			//acquire data as OSPtoRINEX does for GPS, GLONASS and SBAS, and get all epochs acquired
+			vector<string> observables = getTokens("C1C,L1C,D1C,S1C", ',');
+			vector<string> selSys = getTokens("G,R,S", ',');
+			RinexData rinex(RinexData::V302, plog);
+			for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++)
+				rinex.setHdLnData(RinexData::TOBS, it->at(0), observables);
+			rinex.setFilter(selSys, vector<string>());
+			start = Clock::now();
+			GNSSdataFromOSP gnssAcq("SiRF", 4, true, inFile, plog);
+			gnssAcq.acqAllData(rinex, false, false, true);
+			while (gnssAcq.getBufferedEpoch(rinex)) rinex.clearObsData();
+			seconds = chrono::duration<double>(Clock::now() - start).count();
+			items = -1;		//the number of messages is counted by the caller
+		} else if ((stage.compare("obsread2") == 0) || (stage.compare("obsread3") == 0)) {
+			RinexData rinex(RinexData::VTBD, plog);
+			start = Clock::now();
+			rinex.readRinexHeader(inFile);
+			rinex.mapInputFile(inFile);
+			while (rinex.readObsEpoch(inFile) != 0) items++;
+			seconds = chrono::duration<double>(Clock::now() - start).count();
+		} else if ((stage.compare("navread2") == 0) || (stage.compare("navread3") == 0)) {
+			RinexData rinex(RinexData::VTBD, plog);
+			start = Clock::now();
+			rinex.readRinexHeader(inFile);
+			while (((status = rinex.readNavEpoch(inFile)) != 0) && (status != 9)) items++;
+			seconds = chrono::duration<double>(Clock::now() - start).count();
+		} else if ((stage.compare("obsprint2") == 0) || (stage.compare("obsprint3") == 0)) {
+			//read and print epochs as RINEXtoRINEX does, measuring only the print time
+			RinexData rinex(RinexData::VTBD, plog);
+			rinex.readRinexHeader(inFile);
+			rinex.setHdLnData(RinexData::RUNBY, "RXBenchmark", "RXBenchmark");
+			if ((outFile = fopen("BNCH_OBS.TXT", "w")) == NULL) throw string("Cannot create output file");
+			rinex.printObsHeader(outFile);
+			rinex.clearHeaderData();
+			rinex.mapInputFile(inFile);
+			while ((status = rinex.readObsEpoch(inFile)) != 0) {
+				if ((status == 4) || (status == 8)) continue;
+				start = Clock::now();
+				rinex.printObsEpoch(outFile);
+				seconds += chrono::duration<double>(Clock::now() - start).count();
+				items++;
+				if (status != 1) rinex.clearHeaderData();
+			}
+		} else if ((stage.compare("navprint2") == 0) || (stage.compare("navprint3") == 0)) {
+			RinexData rinex(RinexData::VTBD, plog);
+			rinex.readRinexHeader(inFile);
+			rinex.setHdLnData(RinexData::RUNBY, "RXBenchmark", "RXBenchmark");
+			if ((outFile = fopen("BNCH_NAV.TXT", "w")) == NULL) throw string("Cannot create output file");
+			rinex.printNavHeader(outFile);
+			while (((status = rinex.readNavEpoch(inFile)) != 0) && (status != 9)) {
+				if (status != 1) continue;
+				start = Clock::now();
+				rinex.printNavEpoch(outFile);
+				seconds += chrono::duration<double>(Clock::now() - start).count();
+				items++;
+			}
+		} else throw "Unknown in-process stage " + stage;
+	} catch (string error) {
+		plog->severe(error);
+		if (outFile != NULL) fclose(outFile);
+		closeStream(inFile, inputName);
+		return 3;
+	}
+	if (outFile != NULL) fclose(outFile);
+	closeStream(inFile, inputName);
+	FILE* resultFile;
+	if ((resultFile = fopen(RESULTFILE.c_str(), "w")) == NULL) return 3;
+	fprintf(resultFile, "%.9f %lld\n", seconds, items);
+	fclose(resultFile);
+	return 0;
+}
+
+/**fileDigest computes a digest (64 bits FNV-1a hash) of the contents of the given file, excluding the lines containing
+ * the run date (see RUNDATELABELS).
+ *
+ *@param fileName the file name
+ *@return the digest computed, or 0 if the file cannot be read
+ */
+unsigned long long fileDigest(const string &fileName) {
+	unsigned long long hash = 14695981039346656037ULL;
+	char lineBuffer[4096];
+	bool excluded, lineStart = true;
+	size_t n, i;
+	FILE* inFile;
+	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) return 0;
+	excluded = false;
+	while (fgets(lineBuffer, sizeof lineBuffer, inFile) != NULL) {
+		n = strlen(lineBuffer);
+		//a line longer than the buffer is read in pieces: only its first piece is checked for labels
+		if (lineStart) {
+			excluded = false;
+			for (i = 0; i < sizeof RUNDATELABELS / sizeof RUNDATELABELS[0]; i++)
+				if (strstr(lineBuffer, RUNDATELABELS[i]) != NULL) excluded = true;
+		}
+		lineStart = (n > 0) && (lineBuffer[n - 1] == '\n');
+		if (excluded) continue;
+		for (i = 0; i < n; i++) {
+			hash ^= (unsigned char) lineBuffer[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+	fclose(inFile);
+	return hash;
+}
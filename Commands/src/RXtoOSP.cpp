@@ -13,8 +13,10 @@
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -i OBSINT or --interval=OBSINT : Observation interval (in seconds) for epoch data. Default value OBSINT = 5
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -p COMPORT or --port=COMPORT : Serial port name where receiver is connected. Default value COMPORT = COM35 (Win) or /dev/ttyUSB0 (Linux)
  *	- -s MID or --stop=MID : Stop epoch data acquisition when this MID (Message ID) arrives. Default value MID = 7
+ *	- -x or --index : Write the index file of the OSP binary output file. Default value INDEX=FALSE
  *
  *Copyright 2015 Francisco Cancillo
  *<p>
@@ -33,16 +35,26 @@
  *V2.0	|2/2016	|Improve logging
  *				|Add commands for SiRFV
  *V2.1	|2/2018	|Reviewed to run on Linux
+ *V2.2	|10/2026	|Added option to write the OSP index file during capture
+ *V2.3	|10/2026	|Serial port reading and file writing decoupled using a ring buffer and a writer thread
+ *				|Added option to dump performance counters at exit
  */
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "PerfCounters.h"
+#include "MsgRingBuffer.h"
+#include "OSPIndex.h"
 #include "Utilities.h"
 //from SerialTxRx
 #include "SerialTxRx.h"
 //standard
 #include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
 
 using namespace std;
 
@@ -56,11 +68,16 @@ using namespace std;
 
 ///The command line format
 const string CMDLINE = "OSPDataLogger.exe {options}";
-const string MYVER = " V2.1";
+const string MYVER = " V2.3";
+///The number of message slots in the ring buffer between the serial reader and the file writer
+#define RINGSLOTS 512
+///The size of the output file stream buffer, and the time in milliseconds the writer waits when the ring is empty
+#define OUTFILEBUF 65536
+#define WRITERWAIT 10
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int BAUD, DURATION, BFILE, G50BPS, HELP, EPHEM, OBSINT, LOGLEVEL, COMPORT, MID, PAT;
+int BAUD, DURATION, BFILE, G50BPS, HELP, EPHEM, INDEX, OBSINT, LOGLEVEL, PERFOUT, COMPORT, MID, PAT;
 
 struct MSGwrite {
 	int msgId;
@@ -78,7 +95,8 @@ struct MSGwrite {
 vector <MSGwrite> lstWmsg;
 //@endcond 
 //functions in this file
-int acquireBin(SerialTxRx, FILE*, int, int, int, Logger*);
+int acquireBin(SerialTxRx&, FILE*, OSPIndex*, int, int, int, Logger*);
+void writeBin(MsgRingBuffer&, FILE*, OSPIndex*, atomic<bool>&, Logger*);
 
 /**main
  * gets the command line arguments, set parameters accordingly and triggers the data acquisition from the receiver.
@@ -126,6 +144,7 @@ int main(int argc, char** argv) {
 	MID = parser.addOption("-s", "--stop", "MID", "Stop epoch data acquisition when this MID (Message ID) arrives", "7");
 	COMPORT = parser.addOption("-p", "--port", "COMPORT", "Serial port name where receiver is connected", COMDEF);
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	OBSINT = parser.addOption("-i", "--interval", "OBSINT", "Observation interval (in seconds) for epoch data", "5");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
 	G50BPS = parser.addOption("-g", "--G50bps", "G50BPS", "Request 50bps nav messages (MID8)", false);
@@ -134,6 +153,7 @@ int main(int argc, char** argv) {
 	DURATION = parser.addOption("-d", "--duration", "DURATION", "Duration of acquisition period, in minutes", "5");
 	BAUD = parser.addOption("-b", "--baud", "BAUD", "Set serial port baud rate", "57600");
 	PAT = parser.addOption("-a", "--patience", "PAT", "Maximum number of bytes to read when waiting for a packet start", "500");
+	INDEX = parser.addOption("-x", "--index", "INDEX", "Write the index file of the OSP binary output file", false);
 	/// 3- Parses arguments in the command line extracting options and operators
 	try {
 		parser.parseArgs(argc, argv);
@@ -147,8 +167,10 @@ int main(int argc, char** argv) {
 		parser.usage("captures OSP message data from a SiRF IV receiver and stores them in a OSP binary file", CMDLINE);
 		return 0;
 	}
-	/// 4- Sets logging level stated in option
+	/// 4- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
 	/// 5- Computes observation interval and number of epochs to read from data given in options
 	int obsIntl = stoi(parser.getStrOpt(OBSINT));
 	int nEpochs = stoi(parser.getStrOpt(DURATION)) * 60 / obsIntl;
@@ -218,9 +240,12 @@ int main(int argc, char** argv) {
 		log.severe("Cannot create the binary output file " + string(fileName));
 		return 5;
 	}
-	/// 9- Calls acquireBin to acquire and record data form receiver
-	int n = acquireBin(port, outFile, nEpochs * 20, nEpochs, patience, &log);
+	/// 9- Calls acquireBin to acquire and record data form receiver, and the index of messages recorded if requested
+	OSPIndex ospIdx;
+	int n = acquireBin(port, outFile, parser.getBoolOpt(INDEX)? &ospIdx : NULL, nEpochs * 20, nEpochs, patience, &log);
 	fclose(outFile);
+	if (parser.getBoolOpt(INDEX) && !ospIdx.save(OSPIndex::indexFileName(parser.getStrOpt(BFILE))))
+		log.severe("Cannot create the index file for " + parser.getStrOpt(BFILE));
 	port.closePort();
 	return n;
 }
@@ -231,9 +256,13 @@ int main(int argc, char** argv) {
  * - the maximum number of epoch is reached, or
  * - an unrecoverable error happens reading data from receiver
  * - a write error happens
+ *<p>Reading and writing are decoupled: this thread only drains the serial port and stores messages read in a ring buffer
+ * of RINGSLOTS slots, and a writer thread (see writeBin) takes them from the ring, writes them to the OSP file and logs them.
+ * It avoids losing receiver data when writes to the output file stall. If the ring is full, messages read are dropped.
  * 
  *@param  port the SerialTxRx object used to communicate with the receiver
  *@param  outFile the binary output file to record the messages received from receiver
+ *@param  pIdx the index where messages recorded are added, or NULL if no index is requested
  *@param maxMsgs the maximum number of messages to be recorded
  *@param maxEpochs the maximum number of epochs to be recorded
  *@param patience the maximum number of erroneous contiguous bytes to read before returning a read error
@@ -243,66 +272,116 @@ int main(int argc, char** argv) {
  *		- (6) error has occurred when writing data read from receiver
  *		- (7) error reading data from receiver: patience exahusted or EOF
  */
-int acquireBin(SerialTxRx port, FILE *outFile, int maxMsgs, int maxEpochs, int patience, Logger* plog) {
+int acquireBin(SerialTxRx &port, FILE *outFile, OSPIndex* pIdx, int maxMsgs, int maxEpochs, int patience, Logger* plog) {
 	/**The acquireBin process sequence follows:*/
-	string txtToLog;
 	int lastMsgMID = stoi(parser.getStrOpt(MID));
 	/// 1- Sets counters
 	int nMsgs = 0;
-	int nErrors = 0;
 	int nEpochs = 0;
 	int readResult = 0;
-	/// 2- Reads messages from the input stream until counts exhausted or unrecoverable error happen 
+	int status = 0;
+	MsgRingBuffer::Slot* slot;
+	/// 2- Sets up the ring buffer and launches the writer thread
+	MsgRingBuffer ring(RINGSLOTS, MAXBUFFERSIZE);
+	atomic<bool> writeError(false);
+	setvbuf(outFile, NULL, _IOFBF, OUTFILEBUF);
+	thread writer(writeBin, ref(ring), outFile, pIdx, ref(writeError), plog);
+	/// 3- Reads messages from the input stream until counts exhausted or unrecoverable error happen
 	while ((nMsgs < maxMsgs) && (nEpochs < maxEpochs)) {
+		if (writeError.load()) {
+			status = 6;
+			break;
+		}
 		readResult = port.readOSPmsg(patience);
-		/// - Log message read using format OSP<MID,length> Result
-		txtToLog = "R OSP<"
-			+ to_string((long long) ((int) port.payBuff[0])) 
-			+ ":" + to_string((long long) ((int) port.payloadLen)) + "> ";
-		switch (readResult) {
-		case 0:	//message is correct
-			txtToLog += "OK";
-			/// - Update counters and write message to OSP file
+		if (readResult == 6) {
+			plog->warning("Error reading. Patience exahusted or EOF");
+			status = 7;
+			break;
+		}
+		if (readResult == 0) {
 			nMsgs++;
 			if (port.payBuff[0] == lastMsgMID) nEpochs++;
-			if ((fwrite(port.paylenBuff, 1, 2, outFile) != 2) ||
-				(fwrite(port.payBuff, 1, port.payloadLen, outFile) != port.payloadLen)) {
-				plog->severe(txtToLog + ". Write error");
-				plog->info("nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
-				return 6;
+		}
+		/// - Stores the message read in the ring: payload for correct messages, and only the MID for erroneous ones
+		if ((slot = ring.getFree()) == NULL) continue;	//ring full: the message is dropped
+		slot->status = readResult;
+		slot->length = port.payloadLen;
+		memcpy(slot->data, port.payBuff, readResult == 0? port.payloadLen : 1);
+		ring.push();
+	}
+	/// 4- Waits for the writer to record messages pending in the ring
+	ring.close();
+	writer.join();
+	if (writeError.load()) status = 6;
+	plog->info("Ring buffer high-water mark:" + to_string((long long) ring.getHighWater()) + " of " + to_string((long long) ring.getSize())
+		+ " slots. Messages dropped:" + to_string((long long) ring.getDropped()));
+	plog->info((status == 0? "Acq End; nMsgs:" : "nMsgs:") + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
+	return status;
+}
+
+/**writeBin
+ * is the body of the writer thread started by acquireBin: it takes messages from the ring buffer, records the correct ones
+ * in the binary OSP file (and its index if requested), and logs the result of each message read.
+ * Messages stored in the output file stream buffer are written to disk in batches when the buffer is full.
+ * When the ring is empty it waits a while before checking again, and finishes when the ring is closed and empty,
+ * or when a write error happens.
+ *
+ *@param ring the ring buffer where acquireBin stores messages read
+ *@param outFile the binary output file to record the messages
+ *@param pIdx the index where messages recorded are added, or NULL if no index is requested
+ *@param writeError is set to true when a write error happens
+ *@param plog the pinter to the Logger
+ */
+void writeBin(MsgRingBuffer &ring, FILE *outFile, OSPIndex* pIdx, atomic<bool> &writeError, Logger* plog) {
+///a macro to build the text tagging messages logged using format OSP<MID,length>. It is built only when needed
+#define MSG_TAG ("R OSP<" + to_string((long long) ((int) slot->data[0])) + ":" + to_string((long long) ((int) slot->length)) + "> ")
+	MsgRingBuffer::Slot* slot;
+	unsigned char paylenBuff[2];
+	bool closed;
+	for (;;) {
+		closed = ring.isClosed();
+		if ((slot = ring.getFilled()) == NULL) {
+			if (closed) break;
+			this_thread::sleep_for(chrono::milliseconds(WRITERWAIT));
+			continue;
+		}
+		switch (slot->status) {
+		case 0:	//message is correct
+			paylenBuff[0] = (unsigned char) (slot->length >> 8);	//numbers in OSP msg are big endians
+			paylenBuff[1] = (unsigned char) (slot->length & 0xFF);
+			if ((fwrite(paylenBuff, 1, 2, outFile) != 2) ||
+				(fwrite(slot->data, 1, slot->length, outFile) != slot->length)) {
+				plog->severe(MSG_TAG + "OK. Write error");
+				writeError.store(true);
+				return;
 			}
-			plog->finest(txtToLog);
+			if (pIdx != NULL) pIdx->addMessage(slot->data, slot->length);
+			LOG_FINEST(plog, MSG_TAG + "OK");
 			break;
 		case 1:
-			plog->warning(txtToLog + "Error in checksum");
-			nErrors++;
+			plog->warning(MSG_TAG + "Error in checksum");
 			break;
 		case 2:
-			plog->warning(txtToLog + "Error reading payload or shorter than expected");
-			nErrors++;
+			plog->warning(MSG_TAG + "Error reading payload or shorter than expected");
 			break;
 		case 3:
-			plog->warning(txtToLog + "Error. Length out of margin");
-			nErrors++;
+			plog->warning(MSG_TAG + "Error. Length out of margin");
 			break;
 		case 4:
-			plog->warning(txtToLog + "Error reading payload length");
-			nErrors++;
+			plog->warning(MSG_TAG + "Error reading payload length");
 			break;
 		case 5:
-			plog->warning(txtToLog + "Error reading payload");
-			nErrors++;
+			plog->warning(MSG_TAG + "Error reading payload");
 			break;
-		case 6:
-			plog->warning("Error reading. Patience exahusted or EOF");
-			plog->info("nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
-			return 7;
 		default:
-			plog->severe(txtToLog + "");
-			nErrors++;
+			plog->severe(MSG_TAG);
 			break;
 		}
+		ring.pop();
+	}
+	if (fflush(outFile) != 0) {
+		plog->severe("Write error flushing the binary output file");
+		writeError.store(true);
 	}
-	plog->info("Acq End; nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
-	return 0;
+#undef MSG_TAG
 }
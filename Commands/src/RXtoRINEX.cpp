@@ -0,0 +1,539 @@
+/** @file RXtoRINEX.cpp
+ * Contains the command line program to generate in real time RINEX files from OSP messages received from a SiRF IV receiver,
+ * or appended to a growing OSP data file.
+ *<p>Usage:
+ *<p>RXtoRINEX.exe {options} [OSPfilename]
+ *<p>Options are:
+ *	- -a or --aend : Append end-of-file comment lines to Rinex file. Default value FALSE
+ *	- -b or --bias : Apply receiver clock bias to measurements and time. Default value TRUE
+ *	- -c or --glo50bps : Use MID8 GLONASS 50bps data to generate GLONASS navigation file, instead of MID70. Default value FALSE
+ *	- -d or --gps50bps : Use MID8 GPS 50bps data to generate nav file, instead of MID15. Default value FALSE
+ *	- -e HDEPOCHS or --hdepochs=HDEPOCHS : Maximum number of epochs to wait for header data before printing the RINEX header. Default value HDEPOCHS = 10
+ *	- -g PORT or --port=PORT : Serial port name where the receiver is connected. Default value: none (OSP file is followed)
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -i MINSV or --minsv=MINSV : Minimun satellites in a fix to acquire observations. Default value MINSV = 4
+ *	- -j ANTN or --antnum=ANTN : Receiver antenna number. Default value ANTN = Antenna#
+ *	- -k ANTT or --antype=ANTT : Receiver antenna type. Default value ANTT = AntennaType
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
+ *	- -m MRKNAM or --mrkname=MRKNAM : Marker name. Default value MRKNAM = MRKNAM
+ *	- -n or --nav : Generate RINEX navigation file. When only one file is generated, ephemeris no longer broadcast are printed while acquiring, and the rest when the acquisition ends. Default value FALSE
+ *	- -o OBSERVER or --observer=OBSERVER : Observer name. Default value OBSERVER = OBSERVER
+ *	- -p PGM or --program=PGM : Program used to generate RINEX file. Default value RXtoRINEX
+ *	- -q RUNBY or --runby=RUNBY : Who runs the RINEX file generator. Default value RUNBY = RUNBY
+ *	- -r RINEX or --rinex=RINEX : RINEX file name prefix. Default value RINEX = PNT1
+ *	- -s SYSLST or --selsys=SYSLST : List of additional systems to GPS (R or S or R,S) to be included in the RINEX files. Default value an empty list
+ *	- -t ROTATE or --rotate=ROTATE : Period (in minutes) to close the RINEX observation file and start a new one. Default value ROTATE = 0 (no rotation)
+ *	- -u MRKNUM or --mrknum=MRKNUM : Marker number. Default value MRKNUM = MRKNUM
+ *	- -v VER or --ver=VER : RINEX version to generate (V210, V302). Default value VER = V210
+ *	- -w WAIT or --wait=WAIT : Time (in seconds) without receiving messages to end the acquisition. Default value WAIT = 60
+ *	- -y AGENCY or --agency=AGENCY : Agency name. Default value AGENCY = AGENCY
+ *	- -z BAUD or --baud=BAUD : Serial port baud rate. Default value BAUD = 57600
+ *Default value for operator is: DATA.OSP
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ *		|		|Added option to dump performance counters at exit
+ *		|		|Navigation data no longer broadcast are printed while acquisition proceeds
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "PerfCounters.h"
+#include "Utilities.h"
+#include "GNSSdataFromOSP.h"
+#include "RinexData.h"
+//from SerialTxRx
+#include "SerialTxRx.h"
+//standard
+#include <stdio.h>
+#include <math.h>
+#include <signal.h>
+#include <map>
+#include <thread>
+#include <chrono>
+
+using namespace std;
+
+//@cond DUMMY
+///Compilation date to identify program full version
+const string COMPDATE = __DATE__;
+///Program name
+const string THISPRG = "RXtoRINEX";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options} [OSPfilename]";
+///Current program version
+const string MYVER = " V1.0 ";
+///A common message
+const string FILENOK = "Cannot open or create file ";
+///The time (in seconds) after their time tag when ephemeris are no longer broadcast, and can be printed in continuous mode
+const double NAVDELAY = 4 * 60 * 60;
+///The receiver name
+const string RECEIVER_NAME = "SiRF";
+///Time in milliseconds to wait for new data appended to the followed OSP file, and timeout in tenths of second for port reads
+#define FOLLOWWAIT 200
+#define PORTTIMEOUT 10
+//Metavariables for options
+int AGENCY, APPEND, ANTN, ANTT, APBIAS, BAUD, HDEPOCHS, MID8G, MID8R, HELP, LOGLEVEL, PERFOUT, NAVI, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, PORT, RINEX, ROTATE, RUNBY, SELSYS, VER, WAIT;
+//Metavariables for operators
+int OSPF;
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+
+///The source of OSP messages: a serial port where the receiver is connected, or a growing OSP file
+struct MsgSource {
+	SerialTxRx* port;		//the port, or NULL if messages are read from a file
+	FILE* file;				//the OSP file followed
+	unsigned char buffer[MAXPAYLOADSIZE];	//the payload of the message read from the file
+	const unsigned char* payload;	//the payload of the last message read
+	unsigned int length;	//its length
+};
+//functions in this file
+bool nextMessage(MsgSource &, int, Logger*);
+bool openObsFile(RinexData &, FILE* &, double &, map<long long, int> &, Logger*);
+void printEpoch(RinexData &, FILE*, double &, map<long long, int> &);
+bool closeObsFile(RinexData &, FILE* &, const map<long long, int> &, bool, Logger*);
+FILE* createNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
+void prinfNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
+
+///Set by the signal handler when the process shall end
+volatile sig_atomic_t stopRequested = 0;
+void onSignal(int) {
+	stopRequested = 1;
+}
+//@endcond
+
+/**main
+ * gets the command line arguments, sets parameters accordingly and generates RINEX files while OSP messages are being received.
+ *<p>Messages are read from the serial port where the receiver is connected (the receiver shall be sending OSP messages, see
+ * SynchroRX and RXtoOSP), or from an OSP binary file which is being written by other process (i.e. RXtoOSP). In this case the
+ * file is followed: when its end is reached, the command waits for new messages appended to it.
+ *<p>Each message is passed to the streaming acquisition of GNSSdataFromOSP as soon as it is received:
+ * - header data are acquired from the first messages. The RINEX header is printed when all header data have been acquired,
+ *	or after the number of epochs stated in the HDEPOCHS option. Records not acquired are printed with provisional data
+ * - each epoch is printed (and flushed) as soon as its MID7 message arrives
+ * - when the observation file is closed (at the end, or when it is rotated), records INTERVAL and TIME OF LAST OBS of its header
+ *	are updated in place with their final values
+ * - when a navigation file is requested and only one is printed (V3.02, or V2.10 for GPS only), it is created after NAVDELAY
+ *	from the first epoch, and the ephemeris older than NAVDELAY are printed and removed from storage after each epoch
+ *<p>The acquisition ends when no messages are received during the time stated in the WAIT option, or when SIGINT / SIGTERM are received.
+ * Then, if requested, navigation files are printed with the navigation data acquired (the rest of them, if already created).
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when opening the input file or the serial port
+ *		- (3) error when creating output files or no epoch data exist
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + COMPDATE + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	BAUD = parser.addOption("-z", "--baud", "BAUD", "Serial port baud rate", "57600");
+	AGENCY = parser.addOption("-y", "--agency", "AGENCY", "Agency name", "AGENCY");
+	WAIT = parser.addOption("-w", "--wait", "WAIT", "Time (in seconds) without receiving messages to end the acquisition", "60");
+	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V302)", "V210");
+	MRKNUM = parser.addOption("-u", "--mrknum", "MRKNUM", "Marker number", "MRKNUM");
+	ROTATE = parser.addOption("-t", "--rotate", "ROTATE", "Period (in minutes) to start a new RINEX observation file (0 = no rotation)", "0");
+	SELSYS = parser.addOption("-s", "--selsys", "SELSYS", "Systems from input in addition to GPS (R,S or R or S)", "");
+	RINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "PNT1");
+	RUNBY = parser.addOption("-q", "--runby", "RUNBY", "Who runs the RINEX file generation", "RUNBY");
+	PGM = parser.addOption("-p", "--program", "PGM", "Program used to generate RINEX file", (char *) (THISPRG+MYVER).c_str());
+	OBSERVER = parser.addOption("-o", "--observer", "OBSERVER", "Observer name", "OBSERVER");
+	NAVI = parser.addOption("-n", "--nRINEX", "NAVI", "Generate RINEX navigation file when the acquisition ends", false);
+	MRKNAM = parser.addOption("-m", "--mrkname", "MRKNAM", "Marker name", "MRKNAM");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
+	ANTT = parser.addOption("-k", "--antype", "ANTT", "Receiver antenna type", "AntennaType");
+	ANTN = parser.addOption("-j", "--antnum", "ANTN", "Receiver antenna number", "Antenna#");
+	MINSV = parser.addOption("-i", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	PORT = parser.addOption("-g", "--port", "PORT", "Serial port name where the receiver is connected (none to follow the OSP file)", "");
+	HDEPOCHS = parser.addOption("-e", "--hdepochs", "HDEPOCHS", "Maximum number of epochs to wait for header data before printing it", "10");
+	MID8G = parser.addOption("-d", "--gps50bps", "MID8G", "Use MID8 GPS 50bps data to generate nav file", false);
+	MID8R = parser.addOption("-c", "--glo50bps", "MID8R", "Use MID8 GLONASS 50bps data to generate nav file", false);
+	APBIAS = parser.addOption("-b", "--bias", "APBIAS", "Apply receiver clock bias to measurements (and time)", true);
+	APPEND = parser.addOption("-a", "--aend", "APPEND", "Append end-of-file comment lines to Rinex file", false);
+	/// 3- Setups the default values for operators in the command line
+	OSPF = parser.addOperator("DATA.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Generates in real time RINEX files from OSP messages received from a SiRF IV receiver or appended to an OSP file", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
+	/// 6- Opens the source of messages: the serial port, or the OSP file to follow
+	MsgSource source;
+	SerialTxRx port;
+	source.port = NULL;
+	source.file = NULL;
+	if (!parser.getStrOpt(PORT).empty()) {
+		try {
+			port.openPort(parser.getStrOpt(PORT));
+			port.setPortParams(stoi(parser.getStrOpt(BAUD)), PORTTIMEOUT);
+		} catch (string error) {
+			log.severe(error);
+			return 2;
+		}
+		source.port = &port;
+		log.info("Reading OSP messages from port " + parser.getStrOpt(PORT));
+	} else {
+		if ((source.file = fopen(parser.getOperator(OSPF).c_str(), "rb")) == NULL) {
+			log.severe(FILENOK + parser.getOperator(OSPF));
+			return 2;
+		}
+		log.info("Following OSP file " + parser.getOperator(OSPF));
+	}
+	/// 7- Setups the RinexData object members with data given in command line options
+	vector<string> selSys;	//the selected systems
+	vector<string> selObs;	//the empty selected observations
+	vector<string> observables = getTokens("C1C,L1C,D1C,S1C", ',');	//the defined observables in OSP
+	bool glonassSel = false;		//if GLONASS data (observation or navigation) are requested or not
+	string aStr = parser.getStrOpt(SELSYS);
+	if (aStr.empty()) aStr = "G";
+	else aStr = "G," + aStr;
+	selSys = getTokens(aStr, ',');
+	aStr = parser.getStrOpt(VER);
+	RinexData::RINEXversion rinexVer = RinexData::V210;		//default version is 2.10
+	if (aStr.compare("V302") == 0) rinexVer = RinexData::V302;
+	RinexData rinex(rinexVer, &log);
+	try {
+		rinex.setHdLnData(RinexData::RUNBY, parser.getStrOpt(PGM), parser.getStrOpt(RUNBY));
+		rinex.setHdLnData(RinexData::MRKNAME, parser.getStrOpt(MRKNAM));
+		rinex.setHdLnData(RinexData::MRKNUMBER, parser.getStrOpt(MRKNUM));
+		rinex.setHdLnData(RinexData::ANTTYPE, parser.getStrOpt(ANTN), parser.getStrOpt(ANTT));
+		rinex.setHdLnData(RinexData::ANTHEN, (double) 0.0, (double) 0.0, (double) 0.0);
+		rinex.setHdLnData(RinexData::AGENCY, parser.getStrOpt(OBSERVER), parser.getStrOpt(AGENCY));
+		rinex.setHdLnData(RinexData::TOFO, string("GPS"));
+		rinex.setHdLnData(RinexData::WVLEN, (int) 1, (int) 0);
+		for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) {
+			rinex.setHdLnData(RinexData::TOBS, it->at(0), observables);
+			if (it->at(0) == 'R') glonassSel = true;
+		}
+		if (!rinex.setFilter(selSys, selObs)) log.warning("Error in selected systems. Erroneous data ignored");
+	} catch (string error) {
+			log.severe(error);
+	}
+	/// 8- Acquires messages from the source as they are received, and prints epochs as they are completed
+	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), source.file, &log);
+	bool useMID8G = parser.getBoolOpt(MID8G);
+	bool useMID8R = parser.getBoolOpt(MID8R);
+	int hdEpochs = stoi(parser.getStrOpt(HDEPOCHS));
+	int waitTime = stoi(parser.getStrOpt(WAIT));
+	double rotatePeriod = stoi(parser.getStrOpt(ROTATE)) * 60.0;
+	double fileStart = 0.0;		//the time of the first epoch in the current observation file
+	double lastEpoch = -1.0;	//the time of the last epoch printed in the current observation file
+	map<long long, int> spacings;	//for each time (in ms) between consecutive epochs printed in the current observation file, its count
+	int week, eFlag, nBuffered = 0;
+	double tow, bias;
+	int epochCount = 0;
+	int status = 0;
+	FILE* obsFile = NULL;
+	//in V2.10 each system has its own navigation file: to print them the filter is changed, which cannot be done while acquiring
+	bool flushNav = parser.getBoolOpt(NAVI) && ((rinexVer == RinexData::V302) || (selSys.size() == 1));
+	char navSys = rinexVer == RinexData::V302? 'M' : selSys.front().at(0);
+	double firstEpoch = -1.0;	//the time of the first epoch printed
+	double epochTime;
+	FILE* navFile = NULL;
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	gnssAcq.startStreamAcq(glonassSel);
+	try {
+		while (!stopRequested && (status == 0) && nextMessage(source, waitTime, &log)) {
+			if (!gnssAcq.acqStreamData(source.payload, source.length, rinex, useMID8G, useMID8R)) continue;
+			/// - While the header is not printed, epochs remain buffered until header data are acquired or HDEPOCHS are buffered
+			if ((obsFile == NULL) && !gnssAcq.streamHeaderAcq() && (++nBuffered < hdEpochs)) continue;
+			while (gnssAcq.getBufferedEpoch(rinex)) {
+				/// - Rotates the observation file when its period has elapsed, and creates it when needed
+				rinex.getEpochTime(week, tow, bias, eFlag);
+				if ((obsFile != NULL) && (rotatePeriod > 0.0) && (getSecsGPSEphe(week, tow) - fileStart >= rotatePeriod)) {
+					if (!closeObsFile(rinex, obsFile, spacings, false, &log)) status = 3;
+				}
+				if (obsFile == NULL) {
+					if (!openObsFile(rinex, obsFile, lastEpoch, spacings, &log)) {
+						status = 3;
+						break;
+					}
+					fileStart = getSecsGPSEphe(week, tow);
+				}
+				printEpoch(rinex, obsFile, lastEpoch, spacings);
+				fflush(obsFile);
+				epochCount++;
+				/// - Prints the navigation data no longer broadcast, creating the navigation file when NAVDELAY has elapsed
+				if (!flushNav) continue;
+				epochTime = getSecsGPSEphe(week, tow);
+				if (firstEpoch < 0.0) firstEpoch = epochTime;
+				if ((navFile == NULL) && (epochTime - firstEpoch >= NAVDELAY)) {
+					if ((navFile = createNavFile(rinex, rinexVer, navSys, &log)) == NULL) {
+						flushNav = false;
+						continue;
+					}
+					try {
+						rinex.printNavHeader(navFile);
+					} catch (string error) {
+						log.severe(error);
+						fclose(navFile);
+						navFile = NULL;
+						flushNav = false;
+					}
+				}
+				if (flushNav) {
+					rinex.printNavEpoch(navFile, epochTime - NAVDELAY);
+					fflush(navFile);
+				}
+			}
+		}
+	} catch (string error) {
+		log.severe(error);
+		status = 3;
+	}
+	if (stopRequested) log.info("Stop requested");
+	/// 9- Prints epochs still buffered, if any, and closes the observation file updating its header
+	try {
+		if ((obsFile == NULL) && (status == 0)) {
+			while (gnssAcq.getBufferedEpoch(rinex)) {
+				if ((obsFile == NULL) && !openObsFile(rinex, obsFile, lastEpoch, spacings, &log)) {
+					status = 3;
+					break;
+				}
+				printEpoch(rinex, obsFile, lastEpoch, spacings);
+				epochCount++;
+			}
+		}
+		if ((obsFile != NULL) && !closeObsFile(rinex, obsFile, spacings, parser.getBoolOpt(APPEND), &log)) status = 3;
+	} catch (string error) {
+		log.severe(error);
+		status = 3;
+	}
+	if (!gnssAcq.endStreamAcq(rinex)) log.warning("All, or some header data not acquired");
+	if (source.port != NULL) port.closePort();
+	else fclose(source.file);
+	/// 10- If navigation RINEX file requested, prints it for each system selected
+	if (navFile != NULL) {
+		try {
+			rinex.printNavEpoch(navFile);
+		} catch (string error) {
+			log.severe(error);
+		}
+		fclose(navFile);
+	} else if (parser.getBoolOpt(NAVI)) {
+		if (rinexVer == RinexData::V302) prinfNavFile(rinex, rinexVer, 'M', &log);
+		else for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) prinfNavFile(rinex, rinexVer, it->at(0), &log);
+	}
+	log.info("End of RINEX generation. Epochs printed: " + to_string((long long) epochCount));
+	if ((status == 0) && (epochCount == 0)) status = 3;
+	return status;
+}
+
+/**nextMessage gets the next OSP message from the source. When no message is available, waits for it.
+ *<p>From a serial port, messages with errors are skipped. From a file, when its end is reached (or only part of the next
+ * message is in it) the file position is kept, and new data appended to it are waited for.
+ *
+ *@param source the source of messages. The message payload and length are set in it
+ *@param waitTime the maximum time in seconds to wait for a message
+ *@param plog point to the Logger
+ *@return true if a message has been got, false otherwise (wait time elapsed, stop requested or read error)
+ */
+bool nextMessage(MsgSource &source, int waitTime, Logger* plog) {
+	chrono::steady_clock::time_point limit = chrono::steady_clock::now() + chrono::seconds(waitTime);
+	unsigned char paylenBuff[2];
+	long pos;
+	int result;
+	while (!stopRequested) {
+		if (source.port != NULL) {
+			if ((result = source.port->readOSPmsg()) == 0) {
+				source.payload = source.port->payBuff;
+				source.length = source.port->payloadLen;
+				return true;
+			}
+			if (result != 6) LOG_FINE(plog, "R OSP message error " + to_string((long long) result));
+		} else {
+			pos = ftell(source.file);
+			if (fread(paylenBuff, 1, 2, source.file) == 2) {
+				source.length = (paylenBuff[0] << 8) | paylenBuff[1];	//numbers in msg are big endians
+				if (source.length > MAXPAYLOADSIZE) {
+					plog->severe("OSP message length out of margin in the input file");
+					return false;
+				}
+				if (fread(source.buffer, 1, source.length, source.file) == source.length) {
+					source.payload = source.buffer;
+					return true;
+				}
+			}
+			//end of file reached: wait for new data from the same position
+			if (ferror(source.file) || (fseek(source.file, pos, SEEK_SET) != 0)) {
+				plog->severe("Error reading the input file");
+				return false;
+			}
+			clearerr(source.file);
+			this_thread::sleep_for(chrono::milliseconds(FOLLOWWAIT));
+		}
+		if (chrono::steady_clock::now() >= limit) {
+			plog->info("No messages received in " + to_string((long long) waitTime) + " seconds");
+			return false;
+		}
+	}
+	return false;
+}
+
+/**openObsFile creates the RINEX observation file with the standard name for the current epoch, and prints its header.
+ * The current epoch is stated as first and last observation time, and a provisional interval is set if it is not known.
+ *
+ *@param rinex the RinexData object with header data and the current epoch
+ *@param obsFile the file created
+ *@param lastEpoch the time of the last epoch printed in the file, reset to none
+ *@param spacings the counts of times between consecutive epochs printed in the file, cleared
+ *@param plog point to the Logger
+ *@return true if the file has been created, false otherwise
+ */
+bool openObsFile(RinexData &rinex, FILE* &obsFile, double &lastEpoch, map<long long, int> &spacings, Logger* plog) {
+	double aDouble;
+	lastEpoch = -1.0;
+	spacings.clear();
+	//epoch times from the receiver are GPS ones. The time system is stated, as the file system is not known before printing the first header
+	rinex.setHdLnData(RinexData::TOFO, string("GPS"));
+	rinex.setHdLnData(RinexData::TOLO);
+	//the name is set before the provisional interval, to state in it the data frequency only when known
+	string outFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
+	//a provisional interval is printed to be updated when the file is closed
+	if (!rinex.getHdLnData(RinexData::INT, aDouble)) rinex.setHdLnData(RinexData::INT, 0.0);
+	if ((obsFile = fopen(outFileName.c_str(), "w+")) == NULL) {
+		plog->severe(FILENOK + outFileName);
+		return false;
+	}
+	rinex.printObsHeader(obsFile);
+	plog->info("Printing RINEX observation file " + outFileName);
+	return true;
+}
+
+/**printEpoch prints the current epoch in the observation file, stating it as the last observation time, and counts the time
+ * elapsed (rounded to milliseconds) from the previous epoch printed in the file.
+ *
+ *@param rinex the RinexData object with the current epoch
+ *@param obsFile the observation file
+ *@param lastEpoch the time of the last epoch printed in the file, updated with the current one
+ *@param spacings the counts of times between consecutive epochs printed in the file
+ */
+void printEpoch(RinexData &rinex, FILE* obsFile, double &lastEpoch, map<long long, int> &spacings) {
+	int week, eFlag;
+	double tow, bias, epochTime;
+	long long spacing;
+	rinex.getEpochTime(week, tow, bias, eFlag);
+	epochTime = getSecsGPSEphe(week, tow);
+	rinex.setHdLnData(RinexData::TOLO);
+	rinex.printObsEpoch(obsFile);
+	if (lastEpoch >= 0.0) {
+		spacing = (long long) floor((epochTime - lastEpoch) * 1000.0 + 0.5);
+		if (spacing > 0) spacings[spacing]++;
+	}
+	lastEpoch = epochTime;
+}
+
+/**closeObsFile updates in the observation file header the records known after printing it, and closes the file.
+ *
+ *@param rinex the RinexData object with header data
+ *@param obsFile the file to close
+ *@param spacings the counts of times between consecutive epochs printed in the file. The most frequent one is stated as the
+ * interval, if any (otherwise the one in the header is kept)
+ *@param printEOF when true, end-of-file comment lines are appended to the file
+ *@param plog point to the Logger
+ *@return true if the file has been updated and closed without errors, false otherwise
+ */
+bool closeObsFile(RinexData &rinex, FILE* &obsFile, const map<long long, int> &spacings, bool printEOF, Logger* plog) {
+	map<long long, int>::const_iterator itMax = spacings.end();
+	for (map<long long, int>::const_iterator it = spacings.begin(); it != spacings.end(); it++)
+		if ((itMax == spacings.end()) || (it->second > itMax->second)) itMax = it;
+	if (itMax != spacings.end()) rinex.setHdLnData(RinexData::INT, itMax->first / 1000.0);
+	bool status = rinex.updateObsHeader(obsFile);
+	if (!status) plog->severe("Cannot update the RINEX observation file header");
+	if (printEOF) rinex.printObsEOF(obsFile);
+	if (fclose(obsFile) != 0) status = false;
+	obsFile = NULL;
+	return status;
+}
+
+/**createNavFile creates a RINEX navigation file with the standard name for the navigation data stored in the given RinexData object.
+ *
+ *@param rinex is the RinexData object containing navigation data for the file to be printed
+ *@param ver is the RINEX version of the file to be generated
+ *@param sysId is the identification of the satellite system data to be printed. Only relevant for version 2.10 files.
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ *@return the file created, or NULL if it cannot be created
+ */
+FILE* createNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
+	FILE* navFile;		//the file where RINEX navigation data will be printed
+	string outFileName;	//the output file name for RINEX files
+	char fnameSfx;
+	switch (ver) {
+	case RinexData::V210:
+		switch (sysId) {
+		case 'G': fnameSfx = 'N'; break;
+		case 'R': fnameSfx = 'G'; break;
+		case 'S': fnameSfx = 'H'; break;
+		default:
+			plog->warning("Cannot print RINEX V2.10 navigation file for system " + string(1, sysId));
+			return NULL;
+		}
+		outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX), fnameSfx);
+		break;
+	case RinexData::V302:
+		outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX));
+		break;
+	default:
+		plog->warning("Cannot print RINEX navigation file for the version given");
+		return NULL;
+	}
+	if ((navFile = fopen(outFileName.c_str(), "w")) == NULL) plog->warning(FILENOK + outFileName);
+	else plog->info("Printing RINEX navigation file " + outFileName);
+	return navFile;
+}
+
+/**prinfNavFile prints a RINEX navigation file from the navigation data stored stored in the given RinexData object.
+ *File format will be according the given version, and for the given satellite system if version to be generated is 2.10.
+ *
+ *@param rinex is the RinexData object containing navigation data for the file to be printed
+ *@param ver is the RINEX version of the file to be generated
+ *@param sysId is the identification of the satellite system data to be printed. Only relevant for version 2.10 files.
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ */
+void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
+	FILE* navFile;		//the file where RINEX navigation data will be printed
+	if ((navFile = createNavFile(rinex, ver, sysId, plog)) == NULL) return;
+	try {
+		rinex.setFilter(vector<string>(1,string(1,sysId)), vector<string>());
+		rinex.printNavHeader(navFile);
+		rinex.printNavEpoch(navFile);
+	} catch (string error) {
+		plog->severe(error);
+	}
+	fclose(navFile);
+}
@@ -7,6 +7,7 @@
  *	- -a PAT or --patience=PAT : Maximum number of bytes to read when waiting for a packet start. Default value is 500
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -P PERFOUT or --perf=PERFOUT : Dump performance counters at exit to the given file: a summary table, or a Chrome trace if its name ends with .json. Default value: not dumped
  *	- -p COMPORT or --port=COMPORT : Serial port name where receiver is connected. Default value COMPORT = COM35
  *	- -m MODE or --mode=MODE : Set receiver protocol to NMEA or OSP. Default value MODE = NMEA
  *<p>
@@ -27,11 +28,13 @@
  *V1.1	|2/2016	|Minor improvements for logging messages
  *V1.2	|2/2018	|Adapted to new SerialTxRx I/F to set and get port parameters
  *				|Reviewed to run on Linux
+ *V1.3	|10/2026	|Added option to dump performance counters at exit
  */
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "PerfCounters.h"
 #include "Utilities.h"
 //from SerialTxRx
 #include "SerialTxRx.h"
@@ -52,7 +55,7 @@ using namespace std;
 #endif
 ///The command line format
 const string CMDLINE = "SynchroRX.exe {options}";
-const string MYVER = " V1.2";
+const string MYVER = " V1.3";
 ///Default baud rate for OSP binary data transfers
 const int OSPbRate = 57600;
 ///Default baud rate for NMEA ASCII data transfers
@@ -62,7 +65,7 @@ const int MAXtimeout = 50;	//tenthsecons
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
-int COMPORT, HELP, LOGLEVEL, MODE, PAT; //metavariables for options in the command line call
+int COMPORT, HELP, LOGLEVEL, PERFOUT, MODE, PAT; //metavariables for options in the command line call
 //Metavariables for operators
 
 //Protocols / modes used by the receiver to exchange data
@@ -120,6 +123,7 @@ int main(int argc, char** argv) {
 	MODE = parser.addOption("-m", "--mode", "MODE", textBuf, "NMEA");
 	COMPORT = parser.addOption("-p", "--port", "COMPORT", "Serial port name where receiver is connected", COMDEF);
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	PERFOUT = parser.addOption("-P", "--perf", "PERFOUT", "Dump performance counters at exit to the given file (a Chrome trace if it ends with .json)", "");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
 	PAT = parser.addOption("-a", "--patience", "PAT", "Maximum number of bytes to read when waiting for a packet start", "500");
 	/// 3- Parses arguments in the command line extracting options and operators
@@ -135,8 +139,10 @@ int main(int argc, char** argv) {
 		parser.usage("checks and/or sets the communications port and the SiRF IV receiver state", CMDLINE);
 		return 0;
 	}
-	/// 4- Sets logging level stated in option
+	/// 4- Sets logging level stated in option. At detailed levels messages are recorded asynchronously
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	PerfCounters::start(parser.getStrOpt(PERFOUT));
+	if (log.isLevel(Logger::FINE)) log.setAsync(true);
 	/// 5- Gets from option the protocol mode to be used
 	protocol wantedMode = NMEA;		//default values
 	if(parser.getStrOpt(MODE).compare("OSP") == 0) {
@@ -0,0 +1,239 @@
+/** @file BatchRunner.cpp
+ * Contains the implementation of the BatchRunner class.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "BatchRunner.h"
+
+/**Constructs a BatchRunner object to convert files using the given number of worker threads.
+ *
+ * @param nWorkers the number of worker threads. If zero or negative, the number of hardware threads available is used
+ * @param plog a pointer to the Logger used to log conversion summaries. It shall be thread safe
+ */
+BatchRunner::BatchRunner(int nWorkers, Logger* plog) {
+	if (nWorkers <= 0) nWorkers = (int) thread::hardware_concurrency();
+	workers = nWorkers > 0? nWorkers : 1;
+	this->plog = plog;
+}
+
+/**Destructs BatchRunner objects.
+ */
+BatchRunner::~BatchRunner(void) {
+}
+
+/**getFileList gives the list of files to convert from the given directory or list file.
+ *<p>If listOrDir is a directory, the list contains the regular files in it (not in subdirectories) accepted by the given filter,
+ * sorted by name. The list is taken before starting the conversions, and does not include files created by them.
+ *<p>Otherwise listOrDir shall be a text file containing a file name per line. Empty lines and lines starting with # are ignored.
+ * All files listed are included.
+ *
+ * @param listOrDir the name of the directory or the list file
+ * @param accept the function stating if a file in the directory shall be included (see isOSPfileName, etc.). If empty, all are included
+ * @return the names of the files to convert
+ * @throws error string if the directory or list file cannot be read
+ */
+vector<string> BatchRunner::getFileList(string listOrDir, FileFilter accept) {
+	vector<string> files;
+	struct stat fileStat;
+	string aStr;
+	if (stat(listOrDir.c_str(), &fileStat) != 0) throw "Cannot access batch list or directory " + listOrDir;
+	if ((fileStat.st_mode & S_IFMT) == S_IFDIR) {
+		string sep = (listOrDir.back() == '/') || (listOrDir.back() == '\\')? "" : "/";
+#ifdef _WIN32
+		WIN32_FIND_DATAA findData;
+		HANDLE hFind = FindFirstFileA((listOrDir + sep + "*").c_str(), &findData);
+		if (hFind == INVALID_HANDLE_VALUE) throw "Cannot read batch directory " + listOrDir;
+		do {
+			if (((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) && (!accept || accept(string(findData.cFileName))))
+				files.push_back(listOrDir + sep + findData.cFileName);
+		} while (FindNextFileA(hFind, &findData));
+		FindClose(hFind);
+#else
+		DIR* dir = opendir(listOrDir.c_str());
+		struct dirent* entry;
+		if (dir == NULL) throw "Cannot read batch directory " + listOrDir;
+		while ((entry = readdir(dir)) != NULL) {
+			if (accept && !accept(string(entry->d_name))) continue;
+			aStr = listOrDir + sep + entry->d_name;
+			if ((stat(aStr.c_str(), &fileStat) == 0) && ((fileStat.st_mode & S_IFMT) == S_IFREG)) files.push_back(aStr);
+		}
+		closedir(dir);
+#endif
+		sort(files.begin(), files.end());
+		return files;
+	}
+	FILE* listFile;
+	char lineBuffer[1024];
+	size_t n;
+	if ((listFile = fopen(listOrDir.c_str(), "r")) == NULL) throw "Cannot open batch list file " + listOrDir;
+	while (fgets(lineBuffer, sizeof lineBuffer, listFile) != NULL) {
+		//remove trailing end of line and spaces
+		n = strlen(lineBuffer);
+		while ((n > 0) && ((lineBuffer[n-1] == '\n') || (lineBuffer[n-1] == '\r') || (lineBuffer[n-1] == ' '))) n--;
+		lineBuffer[n] = 0;
+		if ((n > 0) && (lineBuffer[0] != '#')) files.push_back(string(lineBuffer));
+	}
+	fclose(listFile);
+	return files;
+}
+
+/**isOSPfileName checks if the given file name is the one of an OSP file: its extension is .OSP (in any case).
+ * Sidecar files, like OSP index files (.ospidx) or RTK files (.OSP.pos), are not accepted.
+ *
+ * @param fileName the file name
+ * @return true if it is an OSP file name, false otherwise
+ */
+bool BatchRunner::isOSPfileName(const string &fileName) {
+	return getExtension(fileName, false) == "osp";
+}
+
+/**isRINEXfileName checks if the given file name is the one of a RINEX observation or navigation file, optionally compressed
+ * with gzip (.gz): a V2.10 name with extension .yyT (yy the two digits year, T the file type, D for Compact RINEX),
+ * or a V3.02 name with extension .rnx or .crx (in any case).
+ *
+ * @param fileName the file name
+ * @return true if it is a RINEX file name, false otherwise
+ */
+bool BatchRunner::isRINEXfileName(const string &fileName) {
+	string ext = getExtension(fileName, true);
+	if ((ext == "rnx") || (ext == "crx")) return true;
+	return (ext.size() == 3) && isdigit(ext[0]) && isdigit(ext[1]) && (strchr("odnglhbpcm", ext[2]) != NULL);
+}
+
+/**isRINEXobsFileName checks if the given file name is the one of a RINEX observation file, optionally compressed
+ * with gzip (.gz): a V2.10 name with extension .yyO (or .yyD for Compact RINEX), or a V3.02 name ending with O.rnx or .crx (in any case).
+ *
+ * @param fileName the file name
+ * @return true if it is a RINEX observation file name, false otherwise
+ */
+bool BatchRunner::isRINEXobsFileName(const string &fileName) {
+	string ext = getExtension(fileName, true);
+	size_t extPos = fileName.size() - ext.size() - 1;	//the position of the dot before the extension
+	if ((fileName.size() > 3) && (fileName.compare(fileName.size() - 3, 3, ".gz") == 0)) extPos -= 3;
+	if (ext == "crx") return true;
+	if (ext == "rnx") return (extPos > 0) && (toupper(fileName[extPos - 1]) == 'O');
+	return (ext.size() == 3) && isdigit(ext[0]) && isdigit(ext[1]) && ((ext[2] == 'o') || (ext[2] == 'd'));
+}
+
+/**run converts the given files using the worker threads.
+ *<p>Each worker takes the next pending file, calls the convert function for it, and stores its results.
+ * When all files have been converted, the summary line of each one is logged at INFO level (SEVERE if its status is not 0).
+ *
+ * @param files the names of the files to convert
+ * @param convert the function performing the conversion of a file
+ * @return the greatest exit status of the conversions performed (0 if all files were converted without errors)
+ */
+int BatchRunner::run(const vector<string> &files, ConvertFunction convert) {
+	vector<size_t> order;
+	vector<long long> sizes;
+	vector<thread> pool;
+	atomic<size_t> next(0);
+	int status = 0;
+	char txtBuf[40];
+	//initialize summaries and set the conversion order: biggest files first
+	summary.clear();
+	summary.resize(files.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		summary[i].fileName = files[i];
+		summary[i].status = -1;
+		summary[i].seconds = 0.0;
+		order.push_back(i);
+		sizes.push_back(fileSize(files[i]));
+	}
+	stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {return sizes[a] > sizes[b];});
+	//launch workers and wait for them
+	int nThreads = min(workers, (int) files.size());
+	plog->info("Batch conversion of " + to_string((long long) files.size()) + " files using " + to_string((long long) nThreads) + " workers");
+	for (int i = 0; i < nThreads; i++) pool.push_back(thread(&BatchRunner::worker, this, cref(order), ref(next), ref(convert)));
+	for (vector<thread>::iterator it = pool.begin(); it != pool.end(); it++) it->join();
+	//log summaries
+	int nFailed = 0;
+	for (vector<FileSummary>::iterator it = summary.begin(); it != summary.end(); it++) {
+		sprintf(txtBuf, " (%.3f s)", it->seconds);
+		if (it->status == 0) plog->info(it->fileName + ": " + it->result + txtBuf);
+		else {
+			plog->severe(it->fileName + ": status " + to_string((long long) it->status) + ". " + it->result + txtBuf);
+			nFailed++;
+		}
+		if (it->status > status) status = it->status;
+		else if ((it->status < 0) && (status == 0)) status = 1;
+	}
+	plog->info("End of batch conversion. Files converted: " + to_string((long long) (files.size() - nFailed))
+		+ " failed: " + to_string((long long) nFailed));
+	return status;
+}
+
+/**getSummary gives the conversion results of the files converted in the last run.
+ *
+ * @return the summary of each file, in the same order they were given to run
+ */
+const vector<BatchRunner::FileSummary>& BatchRunner::getSummary() {
+	return summary;
+}
+
+/**worker is the body of each worker thread: it takes files pending conversion and converts them until no one remains.
+ * Exceptions raised by the conversion function are caught and recorded in the summary.
+ *
+ * @param order the positions of files in the summary vector, in conversion order
+ * @param next the shared position in order of the next file to convert
+ * @param convert the function performing the conversion of a file
+ */
+void BatchRunner::worker(const vector<size_t> &order, atomic<size_t> &next, ConvertFunction &convert) {
+	size_t n;
+	while ((n = next++) < order.size()) {
+		FileSummary &fs = summary[order[n]];	//each summary element is written only by the worker converting its file
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		try {
+			fs.status = convert(fs.fileName, fs.result);
+		} catch (string error) {
+			fs.status = -1;
+			fs.result = error;
+		} catch (int error) {
+			fs.status = -1;
+			fs.result = "Error " + to_string((long long) error);
+		} catch (...) {
+			fs.status = -1;
+			fs.result = "Unexpected error";
+		}
+		fs.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+}
+
+/**fileSize gives the size in bytes of the given file.
+ *
+ * @param fileName the file name
+ * @return the file size, or 0 if it cannot be accessed
+ */
+long long BatchRunner::fileSize(string fileName) {
+	struct stat fileStat;
+	if (stat(fileName.c_str(), &fileStat) != 0) return 0;
+	return (long long) fileStat.st_size;
+}
+
+/**getExtension gives in lower case the extension of the given file name (the characters after its last dot).
+ *
+ * @param fileName the file name
+ * @param skipGz when true, a ".gz" suffix is removed before getting the extension
+ * @return the extension, or an empty string if the name has no dot
+ */
+string BatchRunner::getExtension(const string &fileName, bool skipGz) {
+	string name = fileName;
+	if (skipGz && (name.size() > 3) && (name.compare(name.size() - 3, 3, ".gz") == 0)) name.erase(name.size() - 3);
+	size_t dot = name.find_last_of('.');
+	if ((dot == string::npos) || (name.find_first_of("/\\", dot) != string::npos)) return string();
+	string ext = name.substr(dot + 1);
+	for (string::iterator it = ext.begin(); it != ext.end(); it++) *it = (char) tolower(*it);
+	return ext;
+}
@@ -0,0 +1,74 @@
+/** @file BatchRunner.h
+ * Contains the BatchRunner class definition used to convert a batch of input files using several worker threads.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ *<p>V1.1	|10/2026	|Files in directories are filtered by name, to convert only inputs of the command
+ */
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+
+#include "Logger.h"
+
+using namespace std;
+
+/**BatchRunner class provides resources to convert in a single process a batch of input files, using several worker threads.
+ *<p>A program using BatchRunner would perform the following steps:
+ *	-# Get the list of files to convert using getFileList, from a directory or from a text file containing file names.
+ *		Files in a directory are filtered using the function given (i.e. isOSPfileName), to exclude log, index or other files
+ *	-# Define a BatchRunner object stating the number of worker threads and the Logger to be used
+ *	-# Call run passing the list of files and the function performing the conversion of one file.
+ *		It is called from the worker threads, and shall use only its own objects (RinexData, GNSSdataFromOSP, etc.).
+ *		Shared objects, like the command line ArgParser, shall be used only to read their data.
+ *	-# Use the FileSummary data of each file converted, or the summary lines logged by run
+ *<p>Each worker takes the next file pending conversion when it finishes the current one. Files are taken in decreasing size order,
+ * to avoid most of the workers being idle while the last big files are converted.
+ */
+class BatchRunner {
+public:
+	struct FileSummary {	//result of the conversion of a file
+		string fileName;	//the input file name
+		int status;			//the exit status given by the conversion function, or -1 if it raised an exception
+		string result;		//a text describing the conversion result (number of epochs, etc.)
+		double seconds;		//the elapsed time of the conversion
+	};
+	///The function performing the conversion of a file. Params are the file name and the result text to fill. Returns the exit status
+	typedef function<int (const string &, string &)> ConvertFunction;
+	///The function stating if a file in a directory shall be converted. Param is the file name without directory
+	typedef function<bool (const string &)> FileFilter;
+	BatchRunner(int nWorkers, Logger* plog);
+	~BatchRunner(void);
+	static vector<string> getFileList(string listOrDir, FileFilter accept = FileFilter());
+	static bool isOSPfileName(const string &fileName);
+	static bool isRINEXfileName(const string &fileName);
+	static bool isRINEXobsFileName(const string &fileName);
+	int run(const vector<string> &files, ConvertFunction convert);
+	const vector<FileSummary>& getSummary();
+
+private:
+	int workers;					//the number of worker threads to use
+	Logger* plog;					//the logger shared by all workers
+	vector<FileSummary> summary;	//the conversion results, in the same order of the files given
+
+	void worker(const vector<size_t> &order, atomic<size_t> &next, ConvertFunction &convert);
+	static long long fileSize(string fileName);
+	static string getExtension(const string &fileName, bool skipGz);
+};
+#endif
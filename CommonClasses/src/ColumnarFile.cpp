@@ -0,0 +1,203 @@
+/** @file ColumnarFile.cpp
+ * Contains the implementation of the ColumnarFile class.
+ */
+
+#include <string.h>
+
+#include "ColumnarFile.h"
+
+/**Constructs a ColumnarFile object to write a table to the given file.
+ *
+ * @param out the output file, already open in binary mode
+ * @param rowsPerChunk the number of rows in each chunk written
+ */
+ColumnarFile::ColumnarFile(FILE* out, unsigned int rowsPerChunk) {
+	outFile = out;
+	chunkRows = rowsPerChunk > 0? rowsPerChunk : COLCHUNKROWS;
+	nRows = 0;
+	totalRows = 0;
+	headerWritten = false;
+	writeError = false;
+}
+
+/**Destructs ColumnarFile objects. Data pending to write are lost if close was not called.
+ */
+ColumnarFile::~ColumnarFile(void) {
+}
+
+/**addColumn defines a new column in the table. Columns shall be defined before putting values of the first row.
+ *
+ * @param name the name of the column (up to 255 characters)
+ * @param type the type of data stored in the column
+ * @param width the width in characters for STRING columns. It is ignored for other types
+ * @return the index of the column, to be used when putting values
+ * @throws error string with a message, when columns cannot be added or the width is not valid
+ */
+int ColumnarFile::addColumn(const string &name, ColType type, int width) {
+	if (headerWritten || (totalRows > 0) || (!columns.empty() && !columns[0].values.empty()))
+		throw string("Columns cannot be added after putting values");
+	Column column;
+	column.name = name.substr(0, 255);
+	column.type = type;
+	switch (type) {
+	case CHAR:
+	case INT8:
+		column.width = 1;
+		break;
+	case INT16:
+		column.width = 2;
+		break;
+	case INT32:
+		column.width = 4;
+		break;
+	case DOUBLE:
+		column.width = 8;
+		break;
+	default:
+		if ((width < 1) || (width > 255)) throw string("Wrong width for string column " + name);
+		column.width = width;
+		break;
+	}
+	column.values.reserve((size_t) chunkRows * column.width);
+	columns.push_back(column);
+	return (int) columns.size() - 1;
+}
+
+/**putChar puts the value of a CHAR column in the current row.
+ *
+ * @param col the index of the column
+ * @param value the value to put
+ */
+void ColumnarFile::putChar(int col, char value) {
+	putBytes(col, &value, 1);
+}
+
+/**putInt puts the value of an integer column (INT8, INT16 or INT32) in the current row.
+ * The value is truncated to the width of the column.
+ *
+ * @param col the index of the column
+ * @param value the value to put
+ */
+void ColumnarFile::putInt(int col, long long value) {
+	signed char i8;
+	short i16;
+	int i32;
+	switch (columns[col].type) {
+	case INT8:
+		i8 = (signed char) value;
+		putBytes(col, &i8, 1);
+		break;
+	case INT16:
+		i16 = (short) value;
+		putBytes(col, &i16, 2);
+		break;
+	default:
+		i32 = (int) value;
+		putBytes(col, &i32, 4);
+		break;
+	}
+}
+
+/**putDouble puts the value of a DOUBLE column in the current row.
+ *
+ * @param col the index of the column
+ * @param value the value to put
+ */
+void ColumnarFile::putDouble(int col, double value) {
+	putBytes(col, &value, 8);
+}
+
+/**putStr puts the value of a STRING column in the current row, truncated or padded with spaces to the column width.
+ *
+ * @param col the index of the column
+ * @param value the value to put
+ */
+void ColumnarFile::putStr(int col, const string &value) {
+	Column &column = columns[col];
+	size_t n = value.size() < (size_t) column.width? value.size() : (size_t) column.width;
+	column.values.insert(column.values.end(), value.begin(), value.begin() + n);
+	column.values.insert(column.values.end(), column.width - n, ' ');
+}
+
+/**endRow finishes the current row. When the chunk is full, its rows are written to the output file.
+ *
+ * @throws error string with a message, when the value of any column is missing in the row
+ */
+void ColumnarFile::endRow() {
+	for (vector<Column>::iterator it = columns.begin(); it != columns.end(); it++)
+		if (it->values.size() != (size_t) (nRows + 1) * it->width) throw string("Missing value for column " + it->name);
+	nRows++;
+	totalRows++;
+	if (nRows >= chunkRows) writeChunk();
+}
+
+/**rowCount gives the number of rows finished in the table.
+ *
+ * @return the number of rows
+ */
+unsigned long long ColumnarFile::rowCount() {
+	return totalRows;
+}
+
+/**close writes the rows pending and the end of table mark. The output file is not closed.
+ *
+ * @return true if all data were written without errors, false otherwise
+ */
+bool ColumnarFile::close() {
+	writeChunk();
+	if (!headerWritten) writeHeader();
+	writeUint(0, 4);
+	if (fflush(outFile) != 0) writeError = true;
+	return !writeError;
+}
+
+/**putBytes appends the given bytes to the values pending to write of a column.
+ *
+ * @param col the index of the column
+ * @param bytes the place where the bytes to append are
+ * @param n the number of bytes to append
+ */
+void ColumnarFile::putBytes(int col, const void* bytes, int n) {
+	const unsigned char* from = (const unsigned char*) bytes;
+	columns[col].values.insert(columns[col].values.end(), from, from + n);
+}
+
+/**writeHeader writes the file identification, the byte order mark and the column definitions.
+ */
+void ColumnarFile::writeHeader() {
+	if (fwrite(COLFILEMAGIC, 1, 8, outFile) != 8) writeError = true;
+	writeUint(COLFILEBOM, 4);
+	writeUint((unsigned int) columns.size(), 4);
+	for (vector<Column>::iterator it = columns.begin(); it != columns.end(); it++) {
+		writeUint((unsigned int) it->type, 1);
+		writeUint((unsigned int) it->width, 1);
+		writeUint((unsigned int) it->name.size(), 1);
+		if (fwrite(it->name.c_str(), 1, it->name.size(), outFile) != it->name.size()) writeError = true;
+	}
+	headerWritten = true;
+}
+
+/**writeChunk writes the rows pending, if any, as a chunk: the number of rows and the values of each column.
+ */
+void ColumnarFile::writeChunk() {
+	if (nRows == 0) return;
+	if (!headerWritten) writeHeader();
+	writeUint(nRows, 4);
+	for (vector<Column>::iterator it = columns.begin(); it != columns.end(); it++) {
+		if (fwrite(it->values.data(), 1, it->values.size(), outFile) != it->values.size()) writeError = true;
+		it->values.clear();
+	}
+	nRows = 0;
+}
+
+/**writeUint writes an unsigned integer of the given size in bytes, in the byte order of this machine.
+ *
+ * @param value the value to write
+ * @param n the size in bytes (1 or 4)
+ */
+void ColumnarFile::writeUint(unsigned int value, int n) {
+	unsigned char u8 = (unsigned char) value;
+	if (n == 1) {
+		if (fwrite(&u8, 1, 1, outFile) != 1) writeError = true;
+	} else if (fwrite(&value, 4, 1, outFile) != 1) writeError = true;
+}
@@ -0,0 +1,102 @@
+/** @file ColumnarFile.h
+ * Contains the ColumnarFile class definition used to write tables of data in a binary columnar format.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef COLUMNARFILE_H
+#define COLUMNARFILE_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//@cond DUMMY
+///The file identification written at the beginning of columnar files
+#define COLFILEMAGIC "RXCOLF01"
+///The value written after the identification to allow readers to detect the byte order used
+#define COLFILEBOM 0x01020304
+///The default number of rows in each chunk
+#define COLCHUNKROWS 65536
+//@endcond
+
+/**ColumnarFile class writes a table of data (a set of rows having values for the same columns) to a binary file where
+ * values are stored column by column, in chunks of rows. Each column has a fixed width type, and values of a column in
+ * a chunk are contiguous, in a layout that can be loaded directly into arrays without any parsing.
+ *<p>The file format is:
+ *	-# The file identification: the 8 characters "RXCOLF01"
+ *	-# The byte order mark: a 32 bits unsigned integer with value 0x01020304. All numbers in the file use the byte order
+ *		of the machine that wrote it, and readers can detect it reading this value
+ *	-# The number of columns, as a 32 bits unsigned integer
+ *	-# For each column: its type (one character, see ColType), its width in bytes (8 bits unsigned integer), the length
+ *		of its name (8 bits unsigned integer) and the name characters
+ *	-# For each chunk of rows: the number of rows in the chunk (a 32 bits unsigned integer, greater than 0), and for each
+ *		column (in the order they were defined) the values of all rows in the chunk
+ *	-# A 32 bits unsigned integer with value 0 to mark the end of the table
+ *<p>Strings are stored with the fixed width of the column, truncated or padded with spaces as needed.
+ *<p>The usual process to write a table would be:
+ *	-# Create a ColumnarFile object for the output file, already open in binary mode
+ *	-# Define the table columns using addColumn
+ *	-# For each row, put the value of each column using the put methods, and call endRow
+ *	-# Call close to write rows pending and the end of table mark
+ */
+class ColumnarFile {
+public:
+	///The types of data that can be stored in columns
+	enum ColType {
+		CHAR = 'c',		///one character
+		INT8 = 'b',		///8 bits signed integer
+		INT16 = 'h',	///16 bits signed integer
+		INT32 = 'i',	///32 bits signed integer
+		DOUBLE = 'd',	///64 bits IEEE floating point
+		STRING = 's'	///fixed width character string
+	};
+	ColumnarFile(FILE* out, unsigned int rowsPerChunk = COLCHUNKROWS);
+	~ColumnarFile(void);
+	int addColumn(const string &name, ColType type, int width = 0);
+	void putChar(int col, char value);
+	void putInt(int col, long long value);
+	void putDouble(int col, double value);
+	void putStr(int col, const string &value);
+	void endRow();
+	unsigned long long rowCount();
+	bool close();
+
+private:
+	struct Column {		//the definition and the values pending to write of a column
+		string name;
+		ColType type;
+		int width;
+		vector<unsigned char> values;
+	};
+	vector<Column> columns;
+	FILE* outFile;			//the output file
+	unsigned int chunkRows;	//the number of rows in each chunk
+	unsigned int nRows;		//the number of rows pending to write
+	unsigned long long totalRows;	//the number of rows in the table
+	bool headerWritten;		//true once the file header is written
+	bool writeError;		//true if an error happened when writing data
+
+	ColumnarFile(const ColumnarFile &);				//objects cannot be copied
+	ColumnarFile& operator=(const ColumnarFile &);
+
+	void putBytes(int col, const void* bytes, int n);
+	void writeHeader();
+	void writeChunk();
+	void writeUint(unsigned int value, int n);
+};
+#endif
@@ -0,0 +1,571 @@
+/** @file CompactRinex.cpp
+ * Contains the implementation of the CompactRinex class.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "CompactRinex.h"
+#include "Utilities.h"
+
+//@cond DUMMY
+///The range of observable values that fit the F14.3 RINEX format. Values out of range are encoded as 0
+const double CRXMAXVALUE = 9999999999.999;
+const double CRXMINVALUE = -999999999.999;
+///The initial size of the buffer where Compact RINEX lines are read
+#define CRXLINEBUFSIZE 1024
+///The maximum size of the error messages kept pending to be got
+#define CRXMAXERRORS 4096
+//@endcond
+
+/**Constructs an empty CompactRinex object, ready to decode a Compact RINEX file or to encode a new one.
+ */
+CompactRinex::CompactRinex(void) {
+	lineBufSize = CRXLINEBUFSIZE;
+	lineBuf = new char[lineBufSize];
+	resetState();
+}
+
+/**Destructs CompactRinex objects.
+ */
+CompactRinex::~CompactRinex(void) {
+	delete[] lineBuf;
+}
+
+/**isCompactHeader checks if the given record is the first header record of a Compact RINEX file.
+ *
+ * @param rec the record to be checked
+ * @param recLen the number of chars in the record
+ * @return true if the record has the CRINEX VERS / TYPE label, false otherwise
+ */
+bool CompactRinex::isCompactHeader(const char* rec, int recLen) {
+	return (recLen >= 60 + (int) strlen(CRXVERLABEL)) && (strncmp(rec + 60, CRXVERLABEL, strlen(CRXVERLABEL)) == 0);
+}
+
+/**decodeLine decodes a line of a Compact RINEX file. The RINEX records obtained, if any, can be got using getRecord.
+ * Lines shall be passed in the order they are in the file, starting with the first header record.
+ *
+ * @param line the Compact RINEX line, without EOL chars
+ * @param len the number of chars in the line
+ * @return true if the line has been decoded, false if format errors were found (they can be got using getError)
+ */
+bool CompactRinex::decodeLine(const char* line, int len) {
+	int flag, n;
+	int flagPos = crxVersion == 1? 28 : 31;	//the position of the epoch flag in epoch lines
+	while ((len > 0) && (line[len - 1] == ' ')) len--;
+	switch (decState) {
+	case HEADER:
+		if (len > 60) {
+			if (strncmp(line + 60, CRXVERLABEL, strlen(CRXVERLABEL)) == 0) {
+				crxVersion = 1;
+				for (n = 0; (n < 20) && (n < len); n++)
+					if (line[n] != ' ') {
+						if (line[n] >= '3') crxVersion = 3;
+						break;
+					}
+				return true;
+			}
+			if (strncmp(line + 60, CRXPRGLABEL, strlen(CRXPRGLABEL)) == 0) return true;
+			if ((strncmp(line + 60, "# / TYPES OF OBSERV", 19) == 0) && getFixedInt(line, 6, n)) v2Types = n;
+			else if ((strncmp(line + 60, "SYS / # / OBS TYPES", 19) == 0) && (line[0] != ' ') && getFixedInt(line + 3, 3, n))
+				v3Types[line[0] & 0x7F] = n;
+			else if (strncmp(line + 60, "END OF HEADER", 13) == 0) {
+				if (crxVersion == 0) {
+					addError("Missing " CRXVERLABEL " record", line, len);
+					crxVersion = 3;
+				}
+				decState = EPOCH;
+			}
+		}
+		putRinexLine(line, len);
+		return true;
+	case EPOCH:
+		if ((len > 0) && (line[0] == (crxVersion == 1? '&' : '>'))) {
+			epochLine.assign(line, len);
+			if (crxVersion == 1) epochLine[0] = ' ';
+		} else if (epochLine.empty()) {
+			addError("Epoch line not initialized", line, len);
+			return false;
+		} else repairText(epochLine, line, len);
+		if (epochLine.size() < (size_t) flagPos + 4) epochLine.resize(flagPos + 4, ' ');
+		flag = epochLine[flagPos] - '0';
+		if ((flag < 0) || (flag > 6) || !getFixedInt(epochLine.c_str() + flagPos + 1, 3, n) || (n < 0)) {
+			addError("Wrong epoch flag or number of satellites", line, len);
+			epochLine.clear();
+			return false;
+		}
+		satsLeft = n;
+		if ((flag >= 2) && (flag <= 5)) {	//an event: special records follow
+			putRinexLine(epochLine.c_str(), flagPos + 4);
+			decState = n > 0? SPECIAL : EPOCH;
+			return true;
+		}
+		satPos = crxVersion == 1? 32 : 41;
+		if (epochLine.size() < (size_t) satPos + 3 * n) epochLine.resize(satPos + 3 * n, ' ');
+		decState = CLOCK;
+		return true;
+	case CLOCK:
+		clockSet = false;
+		if (len == 0) clock.order = -1;
+		else if (decodeValue(line, len, clock, clockValue)) clockSet = true;
+		else addError("Wrong clock offset", line, len);
+		putRinexEpoch();
+		epochCount++;
+		decState = satsLeft > 0? SATDATA : EPOCH;
+		return clockSet || (len == 0);
+	case SATDATA:
+		if (--satsLeft <= 0) decState = EPOCH;
+		return decodeSatellite(line, len);
+	case SPECIAL:
+		putRinexLine(line, len);
+		if (--satsLeft <= 0) decState = EPOCH;
+		return true;
+	}
+	return false;
+}
+
+/**getRecord gets the next RINEX record decoded from the Compact RINEX input. When no records decoded are pending, lines are
+ * read from the input file and decoded. Format errors found are kept to be got using getError.
+ * The record remains valid until the next call to getRecord.
+ *
+ * @param input the already open Compact RINEX input file
+ * @param rec the pointer to the first char of the record
+ * @param recLen the number of chars in the record, excluding EOL
+ * @return true if EOF happens when reading, false otherwise
+ */
+bool CompactRinex::getRecord(FILE* input, const char* &rec, int &recLen) {
+	const char* eol;
+	char* newBuf;
+	int len;
+	for (;;) {
+		if (rinexPos < rinexText.size()) {
+			rec = rinexText.data() + rinexPos;
+			eol = (const char*) memchr(rec, '\n', rinexText.size() - rinexPos);
+			recLen = (int) (eol - rec);
+			rinexPos += recLen + 1;
+			return false;
+		}
+		rinexText.clear();
+		rinexPos = 0;
+		//read the next line, enlarging the buffer when it does not fit
+		len = 0;
+		for (;;) {
+			if (fgets(lineBuf + len, lineBufSize - len, input) == NULL) {
+				if (len == 0) return true;
+				break;
+			}
+			len += strlen(lineBuf + len);
+			if ((len > 0) && (lineBuf[len - 1] == '\n')) break;
+			if (len == lineBufSize - 1) {
+				newBuf = new char[lineBufSize * 2];
+				memcpy(newBuf, lineBuf, len);
+				delete[] lineBuf;
+				lineBuf = newBuf;
+				lineBufSize *= 2;
+			}
+		}
+		while ((len > 0) && ((lineBuf[len - 1] == '\n') || (lineBuf[len - 1] == '\r'))) len--;
+		decodeLine(lineBuf, len);
+	}
+}
+
+/**getError gets the messages of format errors found while decoding, and clears them.
+ *
+ * @param msg the error messages found since the last call
+ * @return true if there were errors, false otherwise
+ */
+bool CompactRinex::getError(string &msg) {
+	if (errors.empty()) return false;
+	msg = errors;
+	errors.clear();
+	return true;
+}
+
+/**encodeHeader renders the two records to be printed before the RINEX header records of a Compact RINEX file.
+ * The encoding state is reset: the first epoch encoded after it will be initialized.
+ *
+ * @param rinexV3 true if the RINEX file encoded is V3.02 (CRINEX 3.0), false if V2.10 (CRINEX 1.0)
+ * @param program the name of the program generating the file
+ * @param out the output buffer where records are rendered
+ */
+void CompactRinex::encodeHeader(bool rinexV3, const string &program, OutputBuffer &out) {
+	char buffer[100];
+	char dateTime[20];
+	char fmt[] = "%d-%b-%y %H:%M";
+	resetState();
+	crxVersion = rinexV3? 3 : 1;
+	formatLocalTime(dateTime, sizeof dateTime, fmt);
+	sprintf(buffer, "%-20s%-40s%-20s\n", rinexV3? "3.0" : "1.0", "COMPACT RINEX FORMAT", CRXVERLABEL);
+	out.putStr(buffer);
+	sprintf(buffer, "%-40.40s%-20.20s%-20s\n", program.c_str(), dateTime, CRXPRGLABEL);
+	out.putStr(buffer);
+}
+
+/**encodeEpoch renders the Compact RINEX lines for an epoch having observation data: the epoch line, the clock offset line,
+ * and a line for each satellite having data.
+ *
+ * @param epochPfx the RINEX epoch line without satellites and clock offset: time, epoch flag and number of satellites, and in V3.02 the reserved blanks
+ * @param obs the observation data of the epoch, having observable type indexes as per the header records printed
+ * @param sysIds the system identification for each system index in obs
+ * @param nTypes the number of observable types for each system index in obs
+ * @param clkOffset the receiver clock offset (0 when not available)
+ * @param out the output buffer where lines are rendered
+ */
+void CompactRinex::encodeEpoch(const char* epochPfx, EpochObsMatrix &obs, const vector<char> &sysIds, const vector<int> &nTypes,
+	double clkOffset, OutputBuffer &out) {
+	int row, sx, sat, ox, nt, lol, strength;
+	double value;
+	//build the epoch line with the satellites list, and print it initialized or as differences with the previous one
+	newLine.assign(epochPfx);
+	for (row = obs.firstSat(); row >= 0; row = obs.nextSat(row)) {
+		sat = obs.getSat(row);
+		newLine.push_back(sysIds[obs.getSys(row)]);
+		newLine.push_back('0' + (sat / 10) % 10);
+		newLine.push_back('0' + sat % 10);
+	}
+	if (epochLine.empty()) {
+		out.putChar(crxVersion == 1? '&' : newLine[0]);
+		out.putStr(newLine.c_str() + 1);
+	} else {
+		diffText(epochLine, newLine, textDiff);
+		out.putStr(textDiff);
+	}
+	out.putChar('\n');
+	epochLine.swap(newLine);
+	//print the clock offset line, empty when not available
+	if (clkOffset != 0.0) putValue(clock, llround(clkOffset * (crxVersion == 1? 1e9 : 1e12)), CRXCLKORDER, out);
+	else clock.order = -1;
+	out.putChar('\n');
+	epochCount++;
+	//print a line for each satellite with the differences of its observables, followed by the differences of its flags
+	for (row = obs.firstSat(); row >= 0; row = obs.nextSat(row)) {
+		sx = obs.getSys(row);
+		sat = obs.getSat(row);
+		nt = nTypes[sx];
+		SatState &state = getSatState((sysIds[sx] & 0x7F) * 100 + sat % 100, nt);
+		newLine.assign(2 * nt, ' ');
+		for (ox = 0; ox < nt; ox++) {
+			if (ox > 0) out.putChar(' ');
+			if (obs.hasObs(row, ox)) {
+				value = obs.getValue(row, ox);
+				if ((value > CRXMAXVALUE) || (value < CRXMINVALUE)) value = 0.0;
+				putValue(state.arcs[ox], llround(value * 1000.0), CRXOBSORDER, out);
+				if ((lol = obs.getLol(row, ox)) != 0) newLine[2 * ox] = '0' + lol % 10;
+				if ((strength = obs.getStrength(row, ox)) != 0) newLine[2 * ox + 1] = '0' + strength % 10;
+			} else state.arcs[ox].order = -1;
+		}
+		diffText(state.flags, newLine, textDiff);
+		if (!textDiff.empty()) {
+			out.putChar(' ');
+			out.putStr(textDiff);
+		}
+		out.putChar('\n');
+		state.flags.swap(newLine);
+	}
+}
+
+/**encodeEvent renders the Compact RINEX epoch line for an event epoch (flags 2 to 5). Special records following it are
+ * printed as in RINEX files. The next epoch encoded will be initialized.
+ *
+ * @param epochLine the RINEX epoch line of the event
+ * @param out the output buffer where the line is rendered
+ */
+void CompactRinex::encodeEvent(const char* epochLine, OutputBuffer &out) {
+	if (crxVersion == 1) {
+		out.putChar('&');
+		out.putStr(epochLine + 1);
+	} else out.putStr(epochLine);
+	out.putChar('\n');
+	this->epochLine.clear();
+}
+
+/**resetState sets the initial state to start decoding or encoding a file.
+ */
+void CompactRinex::resetState() {
+	crxVersion = 0;
+	epochLine.clear();
+	clock.order = -1;
+	sats.clear();
+	epochCount = 0;
+	decState = HEADER;
+	v2Types = 0;
+	for (int i = 0; i < 128; i++) v3Types[i] = 0;
+	satsLeft = 0;
+	satPos = 0;
+	clockSet = false;
+	clockValue = 0;
+	rinexText.clear();
+	rinexPos = 0;
+	errors.clear();
+}
+
+/**satKey computes the key used to identify a satellite from its identification.
+ *
+ * @param satId the satellite identification: system code and a 2 digits satellite number
+ * @return the satellite key
+ */
+int CompactRinex::satKey(const char* satId) {
+	int prn = 0;
+	for (int i = 1; i < 3; i++) if ((satId[i] >= '0') && (satId[i] <= '9')) prn = prn * 10 + (satId[i] - '0');
+	return (satId[0] & 0x7F) * 100 + prn;
+}
+
+/**getSatState gets the state of the given satellite for the current epoch. When the satellite had no data in the previous epoch,
+ * its state is reset, and new arcs will be started for all its observables.
+ *
+ * @param key the satellite key
+ * @param nTypes the number of observable types of the satellite system
+ * @return the state of the satellite
+ */
+CompactRinex::SatState &CompactRinex::getSatState(int key, int nTypes) {
+	Arc noArc;
+	noArc.order = -1;
+	noArc.maxOrder = 0;
+	pair<map<int, SatState>::iterator, bool> ins = sats.insert(make_pair(key, SatState()));
+	SatState &state = ins.first->second;
+	if (ins.second || (state.epoch + 1 != epochCount)) {
+		state.arcs.assign(nTypes, noArc);
+		state.flags.clear();
+	} else if (state.arcs.size() != (size_t) nTypes) state.arcs.resize(nTypes, noArc);
+	state.epoch = epochCount;
+	return state;
+}
+
+/**repairText applies to the given text the differences stated in a Compact RINEX text field: blanks mean no change,
+ * '&' means the char changed to blank, and any other char is the new one.
+ *
+ * @param text the text to repair
+ * @param diff the differences
+ * @param len the number of chars in diff
+ */
+void CompactRinex::repairText(string &text, const char* diff, int len) {
+	for (int i = 0; i < len; i++) {
+		if (i >= (int) text.size()) text.push_back(' ');
+		if (diff[i] == ' ') continue;
+		text[i] = diff[i] == '&'? ' ' : diff[i];
+	}
+}
+
+/**diffText computes the differences between two texts as stated for Compact RINEX text fields (see repairText).
+ * Chars beyond the end of a text are considered blanks, and trailing blanks of the differences are removed.
+ *
+ * @param oldText the previous text
+ * @param newText the current text
+ * @param diff the differences computed
+ */
+void CompactRinex::diffText(const string &oldText, const string &newText, string &diff) {
+	size_t n = oldText.size() > newText.size()? oldText.size() : newText.size();
+	size_t last = 0;
+	char o, c;
+	diff.assign(n, ' ');
+	for (size_t i = 0; i < n; i++) {
+		o = i < oldText.size()? oldText[i] : ' ';
+		c = i < newText.size()? newText[i] : ' ';
+		if (c == o) continue;
+		diff[i] = c == ' '? '&' : c;
+		last = i + 1;
+	}
+	diff.resize(last);
+}
+
+/**decodeValue gets the value stated in a Compact RINEX numeric field: an arc initialization ("order&value") or a difference
+ * of the arc order with the previous values.
+ *
+ * @param field the field text
+ * @param len the number of chars in the field
+ * @param arc the state of differences for this value, updated with the field data
+ * @param value the value decoded
+ * @return true if the value has been decoded, false if the field has format errors or the arc was not initialized
+ */
+bool CompactRinex::decodeValue(const char* field, int len, Arc &arc, long long &value) {
+	long long d = 0;
+	long long e[CRXMAXORDER + 1];
+	int i = 0, order = -1;
+	bool negative = false;
+	//get the arc order, if any
+	const char* amp = (const char*) memchr(field, '&', len);
+	if (amp != NULL) {
+		if ((amp != field + 1) || (field[0] < '0') || (field[0] > '0' + CRXMAXORDER)) return false;
+		order = field[0] - '0';
+		i = 2;
+	}
+	//get the integer value
+	if ((i < len) && (field[i] == '-')) {
+		negative = true;
+		i++;
+	}
+	if (i >= len) return false;
+	for (; i < len; i++) {
+		if ((field[i] < '0') || (field[i] > '9')) return false;
+		d = d * 10 + (field[i] - '0');
+	}
+	if (negative) d = -d;
+	if (order >= 0) {	//start a new arc
+		arc.maxOrder = order;
+		arc.order = 0;
+		arc.diff[0] = value = d;
+		return true;
+	}
+	if (arc.order < 0) return false;
+	order = arc.order < arc.maxOrder? arc.order + 1 : arc.maxOrder;
+	e[order] = d;
+	for (i = order - 1; i >= 0; i--) e[i] = e[i + 1] + arc.diff[i];
+	for (i = 0; i <= order; i++) arc.diff[i] = e[i];
+	arc.order = order;
+	value = e[0];
+	return true;
+}
+
+/**putValue renders a numeric field of Compact RINEX, starting a new arc if needed, or rendering the difference of the arc order.
+ *
+ * @param arc the state of differences for this value, updated with the new one
+ * @param value the value to render
+ * @param maxOrder the order of differences to use when a new arc is started
+ * @param out the output buffer where the field is rendered
+ */
+void CompactRinex::putValue(Arc &arc, long long value, int maxOrder, OutputBuffer &out) {
+	long long e[CRXMAXORDER + 1];
+	int i, order;
+	if (arc.order < 0) {
+		arc.maxOrder = maxOrder;
+		arc.order = 0;
+		arc.diff[0] = value;
+		out.putInt(maxOrder);
+		out.putChar('&');
+		out.putInt(value);
+		return;
+	}
+	order = arc.order < arc.maxOrder? arc.order + 1 : arc.maxOrder;
+	e[0] = value;
+	for (i = 1; i <= order; i++) e[i] = e[i - 1] - arc.diff[i - 1];
+	for (i = 0; i <= order; i++) arc.diff[i] = e[i];
+	arc.order = order;
+	out.putInt(e[order]);
+}
+
+/**putScaled renders an integer value scaled by 10^-decimals in fixed point notation, as printf would do with "%width.decimalsf".
+ *
+ * @param value the integer value
+ * @param decimals the number of decimals
+ * @param width the minimum width of the field
+ * @param out the output buffer where the value is rendered
+ */
+void CompactRinex::putScaled(long long value, int decimals, int width, OutputBuffer &out) {
+	char digits[32];
+	int n = 0;
+	unsigned long long u = value < 0? 0ULL - (unsigned long long) value : (unsigned long long) value;
+	for (int i = 0; i < decimals; i++, u /= 10) digits[n++] = '0' + (char) (u % 10);
+	digits[n++] = '.';
+	do {
+		digits[n++] = '0' + (char) (u % 10);
+		u /= 10;
+	} while (u != 0);
+	if (value < 0) digits[n++] = '-';
+	if (n < width) out.putChars(' ', width - n);
+	while (n > 0) out.putChar(digits[--n]);
+}
+
+/**putRinexLine appends a RINEX record to the ones decoded pending to be got.
+ *
+ * @param line the record text
+ * @param len the number of chars in the record
+ */
+void CompactRinex::putRinexLine(const char* line, int len) {
+	for (int i = 0; i < len; i++) rinexText.putChar(line[i]);
+	rinexText.putChar('\n');
+}
+
+/**putRinexEpoch appends the RINEX epoch line (and continuation lines in V2.10) of the current epoch to the records decoded.
+ */
+void CompactRinex::putRinexEpoch() {
+	int i;
+	int nSats = satsLeft;
+	const char* line = epochLine.c_str();
+	if (crxVersion == 1) {
+		for (i = 0; i < 32; i++) rinexText.putChar(line[i]);
+		for (i = 0; i < nSats; i++) {
+			if ((i > 0) && ((i % 12) == 0)) {	//continuation line
+				rinexText.putChar('\n');
+				rinexText.putChars(' ', 32);
+			}
+			rinexText.putChar(line[32 + 3 * i]);
+			rinexText.putChar(line[33 + 3 * i]);
+			rinexText.putChar(line[34 + 3 * i]);
+			if ((i == 11) && clockSet) putScaled(clockValue, 9, 12, rinexText);
+		}
+		if ((nSats < 12) && clockSet) {
+			rinexText.putChars(' ', 3 * (12 - nSats));
+			putScaled(clockValue, 9, 12, rinexText);
+		}
+	} else {
+		for (i = 0; i < 35; i++) rinexText.putChar(line[i]);
+		if (clockSet) {
+			rinexText.putChars(' ', 6);
+			putScaled(clockValue, 12, 15, rinexText);
+		}
+	}
+	rinexText.putChar('\n');
+}
+
+/**decodeSatellite decodes a Compact RINEX line with data of the next satellite in the current epoch, and appends the RINEX
+ * observation records (one in V3.02, one for each five observables in V2.10) to the records decoded.
+ *
+ * @param line the Compact RINEX line, without EOL chars
+ * @param len the number of chars in the line
+ * @return true if the line has been decoded, false if format errors were found
+ */
+bool CompactRinex::decodeSatellite(const char* line, int len) {
+	const char* satId = epochLine.c_str() + satPos;
+	int nt = crxVersion == 1? v2Types : v3Types[satId[0] & 0x7F];
+	int pos = 0, start, ox;
+	bool good = true;
+	satPos += 3;
+	SatState &state = getSatState(satKey(satId), nt);
+	satValues.resize(nt);
+	satHasValue.assign(nt, 0);
+	//get the values of each observable: fields are separated by a blank, and empty fields mean no value
+	for (ox = 0; ox < nt; ox++) {
+		start = pos;
+		while ((pos < len) && (line[pos] != ' ')) pos++;
+		if (pos > start) {
+			if (decodeValue(line + start, pos - start, state.arcs[ox], satValues[ox])) satHasValue[ox] = 1;
+			else {
+				state.arcs[ox].order = -1;
+				good = false;
+			}
+		} else state.arcs[ox].order = -1;
+		if (pos < len) pos++;
+	}
+	//the remaining chars are the differences of flags
+	repairText(state.flags, line + pos, len - pos);
+	if (state.flags.size() < (size_t) 2 * nt) state.flags.resize(2 * nt, ' ');
+	if (!good) addError("Wrong observable value", line, len);
+	//render the RINEX records
+	if (crxVersion != 1) {
+		rinexText.putChar(satId[0]);
+		rinexText.putChar(satId[1]);
+		rinexText.putChar(satId[2]);
+	}
+	for (ox = 0; ox < nt; ox++) {
+		if ((crxVersion == 1) && (ox > 0) && ((ox % 5) == 0)) rinexText.putChar('\n');
+		if (satHasValue[ox]) {
+			putScaled(satValues[ox], 3, 14, rinexText);
+			rinexText.putChar(state.flags[2 * ox]);
+			rinexText.putChar(state.flags[2 * ox + 1]);
+		} else rinexText.putChars(' ', 16);
+	}
+	rinexText.putChar('\n');
+	return good;
+}
+
+/**addError appends a message to the errors found while decoding, including the beginning of the line where it was found.
+ *
+ * @param msg the error message
+ * @param line the line having the error
+ * @param len the number of chars in the line
+ */
+void CompactRinex::addError(const string &msg, const char* line, int len) {
+	if (errors.size() >= CRXMAXERRORS) return;
+	if (!errors.empty()) errors += "; ";
+	errors += "Compact RINEX: " + msg + " [" + string(line, len < 40? len : 40) + "]";
+}
@@ -0,0 +1,125 @@
+/** @file CompactRinex.h
+ * Contains the CompactRinex class definition used to decode and encode observation files in Compact RINEX format (Hatanaka).
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef COMPACTRINEX_H
+#define COMPACTRINEX_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "EpochObsMatrix.h"
+#include "OutputBuffer.h"
+
+using namespace std;
+
+//@cond DUMMY
+///The label of the first header record in Compact RINEX files
+#define CRXVERLABEL "CRINEX VERS   / TYPE"
+///The label of the second header record in Compact RINEX files
+#define CRXPRGLABEL "CRINEX PROG / DATE"
+///The maximum order of differences accepted when decoding
+#define CRXMAXORDER 9
+///The order of differences used to encode observables
+#define CRXOBSORDER 3
+///The order of differences used to encode receiver clock offsets
+#define CRXCLKORDER 2
+//@endcond
+
+/**CompactRinex class decodes and encodes observation data in the Compact RINEX format defined by Y. Hatanaka
+ * (CRINEX 1.0 for RINEX V2.10 files, and CRINEX 3.0 for RINEX V3.02 files).
+ *<p>In Compact RINEX files, header records are the ones of the RINEX file preceded by two specific records. Epoch data are
+ * reduced taking into account their changes from one epoch to the next:
+ * - The epoch line, including the list of satellites, is compared as text with the previous one: only characters changed are included.
+ * - The receiver clock offset, and each observable of each satellite, are converted to integers and replaced by their differences of
+ *	given order with the previous values of the same arc. An arc starts including its order and initial value (as in "3&123456789").
+ * - Loss of lock and signal strength flags of each satellite are compared as text with the previous ones.
+ *<p>To decode a Compact RINEX file, its records are passed using decodeLine or getRecord, and the RINEX records obtained are got using getRecord.
+ * Only the data needed to decode (number of observable types from the header records) are extracted from records.
+ *<p>To encode a file, encodeHeader renders the Compact RINEX specific records to be printed before the RINEX header records,
+ * and encodeEpoch or encodeEvent render epoch data.
+ *<p>The same object cannot be used to decode and encode at the same time.
+ */
+class CompactRinex {
+public:
+	CompactRinex(void);
+	~CompactRinex(void);
+	static bool isCompactHeader(const char* rec, int recLen);
+	//methods to decode Compact RINEX files
+	bool decodeLine(const char* line, int len);
+	bool getRecord(FILE* input, const char* &rec, int &recLen);
+	bool getError(string &msg);
+	//methods to encode Compact RINEX files
+	void encodeHeader(bool rinexV3, const string &program, OutputBuffer &out);
+	void encodeEpoch(const char* epochPfx, EpochObsMatrix &obs, const vector<char> &sysIds, const vector<int> &nTypes,
+		double clkOffset, OutputBuffer &out);
+	void encodeEvent(const char* epochLine, OutputBuffer &out);
+
+private:
+	struct Arc {		//the state of differences of a value (an observable or the clock offset)
+		int order;		//the order of the last difference computed, or -1 if no arc is started
+		int maxOrder;	//the order of differences to be used in this arc
+		long long diff[CRXMAXORDER + 1];	//the value (0) and its differences of order 1 to order
+	};
+	struct SatState {	//the state of data of a satellite
+		unsigned long epoch;	//the last data epoch (in epochCount) having data of this satellite
+		vector<Arc> arcs;		//the state of each observable
+		string flags;			//the last loss of lock and signal strength flags
+	};
+	int crxVersion;			//1 for CRINEX 1.0 (RINEX V2.10), 3 for CRINEX 3.0 (RINEX V3.02), 0 if not known
+	string epochLine;		//the last epoch line (with satellite list), or empty if the next one shall be initialized
+	Arc clock;				//the state of the receiver clock offset
+	map<int, SatState> sats;	//the state of each satellite, by satellite key (see satKey)
+	unsigned long epochCount;	//the number of data epochs processed
+	//decoding state
+	enum DecodeState {HEADER, EPOCH, CLOCK, SATDATA, SPECIAL} decState;
+	int v2Types;			//number of observable types for all systems (V2.10)
+	int v3Types[128];		//number of observable types for each system code (V3.02)
+	int satsLeft;			//the number of satellite lines, or special records, remaining in the current epoch
+	int satPos;				//the position in epochLine of the satellite for the next satellite line
+	bool clockSet;			//true if the current epoch has clock offset
+	long long clockValue;	//the clock offset of the current epoch
+	char* lineBuf;			//the buffer where Compact RINEX lines are read
+	int lineBufSize;		//the size of lineBuf
+	OutputBuffer rinexText;	//RINEX records decoded pending to be got
+	size_t rinexPos;		//the position in rinexText of the next record to be got
+	string errors;			//errors found while decoding, pending to be got
+	vector<long long> satValues;	//the observable values decoded for the current satellite line
+	vector<char> satHasValue;		//for each observable of the current satellite line, 1 if it has value, 0 otherwise
+	//encoding state
+	string newLine;			//a working area to build the epoch line and flags
+	string textDiff;		//a working area to build the differences of text
+
+	CompactRinex(const CompactRinex &);				//objects cannot be copied
+	CompactRinex& operator=(const CompactRinex &);
+
+	void resetState();
+	static int satKey(const char* satId);
+	SatState &getSatState(int key, int nTypes);
+	static void repairText(string &text, const char* diff, int len);
+	static void diffText(const string &oldText, const string &newText, string &diff);
+	bool decodeValue(const char* field, int len, Arc &arc, long long &value);
+	static void putValue(Arc &arc, long long value, int maxOrder, OutputBuffer &out);
+	static void putScaled(long long value, int decimals, int width, OutputBuffer &out);
+	void putRinexLine(const char* line, int len);
+	void putRinexEpoch();
+	bool decodeSatellite(const char* line, int len);
+	void addError(const string &msg, const char* line, int len);
+};
+#endif
@@ -0,0 +1,346 @@
+/** @file EpochObsMatrix.cpp
+ * Contains the implementation of the EpochObsMatrix class.
+ */
+#include <algorithm>
+
+#include "EpochObsMatrix.h"
+
+//@cond DUMMY
+//the position of the least significant bit set in a 64 bits word (that shall not be 0)
+#if defined(__GNUC__)
+#define LOWESTBIT(x) __builtin_ctzll(x)
+#else
+static int lowestBit(unsigned long long x) {
+	int n = 0;
+	while ((x & 0xFFFF) == 0) {
+		x >>= 16;
+		n += 16;
+	}
+	while ((x & 0x01) == 0) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+}
+#define LOWESTBIT(x) lowestBit(x)
+#endif
+//@endcond
+
+/**Constructs an empty EpochObsMatrix object.
+ */
+EpochObsMatrix::EpochObsMatrix(void) {
+	nRows = 0;
+	stride = 0;
+	nCells = 0;
+	cursorValid = false;
+	cursorIndex = 0;
+	cursorRow = -1;
+	cursorObs = -1;
+}
+
+/**Destructs EpochObsMatrix objects.
+ */
+EpochObsMatrix::~EpochObsMatrix(void) {
+}
+
+/**clear removes all data stored. The memory allocated is kept to be reused.
+ */
+void EpochObsMatrix::clear() {
+	size_t cell;
+	for (unsigned int row = 0; row < nRows; row++) {
+		keyRow[rowKey[row]] = -1;
+		keyBits[rowKey[row] >> 6] &= ~(1ULL << (rowKey[row] & 63));
+		cell = (size_t) row * stride;
+		for (int i = 0; i <= rowLast[row]; i++) present[cell + i] = 0;
+	}
+	nRows = 0;
+	nCells = 0;
+	cursorValid = false;
+}
+
+/**empty tells if there are cells with data.
+ *
+ * @return true if no data are stored, false otherwise
+ */
+bool EpochObsMatrix::empty() {
+	return nCells == 0;
+}
+
+/**size gives the number of cells with data.
+ *
+ * @return the number of observables stored
+ */
+unsigned int EpochObsMatrix::size() {
+	return nCells;
+}
+
+/**satCount gives the number of satellites with data, that is, the number of rows having at least one cell with data.
+ *
+ * @return the number of satellites having observables stored
+ */
+unsigned int EpochObsMatrix::satCount() {
+	unsigned int n = 0;
+	for (unsigned int row = 0; row < nRows; row++) if (rowCount[row] > 0) n++;
+	return n;
+}
+
+/**put stores data for the given satellite and observable type, if the cell does not have data yet.
+ *
+ * @param sysIx the index of the system the satellite belongs
+ * @param sat the satellite number (0 to MAXSATKEY-1)
+ * @param obsIx the index of the observable type in the system
+ * @param value the value of the observable
+ * @param lol the loss of lock indicator
+ * @param strength the signal strength
+ * @return true if data have been stored, false if the cell already has data or indexes are out of range
+ */
+bool EpochObsMatrix::put(int sysIx, int sat, int obsIx, double value, int lol, int strength) {
+	if ((sysIx < 0) || (sat < 0) || (sat >= MAXSATKEY) || (obsIx < 0)) return false;
+	unsigned int key = sysIx * MAXSATKEY + sat;
+	if (key >= keyRow.size()) {
+		keyRow.resize((sysIx + 1) * MAXSATKEY, -1);
+		keyBits.resize(keyRow.size() / 64, 0);
+	}
+	if ((unsigned int) obsIx >= stride) setStride(obsIx + 1);
+	int row = keyRow[key];
+	if (row < 0) {		//a new row is needed for this satellite
+		row = nRows++;
+		if (nRows > rowKey.size()) {
+			rowKey.push_back(0);
+			rowCount.push_back(0);
+			rowLast.push_back(-1);
+			values.resize(rowKey.size() * stride, 0.0);
+			lols.resize(rowKey.size() * stride, 0);
+			strengths.resize(rowKey.size() * stride, 0);
+			present.resize(rowKey.size() * stride, 0);
+		}
+		rowKey[row] = key;
+		rowCount[row] = 0;
+		rowLast[row] = -1;
+		keyRow[key] = row;
+		keyBits[key >> 6] |= 1ULL << (key & 63);
+	}
+	size_t cell = (size_t) row * stride + obsIx;
+	if (present[cell] != 0) return false;
+	present[cell] = 1;
+	values[cell] = value;
+	lols[cell] = lol;
+	strengths[cell] = strength;
+	rowCount[row]++;
+	if (obsIx > rowLast[row]) rowLast[row] = obsIx;
+	nCells++;
+	cursorValid = false;
+	return true;
+}
+
+/**erase removes data of the given cell. When no data remain in the row, the satellite is removed from the iteration sequence.
+ *
+ * @param row the row of the satellite, as given by firstSat or nextSat
+ * @param obsIx the index of the observable type
+ */
+void EpochObsMatrix::erase(int row, int obsIx) {
+	if (!hasObs(row, obsIx)) return;
+	size_t cell = (size_t) row * stride;
+	present[cell + obsIx] = 0;
+	nCells--;
+	cursorValid = false;
+	if (--rowCount[row] == 0) {
+		rowLast[row] = -1;
+		keyRow[rowKey[row]] = -1;
+		keyBits[rowKey[row] >> 6] &= ~(1ULL << (rowKey[row] & 63));
+	} else if (obsIx == rowLast[row]) {
+		while (present[cell + rowLast[row]] == 0) rowLast[row]--;
+	}
+}
+
+/**firstSat gives the row of the satellite with the lowest system index and satellite number having data.
+ *
+ * @return the row of the satellite, or -1 if no data are stored
+ */
+int EpochObsMatrix::firstSat() {
+	int key = nextKey(0);
+	return key < 0? -1 : keyRow[key];
+}
+
+/**nextSat gives the row of the satellite following the given one, in system index and satellite number order, having data.
+ *
+ * @param row the row of the current satellite, as given by firstSat or nextSat
+ * @return the row of the next satellite, or -1 if no more satellites have data
+ */
+int EpochObsMatrix::nextSat(int row) {
+	int key = nextKey(rowKey[row] + 1);
+	return key < 0? -1 : keyRow[key];
+}
+
+/**getSys gives the system index of the satellite in the given row.
+ *
+ * @param row the row of the satellite
+ * @return the system index
+ */
+int EpochObsMatrix::getSys(int row) {
+	return rowKey[row] / MAXSATKEY;
+}
+
+/**getSat gives the satellite number of the satellite in the given row.
+ *
+ * @param row the row of the satellite
+ * @return the satellite number
+ */
+int EpochObsMatrix::getSat(int row) {
+	return rowKey[row] % MAXSATKEY;
+}
+
+/**lastObs gives the greatest observable type index having data in the given row.
+ *
+ * @param row the row of the satellite
+ * @return the observable type index, or -1 if the row does not have data
+ */
+int EpochObsMatrix::lastObs(int row) {
+	return rowLast[row];
+}
+
+/**hasObs tells if the cell for the given row and observable type has data.
+ *
+ * @param row the row of the satellite
+ * @param obsIx the index of the observable type
+ * @return true if the cell has data, false otherwise
+ */
+bool EpochObsMatrix::hasObs(int row, int obsIx) {
+	if ((row < 0) || ((unsigned int) row >= nRows) || (obsIx < 0) || ((unsigned int) obsIx >= stride)) return false;
+	return present[(size_t) row * stride + obsIx] != 0;
+}
+
+/**getValue gives the observable value in the given cell, that shall have data (see hasObs).
+ *
+ * @param row the row of the satellite
+ * @param obsIx the index of the observable type
+ * @return the observable value
+ */
+double EpochObsMatrix::getValue(int row, int obsIx) {
+	return values[(size_t) row * stride + obsIx];
+}
+
+/**getLol gives the loss of lock indicator in the given cell, that shall have data (see hasObs).
+ *
+ * @param row the row of the satellite
+ * @param obsIx the index of the observable type
+ * @return the loss of lock indicator
+ */
+int EpochObsMatrix::getLol(int row, int obsIx) {
+	return lols[(size_t) row * stride + obsIx];
+}
+
+/**getStrength gives the signal strength in the given cell, that shall have data (see hasObs).
+ *
+ * @param row the row of the satellite
+ * @param obsIx the index of the observable type
+ * @return the signal strength
+ */
+int EpochObsMatrix::getStrength(int row, int obsIx) {
+	return strengths[(size_t) row * stride + obsIx];
+}
+
+/**getCell gives data of the cell at the given position in the sequence of cells with data ordered by system index,
+ * satellite number and observable type index.
+ * When cells are got in sequence (index 0, 1, 2, ...), each one is found from the previous one without searching from the beginning.
+ *
+ * @param index the position in the sequence of cells with data
+ * @param sysIx the system index of the satellite
+ * @param sat the satellite number
+ * @param obsIx the observable type index
+ * @param value the observable value
+ * @param lol the loss of lock indicator
+ * @param strength the signal strength
+ * @return true if data for the given position exist, false otherwise
+ */
+bool EpochObsMatrix::getCell(unsigned int index, int &sysIx, int &sat, int &obsIx, double &value, int &lol, int &strength) {
+	if (index >= nCells) return false;
+	if (!cursorValid || (index < cursorIndex)) {	//start from the first cell with data
+		cursorRow = firstSat();
+		for (cursorObs = 0; !hasObs(cursorRow, cursorObs); cursorObs++);
+		cursorIndex = 0;
+		cursorValid = true;
+	}
+	while (cursorIndex < index) {		//advance to the next cell with data
+		do {
+			if (++cursorObs > rowLast[cursorRow]) {
+				cursorRow = nextSat(cursorRow);
+				cursorObs = 0;
+			}
+		} while (!hasObs(cursorRow, cursorObs));
+		cursorIndex++;
+	}
+	sysIx = getSys(cursorRow);
+	sat = getSat(cursorRow);
+	obsIx = cursorObs;
+	size_t cell = (size_t) cursorRow * stride + cursorObs;
+	value = values[cell];
+	lol = lols[cell];
+	strength = strengths[cell];
+	return true;
+}
+
+/**swap exchanges the contents of this matrix with the ones of the given matrix.
+ *
+ * @param other the matrix to exchange data with
+ */
+void EpochObsMatrix::swap(EpochObsMatrix &other) {
+	keyRow.swap(other.keyRow);
+	keyBits.swap(other.keyBits);
+	rowKey.swap(other.rowKey);
+	rowCount.swap(other.rowCount);
+	rowLast.swap(other.rowLast);
+	std::swap(nRows, other.nRows);
+	std::swap(stride, other.stride);
+	values.swap(other.values);
+	lols.swap(other.lols);
+	strengths.swap(other.strengths);
+	present.swap(other.present);
+	std::swap(nCells, other.nCells);
+	cursorValid = other.cursorValid = false;
+}
+
+/**nextKey gives the first satellite key having data from the given one.
+ *
+ * @param fromKey the satellite key where the search starts
+ * @return the satellite key found, or -1 if no one has data
+ */
+int EpochObsMatrix::nextKey(int fromKey) {
+	unsigned int w = fromKey >> 6;
+	if (w >= keyBits.size()) return -1;
+	unsigned long long bits = keyBits[w] & (~0ULL << (fromKey & 63));
+	while (bits == 0) {
+		if (++w >= keyBits.size()) return -1;
+		bits = keyBits[w];
+	}
+	return (int) ((w << 6) + LOWESTBIT(bits));
+}
+
+/**setStride changes the number of cells in each row, moving existing data to their new positions.
+ *
+ * @param newStride the new number of cells in each row (greater than the current one)
+ */
+void EpochObsMatrix::setStride(unsigned int newStride) {
+	size_t nCellsAlloc = rowKey.size() * newStride;
+	vector<double> newValues(nCellsAlloc, 0.0);
+	vector<int> newLols(nCellsAlloc, 0);
+	vector<int> newStrengths(nCellsAlloc, 0);
+	vector<unsigned char> newPresent(nCellsAlloc, 0);
+	size_t from, to;
+	for (unsigned int row = 0; row < nRows; row++) {
+		from = (size_t) row * stride;
+		to = (size_t) row * newStride;
+		for (int i = 0; i <= rowLast[row]; i++) {
+			newValues[to + i] = values[from + i];
+			newLols[to + i] = lols[from + i];
+			newStrengths[to + i] = strengths[from + i];
+			newPresent[to + i] = present[from + i];
+		}
+	}
+	values.swap(newValues);
+	lols.swap(newLols);
+	strengths.swap(newStrengths);
+	present.swap(newPresent);
+	stride = newStride;
+}
+#undef LOWESTBIT
@@ -0,0 +1,89 @@
+/** @file EpochObsMatrix.h
+ * Contains the EpochObsMatrix class definition used to store the observation data of an epoch.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef EPOCHOBSMATRIX_H
+#define EPOCHOBSMATRIX_H
+
+#include <vector>
+
+using namespace std;
+
+//@cond DUMMY
+//The number of satellite numbers (0 to MAXSATKEY-1) that can be stored for each system
+#define MAXSATKEY 256
+//@endcond
+
+/**EpochObsMatrix class stores the observation data of an epoch as a matrix of satellites x observable types.
+ *<p>Each satellite having data in the epoch has a row in the matrix. Rows have a cell for each observable type index of the system
+ * the satellite belongs. Cell data (observable value, loss of lock indicator and signal strength) are stored in parallel arrays.
+ *<p>Satellites are identified by their system index and satellite number. Rows can be iterated ordered by system index and satellite
+ * number (using firstSat and nextSat), and cells in a row ordered by observable type index, without any sorting.
+ *<p>The memory allocated for rows is kept when the matrix is cleared, to be reused for the next epoch: once the matrix has grown
+ * to the size of the largest epoch, no allocations are made when storing data.
+ *<p>The usual process to store and retrieve epoch data would be:
+ *	-# Use put to store each observable of the epoch
+ *	-# Iterate over satellites using firstSat and nextSat, and over observable types of each satellite from 0 to lastObs, using
+ *		hasObs to know if the cell has data, and getValue, getLol and getStrength to get them
+ *	-# Alternatively, use getCell to get data of the cells having data by its position in the iteration order
+ *	-# Use clear to remove all data before storing the next epoch
+ */
+class EpochObsMatrix {
+public:
+	EpochObsMatrix(void);
+	~EpochObsMatrix(void);
+	void clear();
+	bool empty();
+	unsigned int size();
+	unsigned int satCount();
+	bool put(int sysIx, int sat, int obsIx, double value, int lol, int strength);
+	void erase(int row, int obsIx);
+	int firstSat();
+	int nextSat(int row);
+	int getSys(int row);
+	int getSat(int row);
+	int lastObs(int row);
+	bool hasObs(int row, int obsIx);
+	double getValue(int row, int obsIx);
+	int getLol(int row, int obsIx);
+	int getStrength(int row, int obsIx);
+	bool getCell(unsigned int index, int &sysIx, int &sat, int &obsIx, double &value, int &lol, int &strength);
+	void swap(EpochObsMatrix &other);
+
+private:
+	vector<int> keyRow;			//the row of each satellite key (sysIx * MAXSATKEY + sat), or -1 if the satellite has no data
+	vector<unsigned long long> keyBits;	//bit set of satellite keys having data, used to iterate rows in order
+	vector<int> rowKey;			//the satellite key of each row in use
+	vector<int> rowCount;		//the number of cells with data in each row
+	vector<int> rowLast;		//the greatest observable type index with data in each row, or -1
+	unsigned int nRows;			//the number of rows in use
+	unsigned int stride;		//the number of cells in each row
+	vector<double> values;		//the observable value of each cell
+	vector<int> lols;			//the loss of lock indicator of each cell
+	vector<int> strengths;		//the signal strength of each cell
+	vector<unsigned char> present;	//1 if the cell has data, 0 otherwise
+	unsigned int nCells;		//the number of cells with data
+	//state of the sequential access by position (see getCell)
+	bool cursorValid;
+	unsigned int cursorIndex;
+	int cursorRow;
+	int cursorObs;
+
+	int nextKey(int fromKey);
+	void setStride(unsigned int newStride);
+};
+#endif
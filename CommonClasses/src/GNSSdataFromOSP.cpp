@@ -7,6 +7,20 @@
 #include "GNSSdataFromOSP.h"
 //from CommonClasses
 #include "Utilities.h"
+#include "NavBitsCheck.h"
+#include "PerfCounters.h"
+
+//@cond DUMMY
+//Tables shared by all GNSSdataFromOSP objects
+double GNSSdataFromOSP::GPS_SCALEFACTOR[8][4];
+double GNSSdataFromOSP::GPS_URA[16];
+double GNSSdataFromOSP::GLO_SCALEFACTOR[4][4];
+OSPDispatchTable<GNSSdataFromOSP::HeaderMsgHandler> GNSSdataFromOSP::headerHandlers;
+OSPDispatchTable<GNSSdataFromOSP::RTKHeaderMsgHandler> GNSSdataFromOSP::rtkHeaderHandlers;
+OSPDispatchTable<GNSSdataFromOSP::EpochMsgHandler> GNSSdataFromOSP::epochHandlers;
+bool GNSSdataFromOSP::rtkMIDs[256];
+once_flag GNSSdataFromOSP::sharedTablesSet;
+//@endcond
 
 ///Macro to check message payload length and to log an error message if not correct 
 #define CHECK_PAYLOADLEN(LENGTH, ERROR_MSG) \
@@ -35,10 +49,20 @@ GNSSdataFromOSP::GNSSdataFromOSP(string rcv, int minxfix, bool applBias, FILE* f
 	ospFile = f;
 	plog = pl;
 	dynamicLog = false;
+	epochGPSweek = 0;
+	epochGPStow = epochClkBias = epochClkDrift = 0.0;
+	epochBufferIdx = 0;
+	singlePass = singlePassGLO = epochTimeRead = false;
+	streamHdAcq = streamGLO = streamAcq = false;
+	ospIndex = NULL;
+	rxIdAcq = false;
+	filePos = 0;
+	endOffset = -1;
 	for (int i=0; i<MAXCHANNELS; i++)
 		for (int j=0; j<MAXSUBFR; j++)
 			subfrmCh[i][j].sv = 0;
 	setTblValues();
+	chSatObs.reserve(MAXCHANNELS);
 }
 
 /**Constructs a GNSSdataFromOSP object using parameters passed, and logging data into the stderr.
@@ -53,12 +77,22 @@ GNSSdataFromOSP::GNSSdataFromOSP(string rcv, int minxfix, bool applBias, FILE* f
 	minSVSfix = minxfix;
 	applyBias = applBias;
 	ospFile = f;
+	epochGPSweek = 0;
+	epochGPStow = epochClkBias = epochClkDrift = 0.0;
+	epochBufferIdx = 0;
+	singlePass = singlePassGLO = epochTimeRead = false;
+	streamHdAcq = streamGLO = streamAcq = false;
+	ospIndex = NULL;
+	rxIdAcq = false;
+	filePos = 0;
+	endOffset = -1;
 	for (int i=0; i<MAXCHANNELS; i++)
 		for (int j=0; j<MAXSUBFR; j++)
 			subfrmCh[i][j].sv = 0;
 	plog = new Logger();
 	dynamicLog = true;
 	setTblValues();
+	chSatObs.reserve(MAXCHANNELS);
 }
 
 /**Destroys a GNSSdataFromOSP object
@@ -81,47 +115,13 @@ GNSSdataFromOSP::~GNSSdataFromOSP(void) {
  * @return	true if all above described header data are properly extracted, false otherwise
  */
 bool GNSSdataFromOSP::acqHeaderData(RinexData &rinex) {
-	bool rxIdSet = false;	//identification of receiver not set
-	bool apxSet = false;	//approximate position not set
-	bool frsEphSet = false;	//epoch data not received
-	bool intrvBegin = false; //time for the 1st epoch (having correct time) not stated
-	bool intrvSet = false;	//observations interval not set
-	int mid;
+	HeaderAcqState hds;
 	plog->info("RINEX header data acquisition:");
 	while (message.fill(ospFile) &&		//there are messages in the binary file
-			!(apxSet && rxIdSet && frsEphSet && intrvSet)) {	//not all header data have been acquired
-		mid = message.get();		//get first byte (MID)
-		switch(mid) {
-		case 2:		//collect first MID2 data to obtain approximate position (X, Y, Z)
-			if (!apxSet) apxSet = getMID2PosData(rinex);
-			break;
-		case 6:		//extract the software version
-			if (!rxIdSet) rxIdSet = getMID6RxData(rinex);
-			break;
-		case 7:		//computer time interval from two consecutive epochs with correct time data
-			if (frsEphSet) {
-				if (intrvBegin) frsEphSet = intrvBegin = intrvSet = getMID7Interval(rinex);
-				else {
-					frsEphSet = intrvBegin = getMID7TimeData(rinex);
-					rinex.setHdLnData(rinex.TOFO);
-				}
-			}
-			break;
-		case 28:	//epoch data measurements. They precede the MID7 for the epoch
-			frsEphSet = true;
-			break;
-		default:
-			break;
-		}
+			!(hds.apxSet && hds.rxIdSet && hds.frsEphSet && hds.intrvSet)) {	//not all header data have been acquired
+		getHeaderMsgData(message.get(), rinex, hds);
 	}
-	//log data sources available or not
-	string logMessage = "Header data acquired:";
-	logMessage += apxSet? " Aprox. position;" : ";";
-	logMessage += intrvBegin? " 1st epoch time;" : ";";
-	logMessage += intrvSet? " Observation interval;" : ";";
-	logMessage += rxIdSet? " Receiver version" : "";
-	plog->info(logMessage);
-	return (apxSet && intrvBegin && rxIdSet && intrvSet);
+	return logHeaderAcq(hds);
 }
 
 /**acqHeaderData extracts data from the binary OSP file for a RTK file header.
@@ -139,36 +139,19 @@ bool GNSSdataFromOSP::acqHeaderData(RinexData &rinex) {
  * @return true if all above described header data are properly extracted, false otherwise
  */
 bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
-	bool maskSet = false;	//mask data set
-	bool fetSet = false;	//first epoch time set
-	int mid;
+	RTKHeaderAcqState hds;
+	RTKHeaderMsgHandler handler;
 	//acquire mask data and first and last epoch time
 	plog->info("RTK header data acquisition:");
 	while (message.fill(ospFile)) {	//there are messages in the binary file
-		mid = message.get();		//get first byte (MID)
-		switch(mid) {
-		case 2:
-			if (getMID2PosData(rtko)) {
-				if (!fetSet)	{
-					rtko.setStartTime();
-					fetSet = true;
-				}
-				rtko.setEndTime();
-			}
-			break;
-		case 19:	//collect MID19 with masks
-			maskSet = getMID19Masks(rtko);
-			break;
-		default:
-			break;
-		}
+		if ((handler = rtkHeaderHandlers.get(message.get())) != NULL) (this->*handler)(rtko, hds);
 	}
 	//log data sources available or not
 	string logMessage = "Header data adquired:";
-	logMessage += fetSet? "1ts epoch time;" : ";";
-	logMessage += maskSet? "Mask data" : "";
+	logMessage += hds.fetSet? "1ts epoch time;" : ";";
+	logMessage += hds.maskSet? "Mask data" : "";
 	plog->info(logMessage);
-	return maskSet && fetSet;
+	return hds.maskSet && hds.fetSet;
 }
 
 /**acqEpochData extracts observation and time data from binary OSP file messages for a RINEX epoch.
@@ -195,72 +178,10 @@ bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
  * @return true when observation data from an epoch messages have been acquired, false otherwise (End Of File reached)
  */
 bool GNSSdataFromOSP::acqEpochData(RinexData &rinex, bool useMID8G, bool useMID8R) {
-	int mid, ch, sv;
-	bool sameEpoch;
-	double anObservable;
 	while (message.fill(ospFile)) {	//one message has been read from the binary file
-		mid = message.get();		//get first byte (MID) from message
-		switch(mid) {
-		case 7:		//the Rx sends MID7 when position for current epoch is computed (after sending MID28 msgs)
-			if (getMID7TimeData(rinex)) {
-				plog->fine("Epoch " + to_string((long double) epochGPStow) + " sats=" + to_string((long long) chSatObs.size()));
-				if(!chSatObs.empty()) {
-					for (vector<ChannelObs>::iterator it = chSatObs.begin(); it != chSatObs.end(); it++) {
-						//convert observables from the OSP units to RINEX units when necessary
-						//and apply corrections due to clock bias, when requested
-						anObservable = it->psedrng;		//unit are m
-						if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * C1CADJ;
-						rinex.saveObsData(it->system, it->satPrn, "C1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						anObservable = it->carrPh * L1WLINV;	//convert from initial unit (m) to cycles
-						if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * L1CADJ;
-						rinex.saveObsData(it->system, it->satPrn, "L1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						anObservable = it->carrFq * L1WLINV;	//convert from initial unit (m/s) to Hz
-						if (applyBias && (anObservable != 0.0)) anObservable -=  epochClkDrift;
-						rinex.saveObsData(it->system, it->satPrn, "D1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						rinex.saveObsData(it->system, it->satPrn, "S1C", it->signalStrg, it->limitOl, it->strgIdx, it->timeT);
-					}
-					chSatObs.clear();
-					return true;
-				}
-			}
-			break;
-		case 8:		//collect 50BPS ephemerides data in MID8
-			if (useMID8G || useMID8R) {
-				try {
-					//extract channel number an satellite number from the OSP message
-					ch = (int) message.get();
-					if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
-						sv = (int) message.get();	//the satellite number
-						if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
-							if (useMID8G) getMID8GPSNavData(ch, sv, rinex);
-						} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
-							if (useMID8R) getMID8GLONavData(ch, sv, rinex);
-						} else {
-							plog->warning(msgMID8Ign + " satellite number out of GPS, GLONASS ranges:" + to_string((long long) sv));
-						}
-					} else plog->warning(msgMID8Ign + "channel not in range");
-				} catch (int error) {
-					plog->severe(msgMID8Ign + msgEOM + to_string((long long) error));
-				}
-			}
-			break;
-		case 15:	//collect complete GPS ephemerides data in MID15
-			if (!useMID8G) getMID15NavData(rinex);
-			break;
-		case 28:	//collect satellite measurements from a channel in MID28
-			if (getMID28ObsData(rinex, sameEpoch)) {	//message data are correct and have been stored
-				if (!sameEpoch) {	//last data stored belong to a new epoch, and no MID7 has arrived!
-					//as no MID7 has been received, the epoch time is not availble and current epoch observables shall be discarded 
-					plog->warning("Epoch " + to_string((long double)chSatObs[0].timeT) + " ignored: MID7 lost");
-					chSatObs.erase(chSatObs.begin(), chSatObs.end() - 1);
-				}
-			}
-			break;
-		case 70:	//collect complete GLONASS ephemerides data in MID70
-			if (!useMID8R) getMID70NavData(rinex);
-			break;
-		default:
-			break;
+		if (getEpochMsgData(message.get(), rinex, useMID8G, useMID8R)) {
+			saveEpochObs(rinex, epochClkBias, epochClkDrift);
+			return true;
 		}
 	}
 	return false;
@@ -276,87 +197,330 @@ bool GNSSdataFromOSP::acqEpochData(RinexData &rinex, bool useMID8G, bool useMID8
  * @return true if data properly extracted, false otherwise  (End Of File reached)
  */
 bool GNSSdataFromOSP::acqGLOparams() {
-	int mid, ch, sat, strNum, n, nA, hnA;
-	unsigned int gloStrg[3];		//a place to store the 84 bits of the GLONASS nav string
-	vector<GLONASSslot>::iterator itSlot;
-	char txtBuffer[80];
-	bool dataAcq = false;
-
 	rewind(ospFile);
 	plog->info("Acquisition of GLONASS parameters:");
 	try {
 		while (message.fill(ospFile)) {	//a message has been read from the binary file
-			mid = message.get();		//get first byte (MID) from message
-			if (mid == 8) {
-				CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
-				ch = (int) message.get();
-				if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
-					sat = (int) message.get();	//the satellite number
-					if ((sat >= FIRSTGLOSAT) && (sat <= LASTGLOSAT)) {	//it is a GLONASS satellite (in SirfV), extract nav data params needed
-						//get from message payload the GLONASS string and the string number
-						strNum = getGLOstring(gloStrg);
-						switch (strNum) {
-						case 4:
-							//get slot number (n) in string 4, bits 15-11
-							//and store its first occurrence in the table of GLONASS satellites
-							n = getBits(gloStrg, 10, 5);
-							sat -= FIRSTGLOSAT;
-							if (satGLOslt[sat].slot == 0) {	//if this table entry is empty 
-								satGLOslt[sat].rcvCh = ch;
-								satGLOslt[sat].slot = n;
-							}
-							break;
-						case 6:
-						case 8:
-						case 10:
-						case 12:
-						case 14:
-							//get from almanac data the slot number (nA) in bits 77-73 (see GLONASS ICD for details)
-							//and prepare slot - carrier frequency table to receive the value corresponding to this slot (if not already received)
-							nA = getBits(gloStrg, 72, 5);
-							if (nA > 0 && nA <= MAXGLOSLOTS) {
-								nAhnA[ch].nA = nA;
-								nAhnA[ch].strFhnA = strNum + 1;	//set the string number where continuation data should come
-							} else plog->warning("MID8 GLO almanac string " + to_string((long long) strNum) + " bad slot number = " + to_string((long long) nA));
-							break;
-						case 7:
-						case 9:
-						case 11:
-						case 13:
-						case 15:
-							//check in the slot - carrier frequency table the expected string number in this channel
-							//if current string is the expected one to provide the carrier frequency data, store it
-							if (nAhnA[ch].strFhnA == strNum) {
-								hnA = getBits(gloStrg, 9, 5);	//HnA in almanac: bits 14-10
-								if (hnA >= 25) hnA -= 32;	//set negative values as per table 4.11 of the GLONASS ICD
-								carrierFreq[nAhnA[ch].nA - 1] = hnA;
-							}
-							break;
-						default:
-							break;
-
-						}
-					}
-				} else plog->warning(msgMID8Ign + "channel not in range");
+			if (message.get() == 8) getMID8GLOparams(satGLOslt);
+		}
+	} catch (int error) {
+		plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
+		return false;
+	}
+	logGLOparams(satGLOslt);
+	return true;
+}
+
+/**acqAllData acquires in a single pass of the binary OSP file the RINEX header data, the GLONASS parameters (when requested),
+ * and the observation and navigation data of all epochs.
+ *<p>Each message read is processed as acqHeaderData, acqGLOparams and acqEpochData would do in successive passes
+ * over the file, but without rewinding it:
+ * - header data are acquired until all of them are stated, using its own copy of the epoch time being processed
+ * - GLONASS slots and carrier frequency numbers are acquired from all MID8 messages in the file
+ * - epoch observables are stored in a buffer to be got later using getBufferedEpoch
+ *<p>Data depending on values only known when the sweep finishes are kept until then: the observables of GLONASS
+ * satellites whose slot has not been stated, and the GLONASS ephemeris needing the carrier frequency number.
+ * Also MID15 ephemeris received before any MID7 are kept until header data acquisition finishes, to use as
+ * transmission time the same time it would be used after rewinding the file.
+ *<p>Thus data acquired are the same as the ones obtained using the other acquisition methods, but reading the input only once.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ * @param gloParams when true GLONASS parameters are also acquired (as acqGLOparams does)
+ * @return true if all header data are properly extracted, false otherwise
+ */
+bool GNSSdataFromOSP::acqAllData(RinexData &rinex, bool useMID8G, bool useMID8R, bool gloParams) {
+	HeaderAcqState hds;
+	hds.rxIdSet = rxIdAcq;	//it could be acquired before using the OSP index
+	EpochData hdTime;	//the epoch time used for header data acquisition
+	bool hdAcq = true;		//header data acquisition in progress
+	bool gloAcq = gloParams;	//GLONASS parameters acquisition in progress
+	int mid, sv, eFlag;
+	message.discardBlock();	//the file could have been repositioned
+	epochBuffer.clear();
+	epochBufferIdx = 0;
+	pendingEphem.clear();
+	singlePass = true;
+	singlePassGLO = gloParams;
+	epochTimeRead = false;
+	memset(gloFirstSlt, 0, sizeof gloFirstSlt);
+	memset(gloSlotLive, 0, sizeof gloSlotLive);
+	hdTime.week = epochGPSweek;
+	hdTime.tow = epochGPStow;
+	hdTime.clkBias = epochClkBias;
+	hdTime.clkDrift = epochClkDrift;
+	plog->info("RINEX header, GLONASS parameters and epoch data acquisition in a single pass:");
+	while (fillMessage()) {	//a message has been read from the binary file
+		mid = message.get();		//get first byte (MID) from message
+		if (hdAcq) {
+			if (hds.apxSet && hds.rxIdSet && hds.frsEphSet && hds.intrvSet) {
+				//all header data acquired: MID15 ephemeris waiting for time can be saved
+				hdAcq = false;
+				savePendingEphem(rinex, 'G', hdTime.tow);
+			} else {
+				swapEpochTime(hdTime);
+				getHeaderMsgData(mid, rinex, hds);
+				swapEpochTime(hdTime);
+				message.resetCursor(1);
 			}
 		}
-		//log data acquired
-		plog->finer("GLONASS slot numbers used (from string 4 in MID8):");
-		for (int i=0; i<MAXGLOSATS; i++) {
-			sprintf(txtBuffer, "->sv=%2d slot=%2d rxChannel=%2d ", i+FIRSTGLOSAT, satGLOslt[i].slot, satGLOslt[i].rcvCh);
-			plog->finer(string(txtBuffer));
-			dataAcq = true;
+		if (gloAcq && (mid == 8)) {
+			try {
+				getMID8GLOparams(gloFirstSlt);
+			} catch (int error) {
+				plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
+				gloAcq = false;
+			}
+			message.resetCursor(1);
 		}
-		plog->finer("GLONASS carrier frequency numbers (from almanac in MID8):");
-		for (int i = 0; i < MAXGLOSLOTS; i++) {
-			sprintf(txtBuffer, "->slot=%2d frequency=%2d", i+1, carrierFreq[i]);
-			plog->finer(string(txtBuffer));
-			dataAcq = true;
+		if (getEpochMsgData(mid, rinex, useMID8G, useMID8R)) {
+			epochBuffer.push_back(EpochData());
+			epochBuffer.back().week = epochGPSweek;
+			epochBuffer.back().tow = epochGPStow;
+			epochBuffer.back().clkBias = epochClkBias;
+			epochBuffer.back().clkDrift = epochClkDrift;
+			epochBuffer.back().chObs = chSatObs;
+			chSatObs.clear();
 		}
-	} catch (int error) {
-		plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
 	}
-	return  dataAcq;
+	if (hdAcq) savePendingEphem(rinex, 'G', hdTime.tow);
+	if (singlePassGLO) {
+		//state slots of GLONASS observables pending, as they would be after acquiring GLONASS parameters
+		for (vector<EpochData>::iterator itEp = epochBuffer.begin(); itEp != epochBuffer.end(); itEp++)
+			for (vector<int>::iterator it = itEp->chObs.satPrn.begin(); it != itEp->chObs.satPrn.end(); it++)
+				if (*it < 0) {
+					sv = -*it;
+					*it = gloFirstSlt[sv-FIRSTGLOSAT].slot > 0? gloFirstSlt[sv-FIRSTGLOSAT].slot : sv;
+				}
+		if (gloAcq) logGLOparams(gloFirstSlt);
+	}
+	singlePassGLO = false;
+	savePendingEphem(rinex, 'R', 0.0);
+	singlePass = false;
+	//keep current epoch time to restore it after getting buffered epochs
+	rinex.getEpochTime(lastEpoch.week, lastEpoch.tow, lastEpoch.clkBias, eFlag);
+	plog->info("Epochs acquired: " + to_string((long long) epochBuffer.size()));
+	return logHeaderAcq(hds);
+}
+
+/**setIndex states the index of the OSP file to be used by acqIndexedData and setTimeWindow.
+ *
+ * @param pidx a pointer to the index of the OSP file, or NULL if no index shall be used
+ */
+void GNSSdataFromOSP::setIndex(OSPIndex *pidx) {
+	ospIndex = pidx;
+}
+
+/**setTimeWindow limits the single pass acquisition performed by acqAllData to the epochs in the given time window.
+ * Using the OSP file index, the file is positioned at the first message of the first epoch at or after the window start,
+ * and the single pass will finish after the last epoch at or before the window end.
+ * Epochs are selected using the GPS time given by the receiver in its MID7 message.
+ *
+ * @param fromTag the start of the time window, in seconds from the GPS ephemeris (6/1/1980)
+ * @param toTag the end of the time window, in seconds from the GPS ephemeris (6/1/1980)
+ * @return true if the time window has been stated, false otherwise (no index available or positioning error)
+ */
+bool GNSSdataFromOSP::setTimeWindow(double fromTag, double toTag) {
+	if ((ospIndex == NULL) || (fromTag > toTag)) return false;
+	filePos = ospIndex->epochOffset(fromTag);
+	//the window ends with the MID7 of the last epoch not after toTag, that is, just before the first message of next epoch
+	//(MID7 time resolution is 0.01 sec)
+	endOffset = ospIndex->epochOffset(toTag + 0.005);
+	if (FSEEK64(ospFile, filePos, SEEK_SET) != 0) {
+		endOffset = -1;
+		return false;
+	}
+	plog->info("Epochs acquisition limited to OSP file bytes " + to_string(filePos) + " to " + to_string(endOffset));
+	return true;
+}
+
+/**acqIndexedData acquires, using the OSP file index, data from the messages of the whole file which are needed
+ * independently of the epochs to acquire:
+ * - the receiver identification from the first MID6 message
+ * - navigation data from MID8, MID15 and MID70 messages, as acqEpochData does. The transmission time for MID15 ephemeris
+ *	 is the one of the last MID7 preceding the message (or the first MID7 in the file for messages preceding it)
+ * - when requested, GLONASS parameters from MID8 messages, as acqGLOparams does
+ *<p>Only the indexed messages having these MIDs are read from the file.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ * @param gloParams when true GLONASS parameters are also acquired
+ * @return true when data have been acquired, false otherwise (no index available)
+ */
+bool GNSSdataFromOSP::acqIndexedData(RinexData &rinex, bool useMID8G, bool useMID8R, bool gloParams) {
+	int mid;
+	unsigned int nMsgs = 0;
+	int frsWeek = 0;		//the GPS time of the first MID7 in the file
+	double frsTow = 0.0;
+	if (ospIndex == NULL) return false;
+	for (unsigned int n = 0; n < ospIndex->size(); n++) {
+		if (ospIndex->getEntry(n).mid == 7) {
+			frsWeek = ospIndex->getEntry(n).week;
+			frsTow = ospIndex->getEntry(n).tow;
+			break;
+		}
+	}
+	plog->info("Acquisition of navigation data and receiver identification using the OSP index:");
+	for (unsigned int n = 0; n < ospIndex->size(); n++) {
+		const OSPIndex::MsgEntry& entry = ospIndex->getEntry(n);
+		mid = entry.mid;
+		if (((mid == 6) && !rxIdAcq) || (mid == 8) || (mid == 15) || (mid == 70)) {
+			if ((FSEEK64(ospFile, entry.offset, SEEK_SET) != 0) || !message.fill(ospFile)) break;
+			nMsgs++;
+			message.get();		//skip MID
+			if (mid == 6) {
+				rxIdAcq = getMID6RxData(rinex);
+				continue;
+			}
+			if (gloParams && (mid == 8)) {
+				try {
+					getMID8GLOparams(satGLOslt);
+				} catch (int error) {
+					plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
+					gloParams = false;
+				}
+				message.resetCursor(1);
+			}
+			//messages before the first MID7 take its time
+			epochGPSweek = entry.week == 0? frsWeek : entry.week;
+			epochGPStow = entry.week == 0? frsTow : entry.tow;
+			getEpochMsgData(mid, rinex, useMID8G, useMID8R);
+		}
+	}
+	//clear partial navigation data and epoch time to not mix them with data acquired later
+	memset(subfrmCh, 0, sizeof subfrmCh);
+	epochGPSweek = 0;
+	epochGPStow = 0.0;
+	rewind(ospFile);
+	plog->info("Messages read using OSP index: " + to_string((long long) nMsgs));
+	return true;
+}
+
+/**getBufferedEpoch gets the next epoch buffered by acqAllData or acqStreamData and stores its time and observables into the RinexData object.
+ *<p>When all buffered epochs have been got, the epoch time in the RinexData object is restored to the one existing
+ * when acqAllData finished, and the buffer is released. In a streaming acquisition the buffer is only emptied, to be reused.
+ *
+ * @param rinex the RinexData object where epoch data will be placed
+ * @return true when an epoch has been got, false otherwise (no more epochs buffered)
+ */
+bool GNSSdataFromOSP::getBufferedEpoch(RinexData &rinex) {
+	if (epochBufferIdx >= epochBuffer.size()) {
+		if (!epochBuffer.empty()) {
+			if (streamAcq) epochBuffer.clear();
+			else {
+				rinex.setEpochTime(lastEpoch.week, lastEpoch.tow, lastEpoch.clkBias, 0);
+				vector<EpochData>().swap(epochBuffer);
+			}
+			epochBufferIdx = 0;
+		}
+		return false;
+	}
+	EpochData &ed = epochBuffer[epochBufferIdx++];
+	rinex.setEpochTime(ed.week, ed.tow, ed.clkBias, 0);
+	chSatObs.swap(ed.chObs);
+	saveEpochObs(rinex, ed.clkBias, ed.clkDrift);
+	return true;
+}
+
+/**startStreamAcq starts a streaming acquisition, where messages are given one by one to acqStreamData as they are received.
+ *
+ * @param gloParams when true GLONASS parameters are also acquired from MID8 messages received
+ */
+void GNSSdataFromOSP::startStreamAcq(bool gloParams) {
+	streamHds = HeaderAcqState();
+	streamHds.rxIdSet = rxIdAcq;
+	streamHdTime.week = epochGPSweek;
+	streamHdTime.tow = epochGPStow;
+	streamHdTime.clkBias = epochClkBias;
+	streamHdTime.clkDrift = epochClkDrift;
+	streamHdAcq = true;
+	streamGLO = gloParams;
+	streamAcq = true;
+	epochBuffer.clear();
+	epochBufferIdx = 0;
+	pendingEphem.clear();
+	singlePass = true;		//MID15 ephemeris received before any MID7 are kept until header data are acquired
+	singlePassGLO = false;	//GLONASS slots and carrier frequencies are used as they are known
+	epochTimeRead = false;
+	plog->info("RINEX header, navigation and epoch data streaming acquisition:");
+}
+
+/**acqStreamData processes a message received in a streaming acquisition, as acqAllData does for each message read from the file:
+ * - header data are acquired until all of them are stated, using its own copy of the epoch time being processed
+ * - when requested, GLONASS parameters are acquired from MID8 messages
+ * - navigation data are saved into the RinexData object
+ * - when a MID7 closes an epoch, its time and observables are buffered, to be got using getBufferedEpoch
+ *
+ * @param payload the message payload (starting with the MID)
+ * @param length the payload length
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ * @return true when the message has closed an epoch and it has been buffered, false otherwise
+ */
+bool GNSSdataFromOSP::acqStreamData(const unsigned char* payload, unsigned int length, RinexData &rinex, bool useMID8G, bool useMID8R) {
+	int mid;
+	if (!streamAcq || !message.fillFromBuffer(payload, length)) return false;
+	mid = message.get();		//get first byte (MID) from message
+	if (streamHdAcq) {
+		if (streamHeaderAcq()) {
+			//all header data acquired: MID15 ephemeris waiting for time can be saved
+			streamHdAcq = false;
+			savePendingEphem(rinex, 'G', streamHdTime.tow);
+			singlePass = false;
+		} else {
+			swapEpochTime(streamHdTime);
+			getHeaderMsgData(mid, rinex, streamHds);
+			swapEpochTime(streamHdTime);
+			message.resetCursor(1);
+		}
+	}
+	if (streamGLO && (mid == 8)) {
+		try {
+			getMID8GLOparams(satGLOslt);
+		} catch (int error) {
+			plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
+			streamGLO = false;
+		}
+		message.resetCursor(1);
+	}
+	if (getEpochMsgData(mid, rinex, useMID8G, useMID8R)) {
+		epochBuffer.push_back(EpochData());
+		epochBuffer.back().week = epochGPSweek;
+		epochBuffer.back().tow = epochGPStow;
+		epochBuffer.back().clkBias = epochClkBias;
+		epochBuffer.back().clkDrift = epochClkDrift;
+		epochBuffer.back().chObs = chSatObs;
+		chSatObs.clear();
+		return true;
+	}
+	return false;
+}
+
+/**streamHeaderAcq tells if all header data have been acquired in the streaming acquisition.
+ *
+ * @return true if all header data have been acquired, false otherwise
+ */
+bool GNSSdataFromOSP::streamHeaderAcq() {
+	return streamHds.apxSet && streamHds.rxIdSet && streamHds.frsEphSet && streamHds.intrvSet;
+}
+
+/**endStreamAcq finishes the streaming acquisition. Ephemeris pending to be saved are saved, and it is logged
+ * which header data have been acquired or not.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @return true if all header data were acquired, false otherwise
+ */
+bool GNSSdataFromOSP::endStreamAcq(RinexData &rinex) {
+	if (!streamAcq) return false;
+	if (streamHdAcq) savePendingEphem(rinex, 'G', streamHdTime.tow);
+	if (streamGLO) logGLOparams(satGLOslt);
+	streamHdAcq = streamGLO = streamAcq = singlePass = false;
+	epochBuffer.clear();
+	epochBufferIdx = 0;
+	return logHeaderAcq(streamHds);
 }
 
 /**acqEpochData acquires epoch position data from binary OSP file messages for RTK observation files.
@@ -376,13 +540,49 @@ bool GNSSdataFromOSP::acqEpochData(RTKobservation &rtko) {
 	return  false;
 }
 
+/**acqRTKsolution acquires in a single pass of the OSP file the position solution data of the next epoch, and the masks
+ * contained in the MID19 messages found before it.
+ *<p>The OSP file is read in blocks, and only MID2 and MID19 messages are extracted from them. The rest of messages are
+ * skipped using their length, without copying or decoding them.
+ *<p>Note that the RTK header start and end times are not stated: they shall be set from the solutions acquired.
+ *
+ * @param rtko the RTKobservation object where data got from receiver will be placed
+ * @param maskSet it is set to true when mask data have been acquired from a MID19 message. It is not changed otherwise
+ * @return true when solution data from an epoch have been acquired, false otherwise (End Of File reached)
+ */
+bool GNSSdataFromOSP::acqRTKsolution(RTKobservation &rtko, bool &maskSet) {
+	int skipped = 0;
+	bool acquired = false;
+	while (!acquired && message.fillFromBlock(ospFile, rtkMIDs, skipped)) {
+		if (message.get() == 2) acquired = getMID2PosData(rtko);
+		else if (getMID19Masks(rtko)) maskSet = true;
+	}
+	PERF_COUNT("OSP messages skipped", skipped);
+	return acquired;
+}
+
 //PRIVATE METHODS
 //===============
-/**setTblValues set conversion parameter tables used to translate scaled normalized GPS message data to values in actual units.
+/**setTblValues sets to their initial values the tables used to acquire channel data, and the shared tables when not set yet.
  * Called by the construtors
  *
  */
 void GNSSdataFromOSP::setTblValues() {
+	call_once(sharedTablesSet, setSharedTables);
+	//set tables to 0
+	memset(subfrmCh, 0, sizeof subfrmCh);
+	memset(satGLOslt, 0, sizeof satGLOslt);
+	memset(gloFirstSlt, 0, sizeof gloFirstSlt);
+	memset(gloSlotLive, 0, sizeof gloSlotLive);
+	memset(carrierFreq, 0, sizeof carrierFreq);
+	memset(nAhnA, 0, sizeof nAhnA);
+}
+
+/**setSharedTables sets the tables shared by all GNSSdataFromOSP objects: conversion parameter tables used to translate
+ * scaled normalized GPS message data to values in actual units, and the message dispatch tables.
+ * Called only once, by the first object constructed.
+ */
+void GNSSdataFromOSP::setSharedTables() {
 	//SV clock data
 	GPS_SCALEFACTOR[0][0] = pow(2.0, 4.0);		//T0c
 	GPS_SCALEFACTOR[0][1] = pow(2.0, -31.0);	//Af0: SV clock bias
@@ -461,11 +661,419 @@ void GNSSdataFromOSP::setTblValues() {
 	GLO_SCALEFACTOR[3][1] = pow(2.0, -20.0);	//Vel Z
 	GLO_SCALEFACTOR[3][2] = pow(2.0, -30.0);	//Accel Z
 	GLO_SCALEFACTOR[3][3] = 1;					//Age of oper.
-	//set tables to 0
-	memset(subfrmCh, 0, sizeof subfrmCh);
-	memset(satGLOslt, 0, sizeof satGLOslt);
-	memset(carrierFreq, 0, sizeof carrierFreq);
-	memset(nAhnA, 0, sizeof nAhnA);
+	setDispatchTables();
+}
+
+/**setDispatchTables sets the tables used to dispatch messages to their handlers by MID for each kind of acquisition.
+ * Called by setSharedTables. To acquire data from a new message type, its handler shall be added to the related table.
+ */
+void GNSSdataFromOSP::setDispatchTables() {
+	//RINEX header data
+	headerHandlers.set(2, &GNSSdataFromOSP::headerMID2);
+	headerHandlers.set(6, &GNSSdataFromOSP::headerMID6);
+	headerHandlers.set(7, &GNSSdataFromOSP::headerMID7);
+	headerHandlers.set(28, &GNSSdataFromOSP::headerMID28);
+	//RTK header data
+	rtkHeaderHandlers.set(2, &GNSSdataFromOSP::rtkHeaderMID2);
+	rtkHeaderHandlers.set(19, &GNSSdataFromOSP::rtkHeaderMID19);
+	rtkMIDs[2] = rtkMIDs[19] = true;
+	//RINEX epoch and navigation data
+	epochHandlers.set(7, &GNSSdataFromOSP::epochMID7);
+	epochHandlers.set(8, &GNSSdataFromOSP::epochMID8);
+	epochHandlers.set(15, &GNSSdataFromOSP::epochMID15);
+	epochHandlers.set(28, &GNSSdataFromOSP::epochMID28);
+	epochHandlers.set(70, &GNSSdataFromOSP::epochMID70);
+}
+
+/**getHeaderMsgData extracts RINEX header data from the message in buffer, whose MID is given.
+ * It updates the header acquisition state passed with the data acquired.
+ *
+ * @param mid the message identification
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::getHeaderMsgData(int mid, RinexData &rinex, HeaderAcqState &hds) {
+	HeaderMsgHandler handler = headerHandlers.get(mid);
+	if (handler != NULL) (this->*handler)(rinex, hds);
+}
+
+/**headerMID2 collects data from the first MID2 to obtain the approximate position (X, Y, Z) for the RINEX header.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::headerMID2(RinexData &rinex, HeaderAcqState &hds) {
+	if (!hds.apxSet) hds.apxSet = getMID2PosData(rinex);
+}
+
+/**headerMID6 extracts the software version from the first MID6 for the RINEX header.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::headerMID6(RinexData &rinex, HeaderAcqState &hds) {
+	if (!hds.rxIdSet) hds.rxIdSet = getMID6RxData(rinex);
+}
+
+/**headerMID7 gets the time of the first epoch and computes the observation interval from two consecutive MID7 with correct time data.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::headerMID7(RinexData &rinex, HeaderAcqState &hds) {
+	if (hds.frsEphSet) {
+		if (hds.intrvBegin) hds.frsEphSet = hds.intrvBegin = hds.intrvSet = getMID7Interval(rinex);
+		else {
+			hds.frsEphSet = hds.intrvBegin = getMID7TimeData(rinex);
+			rinex.setHdLnData(rinex.TOFO);
+		}
+	}
+}
+
+/**headerMID28 states that epoch data measurements have been received. They precede the MID7 for the epoch.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::headerMID28(RinexData &/*rinex*/, HeaderAcqState &hds) {
+	hds.frsEphSet = true;
+}
+
+/**rtkHeaderMID2 gets from MID2 the time of the first and last computed solution for the RTK header.
+ *
+ * @param rtko the RTKobservation object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::rtkHeaderMID2(RTKobservation &rtko, RTKHeaderAcqState &hds) {
+	if (getMID2PosData(rtko)) {
+		if (!hds.fetSet)	{
+			rtko.setStartTime();
+			hds.fetSet = true;
+		}
+		rtko.setEndTime();
+	}
+}
+
+/**rtkHeaderMID19 collects from MID19 the masks used by the receiver for the RTK header.
+ *
+ * @param rtko the RTKobservation object where data got from receiver will be placed
+ * @param hds the state of the header data acquisition
+ */
+void GNSSdataFromOSP::rtkHeaderMID19(RTKobservation &rtko, RTKHeaderAcqState &hds) {
+	hds.maskSet = getMID19Masks(rtko);
+}
+
+/**logHeaderAcq logs at INFO level a message stating which header data have been acquired or not.
+ *
+ * @param hds the state of the header data acquisition
+ * @return	true if all header data have been acquired, false otherwise
+ */
+bool GNSSdataFromOSP::logHeaderAcq(HeaderAcqState &hds) {
+	string logMessage = "Header data acquired:";
+	logMessage += hds.apxSet? " Aprox. position;" : ";";
+	logMessage += hds.intrvBegin? " 1st epoch time;" : ";";
+	logMessage += hds.intrvSet? " Observation interval;" : ";";
+	logMessage += hds.rxIdSet? " Receiver version" : "";
+	plog->info(logMessage);
+	return (hds.apxSet && hds.intrvBegin && hds.rxIdSet && hds.intrvSet);
+}
+
+/**getMID8GLOparams gets GLONASS parameters from the MID8 message in buffer.
+ * The first occurrence of slot numbers for each satellite is stored in the given table, and carrier frequency
+ * numbers extracted from almanac data are stored in the carrierFreq table.
+ *
+ * @param slots the table where the first occurrence of GLONASS slots will be stored
+ * @throws the integer value 1 when it is intended to get data after the end of payload
+ */
+void GNSSdataFromOSP::getMID8GLOparams(GLONASSslot (&slots)[MAXGLOSATS]) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID8GLOparams");
+	int ch, sat, strNum, n, nA, hnA;
+	unsigned int gloStrg[3];		//a place to store the 84 bits of the GLONASS nav string
+	OSPMID8Data mid8;
+	CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
+	if (!OSPMID8Layout::decode(message, mid8)) throw 1;
+	ch = mid8.channel;
+	if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
+		sat = mid8.sv;	//the satellite number
+		if ((sat >= FIRSTGLOSAT) && (sat <= LASTGLOSAT)) {	//it is a GLONASS satellite (in SirfV), extract nav data params needed
+			//get from message payload the GLONASS string and the string number
+			strNum = getGLOstring(mid8.words, gloStrg);
+			switch (strNum) {
+			case 4:
+				//get slot number (n) in string 4, bits 15-11
+				//and store its first occurrence in the table of GLONASS satellites
+				n = getBits(gloStrg, 10, 5);
+				sat -= FIRSTGLOSAT;
+				if (slots[sat].slot == 0) {	//if this table entry is empty
+					slots[sat].rcvCh = ch;
+					slots[sat].slot = n;
+				}
+				break;
+			case 6:
+			case 8:
+			case 10:
+			case 12:
+			case 14:
+				//get from almanac data the slot number (nA) in bits 77-73 (see GLONASS ICD for details)
+				//and prepare slot - carrier frequency table to receive the value corresponding to this slot (if not already received)
+				nA = getBits(gloStrg, 72, 5);
+				if (nA > 0 && nA <= MAXGLOSLOTS) {
+					nAhnA[ch].nA = nA;
+					nAhnA[ch].strFhnA = strNum + 1;	//set the string number where continuation data should come
+				} else plog->warning("MID8 GLO almanac string " + to_string((long long) strNum) + " bad slot number = " + to_string((long long) nA));
+				break;
+			case 7:
+			case 9:
+			case 11:
+			case 13:
+			case 15:
+				//check in the slot - carrier frequency table the expected string number in this channel
+				//if current string is the expected one to provide the carrier frequency data, store it
+				if (nAhnA[ch].strFhnA == strNum) {
+					hnA = getBits(gloStrg, 9, 5);	//HnA in almanac: bits 14-10
+					if (hnA >= 25) hnA -= 32;	//set negative values as per table 4.11 of the GLONASS ICD
+					carrierFreq[nAhnA[ch].nA - 1] = hnA;
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	} else plog->warning(msgMID8Ign + "channel not in range");
+}
+
+/**logGLOparams logs at FINER level the GLONASS slots and carrier frequency numbers acquired.
+ *
+ * @param slots the table of GLONASS slots to log
+ */
+void GNSSdataFromOSP::logGLOparams(GLONASSslot (&slots)[MAXGLOSATS]) {
+	char txtBuffer[80];
+	plog->finer("GLONASS slot numbers used (from string 4 in MID8):");
+	for (int i=0; i<MAXGLOSATS; i++) {
+		sprintf(txtBuffer, "->sv=%2d slot=%2d rxChannel=%2d ", i+FIRSTGLOSAT, slots[i].slot, slots[i].rcvCh);
+		plog->finer(string(txtBuffer));
+	}
+	plog->finer("GLONASS carrier frequency numbers (from almanac in MID8):");
+	for (int i = 0; i < MAXGLOSLOTS; i++) {
+		sprintf(txtBuffer, "->slot=%2d frequency=%2d", i+1, carrierFreq[i]);
+		plog->finer(string(txtBuffer));
+	}
+}
+
+/**getEpochMsgData extracts epoch data from the message in buffer, whose MID is given.
+ * Observables from MID28 are stored in chSatObs, and navigation data are saved into the RinexData object
+ * (see acqEpochData for details).
+ *
+ * @param mid the message identification
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ * @return true when the message is a valid MID7 ending an epoch with observables in chSatObs, false otherwise
+ */
+bool GNSSdataFromOSP::getEpochMsgData(int mid, RinexData &rinex, bool useMID8G, bool useMID8R) {
+	EpochMsgHandler handler = epochHandlers.get(mid);
+	return (handler != NULL) && (this->*handler)(rinex, useMID8G, useMID8R);
+}
+
+/**epochMID7 gets the epoch time from MID7. The Rx sends MID7 when position for current epoch is computed (after sending MID28 msgs).
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages
+ * @return true when the message is a valid MID7 ending an epoch with observables in chSatObs, false otherwise
+ */
+bool GNSSdataFromOSP::epochMID7(RinexData &rinex, bool /*useMID8G*/, bool /*useMID8R*/) {
+	epochTimeRead = true;
+	if (getMID7TimeData(rinex)) {
+		LOG_FINE(plog, "Epoch " + to_string((long double) epochGPStow) + " sats=" + to_string((long long) chSatObs.size()));
+		if(!chSatObs.empty()) return true;
+	}
+	return false;
+}
+
+/**epochMID8 collects 50BPS ephemerides data in MID8, when navigation data shall be acquired from them.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages
+ * @return false (the message does not end an epoch)
+ */
+bool GNSSdataFromOSP::epochMID8(RinexData &rinex, bool useMID8G, bool useMID8R) {
+	OSPMID8Data mid8;
+	if (!useMID8G && !useMID8R) return false;
+	if (!OSPMID8Layout::decode(message, mid8)) {
+		plog->severe(msgMID8Ign + msgEOM + to_string((long long) message.payloadLen()));
+		return false;
+	}
+	if (mid8.channel>=0 && mid8.channel<MAXCHANNELS) {	//channel in range, continue data extraction
+		if ((mid8.sv >= FIRSTGPSSAT) && (mid8.sv <= LASTGPSSAT)) {
+			if (useMID8G) getMID8GPSNavData(mid8, rinex);
+		} else if ((mid8.sv >= FIRSTGLOSAT) && (mid8.sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
+			if (useMID8R) getMID8GLONavData(mid8, rinex);
+		} else {
+			plog->warning(msgMID8Ign + " satellite number out of GPS, GLONASS ranges:" + to_string((long long) mid8.sv));
+		}
+	} else plog->warning(msgMID8Ign + "channel not in range");
+	return false;
+}
+
+/**epochMID15 collects complete GPS ephemerides data in MID15, when navigation data are not acquired from MID8.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages
+ * @return false (the message does not end an epoch)
+ */
+bool GNSSdataFromOSP::epochMID15(RinexData &rinex, bool useMID8G, bool /*useMID8R*/) {
+	if (!useMID8G) getMID15NavData(rinex);
+	return false;
+}
+
+/**epochMID28 collects satellite measurements from a channel in MID28.
+ * If measurements belong to a new epoch and no MID7 has arrived, the observables of the former epoch are discarded.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages
+ * @return false (the message does not end an epoch)
+ */
+bool GNSSdataFromOSP::epochMID28(RinexData &rinex, bool /*useMID8G*/, bool /*useMID8R*/) {
+	bool sameEpoch;
+	if (getMID28ObsData(rinex, sameEpoch)) {	//message data are correct and have been stored
+		if (!sameEpoch) {	//last data stored belong to a new epoch, and no MID7 has arrived!
+			//as no MID7 has been received, the epoch time is not availble and current epoch observables shall be discarded
+			plog->warning("Epoch " + to_string((long double)chSatObs.timeT[0]) + " ignored: MID7 lost");
+			chSatObs.eraseAllButLast();
+		}
+	}
+	return false;
+}
+
+/**epochMID70 collects complete GLONASS ephemerides data in MID70, when navigation data are not acquired from MID8.
+ *
+ * @param rinex the RinexData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages
+ * @return false (the message does not end an epoch)
+ */
+bool GNSSdataFromOSP::epochMID70(RinexData &rinex, bool /*useMID8G*/, bool useMID8R) {
+	if (!useMID8R) getMID70NavData(rinex);
+	return false;
+}
+
+/**saveEpochObs saves the observables in chSatObs into the RinexData object, and clears chSatObs.
+ * Observables are converted from the OSP units to RINEX units when necessary, and corrections due to
+ * clock bias and drift are applied, when requested.
+ * Conversion and correction are made for all channels at once, column by column, using loops without branches
+ * that the compiler can vectorize. The resulting columns are saved at once using RinexData::saveObsColumns.
+ *
+ * @param rinex the RinexData object where observables will be saved
+ * @param clkBias the receiver clock bias for the epoch
+ * @param clkDrift the receiver clock drift for the epoch
+ */
+void GNSSdataFromOSP::saveEpochObs(RinexData &rinex, double clkBias, double clkDrift) {
+	PERF_SCOPE("GNSSdataFromOSP::saveEpochObs");
+	static const string obsNames[4] = {"C1C", "L1C", "D1C", "S1C"};	//the observables saved: the ones in obsColumns and S1C
+	unsigned int n = chSatObs.size();
+	//the corrections to apply to non zero values (none when bias shall not be applied)
+	double psrBias = applyBias? clkBias * C1CADJ : 0.0;
+	double phBias = applyBias? clkBias * L1CADJ : 0.0;
+	double fqBias = applyBias? clkDrift : 0.0;
+	for (int i=0; i<3; i++) obsColumns[i].resize(n);
+	double* c1c = obsColumns[0].data();
+	double* l1c = obsColumns[1].data();
+	double* d1c = obsColumns[2].data();
+	const double* psr = chSatObs.psedrng.data();
+	const double* cph = chSatObs.carrPh.data();
+	const double* cfq = chSatObs.carrFq.data();
+	for (unsigned int i = 0; i < n; i++) c1c[i] = psr[i] - (psr[i] != 0.0? psrBias : 0.0);	//unit are m
+	for (unsigned int i = 0; i < n; i++) l1c[i] = cph[i] * L1WLINV;	//convert from initial unit (m) to cycles
+	for (unsigned int i = 0; i < n; i++) l1c[i] -= l1c[i] != 0.0? phBias : 0.0;
+	for (unsigned int i = 0; i < n; i++) d1c[i] = cfq[i] * L1WLINV;	//convert from initial unit (m/s) to Hz
+	for (unsigned int i = 0; i < n; i++) d1c[i] -= d1c[i] != 0.0? fqBias : 0.0;
+	const double* values[4] = {c1c, l1c, d1c, chSatObs.signalStrg.data()};
+	rinex.saveObsColumns(n, chSatObs.system.data(), chSatObs.satPrn.data(), chSatObs.limitOl.data(), chSatObs.strgIdx.data(),
+		chSatObs.timeT.data(), 4, obsNames, values);
+	chSatObs.clear();
+}
+
+/**swapEpochTime swaps the current epoch time data (week, tow, clock bias and drift) with the given ones.
+ * It allows to keep separated epoch time data for header and epoch acquisition during a single pass.
+ *
+ * @param ed the epoch time data to swap
+ */
+void GNSSdataFromOSP::swapEpochTime(EpochData &ed) {
+	swap(epochGPSweek, ed.week);
+	swap(epochGPStow, ed.tow);
+	swap(epochClkBias, ed.clkBias);
+	swap(epochClkDrift, ed.clkDrift);
+}
+
+/**saveGLOEphemeris sets the carrier frequency number in the given GLONASS ephemeris mantissas, scales them and saves the resulting ephemeris.
+ * When GLONASS parameters are being acquired in a single pass, carrier frequencies are only known at the end of the sweep,
+ * and ephemeris are kept pending until then.
+ *
+ * @param rinex the RinexData object where ephemeris will be saved
+ * @param sat the satellite (slot) number
+ * @param tTag the time tag for ephemeris data
+ * @param bom the broadcast orbit mantissas
+ * @param frqLin the line in bom where the carrier frequency number shall be placed
+ * @param frqCol the column in bom where the carrier frequency number shall be placed
+ */
+void GNSSdataFromOSP::saveGLOEphemeris(RinexData &rinex, unsigned int sat, double tTag, int (&bom)[8][4], int frqLin, int frqCol) {
+	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris
+	if (singlePassGLO) {
+		pendingEphem.push_back(PendingEphem());
+		pendingEphem.back().sys = 'R';
+		pendingEphem.back().sat = sat;
+		pendingEphem.back().tTag = tTag;
+		memcpy(pendingEphem.back().bom, bom, sizeof bom);
+		pendingEphem.back().frqLin = frqLin;
+		pendingEphem.back().frqCol = frqCol;
+		return;
+	}
+	bom[frqLin][frqCol] = carrierFreq[sat-1];
+	scaleGLOEphemeris(bom, bo);
+	rinex.saveNavData('R', sat, bo, tTag);
+}
+
+/**savePendingEphem completes and saves the pending ephemeris of the given system kept during a single pass acquisition.
+ * For GPS, the given time of week is used as transmission time. For GLONASS, the carrier frequency number acquired is set.
+ *
+ * @param rinex the RinexData object where ephemeris will be saved
+ * @param sys the system of ephemeris to save
+ * @param tow the GPS time of week to be used as transmission time (GPS only)
+ */
+void GNSSdataFromOSP::savePendingEphem(RinexData &rinex, char sys, double tow) {
+	double tTag;		//the time tag for ephemeris data
+	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris
+	vector<PendingEphem>::iterator it = pendingEphem.begin();
+	while (it != pendingEphem.end()) {
+		if (it->sys == sys) {
+			if (sys == 'G') {
+				it->bom[7][0] = (int) (tow * 100.0);
+				scaleGPSEphemeris(it->bom, tTag, bo);
+				rinex.saveNavData('G', it->sat, bo, tTag);
+			} else {
+				it->bom[it->frqLin][it->frqCol] = carrierFreq[it->sat-1];
+				scaleGLOEphemeris(it->bom, bo);
+				rinex.saveNavData('R', it->sat, bo, it->tTag);
+			}
+			it = pendingEphem.erase(it);
+		} else it++;
+	}
+}
+
+/**fillMessage fills the message buffer with the next message in the OSP file, if the end of the time window
+ * stated for the single pass acquisition has not been reached.
+ *
+ * @return true when a message was correctly read, false otherwise (read error, end of file or end of time window reached)
+ */
+bool GNSSdataFromOSP::fillMessage() {
+	if ((endOffset >= 0) && (filePos >= endOffset)) return false;
+	if (!message.fillFromBlock(ospFile)) return false;
+	filePos += message.payloadLen() + 2;
+	return true;
 }
 
 /**getMID2PosData gets position solution data from a MID2 message and store them into "APPROX POSITION XYZ" record of a RinexData object.
@@ -474,6 +1082,7 @@ void GNSSdataFromOSP::setTblValues() {
  *@return true if data properly extracted (correct message length and satellites in solution greather than minimum), false otherwise
  */
 bool GNSSdataFromOSP::getMID2PosData(RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID2PosData");
 	float x, y, z;
 	int nsv;
 	bool status;
@@ -492,6 +1101,7 @@ bool GNSSdataFromOSP::getMID2PosData(RinexData &rinex) {
  *@return true if data properly extracted (correct message length and satellites in solution greather than minimum), false otherwise
  */
 bool GNSSdataFromOSP::getMID2PosData(RTKobservation &rtko) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID2PosData");
 	float x, y, z;
 	int nsv;
 	bool status;
@@ -511,24 +1121,23 @@ bool GNSSdataFromOSP::getMID2PosData(RTKobservation &rtko) {
  */
 bool GNSSdataFromOSP::getMID2xyz(float &x, float &y, float &z, int &nsv) {
 	char msgBuf[100];
+	OSPMID2Data mid2;
 	CHECK_PAYLOADLEN(41,"MID2 msg len <> 41")
-	//extract X, Y, Z for the rinex header
-	try {
-		x = (float) message.getInt();	//get X
-		y = (float) message.getInt();	//get Y
-		z = (float) message.getInt();	//get Z
-		message.skipBytes(9);	//skip from vX to Mode2: 3*2S 3*1U
-		epochGPSweek = (int) message.getUShort() + 1024;
-		epochGPStow = (double) message.getInt() / 100.0;	//get GPS TOW (scaled by 100)
-		//check if fix has the minimum SVs required
-		nsv = message.get();
-		CHECK_SATSREQUIRED(nsv, "MID2" + msgFew)
-		sprintf(msgBuf, "MID2 tow=%g x=%g y=%g z=%g", epochGPStow, x, y, z);
-		plog->finer(string(msgBuf));
-	} catch (int error) {
-		plog->severe("MID2 " + msgEOM + to_string((long long) error));
+	if (!OSPMID2Layout::decode(message, mid2)) {
+		plog->severe("MID2 " + msgEOM + to_string((long long) message.payloadLen()));
 		return false;
 	}
+	//get X, Y, Z for the rinex header
+	x = (float) mid2.x;
+	y = (float) mid2.y;
+	z = (float) mid2.z;
+	epochGPSweek = (int) mid2.week + 1024;
+	epochGPStow = (double) mid2.tow / 100.0;	//GPS TOW is scaled by 100
+	//check if fix has the minimum SVs required
+	nsv = mid2.svs;
+	CHECK_SATSREQUIRED(nsv, "MID2" + msgFew)
+	sprintf(msgBuf, "MID2 tow=%g x=%g y=%g z=%g", epochGPStow, x, y, z);
+	plog->finer(string(msgBuf));
 	return true;
 }
 
@@ -539,6 +1148,7 @@ bool GNSSdataFromOSP::getMID2xyz(float &x, float &y, float &z, int &nsv) {
  *@return true if data properly extracted, false otherwise
  */
 bool GNSSdataFromOSP::getMID6RxData(RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID6RxData");
 	//Note: current structure of this message does not correspond with what is stated in ICD
 	string swVersion;
 	string swCustomer;
@@ -580,26 +1190,27 @@ bool GNSSdataFromOSP::getMID6RxData(RinexData &rinex) {
  * @return true if data properly extracted (correct message length and satellites in solution greather than minimum), false otherwise
  */
 bool GNSSdataFromOSP::getMID7TimeData(RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID7TimeData");
 	int sats;
 	char msgBuf[100];
+	OSPMID7Data mid7;
 	CHECK_PAYLOADLEN(20,"MID7 msg len <> 20")
-	try {
-		epochGPSweek = (int) message.getUShort();	//get GPS Week (includes rollover)
-		epochGPStow = (double) message.getUInt();	//get GPS TOW
-		epochGPStow /= 100.0;	//... is scaled by 100
-		sats = (int) message.get();			//get number of satellites in the solution
-		CHECK_SATSREQUIRED(sats, "MID7" + msgFew)
-		epochClkDrift = (double) message.getUInt();	//get receiver clock drift (change rate of bias in Hz)
-		//get receiver clock bias in nanoseconds (unsigned 32 bits int) and convert to seconds
-		epochClkBias = (double) message.getUInt() * 1.0e-9;
-		if (!applyBias) {
-			epochGPStow += epochClkBias;
-			epochClkBias = 0.0;
-		}
-	} catch (int error) {
-		plog->severe("MID7TimeData" + msgEOM + to_string((long long) error));
+	if (!OSPMID7Layout::decode(message, mid7)) {
+		plog->severe("MID7TimeData" + msgEOM + to_string((long long) message.payloadLen()));
 		return false;
 	}
+	epochGPSweek = (int) mid7.week;	//GPS Week (includes rollover)
+	epochGPStow = (double) mid7.tow;	//GPS TOW
+	epochGPStow /= 100.0;	//... is scaled by 100
+	sats = mid7.svs;			//number of satellites in the solution
+	CHECK_SATSREQUIRED(sats, "MID7" + msgFew)
+	epochClkDrift = (double) mid7.drift;	//receiver clock drift (change rate of bias in Hz)
+	//receiver clock bias in nanoseconds (unsigned 32 bits int) converted to seconds
+	epochClkBias = (double) mid7.bias * 1.0e-9;
+	if (!applyBias) {
+		epochGPStow += epochClkBias;
+		epochClkBias = 0.0;
+	}
 	rinex.setEpochTime(epochGPSweek, epochGPStow, epochClkBias, 0);
 	sprintf(msgBuf, "MID7 time week=%d tow=%g bias=%g", epochGPSweek, epochGPStow, epochClkBias);
 	plog->finer(string(msgBuf));
@@ -612,21 +1223,24 @@ bool GNSSdataFromOSP::getMID7TimeData(RinexData &rinex) {
  * @return true if data properly extracted (correct message length and satellites in solution greather than minimum), false otherwise
  */
 bool GNSSdataFromOSP::getMID7Interval(RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID7Interval");
 	int week, sats;
 	double tow, interval;
 	char msgBuf[100];
+	OSPMID7Data mid7;
 	CHECK_PAYLOADLEN(20,"MID7 msg len <> 20")
+	if (!OSPMID7Layout::decode(message, mid7)) {
+		plog->severe("MID7interval" + msgEOM + to_string((long long) message.payloadLen()));
+		return false;
+	}
 	try {
-		week = (int) message.getUShort();	//get GPS Week (includes rollover)
-		tow = (double) message.getUInt();	//get GPS TOW
+		week = (int) mid7.week;	//GPS Week (includes rollover)
+		tow = (double) mid7.tow;	//GPS TOW
 		tow /= 100.0;	//.. is scaled by 100)
-		sats = (int) message.get();			//get number of satellites in the solution
+		sats = mid7.svs;			//number of satellites in the solution
 		CHECK_SATSREQUIRED(sats, "MID7" + msgFew)
 		interval = tow - epochGPStow + (double) ((week - epochGPSweek) * 604800.0);
 		rinex.setHdLnData(rinex.INT, interval);
-	} catch (int error) {
-		plog->severe("MID7interval" + msgEOM + to_string((long long) error));
-		return false;
 	} catch (string error) {
 		plog->severe(error + " in getMID7interval");
 		return false;
@@ -638,146 +1252,133 @@ bool GNSSdataFromOSP::getMID7Interval(RinexData &rinex) {
 
 /**getMID8GPSNavData gets GPS navigation data from a MID 8 message and store them into satellite ephemeris (bradcast orbit data) of the RinexData object.
  * 
- * @param ch	the receiver channel number providing data
- * @param sv	the satellite number given by the receiver
+ * @param mid8	the MID8 data decoded: receiver channel number, satellite number given by the receiver and navigation message words
  * @param rinex	the class instance where data are stored
  * @return true if data properly extracted (correct message length, channel number in range, and correct parity in navigation data), false otherwise
  */
-bool GNSSdataFromOSP::getMID8GPSNavData(int ch, int sv, RinexData &rinex) {
+bool GNSSdataFromOSP::getMID8GPSNavData(const OSPMID8Data &mid8, RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID8GPSNavData");
 	CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
+	int ch = mid8.channel;
+	int sv = mid8.sv;
 	unsigned int wd[10];	//a place to store the ten words of OSP message
 	unsigned int navW[45];	//a place to pack message data as per MID 15 (see SiRF ICD)
 	unsigned int sat;		//the satellite number in the satellite navigation message
 	int bom[8][4];		//the RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
 	double tTag;		//the time tag for ephemeris data
 	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris
-	bool parityOK;
 	unsigned int subfrmID, pgID;
 	char msgBuf[100];
-	try {
-		//read ten words with navigation data from the OSP message. Bits in each 32 bits word are: D29 D30 d1 d2 ... d30
-		//that is: two last parity bits from previous word followed by the 30 bits of the current word
-		for (int i=0; i<10; i++) wd[i] = message.getUInt();
-		//check parity of each subframe word
-		parityOK = checkGPSparity(wd[0]);
-		for (int i=1; parityOK && i<10; i++) parityOK &= checkGPSparity(wd[i]);
-		//if parity not OK, ignore all subframe data and return
-		if (!parityOK) {
-			plog->warning(msgMID8Ign + "GPS wrong parity");
-			return false;
-		}
-		//remove parity from each GPS word getting the useful 24 bits
-		//Note that when D30 is set, data bits are complemented (a non documented SiRF OSP feature)
-		for (int i=0; i<10; i++)
-			if ((wd[i] & 0x40000000) == 0) wd[i] = (wd[i]>>6) & 0xFFFFFF;
-			else wd[i] = ~(wd[i]>>6) & 0xFFFFFF;
-		//get subframe and page identification (page identification valid only for subframes 4 & 5)
-		subfrmID = (wd[1]>>2) & 0x07;
-		pgID = (wd[2]>>16) & 0x3F;
-		sprintf(msgBuf, "MID8 GPS ch=%d sv=%d subfrm=%d page=%d", ch, sv, subfrmID, pgID);
-		plog->finer(string(msgBuf));
-		//only have interest subframes: 1,2,3 & page 18 of subframe 4 (pgID = 56 in GPS ICD Table 20-V)
-		if ((subfrmID>0 && subfrmID<4) || (subfrmID==4 && pgID==56)) {
-			subfrmID--;		//convert it to its index
-			//store satellite number and message words
-			subfrmCh[ch][subfrmID].sv = sv;
-			for (int i=0; i<10; i++) subfrmCh[ch][subfrmID].words[i] = wd[i];
-			//check if all ephemerides have been already received
-			if (allGPSEphemReceived(ch)) {
-				//if all 3 frames received , pack their data as per MID 15 (see SiRF ICD)
-				for (int i=0; i<3; i++) {	//for each subframe index 0, 1, 2
-					for (int j=0; j<5; j++) { //for each 2 WORDs group
-						navW[i*15+j*3] = (subfrmCh[ch][i].words[j*2]>>8) & 0xFFFF;
-						navW[i*15+j*3+1] = ((subfrmCh[ch][i].words[j*2] & 0xFF)<<8) | ((subfrmCh[ch][i].words[j*2+1]>>16) & 0xFF);
-						navW[i*15+j*3+2] = subfrmCh[ch][i].words[j*2+1] & 0xFFFF;
-					}
-					//the exception is WORD1 (TLM word) of each subframe, whose data are not needed
-					navW[i*15] = sv;
-					navW[i*15+1] &= 0xFF;
-				}
-				//extract ephemeris data and store them into the RINEX instance
-				if (extractGPSEphemeris(navW, sat, bom)) {
-					scaleGPSEphemeris(bom, tTag, bo);
-					rinex.saveNavData('G', sat, bo, tTag);
+	//the ten words with navigation data from the OSP message. Bits in each 32 bits word are: D29 D30 d1 d2 ... d30
+	//that is: two last parity bits from previous word followed by the 30 bits of the current word
+	memcpy(wd, mid8.words, sizeof wd);
+	//check parity of each subframe word. If parity not OK, ignore all subframe data and return
+	if (checkGPSsubframe(wd) != 0) {
+		plog->warning(msgMID8Ign + "GPS wrong parity");
+		return false;
+	}
+	//remove parity from each GPS word getting the useful 24 bits
+	//Note that when D30 is set, data bits are complemented (a non documented SiRF OSP feature)
+	for (int i=0; i<10; i++)
+		if ((wd[i] & 0x40000000) == 0) wd[i] = (wd[i]>>6) & 0xFFFFFF;
+		else wd[i] = ~(wd[i]>>6) & 0xFFFFFF;
+	//get subframe and page identification (page identification valid only for subframes 4 & 5)
+	subfrmID = (wd[1]>>2) & 0x07;
+	pgID = (wd[2]>>16) & 0x3F;
+	sprintf(msgBuf, "MID8 GPS ch=%d sv=%d subfrm=%d page=%d", ch, sv, subfrmID, pgID);
+	plog->finer(string(msgBuf));
+	//only have interest subframes: 1,2,3 & page 18 of subframe 4 (pgID = 56 in GPS ICD Table 20-V)
+	if ((subfrmID>0 && subfrmID<4) || (subfrmID==4 && pgID==56)) {
+		subfrmID--;		//convert it to its index
+		//store satellite number and message words
+		subfrmCh[ch][subfrmID].sv = sv;
+		for (int i=0; i<10; i++) subfrmCh[ch][subfrmID].words[i] = wd[i];
+		//check if all ephemerides have been already received
+		if (allGPSEphemReceived(ch)) {
+			//if all 3 frames received , pack their data as per MID 15 (see SiRF ICD)
+			for (int i=0; i<3; i++) {	//for each subframe index 0, 1, 2
+				for (int j=0; j<5; j++) { //for each 2 WORDs group
+					navW[i*15+j*3] = (subfrmCh[ch][i].words[j*2]>>8) & 0xFFFF;
+					navW[i*15+j*3+1] = ((subfrmCh[ch][i].words[j*2] & 0xFF)<<8) | ((subfrmCh[ch][i].words[j*2+1]>>16) & 0xFF);
+					navW[i*15+j*3+2] = subfrmCh[ch][i].words[j*2+1] & 0xFFFF;
 				}
-				//TBW check if iono data exist & extract and store iono data in subfrmCh[ch][3]
-				//clear storage
-				for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
+				//the exception is WORD1 (TLM word) of each subframe, whose data are not needed
+				navW[i*15] = sv;
+				navW[i*15+1] &= 0xFF;
+			}
+			//extract ephemeris data and store them into the RINEX instance
+			if (extractGPSEphemeris(navW, sat, bom)) {
+				scaleGPSEphemeris(bom, tTag, bo);
+				rinex.saveNavData('G', sat, bo, tTag);
 			}
+			//TBW check if iono data exist & extract and store iono data in subfrmCh[ch][3]
+			//clear storage
+			for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
 		}
-	} catch (int error) {
-		plog->severe("MID8" + msgEOM + to_string((long long) error));
-		return false;
 	}
 	return true;
 }
 
 /**getMID8GLONavData gets GLONASS navigation data from a MID 8 message and store them into satellite ephemeris (bradcast orbit data) of the RinexData object.
  * 
- * @param ch	the receiver channel number providing data
- * @param sv	the satellite number given by the receiver
+ * @param mid8	the MID8 data decoded: receiver channel number, satellite number given by the receiver and navigation message words
  * @param rinex	the class instance where data are stored
  * @return true if data properly extracted (correct message length, channel number in range, and correct parity in navigation data), false otherwise
  */
-bool GNSSdataFromOSP::getMID8GLONavData(int ch, int sv, RinexData &rinex) {
+bool GNSSdataFromOSP::getMID8GLONavData(const OSPMID8Data &mid8, RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID8GLONavData");
 	CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
+	int ch = mid8.channel;
+	int sv = mid8.sv;
 	int sltNum, svx;				//the slot number (n) extracted from from string 4
 	double tTag;			//the time tag for ephemeris data
 	unsigned int gloStrg[3];//a place to store the 84 bits of a GLONASS string
 	int bom[8][4];			//the RINEX broadcats orbit like arrangement for satellite ephemeris mantissa (as extracted from nav message)
-	double bo[8][4];		//the RINEX broadcats orbit arrangement for satellite ephemeris (after applying scale factors)
 	unsigned int strNum;	//the GLONASS string number
 	string msgTxt;			//a place to build log messages
 	unsigned int sat = sv;	//the satellite number in the satellite navigation message (slot number for GLONASS). Initially the one given by the receiver
-	try {
-		//get from message payload the GLONASS string and the string number
-		strNum = getGLOstring(gloStrg);
-		if (!checkGLOhamming (gloStrg)) {
-			plog->warning(msgMID8Ign + "GLONASS wrong Hamming code");
-			return false;
-		}
-		msgTxt = "MID8 GLONASS ch=" + to_string((long long) ch) + " sv=" + to_string((long long) sv) + " str=" + to_string((long long) strNum);
-		//store satellite number and message words with inmediate data (strings # 1 to 5)
-		if ((strNum > 0) && (strNum <= MAXSUBFR)) {
-			//if string received is 4, it could be necessary to update inmediately the slot number
-			if (strNum == 4) {
-				//get slot number (n) in string 4, bits 15-11 and update the table of GLONASS satellites
-				sltNum = getBits(gloStrg, 10, 5);
-				if ((sltNum >= 0) && (sltNum <= MAXGLOSATS)) {
-					svx = sv - FIRSTGLOSAT;
-					if (satGLOslt[svx].slot != sltNum) {
-						plog->finer(msgTxt
-							+ " slot=" + to_string((long long) satGLOslt[svx].slot)
-							+ " updated to slot=" + to_string((long long) sltNum));
-						satGLOslt[svx].rcvCh = ch;
-						satGLOslt[svx].slot = sltNum;
-					}
-				} else {
-					msgTxt += " wrong slot=" + to_string((long long) sltNum); 
-				}
-			}
-			strNum--;		//convert string number to its index
-			//store satellite number and message words
-			subfrmCh[ch][strNum].sv = sv;
-			for (int i=0; i<3; i++) subfrmCh[ch][strNum].words[i] = gloStrg[i];
-			for (int i=3; i<10; i++) subfrmCh[ch][strNum].words[i] = 0;
-			//check if all ephemerides have been already received
-			msgTxt += " saved";
-			if (allGLOEphemReceived(ch)) {
-				//extract ephemeris data and store them into the RINEX instance
-				if (extractGLOEphemeris(ch, sat, tTag, bom)) {
-					scaleGLOEphemeris(bom, bo);
-					rinex.saveNavData('R', sat, bo, tTag);
-				}
-				//clear storage
-				for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
-			}
-		} else msgTxt += " ignored";
-		plog->finer(msgTxt);
-	} catch (int error) {
-		plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
+	//get from message payload the GLONASS string and the string number
+	strNum = getGLOstring(mid8.words, gloStrg);
+	if (!checkGLOhamming (gloStrg)) {
+		plog->warning(msgMID8Ign + "GLONASS wrong Hamming code");
 		return false;
 	}
+	msgTxt = "MID8 GLONASS ch=" + to_string((long long) ch) + " sv=" + to_string((long long) sv) + " str=" + to_string((long long) strNum);
+	//store satellite number and message words with inmediate data (strings # 1 to 5)
+	if ((strNum > 0) && (strNum <= MAXSUBFR)) {
+		//if string received is 4, it could be necessary to update inmediately the slot number
+		if (strNum == 4) {
+			//get slot number (n) in string 4, bits 15-11 and update the table of GLONASS satellites
+			sltNum = getBits(gloStrg, 10, 5);
+			if ((sltNum >= 0) && (sltNum <= MAXGLOSATS)) {
+				svx = sv - FIRSTGLOSAT;
+				gloSlotLive[svx] = true;
+				if (satGLOslt[svx].slot != sltNum) {
+					plog->finer(msgTxt
+						+ " slot=" + to_string((long long) satGLOslt[svx].slot)
+						+ " updated to slot=" + to_string((long long) sltNum));
+					satGLOslt[svx].rcvCh = ch;
+					satGLOslt[svx].slot = sltNum;
+				}
+			} else {
+				msgTxt += " wrong slot=" + to_string((long long) sltNum); 
+			}
+		}
+		strNum--;		//convert string number to its index
+		//store satellite number and message words
+		subfrmCh[ch][strNum].sv = sv;
+		for (int i=0; i<3; i++) subfrmCh[ch][strNum].words[i] = gloStrg[i];
+		for (int i=3; i<10; i++) subfrmCh[ch][strNum].words[i] = 0;
+		//check if all ephemerides have been already received
+		msgTxt += " saved";
+		if (allGLOEphemReceived(ch)) {
+			//extract ephemeris data and store them into the RINEX instance
+			if (extractGLOEphemeris(ch, sat, tTag, bom)) saveGLOEphemeris(rinex, sat, tTag, bom, 2, 3);
+			//clear storage
+			for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
+		}
+	} else msgTxt += " ignored";
+	plog->finer(msgTxt);
 	return true;
 }
 
@@ -787,35 +1388,42 @@ bool GNSSdataFromOSP::getMID8GLONavData(int ch, int sv, RinexData &rinex) {
  * @return if data properly extracted (correct message length), false otherwise
  */
 bool GNSSdataFromOSP::getMID15NavData(RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID15NavData");
 	CHECK_PAYLOADLEN(92,"MID15 msg len <> 92")
 	unsigned int navW[45];		//to store the 3x15 data items in the message
 	unsigned int sat;		//the satellite number in the satellite navigation message
 	int bom[8][4];		//the RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
 	double tTag;		//the time tag for ephemeris data
 	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris
-	int svID;
+	OSPMID15Data mid15;
 	string msgMID ("MID15 GPS ephemeris sv="); 
-	try {
-		svID = (int) message.get();
-		msgMID += to_string((long long) svID);
-		for (int i=0; i<45; i++) navW[i] = (unsigned int) message.getUShort();
-		//set HOW bits in navW[1] and navW[2] to 0 (MID15 does not provide data from HOW)
-		navW[1] &= 0xFF00;
-		navW[2] &= 0x0003;
-		//extract ephemerides data and store them into the RINEX instance
-		if (!extractGPSEphemeris(navW, sat, bom)) {
-			plog->warning(msgMID + " Wrong data");
-			return false;
-		}
-		plog->finer(msgMID + " Ephemeris OK");
-		//set bom[7][0] (MID15 has no HOW data) with current GPS seconds scaled by 100 as transmission time
-		bom[7][0] = (int) (epochGPStow * 100.0);
-		scaleGPSEphemeris(bom, tTag, bo);
-		rinex.saveNavData('G', sat, bo, tTag);
-	} catch (int error) {
-		plog->severe("MID15" + msgEOM + to_string((long long) error));
+	if (!OSPMID15Layout::decode(message, mid15)) {
+		plog->severe("MID15" + msgEOM + to_string((long long) message.payloadLen()));
 		return false;
 	}
+	msgMID += to_string((long long) mid15.sv);
+	memcpy(navW, mid15.navW, sizeof navW);
+	//set HOW bits in navW[1] and navW[2] to 0 (MID15 does not provide data from HOW)
+	navW[1] &= 0xFF00;
+	navW[2] &= 0x0003;
+	//extract ephemerides data and store them into the RINEX instance
+	if (!extractGPSEphemeris(navW, sat, bom)) {
+		plog->warning(msgMID + " Wrong data");
+		return false;
+	}
+	LOG_FINER(plog, msgMID + " Ephemeris OK");
+	if (singlePass && !epochTimeRead) {
+		//in a single pass, before any MID7 the transmission time is stated when header data acquisition finishes
+		pendingEphem.push_back(PendingEphem());
+		pendingEphem.back().sys = 'G';
+		pendingEphem.back().sat = sat;
+		memcpy(pendingEphem.back().bom, bom, sizeof bom);
+		return true;
+	}
+	//set bom[7][0] (MID15 has no HOW data) with current GPS seconds scaled by 100 as transmission time
+	bom[7][0] = (int) (epochGPStow * 100.0);
+	scaleGPSEphemeris(bom, tTag, bo);
+	rinex.saveNavData('G', sat, bo, tTag);
 	return true;
 }
 
@@ -825,18 +1433,18 @@ bool GNSSdataFromOSP::getMID15NavData(RinexData &rinex) {
  * @return true if data properly extracted (correct message length), false otherwise
  */
 bool GNSSdataFromOSP::getMID19Masks(RTKobservation &rtko) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID19Masks");
 	CHECK_PAYLOADLEN(65,"MID19 msg len <> 65")
 	double elevationMask;
 	double snrMask;
-	try {
-		message.skipBytes(19);	//skip from SubID to DOPmask: 1U 2U 3*1U 2S 6*1U 4U 1U
-		elevationMask = (double) message.getShort();
-		snrMask = (double) message.get();
-		rtko.setMasks(elevationMask/10.0, snrMask);
-	} catch (int error) {
-		plog->severe("MID19" + msgEOM + to_string((long long) error));
+	OSPMID19Data mid19;
+	if (!OSPMID19Layout::decode(message, mid19)) {
+		plog->severe("MID19" + msgEOM + to_string((long long) message.payloadLen()));
 		return false;
 	}
+	elevationMask = (double) mid19.elevationMask;
+	snrMask = (double) mid19.snrMask;
+	rtko.setMasks(elevationMask/10.0, snrMask);
 	plog->finer("MID19 elevation=" + to_string((long double) elevationMask) + " s/n=" + to_string((long double) snrMask));
 	return true;
 }
@@ -848,48 +1456,50 @@ bool GNSSdataFromOSP::getMID19Masks(RTKobservation &rtko) {
  * @return true if data properly extracted (correct message length and receiver gives confidence on observables), false otherwise
  */
 bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID28ObsData");
 	char sys;
 	int channel, sv, satID, syncFlags, carrier2noise, strength, strengthIndex;
 	unsigned short int deltaRangeInterval;
 	double gpsSWtime, pseudorange, carrierFrequency, carrierPhase;
 	char msgBuf[100];
+	OSPMID28Data mid28;
 	CHECK_PAYLOADLEN(56,"MID28 msg len <> 20")
 	sameEpoch = false;
-	try {
-		//get data from message MID28
-		channel = message.get();	
-		message.getInt();			//a time tag not used
-		sv = message.get();			//the satellite number assigned by the receiver
-		if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
-			sys = 'G';
-			satID = sv;
-		} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
-			sys = 'R';
-			satID = getGLOslot(channel, sv);
-		} else if ((sv >= FIRSTSBASSAT) && (sv <= LASTSBASSAT)) {			//it is a SBAS satellite
-			sys = 'S';
-			satID = sv - 100;
-		} else {
-			plog->warning("MID28 satellite number out of GPS, SBAS, GLONASS ranges:" + to_string((long long) sv));
-			return false;
-		}
-		gpsSWtime = message.getDouble();
-		pseudorange = message.getDouble();
-		carrierFrequency = (double) message.getFloat(); //sign - �?
-		carrierPhase = message.getDouble();
-		message.getUShort();		//the timeIntrack is not used
-		syncFlags = message.get();
-		//get the signal strength as the worst of the C/N0 given
-		carrier2noise = 0;
-		strength = message.get();
-		for (int i=1; i<10; i++)
-			if ((carrier2noise = message.get()) < strength) strength = carrier2noise;
-		deltaRangeInterval = message.getUShort();
-	} catch (int error) {
-		plog->severe("MID28 " + msgEOM + to_string((long long) error));
+	if (!OSPMID28Layout::decode(message, mid28)) {
+		plog->severe("MID28 " + msgEOM + to_string((long long) message.payloadLen()));
 		return false;
 	}
-	sprintf(msgBuf,"MID28 tTag=%g ch=%2d sv=%2d sat=%c%02d psr=%g SynFlg=%02X ", gpsSWtime, channel, sv, sys, satID, pseudorange, syncFlags);
+	//get data from message MID28 (the time tag is not used)
+	channel = mid28.channel;
+	sv = mid28.sv;		//the satellite number assigned by the receiver
+	if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
+		sys = 'G';
+		satID = sv;
+	} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
+		sys = 'R';
+		satID = getGLOslot(channel, sv);
+		//in a single pass with GLONASS parameters acquisition, slots not yet stated from nav data are set at the end of the sweep
+		if (singlePassGLO && !gloSlotLive[sv-FIRSTGLOSAT]) satID = -sv;
+	} else if ((sv >= FIRSTSBASSAT) && (sv <= LASTSBASSAT)) {			//it is a SBAS satellite
+		sys = 'S';
+		satID = sv - 100;
+	} else {
+		plog->warning("MID28 satellite number out of GPS, SBAS, GLONASS ranges:" + to_string((long long) sv));
+		return false;
+	}
+	gpsSWtime = mid28.gpsSWtime;
+	pseudorange = mid28.pseudorange;
+	carrierFrequency = (double) mid28.carrierFrequency; //sign - �?
+	carrierPhase = mid28.carrierPhase;
+	syncFlags = mid28.syncFlags;	//the timeIntrack is not used
+	//get the signal strength as the worst of the C/N0 given
+	carrier2noise = 0;
+	strength = mid28.cn0[0];
+	for (int i=1; i<10; i++)
+		if ((carrier2noise = mid28.cn0[i]) < strength) strength = carrier2noise;
+	deltaRangeInterval = mid28.deltaRangeInterval;
+	if (plog->isLevel(Logger::FINER))
+		sprintf(msgBuf,"MID28 tTag=%g ch=%2d sv=%2d sat=%c%02d psr=%g SynFlg=%02X ", gpsSWtime, channel, sv, sys, satID, pseudorange, syncFlags);
 	//compute strengthIndex as per RINEX spec (5.7): min(max(strength / 6, 1), 9)
 	strengthIndex = strength / 6;
 	if (strengthIndex < 1) strengthIndex = 1;
@@ -898,12 +1508,12 @@ bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
 	if ((syncFlags & 0x01) != 0) {	//bit 0 is set only when acquisition is complete
 		if ((syncFlags & 0x02) == 0) carrierPhase = 0.0;
 		if ((syncFlags & 0x10) == 0) carrierFrequency = 0.0;
-		chSatObs.push_back(ChannelObs(sys, satID, pseudorange, carrierPhase, carrierFrequency, (double) strength, 0, strengthIndex, gpsSWtime));
-		sameEpoch = gpsSWtime == chSatObs[0].timeT;
-		plog->finer(string(msgBuf) + "SAVED");
+		chSatObs.push_back(sys, satID, pseudorange, carrierPhase, carrierFrequency, (double) strength, 0, strengthIndex, gpsSWtime);
+		sameEpoch = gpsSWtime == chSatObs.timeT[0];
+		LOG_FINER(plog, string(msgBuf) + "SAVED");
 		return true;
 	}
-	plog->finer(string(msgBuf) + "IGNORED");
+	LOG_FINER(plog, string(msgBuf) + "IGNORED");
 	return false;
 }
 
@@ -913,13 +1523,13 @@ bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
  * @return if data properly extracted (correct SID data), false otherwise
  */
 bool GNSSdataFromOSP::getMID70NavData(RinexData &rinex) {
+	PERF_SCOPE("GNSSdataFromOSP::getMID70NavData");
 	//----------
 	//incomplete and not verified code
 	//----------
 	unsigned int sat;		//the satellite number in the satellite navigation message
 	int bom[8][4];		//the RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
 	double tTag;		//the time tag for ephemeris data
-	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris
 	int tauGPS, tauUTC, b1, b2, n4, kp, nSvs, day, time;
 	bool validEphem;
 	//CHECK_PAYLOADLEN(,"MID70 msg len <> ")
@@ -960,8 +1570,7 @@ bool GNSSdataFromOSP::getMID70NavData(RinexData &rinex) {
 				bom[0][2] = carrierFreq[sat-1];			//SV relative frequency bias +GammaN
 				bom[0][3] =  (int) tTag;	//Message frame time (tk+nd*86400) in seconds of the UTC week?
 				bom[3][3] = 0;			//Age of oper. information (days) (E)
-				scaleGLOEphemeris(bom, bo);
-				rinex.saveNavData('R', sat, bo, tTag);
+				saveGLOEphemeris(rinex, sat, tTag, bom, 0, 2);
 			} else plog->warning("GLONASS ephem. not valid for " + to_string((long long) sat));
 			nSvs--;
 		}
@@ -972,44 +1581,6 @@ bool GNSSdataFromOSP::getMID70NavData(RinexData &rinex) {
 	return true;
 }
 
-/**checkGPSparity checks the parity of a GPS message subframe word using procedure in GPS ICD.
- * To check the parity, the six bits of parity are computed for the word contents, and then compared with the current parity in the 6 LSB of the word passed.
- *  
- * @param d The subframe word passed, where the two LSB bits of the previous word have been added  
- * @return true if parity computed is equal to the current parity in the six LSB of the word
- */
-bool GNSSdataFromOSP::checkGPSparity (unsigned int d) {
-	//d has de form: D29 D30 d1 .. d30)
-	unsigned int toCheck = d;
-	if ((d & 0x40000000) != 0) toCheck = (d & 0xC0000000) | (~d & 0x3FFFFFFF);
-	//compute the parity of the bit stream
-	unsigned int parity = 0;
-	for (int i=0; i<6; i++) parity |= (bitsSet(parityBitMask[i] & toCheck) % 2) << (5-i);
-	return parity == (d & 0x3F);
-}
-
-/**checkGLOhamming checks the GLONASS string for correct hamming code.
- *  
- * @param ps a pointer to the string to be checked contained in the 3 words pointed by pw   
- * @return true if code computed is equal to the current one in bits 1-8 of the string
- */
-bool GNSSdataFromOSP::checkGLOhamming (unsigned int* ps) {
-	//To be implemented
-	return true;
-};
-
-/**bitsSet counts the number of bits set in a given 32 bits stream.
- * Used to compute the XOR of a bit stream for computing parity
- * 
- * @param lw The 32 bit stream to be processed (32 LSB in the long)
- * @return the number of bits set to 1 in lw 
- */
-unsigned int GNSSdataFromOSP::bitsSet(unsigned int lw) {
-	int count = 0;
-	for (int i=0; i<32; i++) count += (int)((lw>>i) & 0x01);
-	return count;
-}
-
 /**allGPSEphemReceived checks if all GPS ephemerides in a given channel have been received
  *All ephemerides have been received if subframes 1, 2 and 3 have been received, all subframes belong
  *to the same satellite (the satellite tracked by the channel has not changed), and their data belong to the same IOD (Issue Of Data)
@@ -1221,7 +1792,7 @@ void GNSSdataFromOSP::scaleGLOEphemeris(int (&bom)[8][4], double (&bo)[8][4]) {
 	return;
 }
 
-/**getGLOstring gets ten words from a MID8 OSP message payload and packs the 84 bits of a GLONASS string they contain into three words.
+/**getGLOstring gets the ten words of a MID8 OSP message payload and packs the 84 bits of a GLONASS string they contain into three words.
  *It is assumed that:
  *a-the OSP word 0, bits 23 to  0 contain GLONASS string bits 84 to 61	(24 b)
  *b-the OSP word 1, bits 24 to  0 contain GLONASS string bits 60 to 36	(25 b)
@@ -1232,17 +1803,11 @@ void GNSSdataFromOSP::scaleGLOEphemeris(int (&bom)[8][4], double (&bo)[8][4]) {
  *	- bit 1 is moved to bit 0 of compact string word 0, 2 to bit 1 of compact string word 0, and so on
  * 	- string bit 84 becomes bit 19 of compact string word 2
  *
+ * @param ospW the ten words of the MID8 message payload
  * @param stringW the three words array where the 84 bits of the GLONASS string are packed 
  * @return string number extracted from the bit stream passed, or 0 in case of error occurred
  */
-int GNSSdataFromOSP::getGLOstring(unsigned int (&stringW)[3]) {
-	unsigned int ospW[10];	//a place to store the ten words of OSP message payload
-	try {
-		for (int i=0; i<10; i++) ospW[i] = message.getUInt();
-	} catch (int error) {
-		plog->severe("MID8 " + msgEOM + to_string((long long) error));
-		return 0;
-	}
+int GNSSdataFromOSP::getGLOstring(const unsigned int (&ospW)[10], unsigned int (&stringW)[3]) {
 	stringW[0] = ((ospW[2] & 0x003FFFFF) << 10) | ((ospW[3] & 0x01FF8000) >> 15);
 	stringW[1] = ((ospW[0] & 0x0000000F) << 28) | ((ospW[1] & 0x01FFFFFF) <<  3) | ((ospW[2] & 0x01C00000) >> 22);
 	stringW[2] = ((ospW[0] & 0x00FFFFF0) >>  4);
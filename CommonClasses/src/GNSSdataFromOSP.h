@@ -22,13 +22,28 @@
  *<p>				|-#	To convert GPS navigation messages to RINEX broadcast orbit parameters, applying the conversion factors
  *<p>				|-# To adquire GLONASS navigation data from OSP messages
  *<p>V2.1	|2/2018	|getMID7Interval modified to improve interval detection logic
+ *<p>V2.2	|10/2026	|Added functionality:
+ *<p>				|-# Single pass acquisition of header, GLONASS parameters and epoch data from the OSP file
+ *<p>				|-# Use of an OSP index to get data from navigation messages and to acquire epochs in a time window
+ *<p>				|-# Block buffered reading of the OSP file in the single pass acquisition, and unchecked extraction of MID8 and MID28 data
+ *<p>				|-# Streaming acquisition of messages received one by one (i.e. from a serial port or a growing OSP file)
+ *<p>				|-# GPS parity and GLONASS Hamming code checks moved to NavBitsCheck, with the GLONASS check implemented
+ *<p>				|-# Performance timers (see PerfCounters) in the methods extracting data from each message type
+ *<p>				|-# Messages dispatched to their handlers using tables indexed by MID, and fixed layout messages decoded using OSPDecoder layouts
+ *<p>				|-# Epoch observables stored as columns, converted and corrected for all channels at once, and saved in RinexData by columns
+ *<p>				|-# Conversion and dispatch tables shared by all objects, to reduce the cost of creating them in long lived processes
+ *<p>				|-# Single pass acquisition of RTK solutions and masks, reading only MID2 and MID19 messages from the OSP file
  */
 #ifndef GNSSDATAFROMOSP_H
 #define GNSSDATAFROMOSP_H
 
+#include <mutex>
+
 //from CommonClasses
 #include "Logger.h"
 #include "OSPMessage.h"
+#include "OSPDecoder.h"
+#include "OSPIndex.h"
 #include "RinexData.h"
 #include "RTKobservation.h"
 
@@ -60,10 +75,6 @@ const double L1CADJ = 1575420000.0;	//to adjust L1C (carrier phase in cycles) =
 const double L1WLINV = 1575420000.0 / 299792458.0; //the inverse of L1 wave length to convert m/s to Hz.
 const double ThisPI = 3.1415926535898;
 
-//a bit mask definition for the bits participating in the computation of parity (see GPS ICD)
-//bit mask order: D29 D30 d1 d2 d3 ... d24 ... d29 d30
-//parityBitMask[i] identifies bits participating (set to 1) or not (set to 0) in the computation of parity bit i.
-const unsigned int parityBitMask[] = {0xBB1F3480, 0x5D8F9A40, 0xAEC7CD00, 0x5763E680, 0x6BB1F340, 0x8B7A89C0};
 //Default value for unknown data
 const string unknown ("UNKNOWN");
 const string msgEOM (" error getting data after end of message: ");
@@ -84,6 +95,33 @@ const string msgFew (" ignored: few SVs in solution");
  *	-# Epoch data acquired can be used to generate / print RINEX or RTK file epoch (see available methods in RinexData and RTKobservation classes)
  *	-# Repeat above steps 5 and 6 while epoch data are available in the input file.
  *<p>
+ * Alternatively, the OSP file can be read only once using the single pass acquisition methods:
+ *	-# Acquire header data, GLONASS parameters (if requested) and all epoch and navigation data in one sweep of the binary
+ *		file using acqAllData. Epoch observables are buffered, and data which could only be completed at the end of the file
+ *		(GLONASS slots and carrier frequencies) are stated when the sweep finishes
+ *	-# Print the RINEX header from data acquired
+ *	-# Get each buffered epoch into the RinexData object using getBufferedEpoch, and print it, while it returns true
+ *<p>
+ * RTK data can also be acquired in one sweep of the binary file: acqRTKsolution acquires the solution of the next epoch
+ * and the masks found before it, skipping by their length the messages not containing RTK data. Header times shall be
+ * stated from the solutions acquired, and the header printed before the end of acquisition updated when it finishes
+ * (see RTKobservation::patchHeaderTimes).
+ *<p>
+ * When an index of the OSP file is available (see OSPIndex), it can be stated using setIndex. Then:
+ *	- navigation data, receiver identification and GLONASS parameters can be acquired from the messages containing them,
+ *		without reading the rest, using acqIndexedData
+ *	- the single pass acquisition can be limited to the epochs in a time window stated using setTimeWindow
+ *<p>
+ * For real time generation of RINEX files, messages can be given one by one as they are received, using the streaming methods:
+ *	-# Start the streaming acquisition using startStreamAcq
+ *	-# Pass each message received to acqStreamData. Header data are acquired from the first messages, and navigation data
+ *		are saved as they arrive. When a MID7 closes an epoch, its observables are buffered and acqStreamData returns true
+ *	-# When header data have been acquired (see streamHeaderAcq), print the RINEX header, and then print each buffered epoch
+ *		got using getBufferedEpoch. Header data acquired later (i.e. the observation interval) shall be updated in the file
+ *		when it is closed (see RinexData::updateObsHeader)
+ *	-# When no more messages will be received, finish the acquisition using endStreamAcq
+ *<p>In streaming acquisition GLONASS slots and carrier frequency numbers are the ones known when each message is processed.
+ *<p>
  * This version implements acquisition from binary files containing OSP messages collected from SiRFIV receivers.
  * Each OSP message starts with the payload length (2 bytes) and follows the n bytes of the message payload.
  *<p>
@@ -102,7 +140,17 @@ public:
 	bool acqHeaderData(RTKobservation &);
 	bool acqEpochData(RinexData &, bool, bool);
 	bool acqEpochData(RTKobservation &);
+	bool acqRTKsolution(RTKobservation &, bool &);
 	bool acqGLOparams();
+	bool acqAllData(RinexData &, bool, bool, bool);
+	bool getBufferedEpoch(RinexData &);
+	void setIndex(OSPIndex *);
+	bool setTimeWindow(double, double);
+	bool acqIndexedData(RinexData &, bool, bool, bool);
+	void startStreamAcq(bool);
+	bool acqStreamData(const unsigned char*, unsigned int, RinexData &, bool, bool);
+	bool streamHeaderAcq();
+	bool endStreamAcq(RinexData &);
 
 private:
 	string receiver;
@@ -114,6 +162,10 @@ private:
 	double epochClkDrift;
 	FILE* ospFile;
 	OSPMessage message;
+	OSPIndex* ospIndex;		//the index of the OSP file, or NULL if not available
+	long long filePos;		//the position in the OSP file of the next message to be read in a single pass
+	long long endOffset;	//the position in the OSP file where the single pass stops, or -1 to read until the end of file
+	bool rxIdAcq;			//receiver identification acquired using the OSP index
 	struct SubframeData {		//A type to store 50bps message data
 		int sv;					//the satelite number
 		unsigned int words[10];	//the ten words with nav data
@@ -131,50 +183,148 @@ private:
 	};
 	GLONASSfreq nAhnA[MAXCHANNELS];	//for each channel, the nA and frequency data
 	int carrierFreq[MAXGLOSLOTS];
-	struct ChannelObs {		//storage for channel/satellite observables during one epoch
-		char system;		//system identification
-		int satPrn;			//satellite number
-		double psedrng;		//pseudorange in m
-		double carrPh;		//carrier phase in m
-		double carrFq;		//carrier frequency in m/s
-		double signalStrg;	//signal strength
-		int limitOl;		//limit of liability
-		int strgIdx;		//strength index
-		double timeT;		//a time tag to identify these measurements
+	struct ChannelObs {		//storage for channel/satellite observables during one epoch, as columns with a row for each channel
+		vector<char> system;		//system identification
+		vector<int> satPrn;			//satellite number
+		vector<double> psedrng;		//pseudorange in m
+		vector<double> carrPh;		//carrier phase in m
+		vector<double> carrFq;		//carrier frequency in m/s
+		vector<double> signalStrg;	//signal strength
+		vector<int> limitOl;		//limit of liability
+		vector<int> strgIdx;		//strength index
+		vector<double> timeT;		//a time tag to identify these measurements
+		unsigned int size() const {
+			return (unsigned int) system.size();
+		}
+		bool empty() const {
+			return system.empty();
+		}
+		void reserve(unsigned int n) {
+			system.reserve(n); satPrn.reserve(n); psedrng.reserve(n); carrPh.reserve(n); carrFq.reserve(n);
+			signalStrg.reserve(n); limitOl.reserve(n); strgIdx.reserve(n); timeT.reserve(n);
+		}
+		void clear() {
+			system.clear(); satPrn.clear(); psedrng.clear(); carrPh.clear(); carrFq.clear();
+			signalStrg.clear(); limitOl.clear(); strgIdx.clear(); timeT.clear();
+		}
+		void push_back(char sy, int sa, double ps, double ca, double cf, double si, int li, int st, double ti) {
+			system.push_back(sy); satPrn.push_back(sa); psedrng.push_back(ps); carrPh.push_back(ca); carrFq.push_back(cf);
+			signalStrg.push_back(si); limitOl.push_back(li); strgIdx.push_back(st); timeT.push_back(ti);
+		}
+		void eraseAllButLast() {	//keeps only the channel data in the last row
+			unsigned int n = size();
+			if (n < 2) return;
+			system.erase(system.begin(), system.begin() + n - 1); satPrn.erase(satPrn.begin(), satPrn.begin() + n - 1);
+			psedrng.erase(psedrng.begin(), psedrng.begin() + n - 1); carrPh.erase(carrPh.begin(), carrPh.begin() + n - 1);
+			carrFq.erase(carrFq.begin(), carrFq.begin() + n - 1); signalStrg.erase(signalStrg.begin(), signalStrg.begin() + n - 1);
+			limitOl.erase(limitOl.begin(), limitOl.begin() + n - 1); strgIdx.erase(strgIdx.begin(), strgIdx.begin() + n - 1);
+			timeT.erase(timeT.begin(), timeT.begin() + n - 1);
+		}
+		void swap(ChannelObs &other) {
+			system.swap(other.system); satPrn.swap(other.satPrn); psedrng.swap(other.psedrng); carrPh.swap(other.carrPh);
+			carrFq.swap(other.carrFq); signalStrg.swap(other.signalStrg); limitOl.swap(other.limitOl);
+			strgIdx.swap(other.strgIdx); timeT.swap(other.timeT);
+		}
+	};
+	ChannelObs chSatObs;	//the observables of the current epoch, with room reserved for MAXCHANNELS
+	vector<double> obsColumns[3];	//the C1C, L1C, D1C values computed from chSatObs to be saved in RinexData
+	struct HeaderAcqState {	//the state of acquisition of RINEX header data
+		bool rxIdSet;		//identification of receiver set
+		bool apxSet;		//approximate position set
+		bool frsEphSet;		//epoch data received
+		bool intrvBegin;	//time for the 1st epoch (having correct time) stated
+		bool intrvSet;		//observations interval set
 		//constructor
-		ChannelObs(char sy, int sa, double ps, double ca, double cf, double si, int li, int st, double ti) {
-			system = sy;
-			satPrn = sa;
-			psedrng = ps;
-			carrPh = ca;
-			carrFq = cf;
-			signalStrg = si;
-			limitOl = li;
-			strgIdx = st;
-			timeT = ti;
+		HeaderAcqState() {
+			rxIdSet = apxSet = frsEphSet = intrvBegin = intrvSet = false;
 		}
 	};
-	vector<ChannelObs> chSatObs;
-	//Constant data used to convert GPS broadcast navigation data to "true" values
-	double GPS_SCALEFACTOR[8][4];	//the scale factors to apply to GPS broadcast orbit data to obtain ephemeris (see GPS ICD)
-	double GPS_URA[16];			//the User Range Accuracy values corresponding to URA index in the GPS SV broadcast data (see GPS ICD)
-	double GLO_SCALEFACTOR[4][4];	//the scale factors to apply to GLONASS broadcast orbit data to obtain ephemeris (see GLONASS ICD)
+	struct RTKHeaderAcqState {	//the state of acquisition of RTK header data
+		bool maskSet;		//mask data set
+		bool fetSet;		//first epoch time set
+		//constructor
+		RTKHeaderAcqState() {
+			maskSet = fetSet = false;
+		}
+	};
+	//Handlers of messages for each kind of acquisition, and the tables to dispatch messages to them by MID
+	typedef void (GNSSdataFromOSP::*HeaderMsgHandler)(RinexData &rinex, HeaderAcqState &hds);
+	typedef void (GNSSdataFromOSP::*RTKHeaderMsgHandler)(RTKobservation &rtko, RTKHeaderAcqState &hds);
+	typedef bool (GNSSdataFromOSP::*EpochMsgHandler)(RinexData &rinex, bool useMID8G, bool useMID8R);
+	static OSPDispatchTable<HeaderMsgHandler> headerHandlers;
+	static OSPDispatchTable<RTKHeaderMsgHandler> rtkHeaderHandlers;
+	static OSPDispatchTable<EpochMsgHandler> epochHandlers;
+	static bool rtkMIDs[256];	//the MIDs of messages containing RTK data, to be read in the single pass RTK acquisition
+	struct EpochData {		//storage for the time and observables of an epoch acquired in a single pass
+		int week;			//the GPS week
+		double tow;			//the GPS time of week
+		double clkBias;		//the receiver clock bias
+		double clkDrift;	//the receiver clock drift
+		ChannelObs chObs;	//the observables of this epoch
+	};
+	vector<EpochData> epochBuffer;	//epochs acquired in a single pass, waiting to be got
+	unsigned int epochBufferIdx;	//index in epochBuffer of the next epoch to be got
+	EpochData lastEpoch;	//the RinexData epoch time at the end of the single pass, to be restored after getting all epochs
+	struct PendingEphem {	//storage for satellite ephemeris waiting to be completed in a single pass
+		char sys;			//system identification
+		unsigned int sat;	//satellite number
+		double tTag;		//the time tag for ephemeris data (GLONASS only)
+		int bom[8][4];		//the broadcast orbit mantissas
+		int frqLin;			//line and column in bom where the GLONASS carrier frequency number shall be placed
+		int frqCol;
+	};
+	vector<PendingEphem> pendingEphem;
+	bool singlePass;		//true when a single pass acquisition is in progress
+	bool singlePassGLO;		//true when GLONASS parameters are also being acquired in the single pass
+	bool epochTimeRead;		//true when a MID7 has been processed for epoch data in the single pass
+	GLONASSslot gloFirstSlt[MAXGLOSATS];	//first occurrence of GLONASS slots acquired in the single pass
+	bool gloSlotLive[MAXGLOSATS];	//true when slot was stated from MID8 nav data during the single pass
+	HeaderAcqState streamHds;	//the state of header data acquisition in the streaming acquisition
+	EpochData streamHdTime;		//the epoch time used for header data acquisition in the streaming acquisition
+	bool streamHdAcq;		//true while header data are being acquired in the streaming acquisition
+	bool streamGLO;			//true when GLONASS parameters are also being acquired in the streaming acquisition
+	bool streamAcq;			//true when a streaming acquisition is in progress
+	//Constant data used to convert GPS broadcast navigation data to "true" values. Shared by all objects, and set once by the first one
+	static double GPS_SCALEFACTOR[8][4];	//the scale factors to apply to GPS broadcast orbit data to obtain ephemeris (see GPS ICD)
+	static double GPS_URA[16];			//the User Range Accuracy values corresponding to URA index in the GPS SV broadcast data (see GPS ICD)
+	static double GLO_SCALEFACTOR[4][4];	//the scale factors to apply to GLONASS broadcast orbit data to obtain ephemeris (see GLONASS ICD)
+	static once_flag sharedTablesSet;	//to set shared tables only once
 	//Logger
 	Logger* plog;		//the place to send logging messages
 	bool dynamicLog;	//true when created dynamically here, false when provided externally
 
 	void setTblValues();
-	bool checkGPSparity (unsigned int );
-	bool checkGLOhamming (unsigned int* );
-	unsigned int bitsSet(unsigned int );
+	static void setSharedTables();
+	static void setDispatchTables();
 	bool allGPSEphemReceived(int );
 	bool extractGPSEphemeris(const unsigned int (&navW)[45], unsigned int &sat, int (&bom)[8][4]);
 	bool extractGLOEphemeris(int ch, unsigned int &sat, double &tTag, int (&bom)[8][4]);
 	void scaleGPSEphemeris(int (&bom)[8][4], double &tTag, double (&bo)[8][4]);
 	void scaleGLOEphemeris(int (&bom)[8][4], double (&bo)[8][4]);
 	bool allGLOEphemReceived(int );
-	int getGLOstring(unsigned int (&stringW)[3]);
+	int getGLOstring(const unsigned int (&ospW)[10], unsigned int (&stringW)[3]);
 	int getGLOslot(int ch, int sat);
+	void getHeaderMsgData(int mid, RinexData &rinex, HeaderAcqState &hds);
+	void headerMID2(RinexData &rinex, HeaderAcqState &hds);
+	void headerMID6(RinexData &rinex, HeaderAcqState &hds);
+	void headerMID7(RinexData &rinex, HeaderAcqState &hds);
+	void headerMID28(RinexData &rinex, HeaderAcqState &hds);
+	void rtkHeaderMID2(RTKobservation &rtko, RTKHeaderAcqState &hds);
+	void rtkHeaderMID19(RTKobservation &rtko, RTKHeaderAcqState &hds);
+	bool logHeaderAcq(HeaderAcqState &hds);
+	void getMID8GLOparams(GLONASSslot (&slots)[MAXGLOSATS]);
+	void logGLOparams(GLONASSslot (&slots)[MAXGLOSATS]);
+	bool getEpochMsgData(int mid, RinexData &rinex, bool useMID8G, bool useMID8R);
+	bool epochMID7(RinexData &rinex, bool useMID8G, bool useMID8R);
+	bool epochMID8(RinexData &rinex, bool useMID8G, bool useMID8R);
+	bool epochMID15(RinexData &rinex, bool useMID8G, bool useMID8R);
+	bool epochMID28(RinexData &rinex, bool useMID8G, bool useMID8R);
+	bool epochMID70(RinexData &rinex, bool useMID8G, bool useMID8R);
+	void saveEpochObs(RinexData &rinex, double clkBias, double clkDrift);
+	void swapEpochTime(EpochData &ed);
+	void saveGLOEphemeris(RinexData &rinex, unsigned int sat, double tTag, int (&bom)[8][4], int frqLin, int frqCol);
+	void savePendingEphem(RinexData &rinex, char sys, double tow);
+	bool fillMessage();
 
 	bool getMID2PosData(RinexData &);
 	bool getMID2PosData(RTKobservation &);
@@ -182,8 +332,8 @@ private:
 	bool getMID6RxData(RinexData &);
 	bool getMID7TimeData(RinexData &);
 	bool getMID7Interval(RinexData &);
-	bool getMID8GPSNavData(int, int, RinexData &);
-	bool getMID8GLONavData(int, int, RinexData &);
+	bool getMID8GPSNavData(const OSPMID8Data &, RinexData &);
+	bool getMID8GLONavData(const OSPMID8Data &, RinexData &);
 	bool getMID15NavData(RinexData &);
 	bool getMID19Masks(RTKobservation &);
 	bool getMID28ObsData(RinexData &, bool &);
@@ -0,0 +1,165 @@
+/** @file JobServer.cpp
+ * Contains the implementation of the JobServer class.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <chrono>
+
+#include "JobServer.h"
+
+/**Constructs a JobServer object to run jobs using the given number of worker threads.
+ *
+ * @param nWorkers the number of worker threads. If zero or negative, the number of hardware threads available is used
+ * @param prgName the program name to be passed as argv[0] to jobs
+ * @param plog a pointer to the Logger used to log jobs results. It shall be thread safe
+ */
+JobServer::JobServer(int nWorkers, string prgName, Logger* plog) {
+	if (nWorkers <= 0) nWorkers = (int) thread::hardware_concurrency();
+	workers = nWorkers > 0? nWorkers : 1;
+	program = prgName;
+	this->plog = plog;
+	inputEnded = false;
+	replyFile = NULL;
+	jobsDone = jobsFailed = worstStatus = 0;
+}
+
+/**Destructs JobServer objects.
+ */
+JobServer::~JobServer(void) {
+}
+
+/**parseJobLine extracts the job identifier and arguments from a job line.
+ * Tokens are separated by spaces or tabs. Double quotes can be used to include spaces in a token.
+ *
+ * @param line the job line, without the end of line
+ * @param id the job identifier (the first token)
+ * @param args the job arguments (the rest of tokens)
+ * @return true if a job identifier exists in the line, false otherwise (empty or comment line)
+ */
+bool JobServer::parseJobLine(const string &line, string &id, vector<string> &args) {
+	vector<string> tokens;
+	string token;
+	bool inToken = false, quoted = false;
+	id.clear();
+	args.clear();
+	for (string::const_iterator it = line.begin(); it != line.end(); it++) {
+		if (*it == '"') {
+			quoted = !quoted;
+			inToken = true;
+		} else if (!quoted && ((*it == ' ') || (*it == '\t') || (*it == '\r') || (*it == '\n'))) {
+			if (inToken) tokens.push_back(token);
+			token.clear();
+			inToken = false;
+		} else {
+			token += *it;
+			inToken = true;
+		}
+	}
+	if (inToken) tokens.push_back(token);
+	if (tokens.empty() || (tokens[0].at(0) == '#')) return false;
+	id = tokens[0];
+	args.assign(tokens.begin() + 1, tokens.end());
+	return true;
+}
+
+/**serve reads job lines from the input stream and runs the jobs using the worker threads, writing a reply line to the output
+ * stream for each job when it ends. Input lines are read until the end of the input stream or a line with the word QUIT.
+ * When input ends, it waits for the jobs pending before returning.
+ *<p>Jobs wait in a queue for a free worker. When JOBSQUEUED jobs per worker are waiting, input reading is suspended until
+ * a worker takes a job.
+ *
+ * @param input the stream where jobs lines are read
+ * @param output the stream where reply lines are written
+ * @param run the function running a job
+ * @return the greatest exit status of the jobs run (0 if all jobs were run without errors)
+ */
+int JobServer::serve(FILE* input, FILE* output, JobFunction run) {
+	vector<thread> pool;
+	char lineBuffer[4096];
+	Job job;
+	replyFile = output;
+	inputEnded = false;
+	jobsDone = jobsFailed = worstStatus = 0;
+	plog->info("Serving jobs using " + to_string((long long) workers) + " workers");
+	for (int i = 0; i < workers; i++) pool.push_back(thread(&JobServer::worker, this, ref(run)));
+	while (fgets(lineBuffer, sizeof lineBuffer, input) != NULL) {
+		if (!parseJobLine(string(lineBuffer), job.id, job.args)) continue;
+		if (job.args.empty() && (job.id.compare("QUIT") == 0)) break;
+		unique_lock<mutex> lock(queueMutex);
+		roomAvailable.wait(lock, [this] {return pending.size() < (size_t) (workers * JOBSQUEUED);});
+		pending.push_back(job);
+		jobAvailable.notify_one();
+	}
+	{
+		lock_guard<mutex> lock(queueMutex);
+		inputEnded = true;
+	}
+	jobAvailable.notify_all();
+	for (vector<thread>::iterator it = pool.begin(); it != pool.end(); it++) it->join();
+	plog->info("End of service. Jobs run: " + to_string((long long) jobsDone) + " failed: " + to_string((long long) jobsFailed));
+	return worstStatus;
+}
+
+/**worker is the body of each worker thread: it takes jobs from the queue and runs them until input ends and no one remains.
+ * Exceptions raised by the job function are caught and replied as a failed job.
+ *
+ * @param run the function running a job
+ */
+void JobServer::worker(JobFunction &run) {
+	Job job;
+	vector<char*> argv;
+	string result;
+	int status;
+	while (true) {
+		{
+			unique_lock<mutex> lock(queueMutex);
+			jobAvailable.wait(lock, [this] {return !pending.empty() || inputEnded;});
+			if (pending.empty()) return;
+			job = pending.front();
+			pending.pop_front();
+		}
+		roomAvailable.notify_one();
+		//build argv as given to main
+		argv.clear();
+		argv.push_back((char*) program.c_str());
+		for (vector<string>::iterator it = job.args.begin(); it != job.args.end(); it++) argv.push_back((char*) it->c_str());
+		argv.push_back(NULL);
+		result.clear();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		try {
+			status = run((int) argv.size() - 1, argv.data(), result);
+		} catch (string error) {
+			status = -1;
+			result = error;
+		} catch (int error) {
+			status = -1;
+			result = "Error " + to_string((long long) error);
+		} catch (...) {
+			status = -1;
+			result = "Unexpected error";
+		}
+		reply(job, status, chrono::duration<double>(chrono::steady_clock::now() - start).count(), result);
+	}
+}
+
+/**reply writes the reply line for a job ended, and accounts its result.
+ *
+ * @param job the job ended
+ * @param status the exit status of the job
+ * @param seconds the elapsed time of the job
+ * @param result the text describing the job result
+ */
+void JobServer::reply(const Job &job, int status, double seconds, const string &result) {
+	lock_guard<mutex> lock(replyMutex);
+	jobsDone++;
+	if (status != 0) {
+		jobsFailed++;
+		plog->warning("Job " + job.id + ": status " + to_string((long long) status) + ". " + result);
+	}
+	if (status > worstStatus) worstStatus = status;
+	else if ((status < 0) && (worstStatus == 0)) worstStatus = 1;
+	fprintf(replyFile, "%s %d %.3f %s\n", job.id.c_str(), status, seconds, result.c_str());
+	fflush(replyFile);
+}
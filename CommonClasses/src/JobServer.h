@@ -0,0 +1,85 @@
+/** @file JobServer.h
+ * Contains the JobServer class definition used to run in a long lived process conversion jobs received as lines of arguments.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#include "Logger.h"
+
+using namespace std;
+
+//@cond DUMMY
+///The maximum number of jobs waiting for a worker, per worker thread
+#define JOBSQUEUED 4
+//@endcond
+
+/**JobServer class provides resources to run many conversion jobs in a single long lived process, avoiding the cost of
+ * starting a process for each one, and running several jobs at the same time using worker threads.
+ *<p>Jobs are received as text lines from an input stream (the standard input, or a named pipe). Each line contains a job
+ * identifier followed by the job arguments, as they would be given in the command line of the program performing the conversion,
+ * separated by spaces or tabs. Arguments containing spaces shall be enclosed in double quotes. Empty lines and lines starting
+ * with # are ignored. A line with the word QUIT, or the end of the input stream, ends the service after finishing the jobs pending.
+ *<p>For each job a reply line is written to the output stream when the job ends, with the job identifier, its exit status,
+ * its elapsed time in seconds, and a text describing the result. Replies are written in the order jobs end.
+ *<p>A program using JobServer would perform the following steps:
+ *	-# Define a JobServer object stating the number of worker threads, the program name, and the Logger to be used
+ *	-# Call serve passing the input and output streams, and the function running a job.
+ *		It is called from the worker threads with the job arguments in the argc / argv form used by main, argv[0] being the program name,
+ *		and shall use only its own objects (ArgParser, RinexData, GNSSdataFromOSP, etc.). Tables shared by all objects of these
+ *		classes are built once, when the first object is created, and are reused by all jobs
+ */
+class JobServer {
+public:
+	///The function running a job. Params are argc, argv and the result text to fill. Returns the exit status
+	typedef function<int (int, char**, string &)> JobFunction;
+	JobServer(int nWorkers, string prgName, Logger* plog);
+	~JobServer(void);
+	static bool parseJobLine(const string &line, string &id, vector<string> &args);
+	int serve(FILE* input, FILE* output, JobFunction run);
+
+private:
+	struct Job {			//a job received
+		string id;			//the job identifier
+		vector<string> args;	//the job arguments
+	};
+	int workers;			//the number of worker threads to use
+	string program;			//the program name passed as argv[0] to jobs
+	Logger* plog;			//the logger shared by all workers
+	deque<Job> pending;		//jobs waiting for a worker
+	bool inputEnded;		//true when no more jobs will be received
+	mutex queueMutex;		//to serialize access to pending and inputEnded
+	condition_variable jobAvailable;	//signaled when a job is queued or input ends
+	condition_variable roomAvailable;	//signaled when a worker takes a job from the queue
+	mutex replyMutex;		//to serialize writing of replies
+	FILE* replyFile;		//the output stream for replies
+	int jobsDone;			//the number of jobs run
+	int jobsFailed;			//the number of jobs ended with a status not 0
+	int worstStatus;		//the greatest exit status of the jobs run
+
+	void worker(JobFunction &run);
+	void reply(const Job &job, int status, double seconds, const string &result);
+};
+#endif
@@ -2,6 +2,8 @@
  * contains the implementation of the Logger class
  */
 
+#include <chrono>
+
 #include "Logger.h"
 #include "Utilities.h"
 
@@ -10,7 +12,7 @@
  *
  */
 Logger::Logger(void) {
-	levelSet = INFO;
+	init();
 	fileLog = stderr;
 }
 
@@ -21,7 +23,7 @@ Logger::Logger(void) {
  *@param fileName the name of the log file
  */
 Logger::Logger(string fileName) {
-	levelSet = INFO;
+	init();
 	fileLog = fopen(fileName.c_str(), "a");
 	if (fileLog == NULL) fileLog = stderr;
 }
@@ -35,7 +37,7 @@ Logger::Logger(string fileName) {
  *@param initMsg a text message to be logged when the logging object is created
  */
 Logger::Logger(string fileName, string prefix, string initMsg) {
-	levelSet = INFO;
+	init();
 	fileLog = fopen(fileName.c_str(), "a");
 	if (fileLog == NULL) fileLog = stderr;
 	program = prefix;
@@ -43,9 +45,12 @@ Logger::Logger(string fileName, string prefix, string initMsg) {
 }
 
 /**Destructs the Logger object after closing its log file. 
+ *<p>In asynchronous mode, messages pending in the queue are recorded before closing the file.
  */
 Logger::~Logger(void) {
 	logMsg (SEVERE, "logging END");
+	setAsync(false);
+	delete queueTail;
 	if (fileLog != stderr) fclose(fileLog);
 }
 
@@ -90,8 +95,7 @@ void Logger::setLevel(string levelDescription) {
  *@return true when messages at the given level would be logged, false otherwise.
  */
 bool Logger::isLevel(logLevel level) {
-	if (levelSet <= level) return true;
-	return false;
+	return level <= levelSet;
 }
 
 /**isLevel gives result of comparing the current log level with the level given.
@@ -106,8 +110,7 @@ bool Logger::isLevel(logLevel level) {
  *@param levelDescription the word describing the log level to set
  */
 bool Logger::isLevel(string levelDescription) {
-	if (levelSet <= identifyLevel(levelDescription)) return true;
-	return false;
+	return identifyLevel(levelDescription) <= levelSet;
 }
 
 /**severe logs a message at SEVERE level.
@@ -179,36 +182,136 @@ void Logger::finest(string toLog) {
 	logMsg(FINEST, toLog);
 }
 
+/**setAsync sets or resets the asynchronous logging mode.
+ *<p>In asynchronous mode logging methods only time tag the message and append it to a lock-free queue.
+ *A background writer thread takes messages from the queue, formats and records them in the log file, which is flushed
+ *only when the queue becomes empty. It avoids callers waiting for the file writes and flushes, and messages from several
+ *threads contending for the logger mutex.
+ *<p>When the mode is reset, the messages pending in the queue are recorded before returning.
+ *<p>This method shall not be called while other threads are logging messages.
+ *
+ *@param async true to set the asynchronous mode, false to reset it
+ */
+void Logger::setAsync(bool async) {
+	if (async == asyncMode) return;
+	if (async) {
+		stopWriter = false;
+		asyncMode = true;
+		writer = thread(&Logger::writerLoop, this);
+	} else {
+		{
+			lock_guard<mutex> lock(writerMutex);
+			stopWriter = true;
+		}
+		writerWake.notify_one();
+		writer.join();
+		asyncMode = false;
+	}
+}
+
 //*Private methods
 
+/**init sets the initial state of the Logger: default INFO level and synchronous mode.
+ */
+void Logger::init() {
+	levelSet = INFO;
+	stampTime = 0;
+	memset(&stampInfo, 0, sizeof stampInfo);
+	asyncMode = false;
+	stopWriter = false;
+	queueTail = new QueuedMsg();
+	queueTail->next.store(NULL);
+	queueHead.store(queueTail);
+}
+
 /**logMsg is an internal method to tag, format, and log messages data passed by log level methods.
+ *<p>In synchronous mode, the message is recorded holding the logger mutex, to avoid mixing messages logged at the same time by several threads.
+ *<p>In asynchronous mode, the message is appended to the queue to be recorded by the writer thread.
+ *A producer appends its message exchanging the queue head, and then links it to the previous one.
  *
  *@param logLevel states the level to tag the message
  *@param message contains its description
  */
 void Logger::logMsg(logLevel msgLevel, string msg) {
 	time_t rawtime;
-	struct tm * timeinfo;
-	char txtBuf[80];
 
 	time (&rawtime);
-	timeinfo = localtime (&rawtime);
-	if (msgLevel == SEVERE) strftime(txtBuf, sizeof txtBuf, " %Y-%m-%d %H:%M:%S ", timeinfo);
-	else strftime(txtBuf, sizeof txtBuf, " %H:%M:%S ", timeinfo);
-	fprintf(fileLog, "%s%s", program.c_str(), txtBuf);
-	switch (msgLevel) {
-	case SEVERE: fprintf(fileLog, "(SVR) "); break;
-	case WARNING: fprintf(fileLog, "(WRN) "); break;
-	case INFO: fprintf(fileLog, "(INF) "); break;
-	case CONFIG: fprintf(fileLog, "(CFG) "); break;
-	case FINE:  fprintf(fileLog, "(FNE) "); break;
-	case FINER:  fprintf(fileLog, "(FNR) "); break;
-	case FINEST: fprintf(fileLog, "(FNS) "); break;
+	if (asyncMode) {
+		QueuedMsg* pmsg = new QueuedMsg();
+		pmsg->level = msgLevel;
+		pmsg->rawtime = rawtime;
+		pmsg->msg.swap(msg);
+		pmsg->next.store(NULL, memory_order_relaxed);
+		QueuedMsg* prev = queueHead.exchange(pmsg, memory_order_acq_rel);
+		prev->next.store(pmsg, memory_order_release);
+		return;
 	}
-	fprintf(fileLog, "%s\n", msg.c_str());
+	lock_guard<mutex> lock(logMutex);
+	writeMsg(msgLevel, rawtime, msg);
 	fflush(fileLog);
 }
 
+/**writeMsg formats and writes to the log file the given message data.
+ *<p>It shall be called holding the logger mutex, or from the writer thread.
+ *The broken down local time is computed only when the time changes from the previous message.
+ *
+ *@param msgLevel the level to tag the message
+ *@param rawtime the time when the message was logged
+ *@param msg the message text
+ */
+void Logger::writeMsg(logLevel msgLevel, time_t rawtime, const string &msg) {
+	static const char* levelTag[] = {"(SVR) ", "(WRN) ", "(INF) ", "(CFG) ", "(FNE) ", "(FNR) ", "(FNS) "};
+	char txtBuf[80];
+
+	if ((rawtime != stampTime) || (stampTime == 0)) {
+		stampTime = rawtime;
+#ifdef _WIN32
+		localtime_s(&stampInfo, &rawtime);
+#else
+		localtime_r(&rawtime, &stampInfo);
+#endif
+	}
+	if (msgLevel == SEVERE) strftime(txtBuf, sizeof txtBuf, " %Y-%m-%d %H:%M:%S ", &stampInfo);
+	else strftime(txtBuf, sizeof txtBuf, " %H:%M:%S ", &stampInfo);
+	fprintf(fileLog, "%s%s%s%s\n", program.c_str(), txtBuf, levelTag[msgLevel], msg.c_str());
+}
+
+/**dequeue takes the first message pending in the asynchronous queue, if any.
+ *<p>The message taken becomes the dummy node at the queue tail, and the previous dummy is deleted.
+ *It shall be called only from the writer thread, or once it has finished.
+ *
+ *@param pmsg is set to the message taken
+ *@return true if a message has been taken, false if the queue is empty
+ */
+bool Logger::dequeue(QueuedMsg* &pmsg) {
+	QueuedMsg* next = queueTail->next.load(memory_order_acquire);
+	if (next == NULL) return false;
+	delete queueTail;
+	queueTail = next;
+	pmsg = next;
+	return true;
+}
+
+/**writerLoop is the body of the writer thread in asynchronous mode.
+ *<p>It records all messages pending in the queue, flushes the log file, and waits a while before checking again for new messages.
+ *When stopped, it records the remaining messages before finishing.
+ */
+void Logger::writerLoop() {
+	QueuedMsg* pmsg;
+	bool stop = false;
+	while (!stop) {
+		{
+			unique_lock<mutex> lock(writerMutex);
+			writerWake.wait_for(lock, chrono::milliseconds(20), [this] {return stopWriter;});
+			stop = stopWriter;
+		}
+		if (queueTail->next.load(memory_order_acquire) == NULL) continue;
+		lock_guard<mutex> lock(logMutex);
+		while (dequeue(pmsg)) writeMsg(pmsg->level, pmsg->rawtime, pmsg->msg);
+		fflush(fileLog);
+	}
+}
+
 /**identifyLevel gives the log level corresponding to level description given.
  *<p>Level description is given as a string containing the word "S[EVERE]", "W[ARNING]", "I[NFO]", "C[ONFIG]", "[FIN]E", "[FINE]R" or "[FINES]T",
  *which correspond with the log lavel having the same name. Note: characters between braces are optional.
@@ -16,6 +16,8 @@
  *<p>Ver.	|Date	|Reason for change
  *<p>---------------------------------
  *<p>V1.0	|2/2015	|First release
+ *<p>V1.1	|10/2026	|Logging is thread safe: messages from several threads are not interleaved
+ *<p>				|Added asynchronous logging mode and macros to avoid formatting messages not logged
  */
 #ifndef LOGGER_H
 #define LOGGER_H
@@ -24,6 +26,10 @@
 #include <time.h>
 #include <stdio.h>
 #include <string.h>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 
 using namespace std;
 
@@ -34,6 +40,11 @@ using namespace std;
 		If the log level is not explicitly stated, the default level is INFO.
  *	-# Log any message that would be necessary using the method corresponding to the desired log level of the message.
  *		Only those messages having level from SEVERE to the current level stated are recorded in the log file.
+ *<p>A Logger object can be shared by several threads: each message is recorded as a whole line.
+ *<p>In asynchronous mode (see setAsync) messages are queued in a lock-free queue and recorded by a background writer thread,
+ * which writes them in batches and flushes the log file only when the queue becomes empty.
+ *<p>The LOG_FINE, LOG_FINER, LOG_FINEST and LOG_CONFIG macros can be used to log messages whose text is costly to build:
+ * the message expression is evaluated only when the level would be actually logged.
  */
 class Logger {
 public:
@@ -56,12 +67,42 @@ public:
 	void fine(string);
 	void finer(string);
 	void finest(string);
+	void setAsync(bool);
 private:
+	struct QueuedMsg {	//a message waiting in the asynchronous queue to be recorded
+		logLevel level;
+		time_t rawtime;
+		string msg;
+		atomic<QueuedMsg*> next;
+	};
 	string program;		//program name to tag logs
 	logLevel levelSet;	//maximum level to log
 	FILE * fileLog;
+	mutex logMutex;		//to serialize recording of messages from several threads
+	time_t stampTime;	//the time of the last message recorded, and its broken down local time
+	struct tm stampInfo;
+	bool asyncMode;		//when true messages are queued to be recorded by the writer thread
+	atomic<QueuedMsg*> queueHead;	//the last message queued. Producers append messages here
+	QueuedMsg* queueTail;			//the last message taken by the writer (a dummy node whose next is the first pending)
+	thread writer;
+	bool stopWriter;
+	mutex writerMutex;
+	condition_variable writerWake;
 
+	void init();
 	void logMsg(logLevel msgLevel, string msg);
+	void writeMsg(logLevel msgLevel, time_t rawtime, const string &msg);
+	bool dequeue(QueuedMsg* &pmsg);
+	void writerLoop();
 	logLevel identifyLevel(string level);
 };
+
+//@cond DUMMY
+///Macros to log messages at the given level evaluating the message expression only when it would be recorded
+#define LOG_AT(PLOG, LEVEL, METHOD, MSG) do { if ((PLOG)->isLevel(Logger::LEVEL)) (PLOG)->METHOD(MSG); } while (0)
+#define LOG_CONFIG(PLOG, MSG) LOG_AT(PLOG, CONFIG, config, MSG)
+#define LOG_FINE(PLOG, MSG) LOG_AT(PLOG, FINE, fine, MSG)
+#define LOG_FINER(PLOG, MSG) LOG_AT(PLOG, FINER, finer, MSG)
+#define LOG_FINEST(PLOG, MSG) LOG_AT(PLOG, FINEST, finest, MSG)
+//@endcond
 #endif
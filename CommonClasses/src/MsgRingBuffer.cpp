@@ -0,0 +1,119 @@
+/** @file MsgRingBuffer.cpp
+ * Contains the implementation of the MsgRingBuffer class.
+ */
+
+#include "MsgRingBuffer.h"
+
+/**Constructs a MsgRingBuffer object allocating the given number of slots and their data buffers.
+ *
+ * @param nSlots the number of slots in the ring (at least 1)
+ * @param slotSize the size in bytes of the data buffer of each slot
+ */
+MsgRingBuffer::MsgRingBuffer(unsigned int nSlots, unsigned int slotSize) {
+	if (nSlots == 0) nSlots = 1;
+	this->slotSize = slotSize;
+	store = new unsigned char[(size_t) nSlots * slotSize];
+	slots.resize(nSlots);
+	for (unsigned int i = 0; i < nSlots; i++) {
+		slots[i].status = 0;
+		slots[i].length = 0;
+		slots[i].data = store + (size_t) i * slotSize;
+	}
+	head.store(0);
+	tail.store(0);
+	highWater.store(0);
+	dropped.store(0);
+	closed.store(false);
+}
+
+/**Destructs MsgRingBuffer objects.
+ */
+MsgRingBuffer::~MsgRingBuffer(void) {
+	delete[] store;
+}
+
+/**getFree gives the next free slot to be filled by the producer.
+ * If the ring is full, the message the producer tries to store is counted as dropped.
+ *
+ * @return a pointer to the free slot, or NULL if the ring is full
+ */
+MsgRingBuffer::Slot* MsgRingBuffer::getFree() {
+	unsigned long h = head.load(memory_order_relaxed);
+	if (h - tail.load(memory_order_acquire) >= slots.size()) {
+		dropped++;
+		return NULL;
+	}
+	return &slots[h % slots.size()];
+}
+
+/**push makes available to the consumer the slot given by the last getFree call, and updates the high-water mark.
+ */
+void MsgRingBuffer::push() {
+	unsigned long h = head.load(memory_order_relaxed) + 1;
+	head.store(h, memory_order_release);
+	unsigned int filled = (unsigned int) (h - tail.load(memory_order_acquire));
+	if (filled > highWater.load(memory_order_relaxed)) highWater.store(filled, memory_order_relaxed);
+}
+
+/**getFilled gives the oldest slot pushed by the producer and not yet popped.
+ *
+ * @return a pointer to the slot, or NULL if the ring is empty
+ */
+MsgRingBuffer::Slot* MsgRingBuffer::getFilled() {
+	unsigned long t = tail.load(memory_order_relaxed);
+	if (t == head.load(memory_order_acquire)) return NULL;
+	return &slots[t % slots.size()];
+}
+
+/**pop frees the slot given by the last getFilled call, to be reused by the producer.
+ */
+void MsgRingBuffer::pop() {
+	tail.store(tail.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+/**close is called by the producer to notify that no more messages will be pushed.
+ */
+void MsgRingBuffer::close() {
+	closed.store(true, memory_order_release);
+}
+
+/**isClosed tells if the producer has closed the ring.
+ * Slots pushed before closing it can still be pending: they shall be taken calling getFilled after isClosed.
+ *
+ * @return true if the ring has been closed, false otherwise
+ */
+bool MsgRingBuffer::isClosed() {
+	return closed.load(memory_order_acquire);
+}
+
+/**getSize gives the number of slots in the ring.
+ *
+ * @return the number of slots
+ */
+unsigned int MsgRingBuffer::getSize() {
+	return (unsigned int) slots.size();
+}
+
+/**getSlotSize gives the size of the data buffer of each slot.
+ *
+ * @return the data buffer size in bytes
+ */
+unsigned int MsgRingBuffer::getSlotSize() {
+	return slotSize;
+}
+
+/**getHighWater gives the maximum number of slots that have been filled at the same time.
+ *
+ * @return the high-water mark
+ */
+unsigned int MsgRingBuffer::getHighWater() {
+	return highWater.load(memory_order_relaxed);
+}
+
+/**getDropped gives the number of messages dropped because the ring was full.
+ *
+ * @return the number of messages dropped
+ */
+unsigned long MsgRingBuffer::getDropped() {
+	return dropped.load(memory_order_relaxed);
+}
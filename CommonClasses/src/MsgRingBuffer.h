@@ -0,0 +1,76 @@
+/** @file MsgRingBuffer.h
+ * Contains the MsgRingBuffer class definition used to pass messages from a producer thread to a consumer thread.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef MSGRINGBUFFER_H
+#define MSGRINGBUFFER_H
+
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+/**MsgRingBuffer class provides a lock-free ring of message slots to pass messages from one producer thread to one consumer thread.
+ *<p>All slots and their data buffers are allocated when the object is constructed: no allocations are made when passing messages.
+ *<p>The producer thread would perform the following steps for each message:
+ *	-# Call getFree to get the next free slot. If the ring is full, NULL is returned and the message shall be discarded:
+ *		it is counted as dropped
+ *	-# Fill the slot data, length and status
+ *	-# Call push to make the slot available to the consumer
+ *<p>When no more messages will be produced, the producer calls close.
+ *<p>The consumer thread would perform the following steps:
+ *	-# Call getFilled to get the oldest slot pushed. If NULL is returned, the ring is empty: if isClosed was true before calling
+ *		getFilled, no more messages will arrive
+ *	-# Use the slot data
+ *	-# Call pop to free the slot
+ *<p>The ring keeps the high-water mark (maximum number of slots filled at the same time) and the number of messages dropped.
+ */
+class MsgRingBuffer {
+public:
+	struct Slot {			//a message slot in the ring
+		int status;				//a status code stated by the producer
+		unsigned int length;	//the number of bytes in data
+		unsigned char* data;	//the message data buffer, having slotSize bytes
+	};
+	MsgRingBuffer(unsigned int nSlots, unsigned int slotSize);
+	~MsgRingBuffer(void);
+	Slot* getFree();
+	void push();
+	Slot* getFilled();
+	void pop();
+	void close();
+	bool isClosed();
+	unsigned int getSize();
+	unsigned int getSlotSize();
+	unsigned int getHighWater();
+	unsigned long getDropped();
+
+private:
+	vector<Slot> slots;			//the ring of slots
+	unsigned char* store;		//the buffer for data of all slots
+	unsigned int slotSize;		//the size in bytes of each slot data buffer
+	atomic<unsigned long> head;	//the number of slots pushed. Modified only by the producer
+	atomic<unsigned long> tail;	//the number of slots popped. Modified only by the consumer
+	atomic<unsigned int> highWater;	//the maximum number of slots filled at the same time
+	atomic<unsigned long> dropped;	//the number of messages discarded because the ring was full
+	atomic<bool> closed;		//set by the producer when no more messages will be pushed
+
+	MsgRingBuffer(const MsgRingBuffer &);				//objects cannot be copied
+	MsgRingBuffer& operator=(const MsgRingBuffer &);
+};
+#endif
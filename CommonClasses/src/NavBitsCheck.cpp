@@ -0,0 +1,87 @@
+/** @file NavBitsCheck.cpp
+ * Contains the implementation of routines used to validate the bits of navigation messages.
+ */
+#include "NavBitsCheck.h"
+
+//@cond DUMMY
+//GPS parity algorithm in GPS ICD Table 20-XIV can be implemented computing the parity (even or odd number of 1) of the word bits
+//selected with a mask: parityBitMask[i] identifies bits participating (set to 1) or not (set to 0) in the computation of parity bit i.
+const unsigned int parityBitMask[] = {0xBB1F3480, 0x5D8F9A40, 0xAEC7CD00, 0x5763E680, 0x6BB1F340, 0x8B7A89C0};
+//GLONASS Hamming code check sums C1 to C7 in GLONASS ICD (Section 4.7) are computed as the parity of the string bits selected
+//with a mask: hammingMask[k] identifies the string bits (packed in three words, see GNSSdataFromOSP::getGLOstring) participating
+//in the check sum C(k+1), including the check bit beta(k+1). Idle bit 85 is always 0 and is not included.
+const unsigned int hammingMask[7][GLOSTRWORDS] = {
+	{0xAAAD5B01, 0x55555556, 0x000AAAAB},
+	{0x33366D02, 0x9999999B, 0x000CCCCD},
+	{0xC3C78E04, 0xE1E1E1E3, 0x0000F0F1},
+	{0xFC07F008, 0xFE01FE03, 0x0000FF01},
+	{0xFFF80010, 0xFFFE0003, 0x000F0001},
+	{0x00000020, 0xFFFFFFFC, 0x00000001},
+	{0x00000040, 0x00000000, 0x000FFFFE}
+};
+//the count of bits set in a 32 bits word: uses the processor instruction when available
+#if defined(__GNUC__)
+#define POPCOUNT(x) ((unsigned int) __builtin_popcount(x))
+#else
+#define POPCOUNT(x) bitsCount(x)
+#endif
+//@endcond
+
+/**bitsCount counts the number of bits set in a given 32 bits word.
+ * Bits are counted in parallel, adding the counts of adjacent groups of bits (no loop over individual bits is performed).
+ *
+ * @param bits the 32 bits word to be processed
+ * @return the number of bits set to 1 in bits
+ */
+unsigned int bitsCount(unsigned int bits) {
+	bits = bits - ((bits >> 1) & 0x55555555);
+	bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0F;
+	return (bits * 0x01010101) >> 24;
+}
+
+/**checkGPSparity checks the parity of a GPS message subframe word using procedure in GPS ICD.
+ * To check the parity, the six bits of parity are computed for the word contents, and then compared with the current parity in the 6 LSB of the word passed.
+ *
+ * @param word The subframe word passed, where the two LSB bits of the previous word have been added (it has the form: D29* D30* d1 .. d30)
+ * @return true if parity computed is equal to the current parity in the six LSB of the word
+ */
+bool checkGPSparity(unsigned int word) {
+	unsigned int toCheck = word;
+	if ((word & 0x40000000) != 0) toCheck = (word & 0xC0000000) | (~word & 0x3FFFFFFF);
+	//compute the parity of the bit stream
+	unsigned int parity = 0;
+	for (int i=0; i<6; i++) parity |= (POPCOUNT(parityBitMask[i] & toCheck) & 0x01) << (5-i);
+	return parity == (word & 0x3F);
+}
+
+/**checkGPSsubframe checks the parity of all words in a GPS message subframe.
+ *
+ * @param words the ten subframe words, each one having the form: D29* D30* d1 .. d30
+ * @return 0 if parity is correct in all words, or a bit mask identifying the words with wrong parity (bit i set if word i is wrong)
+ */
+unsigned int checkGPSsubframe(const unsigned int* words) {
+	unsigned int wrong = 0;
+	for (int i=0; i<GPSSUBFRWORDS; i++) if (!checkGPSparity(words[i])) wrong |= 1 << i;
+	return wrong;
+}
+
+/**checkGLOhamming checks the GLONASS string for correct Hamming code, using the procedure in GLONASS ICD.
+ * Check sums C1 to C7 and the check sum of all string bits are computed. The string is correct when all of them are 0,
+ * or when only one of C1 to C7 is 1 and the check sum of all bits is 1 (the error is in a check bit, not in data).
+ * Other combinations mean errors in data bits: the string is considered wrong, even if a single error could be corrected.
+ *
+ * @param strWords a pointer to the 84 bits of the string to be checked, packed in 3 words as per GNSSdataFromOSP::getGLOstring
+ * @return true if the Hamming code in bits 1-8 of the string is correct, false otherwise
+ */
+bool checkGLOhamming(const unsigned int* strWords) {
+	unsigned int checkSums = 0;
+	for (int k=0; k<7; k++)
+		checkSums |= ((POPCOUNT(hammingMask[k][0] & strWords[0])
+			+ POPCOUNT(hammingMask[k][1] & strWords[1])
+			+ POPCOUNT(hammingMask[k][2] & strWords[2])) & 0x01) << k;
+	unsigned int sumAll = (POPCOUNT(strWords[0]) + POPCOUNT(strWords[1]) + POPCOUNT(strWords[2] & 0x000FFFFF)) & 0x01;
+	if (checkSums == 0) return sumAll == 0;
+	return (sumAll == 1) && ((checkSums & (checkSums - 1)) == 0);
+}
+#undef POPCOUNT
@@ -0,0 +1,34 @@
+/** @file NavBitsCheck.h
+ * Contains definition of routines used to validate the bits of navigation messages broadcast by GNSS satellites
+ * (GPS subframe words parity and GLONASS strings Hamming code).
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef NAVBITSCHECK_H
+#define NAVBITSCHECK_H
+
+//@cond DUMMY
+//Number of words in a GPS subframe
+#define GPSSUBFRWORDS 10
+//Number of words where a GLONASS string is packed
+#define GLOSTRWORDS 3
+//@endcond
+
+unsigned int bitsCount(unsigned int bits);		//counts the bits set in a 32 bits word
+bool checkGPSparity(unsigned int word);		//checks the parity of a GPS subframe word having D29* D30* d1 ... d30 bits
+unsigned int checkGPSsubframe(const unsigned int* words);	//checks the parity of the ten words of a GPS subframe
+bool checkGLOhamming(const unsigned int* strWords);	//checks the Hamming code of a GLONASS string packed in three words
+#endif
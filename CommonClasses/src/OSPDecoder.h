@@ -0,0 +1,272 @@
+/** @file OSPDecoder.h
+ * Contains the OSP message layouts described as compile time field descriptors, the plain structs where message data
+ * are decoded, and the OSPDispatchTable template used to dispatch messages to their handlers by MID.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef OSPDECODER_H
+#define OSPDECODER_H
+
+#include <string.h>
+#include <type_traits>
+
+//from CommonClasses
+#include "OSPMessage.h"
+
+/**Field types in OSP message payloads. Each type states its size in bytes and how its value is got from the payload bytes:
+ * integers are stored with the most significant byte first, floats with bytes in reverse order, and doubles with bytes
+ * in the SiRF order 3, 2, 1, 0, 7, 6, 5, 4 (two big endian 32 bits words, the low order one first).
+ */
+struct OSPU1 {
+	static const unsigned int SIZE = 1;
+	static unsigned int get(const unsigned char* p) {
+		return p[0];
+	}
+};
+
+struct OSPU2 {
+	static const unsigned int SIZE = 2;
+	static unsigned short get(const unsigned char* p) {
+		return (unsigned short) (p[0] << 8 | p[1]);
+	}
+};
+
+struct OSPS2 {
+	static const unsigned int SIZE = 2;
+	static short get(const unsigned char* p) {
+		return (short) (p[0] << 8 | p[1]);
+	}
+};
+
+struct OSPU4 {
+	static const unsigned int SIZE = 4;
+	static unsigned int get(const unsigned char* p) {
+		return (unsigned int) p[0] << 24 | (unsigned int) p[1] << 16 | (unsigned int) p[2] << 8 | p[3];
+	}
+};
+
+struct OSPS4 {
+	static const unsigned int SIZE = 4;
+	static int get(const unsigned char* p) {
+		return (int) OSPU4::get(p);
+	}
+};
+
+struct OSPF4 {
+	static const unsigned int SIZE = 4;
+	static float get(const unsigned char* p) {
+		unsigned int bits = OSPU4::get(p);
+		float value;
+		memcpy(&value, &bits, sizeof value);
+		return value;
+	}
+};
+
+struct OSPD8 {
+	static const unsigned int SIZE = 8;
+	static double get(const unsigned char* p) {
+		unsigned long long bits = OSPU4::get(p);
+		bits |= (unsigned long long) OSPU4::get(p + 4) << 32;
+		double value;
+		memcpy(&value, &bits, sizeof value);
+		return value;
+	}
+};
+
+/**OSPField describes a field of a message layout: the struct member where its value is placed, its type, and its offset in the payload.
+ * Fields are usually described using the OSP_FIELD macro.
+ */
+template <typename S, typename M, M S::*MEMBER, typename TYPE, unsigned int OFFSET>
+struct OSPField {
+	static const unsigned int END = OFFSET + TYPE::SIZE;	//the payload length needed to contain the field
+	static void decode(const unsigned char* payload, S &data) {
+		data.*MEMBER = (M) TYPE::get(payload + OFFSET);
+	}
+};
+
+/**OSPArrayField describes a field of a message layout containing N consecutive values of the same type, which are placed in an array member.
+ * Fields are usually described using the OSP_ARRAY macro.
+ */
+template <typename S, typename M, unsigned int N, M (S::*MEMBER)[N], typename TYPE, unsigned int OFFSET>
+struct OSPArrayField {
+	static const unsigned int END = OFFSET + N * TYPE::SIZE;
+	static void decode(const unsigned char* payload, S &data) {
+		for (unsigned int i = 0; i < N; i++) (data.*MEMBER)[i] = (M) TYPE::get(payload + OFFSET + i * TYPE::SIZE);
+	}
+};
+
+//@cond DUMMY
+///Macros to describe the fields of a layout: the struct, the member, the field type and the offset in the payload (the MID is at 0)
+#define OSP_FIELD(S, MEMBER, TYPE, OFFSET) OSPField<S, decltype(S::MEMBER), &S::MEMBER, TYPE, OFFSET>
+#define OSP_ARRAY(S, MEMBER, TYPE, OFFSET) OSPArrayField<S, std::remove_extent<decltype(S::MEMBER)>::type, \
+	std::extent<decltype(S::MEMBER)>::value, &S::MEMBER, TYPE, OFFSET>
+
+template <typename... FIELDS> struct OSPLayoutEnd;
+template <> struct OSPLayoutEnd<> {
+	static const unsigned int value = 0;
+};
+template <typename F, typename... FIELDS> struct OSPLayoutEnd<F, FIELDS...> {
+	static const unsigned int value = F::END > OSPLayoutEnd<FIELDS...>::value? F::END : OSPLayoutEnd<FIELDS...>::value;
+};
+//@endcond
+
+/**OSPLayout describes the layout of a message payload as a list of fields (OSPField or OSPArrayField), and decodes
+ * payloads having this layout into the given struct.
+ *<p>The payload length needed is computed at compile time from the fields, and it is checked once before decoding.
+ * Field extraction is expanded at compile time: each field is got from its fixed offset without further checks.
+ */
+template <typename S, typename... FIELDS>
+struct OSPLayout {
+	static const unsigned int LENGTH = OSPLayoutEnd<FIELDS...>::value;	//the minimum payload length for this layout
+	/**decode decodes the given payload into the struct.
+	 *
+	 * @param payload the payload bytes (its first byte is the MID)
+	 * @param length the payload length
+	 * @param data the struct where field values are placed
+	 * @return true if the payload has been decoded, false otherwise (payload shorter than LENGTH)
+	 */
+	static bool decode(const unsigned char* payload, unsigned int length, S &data) {
+		if (length < LENGTH) return false;
+		int expand[] = {0, (FIELDS::decode(payload, data), 0)...};
+		(void) expand;
+		return true;
+	}
+	/**decode decodes the payload of the given message into the struct (see above)
+	 *
+	 * @param message the message to decode
+	 * @param data the struct where field values are placed
+	 * @return true if the payload has been decoded, false otherwise (payload shorter than LENGTH)
+	 */
+	static bool decode(OSPMessage &message, S &data) {
+		return decode(message.payloadData(), message.payloadLen(), data);
+	}
+};
+
+/**OSPDispatchTable is a table of 256 entries stating the handler for messages with each MID.
+ * HANDLER would be a pointer to function or to member function. Entries not set contain a null handler.
+ */
+template <typename HANDLER>
+class OSPDispatchTable {
+	HANDLER handlers[256];
+public:
+	OSPDispatchTable() {
+		for (int i = 0; i < 256; i++) handlers[i] = HANDLER();
+	}
+	void set(int mid, HANDLER handler) {
+		handlers[mid & 0xFF] = handler;
+	}
+	HANDLER get(int mid) const {
+		return handlers[mid & 0xFF];
+	}
+};
+
+//Structs for data of messages having a fixed layout, and their layouts (see SiRF IV ICD for details)
+///MID2 Measure Navigation Data Out
+struct OSPMID2Data {
+	int x, y, z;			//position in m
+	short vX, vY, vZ;		//velocity in m/s * 8
+	int mode1, hdop2, mode2;
+	unsigned short week;	//GPS week (without rollover)
+	int tow;				//GPS time of week in s * 100
+	int svs;				//satellites used in the solution
+};
+typedef OSPLayout<OSPMID2Data,
+	OSP_FIELD(OSPMID2Data, x, OSPS4, 1),
+	OSP_FIELD(OSPMID2Data, y, OSPS4, 5),
+	OSP_FIELD(OSPMID2Data, z, OSPS4, 9),
+	OSP_FIELD(OSPMID2Data, vX, OSPS2, 13),
+	OSP_FIELD(OSPMID2Data, vY, OSPS2, 15),
+	OSP_FIELD(OSPMID2Data, vZ, OSPS2, 17),
+	OSP_FIELD(OSPMID2Data, mode1, OSPU1, 19),
+	OSP_FIELD(OSPMID2Data, hdop2, OSPU1, 20),
+	OSP_FIELD(OSPMID2Data, mode2, OSPU1, 21),
+	OSP_FIELD(OSPMID2Data, week, OSPU2, 22),
+	OSP_FIELD(OSPMID2Data, tow, OSPS4, 24),
+	OSP_FIELD(OSPMID2Data, svs, OSPU1, 28)> OSPMID2Layout;
+
+///MID7 Clock Status Data
+struct OSPMID7Data {
+	unsigned short week;	//GPS week (includes rollover)
+	unsigned int tow;		//GPS time of week in s * 100
+	int svs;				//satellites used in the solution
+	unsigned int drift;		//clock drift in Hz
+	unsigned int bias;		//clock bias in ns
+	unsigned int estGPStime;	//estimated GPS time in ms
+};
+typedef OSPLayout<OSPMID7Data,
+	OSP_FIELD(OSPMID7Data, week, OSPU2, 1),
+	OSP_FIELD(OSPMID7Data, tow, OSPU4, 3),
+	OSP_FIELD(OSPMID7Data, svs, OSPU1, 7),
+	OSP_FIELD(OSPMID7Data, drift, OSPU4, 8),
+	OSP_FIELD(OSPMID7Data, bias, OSPU4, 12),
+	OSP_FIELD(OSPMID7Data, estGPStime, OSPU4, 16)> OSPMID7Layout;
+
+///MID8 50 BPS Data
+struct OSPMID8Data {
+	int channel;
+	int sv;					//the satellite number assigned by the receiver
+	unsigned int words[10];	//the navigation message words
+};
+typedef OSPLayout<OSPMID8Data,
+	OSP_FIELD(OSPMID8Data, channel, OSPU1, 1),
+	OSP_FIELD(OSPMID8Data, sv, OSPU1, 2),
+	OSP_ARRAY(OSPMID8Data, words, OSPU4, 3)> OSPMID8Layout;
+
+///MID15 Ephemeris Data
+struct OSPMID15Data {
+	int sv;
+	unsigned int navW[45];	//the 3x15 data items of subframes 1, 2 and 3
+};
+typedef OSPLayout<OSPMID15Data,
+	OSP_FIELD(OSPMID15Data, sv, OSPU1, 1),
+	OSP_ARRAY(OSPMID15Data, navW, OSPU2, 2)> OSPMID15Layout;
+
+///MID19 Navigation Parameters (only the masks are decoded)
+struct OSPMID19Data {
+	short elevationMask;	//in degrees * 10
+	int snrMask;			//in dB-Hz
+};
+typedef OSPLayout<OSPMID19Data,
+	OSP_FIELD(OSPMID19Data, elevationMask, OSPS2, 20),
+	OSP_FIELD(OSPMID19Data, snrMask, OSPU1, 22)> OSPMID19Layout;
+
+///MID28 Navigation Library Measurement Data
+struct OSPMID28Data {
+	int channel;
+	unsigned int timeTag;		//in ms
+	int sv;						//the satellite number assigned by the receiver
+	double gpsSWtime;			//in s
+	double pseudorange;			//in m
+	float carrierFrequency;		//in m/s
+	double carrierPhase;		//in m
+	unsigned short timeInTrack;	//in ms
+	int syncFlags;
+	int cn0[10];				//C/N0 in dB-Hz
+	unsigned short deltaRangeInterval;	//in ms
+};
+typedef OSPLayout<OSPMID28Data,
+	OSP_FIELD(OSPMID28Data, channel, OSPU1, 1),
+	OSP_FIELD(OSPMID28Data, timeTag, OSPU4, 2),
+	OSP_FIELD(OSPMID28Data, sv, OSPU1, 6),
+	OSP_FIELD(OSPMID28Data, gpsSWtime, OSPD8, 7),
+	OSP_FIELD(OSPMID28Data, pseudorange, OSPD8, 15),
+	OSP_FIELD(OSPMID28Data, carrierFrequency, OSPF4, 23),
+	OSP_FIELD(OSPMID28Data, carrierPhase, OSPD8, 27),
+	OSP_FIELD(OSPMID28Data, timeInTrack, OSPU2, 35),
+	OSP_FIELD(OSPMID28Data, syncFlags, OSPU1, 37),
+	OSP_ARRAY(OSPMID28Data, cn0, OSPU1, 38),
+	OSP_FIELD(OSPMID28Data, deltaRangeInterval, OSPU2, 48)> OSPMID28Layout;
+#endif
@@ -0,0 +1,249 @@
+/** @file OSPIndex.cpp
+ * Contains the implementation of the OSPIndex class.
+ */
+
+#include <string.h>
+
+#include "OSPIndex.h"
+//from CommonClasses
+#include "OSPMessage.h"
+#include "Utilities.h"
+
+//@cond DUMMY
+///The identification written at the beginning of index files
+const char IDXID[] = "OSPIDX01";
+///The size in bytes of an index entry in the index file
+#define IDXENTRYSIZE 15
+//@endcond
+
+/**putBigEndian stores in the buffer the n less significant bytes of the value given, most significant byte first.
+ *
+ * @param buffer the place where bytes will be stored
+ * @param value the value to store
+ * @param n the number of bytes to store
+ */
+static void putBigEndian(unsigned char* buffer, unsigned long long value, int n) {
+	for (int i=n-1; i>=0; i--) {
+		buffer[i] = (unsigned char) (value & 0xFF);
+		value >>= 8;
+	}
+}
+
+/**getBigEndian gets the value of the n bytes in the buffer given, most significant byte first.
+ *
+ * @param buffer the place where bytes are stored
+ * @param n the number of bytes to get
+ * @return the value of the bytes
+ */
+static unsigned long long getBigEndian(const unsigned char* buffer, int n) {
+	unsigned long long value = 0;
+	for (int i=0; i<n; i++) value = (value << 8) | buffer[i];
+	return value;
+}
+
+/**Constructs an empty OSPIndex object.
+ */
+OSPIndex::OSPIndex(void) {
+	clear();
+}
+
+/**Destructs OSPIndex objects.
+ */
+OSPIndex::~OSPIndex(void) {
+}
+
+/**indexFileName gives the name of the index file corresponding to the given OSP file name.
+ *
+ * @param ospFileName the OSP file name
+ * @return the index file name (the OSP file name followed by OSPIDXEXT)
+ */
+string OSPIndex::indexFileName(string ospFileName) {
+	return ospFileName + OSPIDXEXT;
+}
+
+/**clear removes all data in the index.
+ */
+void OSPIndex::clear() {
+	entries.clear();
+	ospLength = 0;
+	lastWeek = 0;
+	lastTow = 0.0;
+}
+
+/**addMessage adds to the index a message placed just after the last one indexed.
+ * When the message is a MID7, its GPS week and time of week are used to tag this and the following messages.
+ *
+ * @param payload the message payload (first byte is the MID)
+ * @param length the payload length
+ */
+void OSPIndex::addMessage(const unsigned char* payload, unsigned int length) {
+	MsgEntry entry;
+	entry.offset = ospLength;
+	entry.mid = length > 0? payload[0] : 0;
+	if ((entry.mid == 7) && (length >= 7)) {
+		lastWeek = (int) getBigEndian(payload + 1, 2);
+		lastTow = (double) getBigEndian(payload + 3, 4) / 100.0;
+	}
+	entry.week = lastWeek;
+	entry.tow = lastTow;
+	entries.push_back(entry);
+	ospLength += length + 2;
+}
+
+/**build builds the index reading all messages in the given OSP file.
+ * The file is read from its beginning, and rewound after reading it.
+ *
+ * @param ospFile the OSP binary file to index
+ * @return true if the index has been built, false otherwise (the file contains a truncated message)
+ */
+bool OSPIndex::build(FILE* ospFile) {
+	unsigned char buffer[MAXPAYLOADSIZE];
+	unsigned int length;
+	bool complete = true;
+	clear();
+	rewind(ospFile);
+	while (fread(buffer, 1, 2, ospFile) == 2) {
+		length = (buffer[0] << 8) | buffer[1];	//numbers in msg are big endians
+		if ((length > MAXPAYLOADSIZE) || (fread(buffer, 1, length, ospFile) < length)) {
+			complete = false;
+			break;
+		}
+		addMessage(buffer, length);
+	}
+	rewind(ospFile);
+	return complete;
+}
+
+/**save writes the index data to the given index file.
+ *
+ * @param fileName the index file name
+ * @return true if the index file has been written, false otherwise
+ */
+bool OSPIndex::save(string fileName) {
+	unsigned char buffer[IDXENTRYSIZE];
+	FILE* idxFile;
+	bool written;
+	if ((idxFile = fopen(fileName.c_str(), "wb")) == NULL) return false;
+	putBigEndian(buffer, ospLength, 8);
+	written = (fwrite(IDXID, 1, 8, idxFile) == 8) && (fwrite(buffer, 1, 8, idxFile) == 8);
+	putBigEndian(buffer, entries.size(), 4);
+	written = written && (fwrite(buffer, 1, 4, idxFile) == 4);
+	for (vector<MsgEntry>::iterator it = entries.begin(); written && (it != entries.end()); it++) {
+		putBigEndian(buffer, it->offset, 8);
+		putBigEndian(buffer + 8, it->mid, 1);
+		putBigEndian(buffer + 9, it->week, 2);
+		putBigEndian(buffer + 11, (unsigned long long) (it->tow * 100.0 + 0.5), 4);
+		written = fwrite(buffer, 1, IDXENTRYSIZE, idxFile) == IDXENTRYSIZE;
+	}
+	return (fclose(idxFile) == 0) && written;
+}
+
+/**load reads the index data from the given index file.
+ * Index data read are accepted only if the length of the OSP data indexed matches the length of the given OSP file.
+ *
+ * @param fileName the index file name
+ * @param ospFile the OSP binary file indexed
+ * @return true if the index has been loaded, false otherwise (the file does not exist, its format is not correct or does not match the OSP file)
+ */
+bool OSPIndex::load(string fileName, FILE* ospFile) {
+	unsigned char buffer[IDXENTRYSIZE];
+	FILE* idxFile;
+	unsigned int n;
+	MsgEntry entry;
+	clear();
+	if ((idxFile = fopen(fileName.c_str(), "rb")) == NULL) return false;
+	if ((fread(buffer, 1, 8, idxFile) != 8) || (memcmp(buffer, IDXID, 8) != 0)
+			|| (fread(buffer, 1, 8, idxFile) != 8) || ((long long) getBigEndian(buffer, 8) != fileLength(ospFile))
+			|| (fread(buffer, 1, 4, idxFile) != 4)) {
+		fclose(idxFile);
+		return false;
+	}
+	n = (unsigned int) getBigEndian(buffer, 4);
+	entries.reserve(n);
+	while ((entries.size() < n) && (fread(buffer, 1, IDXENTRYSIZE, idxFile) == IDXENTRYSIZE)) {
+		entry.offset = (long long) getBigEndian(buffer, 8);
+		entry.mid = (int) buffer[8];
+		entry.week = (int) getBigEndian(buffer + 9, 2);
+		entry.tow = (double) getBigEndian(buffer + 11, 4) / 100.0;
+		if (!entries.empty() && (entry.offset <= entries.back().offset)) break;	//offsets shall be increasing
+		entries.push_back(entry);
+	}
+	fclose(idxFile);
+	if (entries.size() != n) {
+		clear();
+		return false;
+	}
+	ospLength = fileLength(ospFile);
+	return true;
+}
+
+/**size gives the number of messages indexed.
+ *
+ * @return the number of index entries
+ */
+unsigned int OSPIndex::size() {
+	return entries.size();
+}
+
+/**getEntry gives the index data of the n-th message in the OSP file.
+ *
+ * @param n the position of the message in the OSP file (from 0)
+ * @return the index data of the message
+ */
+const OSPIndex::MsgEntry& OSPIndex::getEntry(unsigned int n) {
+	return entries[n];
+}
+
+/**epochOffset gives the position in the OSP file of the first message belonging to the first epoch tagged at or after the given time.
+ * An epoch starts just after the MID7 message of the previous epoch, and finishes with its own MID7.
+ *
+ * @param tTag the time in seconds from the GPS ephemeris (6/1/1980)
+ * @return the offset of the first message of the epoch, or the length of the OSP data indexed if no epoch exists after the given time
+ */
+long long OSPIndex::epochOffset(double tTag) {
+	unsigned int low = 0;
+	unsigned int high = entries.size();
+	unsigned int mid;
+	//binary search of the first entry tagged at or after tTag: it is the first MID7 of such epochs
+	while (low < high) {
+		mid = (low + high) / 2;
+		if (timeTag(mid) < tTag) low = mid + 1;
+		else high = mid;
+	}
+	if (low >= entries.size()) return ospLength;
+	//go back to the message just after the previous MID7
+	while ((low > 0) && (entries[low-1].mid != 7)) low--;
+	return entries[low].offset;
+}
+
+/**length gives the length in bytes of the OSP data indexed.
+ *
+ * @return the length of the OSP data indexed
+ */
+long long OSPIndex::length() {
+	return ospLength;
+}
+
+/**timeTag gives the time tag of the n-th entry in the index.
+ * Entries before the first MID7 in the file have time tag 0.
+ *
+ * @param n the entry position
+ * @return the time tag in seconds from the GPS ephemeris (6/1/1980)
+ */
+double OSPIndex::timeTag(unsigned int n) {
+	if (entries[n].week == 0 && entries[n].tow == 0.0) return 0.0;
+	return getSecsGPSEphe(entries[n].week, entries[n].tow);
+}
+
+/**fileLength gives the length in bytes of the given file, keeping its current position.
+ *
+ * @param file the file
+ * @return the file length in bytes
+ */
+long long OSPIndex::fileLength(FILE* file) {
+	long long position = FTELL64(file);
+	FSEEK64(file, 0, SEEK_END);
+	long long fileLen = FTELL64(file);
+	FSEEK64(file, position, SEEK_SET);
+	return fileLen;
+}
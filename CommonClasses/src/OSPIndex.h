@@ -0,0 +1,85 @@
+/** @file OSPIndex.h
+ * Contains the OSPIndex class definition used to build, save and load an index of the messages contained in an OSP binary file.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef OSPINDEX_H
+#define OSPINDEX_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+///The extension added to the OSP file name to name its index file
+#define OSPIDXEXT ".ospidx"
+///Macros to position the file stream using 64 bits offsets
+#ifdef _WIN32
+#define FSEEK64 _fseeki64
+#define FTELL64 _ftelli64
+#else
+#define FSEEK64 fseeko
+#define FTELL64 ftello
+#endif
+
+/**OSPIndex class provides resources to have random access to messages in an OSP binary file.
+ *<p>For each message in the OSP file the index stores:
+ * - its byte offset in the file (the position of the payload length)
+ * - its MID (message identification)
+ * - the GPS week and time of week of the last MID7 message found up to this message (inclusive), or 0 if none
+ *<p>The index can be built when the OSP file is recorded, adding each message written, or later reading the OSP file.
+ * It can be saved to a sidecar index file (the OSP file name followed by OSPIDXEXT) and loaded from it.
+ *<p>Index file contents are binary data, with integers stored most significant byte first (as in OSP messages):
+ * - 8 bytes with the identification "OSPIDX01"
+ * - 8 bytes with the length of the OSP file indexed, used to detect index files not matching the OSP file
+ * - 4 bytes with the number of messages indexed
+ * - for each message, 15 bytes containing: the offset (8 bytes), the MID (1 byte), the GPS week (2 bytes),
+ *		and the GPS time of week scaled by 100 (4 bytes) as in MID7
+ *<p>Index data allow to get the position of the first message of the epochs in a given time window,
+ * or the position of messages having a given MID.
+ */
+class OSPIndex {
+public:
+	struct MsgEntry {	//index data of a message in the OSP file
+		long long offset;	//the position in the OSP file of the message (its payload length)
+		int mid;			//the message identification
+		int week;			//the GPS week of the last MID7 message found up to this message, or 0 if none
+		double tow;			//the GPS time of week of the last MID7 message found up to this message
+	};
+	OSPIndex(void);
+	~OSPIndex(void);
+	static string indexFileName(string ospFileName);
+	void clear();
+	void addMessage(const unsigned char* payload, unsigned int length);
+	bool build(FILE* ospFile);
+	bool save(string fileName);
+	bool load(string fileName, FILE* ospFile);
+	unsigned int size();
+	const MsgEntry& getEntry(unsigned int n);
+	long long epochOffset(double tTag);
+	long long length();
+
+private:
+	vector<MsgEntry> entries;	//the index entries, one for each message
+	long long ospLength;		//the length in bytes of the OSP data indexed
+	int lastWeek;				//GPS week of the last MID7 indexed
+	double lastTow;				//GPS time of week of the last MID7 indexed
+
+	double timeTag(unsigned int n);
+	long long fileLength(FILE* file);
+};
+#endif
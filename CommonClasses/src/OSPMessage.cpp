@@ -5,17 +5,23 @@
 #include "OSPMessage.h"
 //from CommonClasses
 #include "Utilities.h"
+#include "PerfCounters.h"
 
 /**Constructs and empty OSPMessage object.
  */
 OSPMessage::OSPMessage(void) {
 	cursor = 0;
 	payloadLength = 0;
+	payload = msgBuffer;
+	block = NULL;
+	blockLen = 0;
+	blockCursor = 0;
 }
 
 /**Destructs OSPmessage objects.
  */
 OSPMessage::~OSPMessage(void) {
+	delete[] block;
 }
 
 /**fill fills a OSPMessage object buffer with data extracted from next message in the OSP binary file.
@@ -29,15 +35,99 @@ OSPMessage::~OSPMessage(void) {
  * @return true when a message was correctly read, false otherwise (read error or end of file found)
  */
 bool OSPMessage::fill(FILE* file) {
+	PERF_SCOPE("OSPMessage::fill");
 	unsigned char buffer[2];
 
 	cursor = 0;
+	payload = msgBuffer;
 	//read message length from the input stream
 	if (fread(buffer, 1, 2, file) < 2) return false;
 	payloadLength = (buffer[0] << 8) | buffer[1];	//numbers in msg are big endians
 	//read payload bytes
 	if (payloadLength > MAXPAYLOADSIZE) return false;
-	if (fread(payload, 1, payloadLength, file) < payloadLength) return false;
+	if (fread(msgBuffer, 1, payloadLength, file) < payloadLength) return false;
+	PERF_COUNT("OSP bytes read", payloadLength + 2);
+	return true;
+}
+
+/**fillFromBlock sets the OSPMessage object payload to the next message in the block buffer, reading a new block
+ * of data from the OSP binary file when the block buffer does not contain the complete message.
+ * The payload is not copied: it points to the message bytes in the block buffer, and remains valid until the next fill.
+ * The buffer cursor for further extractions from the payload is set to 0.
+ * <p>Because the file is read in blocks, its position can be ahead of the message extracted. If the file is repositioned,
+ * the data in the block buffer shall be discarded (see discardBlock) before using this method again.
+ * <p>Conditions for a message to be correctly extracted are the same than in fill.
+ *
+ * @param file the pointer to the OSP binary FILE containing messages
+ * @return true when a message was correctly extracted, false otherwise (read error or end of file found)
+ */
+bool OSPMessage::fillFromBlock(FILE* file) {
+	PERF_SCOPE("OSPMessage::fillFromBlock");
+	unsigned int length;
+
+	cursor = 0;
+	if (block == NULL) {
+		block = new unsigned char[OSPBLOCKSIZE];
+		blockLen = blockCursor = 0;
+	}
+	//read a new block when the message length or payload are not all in the block
+	if ((blockLen - blockCursor < 2)
+			|| (blockLen - blockCursor < 2 + (unsigned int) ((block[blockCursor] << 8) | block[blockCursor+1]))) {
+		PERF_SCOPE("OSPMessage::fillFromBlock read");
+		//move remaining bytes to the beginning of the block and fill the rest of it
+		blockLen -= blockCursor;
+		memmove(block, block + blockCursor, blockLen);
+		blockCursor = 0;
+		length = (unsigned int) fread(block + blockLen, 1, OSPBLOCKSIZE - blockLen, file);
+		PERF_COUNT("OSP bytes read", length);
+		blockLen += length;
+	}
+	if (blockLen - blockCursor < 2) return false;
+	length = (block[blockCursor] << 8) | block[blockCursor+1];	//numbers in msg are big endians
+	if ((length > MAXPAYLOADSIZE) || (blockLen - blockCursor - 2 < length)) return false;
+	payload = block + blockCursor + 2;
+	payloadLength = length;
+	blockCursor += length + 2;
+	return true;
+}
+
+/**fillFromBlock sets the OSPMessage object payload to the next message in the block buffer having one of the selected MIDs.
+ * Messages with MIDs not selected are passed over using their length: their payload is neither copied nor decoded.
+ * <p>Conditions for a message to be correctly extracted are the same than in fill.
+ *
+ * @param file the pointer to the OSP binary FILE containing messages
+ * @param selected the table with 256 entries stating for each MID if its messages shall be extracted
+ * @param skipped the counter of messages passed over, incremented for each message not selected
+ * @return true when a message was correctly extracted, false otherwise (read error or end of file found)
+ */
+bool OSPMessage::fillFromBlock(FILE* file, const bool* selected, int &skipped) {
+	while (fillFromBlock(file)) {
+		if ((payloadLength > 0) && selected[payload[0]]) return true;
+		skipped++;
+	}
+	return false;
+}
+
+/**discardBlock discards data in the block buffer not yet extracted.
+ * It shall be used when the OSP file is repositioned after having extracted messages from blocks.
+ */
+void OSPMessage::discardBlock() {
+	blockLen = blockCursor = 0;
+}
+
+/**fillFromBuffer sets the OSPMessage object payload to the given message payload already in memory.
+ * The payload is not copied: it points to the given bytes, and remains valid while they are not modified.
+ * The buffer cursor for further extractions from the payload is set to 0.
+ *
+ * @param data the message payload bytes
+ * @param length the payload length
+ * @return true when the message has been set, false otherwise (length out of margin)
+ */
+bool OSPMessage::fillFromBuffer(const unsigned char* data, unsigned int length) {
+	cursor = 0;
+	if ((length == 0) || (length > MAXPAYLOADSIZE)) return false;
+	payload = data;
+	payloadLength = length;
 	return true;
 }
 
@@ -53,6 +143,15 @@ bool OSPMessage::skipBytes(int n) {
 	return true;
 }
 
+/**resetCursor sets the payload cursor at the given position.
+ * It allows data in the current message to be extracted again (i.e. from position 1, just after the message identifier).
+ *
+ * @param pos the new position of the buffer cursor
+ */
+void OSPMessage::resetCursor(unsigned int pos) {
+	cursor = pos;
+}
+
 /**payloadLen provides the length of the current payload
  *
  * @return the payload length of the message in buffer
@@ -61,6 +160,14 @@ unsigned int OSPMessage::payloadLen() {
 	return payloadLength;
 }
 
+/**payloadData provides the bytes of the current payload
+ *
+ * @return a pointer to the payload of the message in buffer (its first byte is the MID)
+ */
+const unsigned char* OSPMessage::payloadData() {
+	return payload;
+}
+
 /**get gets the byte value in the payload at current cursor position.
  * The cursor is incremented by one after getting the byte.
  *
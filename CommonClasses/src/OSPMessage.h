@@ -15,14 +15,22 @@
  *<p>Ver.	|Date	|Reason for change
  *<p>---------------------------------
  *<p>V1.0	|2/2015	|First release
+ *<p>V1.1	|10/2026	|Added resetCursor to allow several extractions from the same message
+ *<p>				|Added block buffered reading with payload views and unchecked data extraction
+ *<p>				|Added setting the payload from a message already in memory (i.e. received from a serial port)
+ *<p>				|Added performance timers and read bytes counter (see PerfCounters) when filling messages
+ *<p>V1.2	|10/2026	|Added extraction from blocks of the messages having selected MIDs, skipping the others
  */
 #ifndef OSPMESSAGE_H
 #define OSPMESSAGE_H
 
 #include <stdio.h>
+#include <string.h>
 
 ///The maximum size in bytes of any message payload
 #define MAXPAYLOADSIZE 2048
+///The size in bytes of the block buffer used to read OSP files
+#define OSPBLOCKSIZE 262144
 
 /**OSPMessage class provides resources to perform data acquisition from OSP message payload.
  *Note that a payload is a part of the OSP message described in the SiRF ICD.
@@ -30,12 +38,24 @@
  *values for basic data types at the current position of the cursor from the byte stream in the payload.
  *<p>Methods are defined to:
  * - fill the buffer with a OSP message read from OSP binary file
+ * - fill the buffer with a OSP message extracted from a large block read from the OSP binary file. In this case the payload
+ *		is not copied: it is a view of the message in the block buffer. Note that the file position is ahead of the message
+ *		extracted, and that data in the block shall be discarded if the file is repositioned (rewind, fseek)
+ * - fill the buffer as above with the next message having one of the selected MIDs, skipping the others by their length
+ * - set the payload to a message already in memory, without copying it
  * - get the value of the specific types a message could contain (byte, integer (short or not,
  *		unsigned or not), float or double). Bit and byte ordering in the source are taken into account to perform the translation.
  * - skip unused data from the buffer advancing the cursor
+ * - reset the cursor to extract again data from the message in buffer
+ * - check once that the payload contains a given number of bytes after the cursor, and then get values without
+ *		checking payload limits (the unchecked methods named fast...)
  */
 class OSPMessage {
-	unsigned char payload[MAXPAYLOADSIZE];	//buffer for the OSP message payload
+	const unsigned char* payload;	//the OSP message payload: msgBuffer, or a place in the block buffer
+	unsigned char msgBuffer[MAXPAYLOADSIZE];	//buffer for the OSP message payload read message by message
+	unsigned char* block;	//buffer for blocks of OSP file data (allocated when first used)
+	unsigned int blockLen;	//the number of bytes in the block buffer
+	unsigned int blockCursor;	//block index to the first byte of the next message to extract
 	unsigned int payloadLength;		//the payload length in bytes of current message
 	unsigned int cursor;	//payload index to the first byte to be extracted by any method defined below
 							//it is incremented after any extraction
@@ -43,6 +63,10 @@ public:
 	OSPMessage(void);
 	~OSPMessage(void);
 	bool fill(FILE*);	//fill the buffer whith a OSP message read from OSP binary file
+	bool fillFromBlock(FILE*);	//set the payload to the next OSP message in the block read from OSP binary file
+	bool fillFromBlock(FILE*, const bool*, int &);	//as above, for the next message having a selected MID
+	void discardBlock();	//discard data in the block buffer (to be used when the file is repositioned)
+	bool fillFromBuffer(const unsigned char* data, unsigned int length);	//set the payload to the given message bytes
 	int get();			//get from payload the byte value at cursor. Increment it by one
 	int getInt();		//get from payload the 32 bits integer at cursor. Increment it by four
 	unsigned int getUInt(); //get from payload the 32 bits unsigned integer at cursor. Increment it by four
@@ -52,6 +76,71 @@ public:
 	double getDouble();	//get from payload the 64 bits floating point at cursor. Increment it by eigth
 	int getInt3();		//get from payload the 24 bits integer at cursor. Increment it by three
 	bool skipBytes(int n);	//skip n bytes advancing cursor by n
+	void resetCursor(unsigned int pos = 0);	//set cursor at the given position
 	unsigned int payloadLen(); //provides the payload length
+	const unsigned char* payloadData();	//provides the payload bytes
+	bool hasBytes(unsigned int n);	//check that n bytes can be extracted from cursor
+	//unchecked extraction methods: hasBytes shall be checked before using them
+	int fastGet();		//get from payload the byte value at cursor. Increment it by one
+	int fastGetInt();	//get from payload the 32 bits integer at cursor. Increment it by four
+	unsigned int fastGetUInt();	//get from payload the 32 bits unsigned integer at cursor. Increment it by four
+	void fastGetUInts(unsigned int* values, int n);	//get from payload n 32 bits unsigned integers at cursor. Increment it by 4*n
+	short unsigned int fastGetUShort();	//get from payload the 16 bits unsigned integer at cursor. Increment it by two
+	float fastGetFloat();	//get from payload the 32 bits floating point at cursor. Increment it by four
+	double fastGetDouble();	//get from payload the 64 bits floating point at cursor. Increment it by eigth
+	void fastSkipBytes(int n);	//skip n bytes advancing cursor by n
+private:
+	OSPMessage(const OSPMessage &);				//objects cannot be copied
+	OSPMessage& operator=(const OSPMessage &);
 };
+
+//the unchecked extraction methods are defined inline to avoid call overhead when decoding messages
+inline bool OSPMessage::hasBytes(unsigned int n) {
+	return cursor + n <= payloadLength;
+}
+
+inline int OSPMessage::fastGet() {
+	return payload[cursor++];
+}
+
+inline unsigned int OSPMessage::fastGetUInt() {
+	const unsigned char* p = payload + cursor;
+	cursor += 4;
+	return (unsigned int) p[0] << 24 | (unsigned int) p[1] << 16 | (unsigned int) p[2] << 8 | p[3];
+}
+
+inline int OSPMessage::fastGetInt() {
+	return (int) fastGetUInt();
+}
+
+inline void OSPMessage::fastGetUInts(unsigned int* values, int n) {
+	for (int i=0; i<n; i++) values[i] = fastGetUInt();
+}
+
+inline short unsigned int OSPMessage::fastGetUShort() {
+	const unsigned char* p = payload + cursor;
+	cursor += 2;
+	return (short unsigned int) (p[0] << 8 | p[1]);
+}
+
+inline float OSPMessage::fastGetFloat() {
+	//floating numbers are stored in the payload with bytes in reverse order
+	unsigned int bits = fastGetUInt();
+	float value;
+	memcpy(&value, &bits, sizeof value);
+	return value;
+}
+
+inline double OSPMessage::fastGetDouble() {
+	//double numbers are stored in the payload with bytes in the following order: 3, 2, 1, 0, 4, 5, 6, 7
+	unsigned long long bits = fastGetUInt();
+	bits |= (unsigned long long) fastGetUInt() << 32;
+	double value;
+	memcpy(&value, &bits, sizeof value);
+	return value;
+}
+
+inline void OSPMessage::fastSkipBytes(int n) {
+	cursor += n;
+}
 #endif
@@ -0,0 +1,276 @@
+/** @file OutputBuffer.cpp
+ * Contains the implementation of the OutputBuffer class.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "OutputBuffer.h"
+#include "PerfCounters.h"
+
+//@cond DUMMY
+///The highest power of 10 every double can represent exactly, and the table of them
+#define MAXEXACTPOW10 22
+static const double POW10[MAXEXACTPOW10 + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+///The limit for scaled values to be converted using integer arithmetic (2^40)
+#define MAXSCALED 1099511627776.0
+///The minimum distance to 0.5 of the fractional part of scaled values to be rounded using integer arithmetic
+#define MINTIEDIST 0.004
+//@endcond
+
+/**Constructs an empty OutputBuffer object.
+ */
+OutputBuffer::OutputBuffer(void) {
+	buffer = new char[OUTBUFINISIZE];
+	capacity = OUTBUFINISIZE;
+	length = 0;
+}
+
+/**Destructs OutputBuffer objects.
+ */
+OutputBuffer::~OutputBuffer(void) {
+	delete[] buffer;
+}
+
+/**clear removes all text rendered in the buffer, keeping its size.
+ */
+void OutputBuffer::clear() {
+	length = 0;
+}
+
+/**putChar appends a character to the buffer.
+ *
+ * @param c the character to append
+ */
+void OutputBuffer::putChar(char c) {
+	reserve(1);
+	buffer[length++] = c;
+}
+
+/**putChars appends a character repeated n times to the buffer (as printf does with %nc for a space).
+ *
+ * @param c the character to append
+ * @param n the number of times it is appended
+ */
+void OutputBuffer::putChars(char c, int n) {
+	if (n <= 0) return;
+	reserve(n);
+	memset(buffer + length, c, n);
+	length += n;
+}
+
+/**putStr appends a C string to the buffer.
+ *
+ * @param s the null terminated string to append
+ */
+void OutputBuffer::putStr(const char* s) {
+	size_t n = strlen(s);
+	reserve(n);
+	memcpy(buffer + length, s, n);
+	length += n;
+}
+
+/**putStr appends a string to the buffer.
+ *
+ * @param s the string to append
+ */
+void OutputBuffer::putStr(const string &s) {
+	reserve(s.size());
+	memcpy(buffer + length, s.data(), s.size());
+	length += s.size();
+}
+
+/**putInt appends an integer to the buffer, as printf does with formats %wd or %0wd.
+ *
+ * @param value the integer to append
+ * @param width the minimum number of characters to append, left padded with spaces or zeros
+ * @param zeroPad when true, padding is made with zeros after the sign, when false padding is made with spaces
+ */
+void OutputBuffer::putInt(long long value, int width, bool zeroPad) {
+	unsigned long long uvalue = value < 0? 0ULL - (unsigned long long) value : (unsigned long long) value;
+	if (zeroPad) putDigits(uvalue, width - (value < 0? 1 : 0), 0, value < 0, 0, "");
+	else putDigits(uvalue, 1, 0, value < 0, width, "");
+}
+
+/**putHex appends an unsigned integer in hexadecimal to the buffer, as printf does with formats %0wX or %0wx.
+ *
+ * @param value the integer to append
+ * @param width the minimum number of digits to append, left padded with zeros
+ * @param upper when true, upper case digits are used (as %X does), when false lower case ones (as %x does)
+ */
+void OutputBuffer::putHex(unsigned long long value, int width, bool upper) {
+	const char* hexDigits = upper? "0123456789ABCDEF" : "0123456789abcdef";
+	char digits[16];
+	int nDigits = 0;
+	do {
+		digits[nDigits++] = hexDigits[value & 0xF];
+		value >>= 4;
+	} while (value != 0);
+	putChars('0', width - nDigits);
+	reserve(nDigits);
+	while (nDigits > 0) buffer[length++] = digits[--nDigits];
+}
+
+/**putFixed appends a floating point number in fixed point notation to the buffer, as printf does with the format %w.df.
+ *
+ * @param value the number to append
+ * @param width the minimum number of characters to append, left padded with spaces
+ * @param decimals the number of digits after the decimal point
+ */
+void OutputBuffer::putFixed(double value, int width, int decimals) {
+	double scaled, intPart, fracPart;
+	if ((decimals < 0) || (decimals > MAXEXACTPOW10) || !(fabs(value) < MAXSCALED)) {
+		putPrintf("f", value, width, decimals);
+		return;
+	}
+	scaled = fabs(value) * POW10[decimals];
+	fracPart = modf(scaled, &intPart);
+	if ((scaled >= MAXSCALED) || (fabs(fracPart - 0.5) < MINTIEDIST)) {	//rounding cannot be decided exactly
+		putPrintf("f", value, width, decimals);
+		return;
+	}
+	putDigits((unsigned long long) intPart + (fracPart > 0.5? 1 : 0), decimals + 1, decimals, signbit(value) != 0, width, "");
+}
+
+/**putExp appends a floating point number in exponent notation to the buffer, as printf does with the format %w.dE.
+ * The exponent has at least two digits.
+ *
+ * @param value the number to append
+ * @param width the minimum number of characters to append, left padded with spaces
+ * @param decimals the number of digits after the decimal point in the mantissa
+ */
+void OutputBuffer::putExp(double value, int width, int decimals) {
+	double absValue, scaled, intPart, fracPart;
+	unsigned long long mantissa;
+	int exponent, pow10;
+	char suffix[16];	//the exponent part: E, its sign and up to 3 digits for doubles
+	absValue = fabs(value);
+	if ((decimals < 0) || (decimals > 12) || !(absValue <= 1.7976931348623157e308)) {
+		putPrintf("E", value, width, decimals);
+		return;
+	}
+	if (absValue == 0.0) {
+		putDigits(0, decimals + 1, decimals, signbit(value) != 0, width, "E+00");
+		return;
+	}
+	//get the exponent and the mantissa scaled to have decimals+1 digits in its integer part
+	exponent = (int) floor(log10(absValue));
+	for (int i = 0; i < 3; i++) {
+		pow10 = decimals - exponent;
+		if ((pow10 > MAXEXACTPOW10) || (pow10 < -MAXEXACTPOW10)) {
+			putPrintf("E", value, width, decimals);
+			return;
+		}
+		scaled = pow10 >= 0? absValue * POW10[pow10] : absValue / POW10[-pow10];	//only one rounding is made
+		if (scaled >= POW10[decimals + 1]) exponent++;
+		else if (scaled < POW10[decimals]) exponent--;
+		else break;
+	}
+	fracPart = modf(scaled, &intPart);
+	if ((scaled < POW10[decimals]) || (scaled >= POW10[decimals + 1]) || (fabs(fracPart - 0.5) < MINTIEDIST)) {
+		putPrintf("E", value, width, decimals);
+		return;
+	}
+	mantissa = (unsigned long long) intPart + (fracPart > 0.5? 1 : 0);
+	if (mantissa >= (unsigned long long) POW10[decimals + 1]) {	//rounding up gives one more digit
+		mantissa /= 10;
+		exponent++;
+	}
+	snprintf(suffix, sizeof suffix, "E%c%02d", exponent < 0? '-' : '+', exponent < 0? -exponent : exponent);
+	putDigits(mantissa, decimals + 1, decimals, signbit(value) != 0, width, suffix);
+}
+
+/**data provides the text rendered in the buffer. Note that it is not null terminated.
+ *
+ * @return a pointer to the beginning of the text rendered
+ */
+const char* OutputBuffer::data() {
+	return buffer;
+}
+
+/**size provides the length of the text rendered in the buffer.
+ *
+ * @return the number of bytes in the buffer
+ */
+size_t OutputBuffer::size() {
+	return length;
+}
+
+/**write writes to the given file all text rendered in the buffer, and clears it.
+ *
+ * @param out the already open file where text will be written
+ * @return true if all text has been written, false otherwise
+ */
+bool OutputBuffer::write(FILE* out) {
+	PERF_SCOPE("OutputBuffer::write");
+	PERF_COUNT("Text bytes written", (long long) length);
+	bool written = fwrite(buffer, 1, length, out) == length;
+	length = 0;
+	return written;
+}
+
+/**reserve ensures the buffer has room for appending n bytes, enlarging it if needed.
+ *
+ * @param n the number of bytes to be appended
+ */
+void OutputBuffer::reserve(size_t n) {
+	if (length + n <= capacity) return;
+	size_t newCapacity = capacity * 2;
+	while (newCapacity < length + n) newCapacity *= 2;
+	char* newBuffer = new char[newCapacity];
+	memcpy(newBuffer, buffer, length);
+	delete[] buffer;
+	buffer = newBuffer;
+	capacity = newCapacity;
+}
+
+/**putDigits appends a number given by its digits, inserting the decimal point and appending a suffix (the exponent).
+ *
+ * @param value the unsigned integer with all digits of the number
+ * @param minDigits the minimum number of digits, left padded with zeros
+ * @param decimals the number of digits after the decimal point (0 if no decimal point is used)
+ * @param negative when true, a minus sign is placed before the digits
+ * @param width the minimum number of characters to append, left padded with spaces
+ * @param suffix the string appended after the digits
+ */
+void OutputBuffer::putDigits(unsigned long long value, int minDigits, int decimals, bool negative, int width, const char* suffix) {
+	char digits[64];
+	int nDigits = 0;
+	int nChars;
+	do {
+		digits[nDigits++] = '0' + (char) (value % 10);
+		value /= 10;
+	} while ((value != 0) && (nDigits < 32));
+	if (minDigits > 32) minDigits = 32;
+	while (nDigits < minDigits) digits[nDigits++] = '0';
+	nChars = nDigits + (decimals > 0? 1 : 0) + (negative? 1 : 0) + (int) strlen(suffix);
+	putChars(' ', width - nChars);
+	reserve(nChars);
+	if (negative) buffer[length++] = '-';
+	for (int i = nDigits - 1; i >= 0; i--) {
+		buffer[length++] = digits[i];
+		if ((i == decimals) && (decimals > 0)) buffer[length++] = '.';
+	}
+	putStr(suffix);
+}
+
+/**putPrintf appends a floating point number formatted using snprintf, for the values the fast conversions cannot cope with.
+ *
+ * @param fmt the printf conversion specifier to use (f or E)
+ * @param value the number to append
+ * @param width the minimum number of characters to append
+ * @param decimals the number of digits after the decimal point
+ */
+void OutputBuffer::putPrintf(const char* fmt, double value, int width, int decimals) {
+	char format[16];
+	int n;
+	sprintf(format, "%%*.*%s", fmt);
+	n = snprintf(NULL, 0, format, width, decimals, value);
+	if (n <= 0) return;
+	reserve(n + 1);
+	snprintf(buffer + length, n + 1, format, width, decimals, value);
+	length += n;
+}
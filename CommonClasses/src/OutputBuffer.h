@@ -0,0 +1,75 @@
+/** @file OutputBuffer.h
+ * Contains the OutputBuffer class definition used to render formatted text output into a memory buffer before writing it.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ *<p>V1.1	|10/2026	|Added hexadecimal integers
+ */
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <stdio.h>
+#include <string>
+
+using namespace std;
+
+///The initial size in bytes of the output buffer
+#define OUTBUFINISIZE 8192
+///The size in bytes of text rendered before writing it, for outputs written in large blocks
+#define OUTBUFBLOCKSIZE 1048576
+
+/**OutputBuffer class provides resources to render formatted text (i.e. a RINEX epoch or a set of CSV lines) into a reusable
+ * memory buffer, and write all of it to the output file with one fwrite call.
+ *<p>Methods are defined to append to the buffer:
+ * - characters and strings
+ * - integers, as printf does with formats like %3d or %02d
+ * - unsigned integers in hexadecimal, as printf does with formats like %08X or %02x
+ * - floating point numbers in fixed point notation, as printf does with formats like %14.3f
+ * - floating point numbers in exponent notation, as printf does with formats like %19.12E
+ *<p>Numbers are converted using integer arithmetic. The text produced is identical to the one printf would produce:
+ * when the rounding of a value cannot be decided exactly with the precision available, or the value is out of the range
+ * the conversion can cope with, the conversion is performed using snprintf.
+ *<p>The buffer grows as needed, and keeps its size after writing data, to avoid allocations in steady state.
+ */
+class OutputBuffer {
+public:
+	OutputBuffer(void);
+	~OutputBuffer(void);
+	void clear();
+	void putChar(char c);
+	void putChars(char c, int n);
+	void putStr(const char* s);
+	void putStr(const string &s);
+	void putInt(long long value, int width = 0, bool zeroPad = false);
+	void putHex(unsigned long long value, int width = 0, bool upper = true);
+	void putFixed(double value, int width, int decimals);
+	void putExp(double value, int width, int decimals);
+	const char* data();
+	size_t size();
+	bool write(FILE* out);
+
+private:
+	char* buffer;		//the buffer where output text is rendered
+	size_t capacity;	//the size in bytes of the buffer
+	size_t length;		//the number of bytes rendered in the buffer
+
+	OutputBuffer(const OutputBuffer &);				//objects cannot be copied
+	OutputBuffer& operator=(const OutputBuffer &);
+
+	void reserve(size_t n);
+	void putDigits(unsigned long long value, int minDigits, int decimals, bool negative, int width, const char* suffix);
+	void putPrintf(const char* fmt, double value, int width, int decimals);
+};
+#endif
@@ -0,0 +1,192 @@
+/** @file PerfCounters.cpp
+ * Contains the implementation of the PerfCounters class.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "PerfCounters.h"
+
+//@cond DUMMY
+bool PerfCounters::active = false;
+bool PerfCounters::traceMode = false;
+string PerfCounters::outFileName;
+long long PerfCounters::startTime = 0;
+PerfCounters::Counter PerfCounters::counters[PERFMAXCOUNTERS];
+atomic<int> PerfCounters::nCounters(0);
+mutex PerfCounters::defMutex;
+vector<PerfCounters::ThreadTrace*> PerfCounters::traces;
+atomic<long long> PerfCounters::nEvents(0);
+atomic<long long> PerfCounters::lostEvents(0);
+//@endcond
+
+/**start starts measurement of timers and counters, and sets the file where their data will be dumped at program exit.
+ * If the file name ends with ".json" (or ".JSON"), a trace in the Chrome trace event format is dumped, with an event
+ * for each scope measured (up to PERFMAXEVENTS). Otherwise a summary table is dumped. The file name "-" stands for
+ * the standard output.
+ *
+ * @param fileName the file name where data will be dumped. If empty, measurement is not started
+ * @return true if measurement has been started, false otherwise
+ */
+bool PerfCounters::start(const string &fileName) {
+	if (fileName.empty() || active) return false;
+	outFileName = fileName;
+	traceMode = (fileName.size() > 5) &&
+		((fileName.compare(fileName.size() - 5, 5, ".json") == 0) || (fileName.compare(fileName.size() - 5, 5, ".JSON") == 0));
+	startTime = now();
+	active = true;
+	atexit(dumpAtExit);
+	return true;
+}
+
+/**getId gets the identifier of the timer or counter with the given name, defining it if it does not exist.
+ *
+ * @param name the name of the timer or counter
+ * @return its identifier, or -1 if PERFMAXCOUNTERS have been already defined
+ */
+int PerfCounters::getId(const string &name) {
+	lock_guard<mutex> lock(defMutex);
+	int n = nCounters.load();
+	for (int i = 0; i < n; i++) if (counters[i].name == name) return i;
+	if (n >= PERFMAXCOUNTERS) return -1;
+	counters[n].name = name;
+	nCounters.store(n + 1);
+	return n;
+}
+
+/**addTime accounts the time measured for a scope in the given timer, and records its event when a trace is requested.
+ *
+ * @param id the identifier of the timer
+ * @param begin the time in ns when the scope began
+ * @param end the time in ns when the scope ended
+ */
+void PerfCounters::addTime(int id, long long begin, long long end) {
+	if ((id < 0) || (id >= PERFMAXCOUNTERS)) return;
+	Counter &counter = counters[id];
+	long long elapsed = end - begin;
+	long long prevMax = counter.maxNanos.load(memory_order_relaxed);
+	if (!counter.isTimer.load(memory_order_relaxed)) counter.isTimer.store(true, memory_order_relaxed);
+	counter.calls.fetch_add(1, memory_order_relaxed);
+	counter.nanos.fetch_add(elapsed, memory_order_relaxed);
+	while ((elapsed > prevMax) && !counter.maxNanos.compare_exchange_weak(prevMax, elapsed, memory_order_relaxed));
+	if (!traceMode) return;
+	if (nEvents.fetch_add(1, memory_order_relaxed) >= PERFMAXEVENTS) {
+		lostEvents.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+	TraceEvent event = {id, begin - startTime, elapsed};
+	getThreadTrace()->events.push_back(event);
+}
+
+/**addValue adds the given value to a counter.
+ *
+ * @param id the identifier of the counter
+ * @param value the value to add
+ */
+void PerfCounters::addValue(int id, long long value) {
+	if ((id < 0) || (id >= PERFMAXCOUNTERS)) return;
+	counters[id].calls.fetch_add(1, memory_order_relaxed);
+	counters[id].nanos.fetch_add(value, memory_order_relaxed);
+}
+
+/**dump writes the data measured to the file stated when starting measurement.
+ * It is called at program exit, but can be called before to dump data measured so far.
+ *
+ * @return true if data have been dumped, false otherwise (measurement not started, or file cannot be written)
+ */
+bool PerfCounters::dump() {
+	if (!active) return false;
+	bool toStdout = outFileName.compare("-") == 0;
+	FILE* out = toStdout? stdout : fopen(outFileName.c_str(), "w");
+	if (out == NULL) {
+		fprintf(stderr, "Cannot create performance data file %s\n", outFileName.c_str());
+		return false;
+	}
+	bool good = traceMode? dumpTrace(out) : dumpSummary(out);
+	if (toStdout) fflush(out);
+	else if (fclose(out) != 0) good = false;
+	return good;
+}
+
+/**getThreadTrace gets the trace events buffer of the calling thread, creating it when needed.
+ *
+ * @return a pointer to the trace of the calling thread
+ */
+PerfCounters::ThreadTrace* PerfCounters::getThreadTrace() {
+	static thread_local ThreadTrace* threadTrace = NULL;
+	if (threadTrace == NULL) {
+		lock_guard<mutex> lock(defMutex);
+		threadTrace = new ThreadTrace;
+		threadTrace->tid = (int) traces.size() + 1;
+		traces.push_back(threadTrace);
+	}
+	return threadTrace;
+}
+
+/**dumpAtExit is the function registered to be called at program exit to dump the data measured.
+ */
+void PerfCounters::dumpAtExit() {
+	dump();
+}
+
+/**dumpSummary writes a table with the data of each timer (sorted by total time) and each counter.
+ *
+ * @param out the file where the table is written
+ * @return true if it has been written, false otherwise
+ */
+bool PerfCounters::dumpSummary(FILE* out) {
+	int n = nCounters.load();
+	vector<int> order;
+	for (int i = 0; i < n; i++) if (counters[i].calls.load() > 0) order.push_back(i);
+	stable_sort(order.begin(), order.end(), [](int a, int b) {
+		if (counters[a].isTimer.load() != counters[b].isTimer.load()) return counters[a].isTimer.load();
+		return counters[a].nanos.load() > counters[b].nanos.load();
+	});
+	fprintf(out, "Elapsed time: %.3f ms\n", (now() - startTime) / 1e6);
+	fprintf(out, "%-40s %12s %14s %12s %12s\n", "TIMER", "CALLS", "TOTAL ms", "MEAN us", "MAX us");
+	for (vector<int>::iterator it = order.begin(); it != order.end(); it++) {
+		Counter &counter = counters[*it];
+		if (!counter.isTimer) continue;
+		long long calls = counter.calls.load();
+		fprintf(out, "%-40s %12lld %14.3f %12.3f %12.3f\n", counter.name.c_str(), calls,
+			counter.nanos.load() / 1e6, counter.nanos.load() / 1e3 / calls, counter.maxNanos.load() / 1e3);
+	}
+	fprintf(out, "%-40s %12s %14s\n", "COUNTER", "CALLS", "VALUE");
+	for (vector<int>::iterator it = order.begin(); it != order.end(); it++) {
+		Counter &counter = counters[*it];
+		if (counter.isTimer) continue;
+		fprintf(out, "%-40s %12lld %14lld\n", counter.name.c_str(), counter.calls.load(), counter.nanos.load());
+	}
+	return ferror(out) == 0;
+}
+
+/**dumpTrace writes the events recorded in the Chrome trace event format (JSON), which can be loaded in trace viewers.
+ * Each scope measured is a complete event ("ph":"X") with time stamp and duration in us. Counters values
+ * are written at the end of the trace as counter events ("ph":"C").
+ *
+ * @param out the file where the trace is written
+ * @return true if it has been written, false otherwise
+ */
+bool PerfCounters::dumpTrace(FILE* out) {
+	lock_guard<mutex> lock(defMutex);
+	bool first = true;
+	double endTs = (now() - startTime) / 1e3;
+	fprintf(out, "{\"traceEvents\":[");
+	for (vector<ThreadTrace*>::iterator itt = traces.begin(); itt != traces.end(); itt++) {
+		for (vector<TraceEvent>::iterator ite = (*itt)->events.begin(); ite != (*itt)->events.end(); ite++) {
+			fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", first? "" : ",",
+				counters[ite->id].name.c_str(), (*itt)->tid, ite->begin / 1e3, ite->duration / 1e3);
+			first = false;
+		}
+	}
+	int n = nCounters.load();
+	for (int i = 0; i < n; i++) {
+		if (counters[i].isTimer || (counters[i].calls.load() == 0)) continue;
+		fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%lld}}", first? "" : ",",
+			counters[i].name.c_str(), endTs, counters[i].nanos.load());
+		first = false;
+	}
+	fprintf(out, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"lostEvents\":%lld}}\n", lostEvents.load());
+	return ferror(out) == 0;
+}
@@ -0,0 +1,148 @@
+/** @file PerfCounters.h
+ * Contains the PerfCounters and PerfScope classes definition, and the macros used to instrument code with
+ * scoped timers and counters whose results can be dumped at program exit.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+
+//@cond DUMMY
+///The maximum number of timers and counters that can be defined
+#define PERFMAXCOUNTERS 256
+///The maximum number of timed events recorded for a trace
+#define PERFMAXEVENTS 2000000
+//@endcond
+
+/**PerfCounters class stores performance data measured in the program: timers accumulating the number of calls and the time
+ * spent in a scope of code, and counters accumulating values (like bytes read).
+ *<p>Code is instrumented using the following macros:
+ * - PERF_SCOPE(NAME) measures the time from the point where it is placed to the end of the current scope, accounting it
+ *	in the timer NAME (a string literal).
+ * - PERF_COUNT(NAME, N) adds N to the counter NAME.
+ *<p>Data are measured only after start is called with a file name where they will be dumped at program exit, as a summary table,
+ * or as a trace in the Chrome trace event format (JSON) when the file name ends with ".json". When start is not called, the cost of
+ * an instrumented scope is a test of a flag.
+ *<p>Timers and counters can be used from several threads. start shall be called before starting the threads to be measured.
+ *<p>When the program is compiled defining RXNOPERF, macros are void, and code instrumented has no overhead at all.
+ */
+class PerfCounters {
+public:
+	static bool start(const string &fileName);
+	static bool isActive();
+	static int getId(const string &name);
+	static void addTime(int id, long long begin, long long end);
+	static void addValue(int id, long long value);
+	static long long now();
+	static bool dump();
+
+private:
+	struct Counter {	//data of a timer or counter
+		string name;
+		atomic<long long> calls;	//the number of scopes measured or values added
+		atomic<long long> nanos;	//the total time measured in ns, or the sum of values added
+		atomic<long long> maxNanos;	//the maximum time of a scope measured in ns
+		atomic<bool> isTimer;	//true if it is a timer, false if it is a counter
+	};
+	struct TraceEvent {	//a scope measured for the trace
+		int id;
+		long long begin;	//begin time in ns from the start
+		long long duration;	//in ns
+	};
+	struct ThreadTrace {	//the events recorded by a thread
+		int tid;
+		vector<TraceEvent> events;
+	};
+	static bool active;			//true when measurement has been started
+	static bool traceMode;		//true when events are recorded to dump a trace
+	static string outFileName;	//the file where data will be dumped
+	static long long startTime;	//the time when start was called, in ns
+	static Counter counters[PERFMAXCOUNTERS];
+	static atomic<int> nCounters;	//the number of counters defined
+	static mutex defMutex;			//to serialize definition of counters and thread traces
+	static vector<ThreadTrace*> traces;	//the trace of each thread. They are not released to be dumped after threads end
+	static atomic<long long> nEvents;	//the number of events recorded
+	static atomic<long long> lostEvents;	//the number of events not recorded because PERFMAXEVENTS was reached
+
+	static ThreadTrace* getThreadTrace();
+	static void dumpAtExit();
+	static bool dumpSummary(FILE* out);
+	static bool dumpTrace(FILE* out);
+};
+
+/**PerfScope class measures the time elapsed from its construction to its destruction, accounting it in a PerfCounters timer.
+ * Objects of this class are defined using the PERF_SCOPE macro.
+ */
+class PerfScope {
+public:
+	/**Constructs a PerfScope object, starting the measurement when PerfCounters are active.
+	 *
+	 * @param id the identifier of the timer, or -1 if nothing shall be measured
+	 */
+	PerfScope(int id) : timerId(PerfCounters::isActive()? id : -1), begin(0) {
+		if (timerId >= 0) begin = PerfCounters::now();
+	}
+	/**Destructs the PerfScope object, accounting the time measured.
+	 */
+	~PerfScope() {
+		if (timerId >= 0) PerfCounters::addTime(timerId, begin, PerfCounters::now());
+	}
+private:
+	int timerId;
+	long long begin;
+	PerfScope(const PerfScope &);
+	PerfScope& operator=(const PerfScope &);
+};
+
+/**isActive tells if measurement has been started.
+ *
+ * @return true if measurement has been started, false otherwise
+ */
+inline bool PerfCounters::isActive() {
+	return active;
+}
+
+/**now gives the current time of the monotonic clock used for measurements.
+ *
+ * @return the current time in ns
+ */
+inline long long PerfCounters::now() {
+	return (long long) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//@cond DUMMY
+///Macros to instrument code with scoped timers and counters. They are void when RXNOPERF is defined
+#ifndef RXNOPERF
+#define PERF_CONCAT2(A, B) A##B
+#define PERF_CONCAT(A, B) PERF_CONCAT2(A, B)
+#define PERF_SCOPE(NAME) static const int PERF_CONCAT(perfId, __LINE__) = PerfCounters::getId(NAME); \
+	PerfScope PERF_CONCAT(perfScope, __LINE__)(PERF_CONCAT(perfId, __LINE__))
+#define PERF_COUNT(NAME, N) do { static const int perfId = PerfCounters::getId(NAME); if (PerfCounters::isActive()) PerfCounters::addValue(perfId, N); } while (0)
+#else
+#define PERF_SCOPE(NAME)
+#define PERF_COUNT(NAME, N) do { } while (0)
+#endif
+//@endcond
+#endif
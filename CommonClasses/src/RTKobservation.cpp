@@ -25,6 +25,9 @@ RTKobservation::RTKobservation(string prg, string in) {
 	ambEst = "N/A";
 	valThres = "N/A";
 	ephemeris = "Broadcast";
+	startWeek = endWeek = gpsWeek = 0;
+	startTOW = endTOW = gpsTOW = 0.0;
+	timesPos = -1;
 }
 
 /**Destructor.
@@ -111,23 +114,62 @@ void RTKobservation::setPosition(int week, double tow, double x, double y, doubl
  * @param out	the FILE were header will be printed
  */
 void RTKobservation::printHeader(FILE* out) {
-	char buffer[80];
- 	fprintf(out, "%% program\t: %s\n", program.c_str());
-	fprintf(out, "%% inp file\t: %s\n", inpFile.c_str());
-	formatGPStime (buffer, sizeof buffer,"%Y/%m/%d %H:%M:", "%06.3f", startWeek, startTOW);
-	fprintf(out, "%% obs start\t: %s GPST\n", buffer);
-	formatGPStime (buffer, sizeof buffer,"%Y/%m/%d %H:%M:",  "%06.3f", endWeek, endTOW);
-	fprintf(out, "%% obs end\t: %s GPST\n", buffer);
-	fprintf(out, "%% pos mode\t: %s\n", posMode.c_str());
-	fprintf(out, "%% elev mask\t: %4.1f\n", elevMask);
-	fprintf(out, "%% snr mask\t: %4.1f\n", snrMask);
-	fprintf(out, "%% ionos opt\t: %s\n", ionosEst.c_str());
-	fprintf(out, "%% tropo opt\t: %s\n", troposEst.c_str());
-	fprintf(out, "%% ephemeris\t: %s\n", ephemeris.c_str());
-	fprintf(out, "%%\n%% (x/y/z-ecef=WGS84,Q=1:fix,2:float,3:sbas,4:dgps,5:single,6:ppp,ns=# of satellites)\n");
-	fprintf(out, "%%  GPST%19c%s\n",
-			' ',
-			"   x-ecef(m)      y-ecef(m)      z-ecef(m)   Q  ns   sdx(m)   sdy(m)   sdz(m)  sdxy(m)  sdyz(m)  sdzx(m) age(s)  ratio");
+	OutputBuffer header;
+	printIdLines(header);
+	header.write(out);
+	timesPos = ftell(out);
+	printTimeLines(header);
+	printSettingLines(header);
+	header.write(out);
+}
+
+/**printHeader renders header data of the RTK file into the given buffer.
+ *
+ * @param out	the OutputBuffer were header will be rendered
+ */
+void RTKobservation::printHeader(OutputBuffer &out) {
+	printIdLines(out);
+	printTimeLines(out);
+	printSettingLines(out);
+}
+
+/**patchHeaderTimes rewrites the start and end times in the header already printed to the RTK file.
+ * It allows printing the header before acquiring all solutions, and stating their times when the last one is known.
+ * The file position is set at the end of file after patching.
+ *
+ * @param out	the FILE were header was printed (see printHeader). It shall be positionable
+ * @return true if times have been rewritten, false otherwise
+ */
+bool RTKobservation::patchHeaderTimes(FILE* out) {
+	OutputBuffer lines;
+	bool written;
+	if ((timesPos < 0) || (fseek(out, timesPos, SEEK_SET) != 0)) return false;
+	printTimeLines(lines);
+	written = lines.write(out);
+	return (fseek(out, 0, SEEK_END) == 0) && written;
+}
+
+/**printSettingLines renders the header lines with the settings used to compute solutions, and the column titles.
+ *
+ * @param out	the OutputBuffer were lines will be rendered
+ */
+void RTKobservation::printSettingLines(OutputBuffer &out) {
+	out.putStr("% pos mode\t: ");
+	out.putStr(posMode);
+	out.putStr("\n% elev mask\t: ");
+	out.putFixed(elevMask, 4, 1);
+	out.putStr("\n% snr mask\t: ");
+	out.putFixed(snrMask, 4, 1);
+	out.putStr("\n% ionos opt\t: ");
+	out.putStr(ionosEst);
+	out.putStr("\n% tropo opt\t: ");
+	out.putStr(troposEst);
+	out.putStr("\n% ephemeris\t: ");
+	out.putStr(ephemeris);
+	out.putStr("\n%\n% (x/y/z-ecef=WGS84,Q=1:fix,2:float,3:sbas,4:dgps,5:single,6:ppp,ns=# of satellites)\n");
+	out.putStr("%  GPST");
+	out.putChars(' ', 19);
+	out.putStr("   x-ecef(m)      y-ecef(m)      z-ecef(m)   Q  ns   sdx(m)   sdy(m)   sdz(m)  sdxy(m)  sdyz(m)  sdzx(m) age(s)  ratio\n");
 }
 
 /**printSolution prints a line to the RTK file with solution data from the current epoch.
@@ -135,11 +177,59 @@ void RTKobservation::printHeader(FILE* out) {
  * @param out	the FILE were header will be printed
  */
 void RTKobservation::printSolution(FILE* out) {
+	OutputBuffer line;
+	printSolution(line);
+	line.write(out);
+}
+
+/**printSolution renders a line of the RTK file with solution data from the current epoch into the given buffer.
+ *
+ * @param out	the OutputBuffer were the line will be rendered
+ */
+void RTKobservation::printSolution(OutputBuffer &out) {
 	char buffer[80];
 	formatGPStime (buffer, sizeof buffer,"%Y/%m/%d %H:%M:", "%06.3f", gpsWeek, gpsTOW);
-	fprintf(out, "%s %14.4f %14.4f %14.4f %3d %3d", buffer, xSol, ySol, zSol, qSol, nSol);
-	for (int i=0; i<6; i++)
-		fprintf(out, " %8.4f", 0.0);
-	fprintf(out, "   0.00    0.0");
-	fprintf(out, "\n");
+	out.putStr(buffer);
+	out.putChar(' ');
+	out.putFixed(xSol, 14, 4);
+	out.putChar(' ');
+	out.putFixed(ySol, 14, 4);
+	out.putChar(' ');
+	out.putFixed(zSol, 14, 4);
+	out.putChar(' ');
+	out.putInt(qSol, 3);
+	out.putChar(' ');
+	out.putInt(nSol, 3);
+	//standard deviations, age and ratio are not available
+	for (int i=0; i<6; i++) out.putStr("   0.0000");
+	out.putStr("   0.00    0.0\n");
+}
+
+/**printIdLines renders the header lines identifying the program and the input file.
+ *
+ * @param out	the OutputBuffer were lines will be rendered
+ */
+void RTKobservation::printIdLines(OutputBuffer &out) {
+	out.putStr("% program\t: ");
+	out.putStr(program);
+	out.putStr("\n% inp file\t: ");
+	out.putStr(inpFile);
+	out.putChar('\n');
+}
+
+/**printTimeLines renders the header lines with the start and end times of solutions.
+ * Their length does not depend on the time values.
+ *
+ * @param out	the OutputBuffer were lines will be rendered
+ */
+void RTKobservation::printTimeLines(OutputBuffer &out) {
+	char buffer[80];
+	formatGPStime (buffer, sizeof buffer,"%Y/%m/%d %H:%M:", "%06.3f", startWeek, startTOW);
+	out.putStr("% obs start\t: ");
+	out.putStr(buffer);
+	out.putStr(" GPST\n");
+	formatGPStime (buffer, sizeof buffer,"%Y/%m/%d %H:%M:",  "%06.3f", endWeek, endTOW);
+	out.putStr("% obs end\t: ");
+	out.putStr(buffer);
+	out.putStr(" GPST\n");
 }
@@ -17,6 +17,8 @@
  *<p>---------------------------------
  *<p>V1.0	|2/2015	|First release
  *<p>V1.1	|2/2016	|Removed Logger param and resulting empty constructor and destructor
+ *<p>V1.2	|10/2026	|Header and solutions can be rendered into an OutputBuffer
+ *<p>				|Added patching of the start and end times in a header already printed
  */
 #ifndef RTKOBSERVATION_H
 #define RTKOBSERVATION_H
@@ -24,11 +26,17 @@
 #include <string>
 #include <stdio.h>
 
+//from CommonClasses
+#include "OutputBuffer.h"
+
 using namespace std;
 
 /**RTKobservation class defines data to be used for storing and further printing of a RTK file header
  * and the position solution data of each epoch.
  *
+ *<p>Header and solution lines can be printed to a file, or rendered into an OutputBuffer to be written in large blocks.
+ * When the header is printed before knowing the time of the last solution, its start and end times can be patched later.
+ *
  * A detailed definition of the format used for RTK data files can be found in the RTKLIB portal (http://www.rtklib.com/).
  */
 class RTKobservation {
@@ -43,7 +51,10 @@ public:
 	void setEndTime(int week, double tow);
 	void setPosition(int week, double tow, double x, double y, double z, int qlty, int nSat);
 	void printHeader(FILE* out);
+	void printHeader(OutputBuffer &out);
+	bool patchHeaderTimes(FILE* out);
 	void printSolution (FILE* out);
+	void printSolution (OutputBuffer &out);
 private:
 	//RTK observation file header data
 	string program;
@@ -71,5 +82,11 @@ private:
 	//Time related data
 	int gpsWeek;	//extended week number: 0 - no limit 
 	double gpsTOW;	//time of week in seconds as estimated by the receiver
+	//Position in the RTK file of the header lines with start and end times (-1 if header not printed to a file)
+	long timesPos;
+
+	void printIdLines(OutputBuffer &out);
+	void printTimeLines(OutputBuffer &out);
+	void printSettingLines(OutputBuffer &out);
 };
 #endif
\ No newline at end of file
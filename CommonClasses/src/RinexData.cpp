@@ -5,9 +5,20 @@
 
 #include <algorithm>
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
+#include <ctype.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 //from CommonClasses
 #include "Utilities.h"
+#include "PerfCounters.h"
 
 /**RinexData constructor providing only the minimum data required: the RINEX file version to be generated.
  *
@@ -84,6 +95,9 @@ RinexData::RinexData(RINEXversion ver, string prg, string rby, Logger* plogger)
 /**Destructor.
  */
 RinexData::~RinexData(void) {
+	unmapInputFile();
+	if (crxIn != NULL) delete crxIn;
+	if (crxOut != NULL) delete crxOut;
 	if (dynamicLog) delete plog;
 }
 
@@ -276,6 +290,8 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a, const string &b, const string
  *  - SYS: to set data for the given system as required in "SYS / # / OBS TYPES" records
  *  - TOBS: to set data for the given system as required in "# / TYPES OF OBSERV" record
  * <p> Note that arguments use notation according to RINEX V302 for system identification and observable types.
+ * <p> If data for the given system already exist, the observable types not yet defined for it are appended to the existing ones
+ * (i.e. to merge observable types defined in several input files).
  *
  * @param rl the label identifier of the RINEX header record/line data values are for
  * @param a the system identification: G (GPS), R (GLONASS), S (SBAS), E (Galileo)
@@ -287,6 +303,16 @@ bool RinexData::setHdLnData(RINEXlabel rl, char a,  const vector<string> &b) {
 	switch(rl) {
 	case SYS:
 	case TOBS:
+		for (vector<GNSSsystem>::iterator it = systems.begin(); it != systems.end(); it++) {
+			if (it->system != a) continue;
+			for (vector<string>::const_iterator itObs = b.begin(); itObs != b.end(); itObs++)
+				if (find(it->obsType.begin(), it->obsType.end(), *itObs) == it->obsType.end()) {
+					it->obsType.push_back(*itObs);
+					it->selObsType.push_back(true);
+				}
+			v2TblValid = colTblValid = false;
+			return true;
+		}
 		systems.push_back(GNSSsystem(a, b));
 	 	setLabelFlag(SYS);
 	 	setLabelFlag(TOBS);
@@ -431,6 +457,9 @@ bool RinexData::setHdLnData(RINEXlabel rl, int a, int b, const vector<string> &c
  * Param a is the marker type. Params b and c are ignored.
  * - TOFO: to set the current epoch time (week and TOW) as the fist observation time and value passed for time system. Data to be included in record "TIME OF FIRST OBS".
  * Param a is the observation time sistem. Params b and c are ignored.
+ * - COMM: to set a comment record content to be inserted in the RINEX header just after the last record set, as comments read are.
+ * If no record has been set, comment is inserted just before the "END OF HEADER" record.
+ * Param a is the comment to be inserted. Params b and c are ignored.
  *
  * @param rl the label identifier of the RINEX header record/line data values are for
  * @param a meaning depends on the label identifier 
@@ -461,6 +490,10 @@ bool RinexData::setHdLnData(RINEXlabel rl, const string &a, const string &b, con
 		firstObsWeek = epochWeek;
 		firstObsTOW = epochTOW;
 		SET_1PARAM(TOFO, obsTimeSys)
+	case COMM:
+		if (lastRecordSet == labelDef.end()) return setHdLnData(COMM, EOH, a);
+		lastRecordSet = labelDef.insert(lastRecordSet + 1, LABELdata(a));
+		return true;
 	default:
 		throw msgLabelMis + idTOlbl(rl) + msgInSet;
 	}
@@ -1129,7 +1162,7 @@ void RinexData::clearHeaderData() {
  * @return the observable type name in V302, or an empty string if this type does not exits in V3
  */
 string RinexData::obsV2toV3(const string &obsTypeName) {
-	for (vector<EQUIVobs>::iterator it = obsNamEq.begin(); it != obsNamEq.end(); ++it)
+	for (vector<EQUIVobs>::const_iterator it = obsNamEq().begin(); it != obsNamEq().end(); ++it)
 		if(it->v2name.compare(obsTypeName) == 0) return it->v3name;
 	return string();
 }
@@ -1196,24 +1229,114 @@ double RinexData::getEpochTime(int &weeks, double &secs, double &bias, int &eFla
  * @return true if data belong to the current epoch, false otherwise
  */
 bool RinexData::saveObsData(char sys, int sat, string obsType, double value, int lol, int strg, double tTag) {
-	int sx = sysInx(sys);	//system index
+	int sx, ox;		//system and observable indexes
 	if (epochObs.empty()) epochTimeTag = tTag;
 	bool sameEpoch = epochTimeTag == tTag;
 	//check if this observable type for this system shall be stored
 	if (sameEpoch) {
-		if (sx >= 0) {
-			for (unsigned int ox = 0; ox != systems[sx].obsType.size(); ox++)
-				if (obsType.compare(systems[sx].obsType[ox]) == 0) {
-					epochObs.push_back(SatObsData(tTag, sx, sat, ox, value, lol, strg));
-					return true;
-				}
+		if (getObsIndex(sys, obsType, sx, ox)) {
+			if (!epochObs.put(sx, sat, ox, value, lol, strg))
+				plog->warning("Observation data not saved. Satellite " + string(1,sys) + to_string((long long) sat) + " out of range or observation " + obsType + " already saved");
+			return true;
 		}
 		plog->warning("Observation data not saved. Unknown system " + string(1,sys) + " or observation " + obsType); 
 	}
 	return sameEpoch;
 }
 
+/**getObsIndex provides the system index and the observable type index of the given system and observable.
+ * These indexes can be used to save observation data without searching them for each observable (see saveObsData).
+ *
+ * @param sys the system identification (G, S, ...)
+ * @param obsType the type of observable/measurement (C1C, L1C, D1C, ...) as per RINEX V3.01
+ * @param sysIx the index of the system in the systems defined in header data
+ * @param obsIx the index of the observable type in the ones defined for this system in header data
+ * @return true if the system and observable type are defined in the header data, false otherwise
+ */
+bool RinexData::getObsIndex(char sys, const string &obsType, int &sysIx, int &obsIx) {
+	if ((sysIx = sysInx(sys)) < 0) return false;
+	for (obsIx = 0; obsIx != (int) systems[sysIx].obsType.size(); obsIx++)
+		if (obsType.compare(systems[sysIx].obsType[obsIx]) == 0) return true;
+	return false;
+}
+
+/**saveObsData stores measurement data for the observable given by its indexes into the epoch data storage.
+ * It performs as the saveObsData for a given system and observable type, but using the indexes provided by getObsIndex.
+ *
+ * @param sysIx the index of the system the measurement belongs
+ * @param sat the satellite PRN the measurement belongs
+ * @param obsIx the index of the observable type in the system
+ * @param value the value of the measurement
+ * @param lol the loss o lock indicator. See RINEX V2.10
+ * @param strg the signal strength. See RINEX V3.01
+ * @param tTag the time tag for the epoch this measurement belongs
+ * @return true if data belong to the current epoch, false otherwise
+ */
+bool RinexData::saveObsData(int sysIx, int sat, int obsIx, double value, int lol, int strg, double tTag) {
+	if (epochObs.empty()) epochTimeTag = tTag;
+	bool sameEpoch = epochTimeTag == tTag;
+	if (sameEpoch) {
+		if ((sysIx >= 0) && (sysIx < (int) systems.size()) && (obsIx >= 0) && (obsIx < (int) systems[sysIx].obsType.size())) {
+			if (!epochObs.put(sysIx, sat, obsIx, value, lol, strg))
+				plog->warning("Observation data not saved. Satellite " + string(1,systems[sysIx].system) + to_string((long long) sat) + " out of range or observation " + systems[sysIx].obsType[obsIx] + " already saved");
+			return true;
+		}
+		plog->warning("Observation data not saved. Wrong system index " + to_string((long long) sysIx) + " or observation index " + to_string((long long) obsIx));
+	}
+	return sameEpoch;
+}
+
+/**saveObsColumns stores at once measurement data of several observables for several satellites into the epoch data storage.
+ * Data are given as columns: for each observable type there is a column with the value for each satellite.
+ * It performs as saveObsData would do for each satellite and observable (in this order), but the observable indexes of the columns
+ * are taken from a table built only when the column observable types, or the systems and their observable types, change.
+ *
+ * @param nSats the number of satellites (the size of each column)
+ * @param sys the system identification (G, S, ...) of each satellite
+ * @param sats the satellite PRN of each satellite
+ * @param lols the loss o lock indicator of the measurements of each satellite. See RINEX V2.10
+ * @param strgs the signal strength of the measurements of each satellite. See RINEX V3.01
+ * @param tTags the time tag of the measurements of each satellite
+ * @param nObs the number of observable types (the number of columns)
+ * @param obsTypes the observable type of each column (C1C, L1C, D1C, ...) as per RINEX V3.01
+ * @param values the columns with the measurement values: values[j][i] is the value for the observable j of the satellite i
+ * @return true if all data belong to the current epoch, false otherwise
+ */
+bool RinexData::saveObsColumns(unsigned int nSats, const char* sys, const int* sats, const int* lols, const int* strgs, const double* tTags,
+		unsigned int nObs, const string* obsTypes, const double* const* values) {
+	PERF_SCOPE("RinexData::saveObsColumns");
+	if (!colTblValid || (colInxTbl.size() != systems.size()) || (colObsTypes.size() != nObs)
+			|| !equal(colObsTypes.begin(), colObsTypes.end(), obsTypes)) buildColInxTbl(nObs, obsTypes);
+	const int* obsIx = NULL;	//the observable indexes of each column for the current system, or -1 if it is not stored
+	int sysIx = -1;
+	char sysIdx = 0;		//the system the above indexes belong
+	bool allSame = true;
+	for (unsigned int i = 0; i < nSats; i++) {
+		//get the indexes of the observables when the system changes
+		if ((i == 0) || (sys[i] != sysIdx)) {
+			sysIdx = sys[i];
+			sysIx = sysInx(sysIdx);
+			obsIx = ((sysIx < 0) || (nObs == 0))? NULL : &colInxTbl[sysIx][0];
+		}
+		for (unsigned int j = 0; j < nObs; j++) {
+			if (epochObs.empty()) epochTimeTag = tTags[i];
+			if (epochTimeTag != tTags[i]) {
+				allSame = false;
+				continue;
+			}
+			if ((obsIx == NULL) || (obsIx[j] < 0)) {
+				plog->warning("Observation data not saved. Unknown system " + string(1,sysIdx) + " or observation " + obsTypes[j]);
+				continue;
+			}
+			if (!epochObs.put(sysIx, sats[i], obsIx[j], values[j][i], lols[i], strgs[i]))
+				plog->warning("Observation data not saved. Satellite " + string(1,sysIdx) + to_string((long long) sats[i]) + " out of range or observation " + obsTypes[j] + " already saved");
+		}
+	}
+	return allSame;
+}
+
 /**getObsData extract from current epoch storage observable data in the given index position.
+ * Observables are ordered by system, satellite and observable type. Getting them in sequence (index 0, 1, 2, ...) is the fastest way to access them.
  *
  * @param sys the system identification (G, S, ...) the measurement belongs
  * @param sat the satellite PRN the measurement belongs
@@ -1226,15 +1349,11 @@ bool RinexData::saveObsData(char sys, int sat, string obsType, double value, int
  * @return true if data for the given index exist, false otherwise
  */
 bool RinexData::getObsData(char &sys, int &sat, string &obsType, double &value, int &lol, int &strg, double &tTag, unsigned int index) {
-	if (epochObs.size() <= index) return false;
-	vector<SatObsData>::iterator it = epochObs.begin() + index;
-	sys = systems[it->sysIndex].system;
-	sat = it->satellite;
-	obsType = systems[it->sysIndex].obsType[it->obsTypeIndex];
-	value = it->obsValue;
-	lol = it->lossOfLock;
-	strg = it->strength;
-	tTag = it->obsTimeTag;
+	int sysIx, obsIx;
+	if (!epochObs.getCell(index, sysIx, sat, obsIx, value, lol, strg)) return false;
+	sys = systems[sysIx].system;
+	obsType = systems[sysIx].obsType[obsIx];
+	tTag = epochTimeTag;
 	return true;
 }
 
@@ -1267,6 +1386,7 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
 	string aStr;
 	//Reset selection data for systems, satellites or observables as per GNSSsystem constructor
 	applyNavFilter = applyObsFilter = false;
+	v2TblValid = colTblValid = false;
 	selectedSats.clear();
 	for (vector<GNSSsystem>::iterator itSystems = systems.begin(); itSystems != systems.end(); itSystems++) {
 		itSystems->selSystem = true;
@@ -1309,6 +1429,15 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
 			inxSelSys.push_back(sysIdx);
 			if ((*itSelSat).size() > 1) systems[sysIdx].selSat.push_back(stoi((*itSelSat).substr(1)));
 		}
+	//set the selected satellites map of each system
+	for (vector<GNSSsystem>::iterator itSystems = systems.begin(); itSystems != systems.end(); itSystems++) {
+		itSystems->selSatMap.clear();
+		for (vector<int>::iterator itSat = itSystems->selSat.begin(); itSat != itSystems->selSat.end(); itSat++)
+			if (*itSat >= 0) {
+				if (*itSat >= (int) itSystems->selSatMap.size()) itSystems->selSatMap.resize(*itSat + 1, false);
+				itSystems->selSatMap[*itSat] = true;
+			}
+	}
 	//verify given data for selected systems - observations. Save system index and observation index of correct ones
 	for (vector<string>::iterator itSelObs = selObs.begin(); itSelObs != selObs.end(); itSelObs++)
 		if ((sysIdx = sysInx((*itSelObs).at(0))) < 0) {
@@ -1369,18 +1498,17 @@ bool RinexData::setFilter(vector<string> selSat, vector<string> selObs) {
  * @return true when it remains any epoch data after filtering, false when no data remain
  */
 bool RinexData::filterObsData() {
-	vector<SatObsData>::iterator it;
+	PERF_SCOPE("RinexData::filterObsData");
+	int sx, ox;
+	bool satSelected;
 	if (applyObsFilter) {	//remove from epochObs the observables not selected
-		it = epochObs.begin();
-		while (it != epochObs.end()) {
-			if (!systems[it->sysIndex].selSystem ||
-					!systems[it->sysIndex].selObsType[it->obsTypeIndex] ||
-					!isSatSelected(it->sysIndex, it->satellite)) {	//system, observable or satellite not selected
-				it = epochObs.erase(it);
-			} else it++;
+		for (int row = epochObs.firstSat(); row >= 0; row = epochObs.nextSat(row)) {
+			sx = epochObs.getSys(row);
+			satSelected = systems[sx].selSystem && isSatSelected(sx, epochObs.getSat(row));
+			for (ox = epochObs.lastObs(row); ox >= 0; ox--)
+				if (!satSelected || !systems[sx].selObsType[ox]) epochObs.erase(row, ox);
 		}
 	}
-	sort(epochObs.begin(), epochObs.end());
 	return !epochObs.empty();
 }
 
@@ -1391,8 +1519,50 @@ void RinexData::clearObsData() {
 	epochObs.clear();
 }
 
+/**copyObsEpoch sets the current epoch data (time, clock offset, flag and observation data) from the current epoch of other RinexData object.
+ * It is intended to print several files (with different versions or filtering data) from epochs read or acquired once:
+ * epoch data are stored in the source object, and copied from it to each object printing a file before calling printObsEpoch.
+ * Observation data are copied only for systems and observable types defined in this object, using a table relating
+ * the indexes in the source object with indexes in this one. The table is rebuilt when the source object or its systems change.
+ *
+ * @param from the RinexData object containing the epoch data to copy. Its data are not modified
+ * @return true if any observation data has been copied, false otherwise
+ */
+bool RinexData::copyObsEpoch(RinexData &from) {
+	int sx, ox, sysIx, obsIx;
+	if ((copyInxSrc != &from) || (copySysTbl.size() != from.systems.size())) {
+		copySysTbl.assign(from.systems.size(), -1);
+		copyObsTbl.assign(from.systems.size(), vector<int>());
+		copyInxSrc = &from;
+	}
+	epochWeek = from.epochWeek;
+	epochTOW = from.epochTOW;
+	epochTimeTag = from.epochTimeTag;
+	epochClkOffset = from.epochClkOffset;
+	epochFlag = from.epochFlag;
+	nSatsEpoch = from.nSatsEpoch;
+	epochObs.clear();
+	for (int row = from.epochObs.firstSat(); row >= 0; row = from.epochObs.nextSat(row)) {
+		sx = from.epochObs.getSys(row);
+		vector<int> &obsTbl = copyObsTbl[sx];
+		if (obsTbl.size() != from.systems[sx].obsType.size()) {	//(re)build the indexes for this system
+			obsTbl.resize(from.systems[sx].obsType.size());
+			for (ox = 0; ox < (int) obsTbl.size(); ox++)
+				obsTbl[ox] = getObsIndex(from.systems[sx].system, from.systems[sx].obsType[ox], sysIx, obsIx)? obsIx : -1;
+			copySysTbl[sx] = sysInx(from.systems[sx].system);
+		}
+		if (copySysTbl[sx] < 0) continue;
+		for (ox = 0; ox <= from.epochObs.lastObs(row); ox++)
+			if (from.epochObs.hasObs(row, ox) && (obsTbl[ox] >= 0))
+				epochObs.put(copySysTbl[sx], from.epochObs.getSat(row), obsTbl[ox],
+					from.epochObs.getValue(row, ox), from.epochObs.getLol(row, ox), from.epochObs.getStrength(row, ox));
+	}
+	return !epochObs.empty();
+}
+
 /**saveNavData stores navigation data from a given satellite into the navigation data storage.
  * Only new epoch data are stored: tTag, system and satellite shall be different from other records already saved.
+ * The storage is kept ordered by time tag, system and satellite.
  *
  * @param sys the satellite system identifier (G,E,R, ...)
  * @param sat the satellite PRN the navigation data belongs
@@ -1404,13 +1574,10 @@ bool RinexData::saveNavData(char sys, int sat, double bo[8][4], double tTag) {
 	//check if this sat epoch data already exists: same satellite and time tag
 	char msgBuf[100];
 	sprintf(msgBuf,"Ephemeris for sat=%c%02d at=%g ", sys, sat, tTag);
-	for (vector<SatNavData>::iterator it = epochNav.begin(); it != epochNav.end(); it++) {
-		if((sys == it->systemId) && (sat == it->satellite) && (tTag == it->navTimeTag)) {
-			plog->fine(string(msgBuf) + " already exist");
-			return false;
-		}
+	if (!insertNavData(SatNavData(tTag, sys, sat, bo))) {
+		plog->fine(string(msgBuf) + " already exist");
+		return false;
 	}
-	epochNav.push_back(SatNavData(tTag, sys, sat, bo));
 	plog->fine(string(msgBuf) + " saved");
 	return true;
 }
@@ -1441,21 +1608,24 @@ bool RinexData::getNavData(char& sys, int &sat, double (&bo)[8][4], double &tTag
  * @return true when it remains any epoch data after filtering, false when no data remain
  */
 bool RinexData::filterNavData() {
+	PERF_SCOPE("RinexData::filterNavData");
 	char buffer[5];
-	vector<SatNavData>::iterator it;
+	vector<SatNavData>::iterator it, itKept;
 	vector<string>::iterator itsel;
-	if (applyNavFilter) {	//remove from epochNav the system-satellites not selected
-		it = epochNav.begin();
-		while (it != epochNav.end()) {
+	if (applyNavFilter) {	//remove from epochNav the system-satellites not selected, moving the selected ones in a single pass
+		itKept = epochNav.begin();
+		for (it = epochNav.begin(); it != epochNav.end(); it++) {
 			sprintf(buffer, "%1c%02.2d", it->systemId, it->satellite);	//obtain a string with system-satellite identification
 			for (itsel = selectedSats.begin();	//look for it in the selected system-satellites list
 				(itsel != selectedSats.end()) && (string(buffer).compare(0,(*itsel).size(), *itsel) != 0);
 				++itsel);
-			if (itsel == selectedSats.end()) it = epochNav.erase(it);
-			else it++;
+			if (itsel != selectedSats.end()) {
+				if (itKept != it) *itKept = *it;
+				itKept++;
+			}
 		}
+		epochNav.erase(itKept, epochNav.end());
 	}
-	sort(epochNav.begin(), epochNav.end());
 	return !epochNav.empty();
 }
 
@@ -1466,6 +1636,21 @@ void RinexData::clearNavData() {
 	epochNav.clear();
 }
 
+/**setCompactOutput sets the format of the observation files to be printed: Compact RINEX (Hatanaka) or RINEX.
+ * In Compact RINEX the file header is preceded by the CRINEX specific records, and epoch data are encoded as differences with
+ * the previous epoch (see CompactRinex). Navigation files are always printed in RINEX format.
+ *
+ * @param compact true to print observation files in Compact RINEX format, false to print them in RINEX format (the default)
+ */
+void RinexData::setCompactOutput(bool compact) {
+	if (compact) {
+		if (crxOut == NULL) crxOut = new CompactRinex();
+	} else if (crxOut != NULL) {
+		delete crxOut;
+		crxOut = NULL;
+	}
+}
+
 /**getObsFileName constructs a standard RINEX observation file name from the given prefix and current header data.
  * For V2.1 RINEX file names, the given prefix and the current TIME OF FIRST OBSERVATION header data are used.
  * Additionally, for V3.02 the file name includes data from MARKER NUMBER, REC # / TYPE / VERS, TIME OF FIRST OBS and TIME OF LAST OBS,
@@ -1473,14 +1658,19 @@ void RinexData::clearNavData() {
  *
  * @param prefix : the file name prefix
  * @param country the 3-char ISO 3166-1 country code, or "---" if parameter not given
+ *<p>When Compact RINEX output is set, the file type in V2.1 names is 'D', and the extension in V3.02 names is crx.
+ *
  * @return the RINEX observation file name in the standard format (PRFXdddamm.yyO for v2.1, XXXXMRCCC_R_YYYYDDDHHMM_FPU_DFU_DO.RNX for v3.02)
  */
 string RinexData::getObsFileName(string prefix, string country) {
+	string fileName;
 	switch(version) {
 	case V302:
-		return fmtRINEXv3name(prefix, firstObsWeek, firstObsTOW, 'O', country);
+		fileName = fmtRINEXv3name(prefix, firstObsWeek, firstObsTOW, 'O', country);
+		if (crxOut != NULL) fileName.replace(fileName.size() - 3, 3, "crx");
+		return fileName;
 	default:
-		return fmtRINEXv2name(prefix, firstObsWeek, firstObsTOW, 'O');
+		return fmtRINEXv2name(prefix, firstObsWeek, firstObsTOW, crxOut != NULL? 'D' : 'O');
 	}
 }
 
@@ -1501,8 +1691,7 @@ string RinexData::getNavFileName(string prefix, char suffix, string country) {
 		week = firstObsWeek;
 		tow = firstObsTOW;
 	}
-	if (!epochNav.empty()) {
-		sort(epochNav.begin(), epochNav.end());
+	if (!epochNav.empty()) {	//navigation data are ordered: the first one is the earliest
 		week = getGPSweek(epochNav[0].navTimeTag);
 		tow = getGPStow(epochNav[0].navTimeTag);
 	}
@@ -1520,6 +1709,7 @@ string RinexData::getNavFileName(string prefix, char suffix, string country) {
  * @throws error message string when header cannot be printed
  */
 void RinexData::printObsHeader(FILE* out) {
+	PERF_SCOPE("RinexData::printObsHeader");
 	string aStr;
 	///Before printing, set and verify VERSION data record:
 	int anInt = nSysSel();
@@ -1544,12 +1734,19 @@ void RinexData::printObsHeader(FILE* out) {
 				if (v2ObsInx(aStr) == -1) v2ObsLst.push_back(aStr);
 			}
 		}
+		v2TblValid = false;
 		setLabelFlag(SYS, false);
 		setLabelFlag(TOBS);
 	} else {	//version will be V302
 		setLabelFlag(SYS);
 		setLabelFlag(TOBS, false);
 	}
+	///When Compact RINEX output is set, print the CRINEX specific records before the header ones.
+	if (crxOut != NULL) {
+		outBuf.clear();
+		crxOut->encodeHeader(version == V302, pgm, outBuf);
+		outBuf.write(out);
+	}
 	///Finally, for each observation header record belonging to the current version and having data defined, print it.
 	for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++) {
 		if (((it->type & OBSMSK) != OBSNAP) && (it->ver == VALL || it->ver == version)) {
@@ -1576,13 +1773,10 @@ void RinexData::printObsHeader(FILE* out) {
  * @throws error message string when epoch data cannot be printed due to undefined version to be printed
  */
 void RinexData::printObsEpoch(FILE* out) {
-///a macro to compute comparison expression of satellite in two consecutive observables, in iterator POSITION and (POSITION-1)
-	#define DIFFERENT_SAT(POSITION) \
-		((POSITION-1)->sysIndex != POSITION->sysIndex) ||	\
-		((POSITION-1)->satellite != POSITION->satellite)
-
+	PERF_SCOPE("RinexData::printObsEpoch");
 	char timeBuffer[80];
-	vector<SatObsData>::iterator it;
+	int row;		//the row in epochObs of the next satellite to print
+	int sx, ox;
 	int anInt;
 	bool clkPrinted = false;	//a flag to know if clock bias has been printed or not
 	//set the printable epoch time using format of the version to be printed.
@@ -1607,58 +1801,89 @@ void RinexData::printObsEpoch(FILE* out) {
 		switch (version) {
 		case V210:	//RINEX version 2.10
 			//change the observable type index as per V210 and remove observations not allowed in V210
-			it = epochObs.begin();
-			while (it != epochObs.end()) {
-				anInt = v2ObsInx(obsV3toV2(it->sysIndex, it->obsTypeIndex));
-				if (anInt >= 0) {
-					it->obsTypeIndex = anInt;
-					it++;
-				} else it = epochObs.erase(it);
+			if (!v2TblValid || (v2InxTbl.size() != systems.size())) buildV2InxTbl();
+			v2Obs.clear();
+			for (row = epochObs.firstSat(); row >= 0; row = epochObs.nextSat(row)) {
+				sx = epochObs.getSys(row);
+				for (ox = 0; ox <= epochObs.lastObs(row); ox++)
+					if (epochObs.hasObs(row, ox) && ((anInt = v2InxTbl[sx][ox]) >= 0)
+							&& !v2Obs.put(sx, epochObs.getSat(row), anInt, epochObs.getValue(row, ox), epochObs.getLol(row, ox), epochObs.getStrength(row, ox)))
+						plog->warning("Epoch " + to_string((long double) epochTimeTag)
+							+ " sat=" + string(1,systems[sx].system) + to_string((long long) epochObs.getSat(row))
+							+ " obs=" + string(systems[sx].obsType[ox])
+							+ " Ignored observable already printed");
 			}
+			epochObs.clear();
+			epochObs.swap(v2Obs);
 			//check if it remains anything to print
 		 	if (epochObs.empty()) return;
-			//sort observable data items available by system, satellite and new measurement type
-			sort(epochObs.begin(), epochObs.end());
 			//count the number of different satellites with data in this epoch (at least one)
-			nSatsEpoch = 1;
-			for (it = epochObs.begin()+1; it != epochObs.end(); it++) if (DIFFERENT_SAT(it)) nSatsEpoch++;
-	 		//print epoch 1st line
-	 		fprintf(out, "%s  %1d%3d", timeBuffer, epochFlag, nSatsEpoch);
+			nSatsEpoch = epochObs.satCount();
+			if (crxOut != NULL) {
+				printCompactEpoch(out, timeBuffer);
+				break;
+			}
+	 		//render epoch 1st line
+			outBuf.clear();
+			outBuf.putStr(timeBuffer);
+			outBuf.putChars(' ', 2);
+			outBuf.putInt(epochFlag, 1);
+			outBuf.putInt(nSatsEpoch, 3);
 			//append the different systems and satellites existing in this epoch.
 			//if number of satellites is greather than 12, use continuation lines. Clock bias is printed only in the 1st one
-			fprintf(out, "%1c%02d", systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
-			anInt = 1;		//currently, the number of satellites already printed
-			for (it = epochObs.begin()+1; it != epochObs.end(); it++)
-				if (DIFFERENT_SAT(it)) {
-					if ((anInt % 12) == 0) fprintf(out, "\n%32c", ' '); //to print the 1st sat in a continuation line
-					fprintf(out, "%1c%02d", systems[it->sysIndex].system, it->satellite);
-					anInt++;
-					if (anInt == 12) {		//printed last sat in the 1st line
-						fprintf(out, "%12.9f", epochClkOffset);
-						clkPrinted = true;
-					}
+			anInt = 0;		//currently, the number of satellites already printed
+			for (row = epochObs.firstSat(); row >= 0; row = epochObs.nextSat(row)) {
+				if ((anInt != 0) && ((anInt % 12) == 0)) {	//to print the 1st sat in a continuation line
+					outBuf.putChar('\n');
+					outBuf.putChars(' ', 32);
+				}
+				outBuf.putChar(systems[epochObs.getSys(row)].system);
+				outBuf.putInt(epochObs.getSat(row), 2, true);
+				anInt++;
+				if (anInt == 12) {		//printed last sat in the 1st line
+					outBuf.putFixed(epochClkOffset, 12, 9);
+					clkPrinted = true;
 				}
+			}
 			while ((anInt % 12) != 0) {	//fill the line
-				fprintf(out, "%3c", ' ');
+				outBuf.putChars(' ', 3);
 				anInt++;
 			}
-			if (clkPrinted) fprintf(out, "\n");
-			else fprintf(out, "%12.9f\n", epochClkOffset);
-			//print epoch measurement lines. For each satellite in this epoch, print a line with their measurements, and remove them
-			while (printSatObsValues(out, 5));
+			if (!clkPrinted) outBuf.putFixed(epochClkOffset, 12, 9);
+			outBuf.putChar('\n');
+			//render epoch measurement lines. For each satellite in this epoch, a line with their measurements
+			row = epochObs.firstSat();
+			while (printSatObsValues(5, row));
+			//print all epoch lines and remove epoch data
+			outBuf.write(out);
+			epochObs.clear();
 	 		break;
 		case V302:	//RINEX version 3.00
-			//sort observable data items available by system, satellite and measurement type
-			sort(epochObs.begin(), epochObs.end());
 			//count the number of different satellites with data in this epoch (at least one)
-			nSatsEpoch = 1;
-			for (it = epochObs.begin()+1; it != epochObs.end(); it++) if (DIFFERENT_SAT(it)) nSatsEpoch++;
-			//print epoch 1st line
- 			fprintf(out, "%s  %1d%3d%5c%15.12f%3c\n", timeBuffer, epochFlag, nSatsEpoch, ' ', epochClkOffset, ' ');
-			//for each satellite belonging to this epoch,  print a line with their measurements (they are removed just after printed)
+			nSatsEpoch = epochObs.satCount();
+			if (crxOut != NULL) {
+				printCompactEpoch(out, timeBuffer);
+				break;
+			}
+			//render epoch 1st line
+			outBuf.clear();
+			outBuf.putStr(timeBuffer);
+			outBuf.putChars(' ', 2);
+			outBuf.putInt(epochFlag, 1);
+			outBuf.putInt(nSatsEpoch, 3);
+			outBuf.putChars(' ', 5);
+			outBuf.putFixed(epochClkOffset, 15, 12);
+			outBuf.putChars(' ', 3);
+			outBuf.putChar('\n');
+			//for each satellite belonging to this epoch, render a line with their measurements
+			row = epochObs.firstSat();
 			do {
-				fprintf(out, "%1c%02d", systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
- 			} while (printSatObsValues(out, 999));
+				outBuf.putChar(systems[epochObs.getSys(row)].system);
+				outBuf.putInt(epochObs.getSat(row), 2, true);
+ 			} while (printSatObsValues(999, row));
+			//print all epoch lines and remove epoch data
+			outBuf.write(out);
+			epochObs.clear();
  			break;
  		}
 		break;
@@ -1673,7 +1898,12 @@ void RinexData::printObsEpoch(FILE* out) {
 				nSatsEpoch++;
 		}
 		//print epoch 1st line. Note that nSatsEpoch contains the number of special records that follow
- 		fprintf(out, "%s  %1d%3d\n", timeBuffer, epochFlag, nSatsEpoch);
+		if (crxOut != NULL) {
+			sprintf(timeBuffer + strlen(timeBuffer), "  %1d%3d", epochFlag, nSatsEpoch);
+			outBuf.clear();
+			crxOut->encodeEvent(timeBuffer, outBuf);
+			outBuf.write(out);
+		} else fprintf(out, "%s  %1d%3d\n", timeBuffer, epochFlag, nSatsEpoch);
 		if (nSatsEpoch > 0) {
 			//print the header lines that follow
 			for (vector<LABELdata>::iterator lit = labelDef.begin(); lit != labelDef.end(); lit++) {
@@ -1698,12 +1928,60 @@ void RinexData::printObsEpoch(FILE* out) {
 	 printObsEpoch(out);
 }
  
+/**updateObsHeader updates in place, in an already printed RINEX observation file, the header records whose data
+ * could be known only after printing the header: INTERVAL, TIME OF FIRST OBS and TIME OF LAST OBS.
+ *<p>These records are rewritten with the data currently stored. To be updated, they shall have been printed in the header
+ * (with provisional data), and their format has fixed length. The file shall be open for update ("w+"), and after updating
+ * it is positioned at its end.
+ *<p>Note that it shall be used before printObsEOF, as it clears header data.
+ *
+ * @param out the RINEX observation file where the header has been printed
+ * @return true if the header has been read and records updated, false otherwise (read or positioning error)
+ */
+bool RinexData::updateObsHeader(FILE* out) {
+	char line[100];
+	long pos;
+	size_t n;
+	bool eohFound = false;
+	if (fflush(out) != 0 || fseek(out, 0L, SEEK_SET) != 0) return false;
+	while (!eohFound) {
+		pos = ftell(out);
+		if (fgets(line, sizeof line, out) == NULL) break;
+		n = strlen(line);
+		while ((n > 60) && ((line[n-1] == '\n') || (line[n-1] == '\r') || (line[n-1] == ' '))) line[--n] = 0;
+		if (n <= 60) continue;
+		for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++) {
+			if (strcmp(it->labelVal, line + 60) != 0) continue;
+			switch (it->labelID) {
+			case EOH:
+				eohFound = true;
+				break;
+			case INT:
+			case TOFO:
+			case TOLO:
+				if (!it->hasData) break;
+				//rewrite the record, and set the file position for the next read
+				if (fseek(out, pos, SEEK_SET) != 0) return false;
+				printHdLineData(out, it);
+				if (fseek(out, 0L, SEEK_CUR) != 0) return false;
+				break;
+			default:
+				break;
+			}
+			break;
+		}
+	}
+	if (fseek(out, 0L, SEEK_END) != 0) return false;
+	return eohFound;
+}
+
  /**printNavHeader prints RINEX navigation file header using the current RINEX data.
  * 
  * @param out	The already open print file where RINEX header will be printed
  * @throws error message string when header cannot be printed
  */
 void RinexData::printNavHeader(FILE* out) {
+	PERF_SCOPE("RinexData::printNavHeader");
 	///Before printing, set and verify VERSION data record. Independent of the version to be printed. It is initially
 	///set as per version V3.01: file type will be 'N', and system identification the one of the system to print, or 
 	///'M' if there are data for several systems.
@@ -1769,11 +2047,26 @@ void RinexData::printNavHeader(FILE* out) {
  * @throws error message string when epoch cannot be printed
  */
 void RinexData::printNavEpoch(FILE* out) {
+	printNavEpoch(out, HUGE_VAL);
+}
+
+/**printNavEpoch prints ephemeris data stored having a time tag before the given limit, according version and systems selected.
+ *<p>It allows printing navigation data while they are being acquired: ephemeris for a time window already finished can be printed
+ * and removed from the storage, keeping it bounded. Ephemeris are printed ordered by time tag, system and satellite.
+ * Ephemeris of unknown systems are logged and removed without printing them.
+ *<p>Other conditions are as per printNavEpoch without limit.
+ * 
+ * @param out the already open print file where RINEX epoch will be printed
+ * @param tTagLimit the time tag limit: only ephemeris having time tags before it are printed
+ * @throws error message string when epoch cannot be printed
+ */
+void RinexData::printNavEpoch(FILE* out, double tTagLimit) {
+	PERF_SCOPE("RinexData::printNavEpoch");
 	char timeBuffer[80];
 	int nBroadcastOrbits, nEphemeris;
 	char* timeFormat;
 	char* lineStart;
-	vector<SatNavData>::iterator it;
+	vector<SatNavData>::iterator it, itKept;
 
 #ifdef _WIN32
 	//MS VS specific!!
@@ -1793,55 +2086,66 @@ void RinexData::printNavEpoch(FILE* out) {
 	default:
 		throw string("Unknown RINEX navigation version");
 	}
-	//filter and sort epochs available by time tag, system, and satellite
-	//filterNavData();
-	//sort epochs available by time tag, system, and satellite
-	sort(epochNav.begin(), epochNav.end());
-	plog->finest("Nav epoch for sys=" + string(1, systemId));
-	it = epochNav.begin();
-	while (it != epochNav.end()) {
+	//epochs available are already ordered by time tag, system, and satellite
+	LOG_FINEST(plog, "Nav epoch for sys=" + string(1, systemId));
+	//ephemeris not printed are moved to the beginning of epochNav, and the rest is removed after printing
+	itKept = epochNav.begin();
+	outBuf.clear();
+	for (it = epochNav.begin(); (it != epochNav.end()) && (it->navTimeTag < tTagLimit); it++) {
 		if ((version == V210) && (it->systemId != systemId)) {	//in V210 only sats belonging to one system are printed
-			plog->finest("Nav epoch ignored: sys=" + string(1,it->systemId) + "; sat=" + to_string((long long) it->satellite));
-			it++;
+			LOG_FINEST(plog, "Nav epoch ignored: sys=" + string(1,it->systemId) + "; sat=" + to_string((long long) it->satellite));
+			if (itKept != it) *itKept = *it;
+			itKept++;
 		} else {
-			plog->finest("Nav epoch printed: sys=" + string(1, it->systemId) + "; sat=" + to_string((long long) it->satellite));
+			switch (it->systemId) {
+			//set values for nBroadcastOrbits and nEphemeris as stated in RINEX 3.01 doc 
+			case 'G': nBroadcastOrbits = 8; nEphemeris = 26; break;
+			case 'E': nBroadcastOrbits = 8; nEphemeris = 25; break;
+			case 'S': nBroadcastOrbits = 4; nEphemeris = 12; break;
+			case 'R': nBroadcastOrbits = 4; nEphemeris = 12; break;
+			default:	//the ephemeris are not printed, and removed as the printed ones
+				plog->warning("Nav epoch not printed. Unknown system:" + string(1, it->systemId));
+				continue;
+			}
+			LOG_FINEST(plog, "Nav epoch printed: sys=" + string(1, it->systemId) + "; sat=" + to_string((long long) it->satellite));
 			//print epoch first line
 			formatGPStime (timeBuffer, sizeof timeBuffer, timeFormat, " %4.1f", getGPSweek(it->navTimeTag), getGPStow(it->navTimeTag));
 			switch (version) {	//print satellite and epoch time
 			case V210:
-				fprintf(out, "%02d %s", it->satellite, timeBuffer);
+				outBuf.putInt(it->satellite, 2, true);
+				outBuf.putChar(' ');
+				outBuf.putStr(timeBuffer);
 				if (it->systemId == 'R') {	//in V2 GLONASS tk to print is daily, not weekly 
 					it->broadcastOrbit[0][3] = fmod(it->broadcastOrbit[0][3], 86400);
 				}
 				break;
 			case V302:
-				fprintf(out, "%1c%02d %s", it->systemId, it->satellite, timeBuffer);
+				outBuf.putChar(it->systemId);
+				outBuf.putInt(it->satellite, 2, true);
+				outBuf.putChar(' ');
+				outBuf.putStr(timeBuffer);
 				break;
 			}
 			for (int i=1; i<4; i++)	//add the Af0, Af1 & Af2 values
-				fprintf(out, "%19.12E", it->broadcastOrbit[0][i]);
-			fprintf(out, "\n");
+				outBuf.putExp(it->broadcastOrbit[0][i], 19, 12);
+			outBuf.putChar('\n');
 			//print the rest of broadcast orbit data lines
-			switch (it->systemId) {
-			//set values for nBroadcastOrbits and nEphemeris as stated in RINEX 3.01 doc 
-			case 'G': nBroadcastOrbits = 8; nEphemeris = 26; break;
-			case 'E': nBroadcastOrbits = 8; nEphemeris = 25; break;
-			case 'S': nBroadcastOrbits = 4; nEphemeris = 12; break;
-			case 'R': nBroadcastOrbits = 4; nEphemeris = 12; break;
-			default: throw string("Unknown system:") + string(1, it->systemId);
-			}
 			for (int i = 1; (i < nBroadcastOrbits) && (nEphemeris > 0); i++) {
-				fprintf(out, lineStart);
+				outBuf.putStr(lineStart);
 				for (int j = 0; j < 4; j++) {
-					if (nEphemeris > 0) fprintf(out, "%19.12E", it->broadcastOrbit[i][j]);
-					else fprintf(out, "%19c", ' ');
+					if (nEphemeris > 0) outBuf.putExp(it->broadcastOrbit[i][j], 19, 12);
+					else outBuf.putChars(' ', 19);
 					nEphemeris--;
 				}
-				fprintf(out, "\n");
+				outBuf.putChar('\n');
 			}
-			epochNav.erase(it);
 		}
 	}
+	outBuf.write(out);
+	//ephemeris after the time limit are kept
+	if (itKept != it) itKept = copy(it, epochNav.end(), itKept);
+	else itKept = epochNav.end();
+	epochNav.erase(itKept, epochNav.end());
 }
 
 /**readRinexHeader read the RINEX file header extracting its data and storing them into to the class members.
@@ -1854,6 +2158,7 @@ void RinexData::printNavEpoch(FILE* out) {
  * @return EOH if end of header line is read, LASTONE if EOF is found, or NOLABEL if at least ten lines without label are read
  */
 RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
+	PERF_SCOPE("RinexData::readRinexHeader");
 	RINEXlabel labelId;
 	int maxErrors = 10;
 	plog->fine("Data from RINEX file header:");
@@ -1864,6 +2169,12 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
 	// 3 : SATS read. PRN can follow
 	// 4 : EOH read
 	int lineOrder = 0;
+	//the first record read will be checked to detect Compact RINEX files
+	if (crxIn != NULL) {
+		delete crxIn;
+		crxIn = NULL;
+	}
+	crxCheck = true;
 	//read lines from input file
 	do {
 		labelId = readHdLineData(input);
@@ -1922,9 +2233,162 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
 	return labelId;
 }
 
+/**mapInputFile maps in memory the contents of the given input file, from its current position up to its end.
+ * It is intended to be used after reading the file header with readRinexHeader. Once the file is mapped, records are
+ * read from memory instead of from the input stream: readObsEpoch parses observation epochs directly from the mapped contents,
+ * without copying lines to intermediate buffers, and the input stream position is not further modified.
+ * Where file mapping is not available (MS Windows) the remaining contents of the file are loaded into a memory buffer.
+ * If contents cannot be mapped, data will continue being read from the input stream.
+ * Compact RINEX input files are not mapped, because their records shall be decoded before parsing them.
+ *
+ * @param input the already open input stream positioned just after the END OF HEADER record
+ * @return true if the input file contents have been mapped, false otherwise
+ */
+bool RinexData::mapInputFile(FILE* input) {
+	unmapInputFile();
+	if (crxIn != NULL) return false;
+	long offset = ftell(input);
+	if (offset < 0) return false;
+#ifdef _WIN32
+	long size;
+	char* buffer;
+	if ((fseek(input, 0, SEEK_END) != 0) || ((size = ftell(input)) < offset) || (fseek(input, offset, SEEK_SET) != 0)) return false;
+	if ((buffer = (char*) malloc(size - offset + 1)) == NULL) return false;
+	inMapSize = fread(buffer, 1, size - offset, input);
+	inMapBase = buffer;
+	inMapPos = 0;
+	inMapEnd = inMapSize;
+#else
+	struct stat fileStat;
+	void* addr;
+	if ((fstat(fileno(input), &fileStat) != 0) || (fileStat.st_size < offset)) return false;
+	if (fileStat.st_size == 0) return false;
+	if ((addr = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(input), 0)) == MAP_FAILED) return false;
+	madvise(addr, fileStat.st_size, MADV_SEQUENTIAL);
+	inMapBase = (const char*) addr;
+	inMapSize = fileStat.st_size;
+	inMapPos = offset;
+	inMapEnd = inMapSize;
+#endif
+	inMapOwned = true;
+	plog->fine("Input file mapped in memory. Bytes:" + to_string((long long) (inMapSize - inMapPos)));
+	return true;
+}
+
+/**unmapInputFile releases the memory mapping of the input file contents, if any, stopping the parallel parsing of epochs if it is active.
+ * After calling it, records will be read again from the input stream passed to the read methods.
+ */
+void RinexData::unmapInputFile() {
+	stopParallelRead();
+	if (inMapBase == NULL) return;
+	if (inMapOwned) {
+#ifdef _WIN32
+		free((void*) inMapBase);
+#else
+		munmap((void*) inMapBase, inMapSize);
+#endif
+	}
+	inMapBase = NULL;
+	inMapSize = inMapPos = inMapEnd = 0;
+	inMapOwned = false;
+}
+
+//@cond DUMMY
+///The maximum size in bytes of the chunks of the mapped input file parsed by each worker
+#define PARCHUNKMAX 4194304
+///The minimum size in bytes of the chunks of the mapped input file parsed by each worker
+#define PARCHUNKMIN 65536
+///The number of chunks per worker that can be parsed ahead of the chunk being read
+#define PARCHUNKSAHEAD 2
+//@endcond
+
+/**ParallelReader contains the state of the parallel parsing of observation epochs from the input file mapped in memory.
+ *<p>The mapped contents are split in chunks starting at epoch boundaries. Worker threads take the next chunk pending to parse,
+ * and parse its epochs storing their data in the chunk. When reading epochs (see readObsEpoch), data are taken from chunks in the
+ * same order they have in the file. Memory used by a chunk is released once all its epochs have been read.
+ *<p>Epoch events (flags 2 to 5) may contain header records that would modify the way following epochs shall be parsed.
+ * For this reason, a worker stops parsing a chunk when an event is found: when reading reaches the event, the parallel parsing
+ * finishes, and remaining epochs are parsed sequentially as they are read.
+ */
+struct RinexData::ParallelReader {
+	struct EpochData {		//the data of an epoch parsed
+		int status;			//the status returned by readObsEpoch when the epoch was parsed
+		int week;			//the epoch time and clock offset
+		double tow;
+		double timeTag;
+		double clkOffset;
+		int flag;			//the epoch flag
+		int nSats;			//the number of satellites in the epoch
+		size_t obsEnd;		//the position in the chunk obs vector after the last observable of this epoch
+	};
+	struct Chunk {			//a chunk of the mapped contents
+		size_t begin;		//the offset in the mapped contents of the first record in the chunk
+		size_t end;			//the offset in the mapped contents after the last record in the chunk
+		vector<EpochData> epochs;		//the epochs parsed from the chunk
+		vector<SatObsData> obs;			//the observables of all epochs parsed from the chunk
+		bool done;			//true when parsing of the chunk has finished
+		bool stopped;		//true when parsing stopped at an epoch event
+		size_t resumePos;	//the offset of the epoch event where parsing stopped
+	};
+	vector<Chunk> chunks;		//the chunks to parse
+	vector<GNSSsystem> systems;	//the systems and observable types used to parse epochs
+	vector<thread> workers;		//the worker threads
+	mutex chunkMutex;			//to access chunk status and the indexes below
+	condition_variable chunkDone;	//notified when a chunk has been parsed
+	condition_variable chunkRead;	//notified when all epochs of a chunk have been read
+	size_t nextChunk;			//the next chunk to parse
+	size_t readChunk;			//the chunk being read
+	size_t readEpoch;			//the next epoch to read in readChunk
+	size_t maxAhead;			//the maximum number of chunks parsed ahead of readChunk
+	atomic<bool> abort;			//true when workers shall stop parsing
+};
+
+/**setParallelRead starts the parallel parsing of observation epochs in the input file mapped in memory, using the given number of worker threads.
+ * It is intended to be used after mapping the input file with mapInputFile.
+ *<p>Once started, readObsEpoch provides the epochs parsed by the workers, in the same order they have in the input file, and with the same
+ * data and status it would provide parsing them sequentially. Parallel parsing finishes when all epochs have been read, or when an
+ * epoch event is found. In this case, remaining epochs are parsed sequentially when read.
+ *<p>Parallel parsing is not started when the file is not mapped, its version is unknown, or it is too small to be split in several chunks.
+ *
+ * @param nWorkers the number of worker threads to use. If zero or negative, the number of hardware threads available is used
+ * @return true if the parallel parsing has been started, false otherwise
+ */
+bool RinexData::setParallelRead(int nWorkers) {
+	vector<size_t> bounds;
+	size_t chunkSize;
+	stopParallelRead();
+	if ((inMapBase == NULL) || ((inFileVer != V210) && (inFileVer != V302))) return false;
+	if (nWorkers <= 0) nWorkers = (int) thread::hardware_concurrency();
+	if (nWorkers <= 1) return false;
+	//split mapped contents in chunks: at least PARCHUNKSAHEAD per worker
+	chunkSize = (inMapEnd - inMapPos) / (nWorkers * PARCHUNKSAHEAD);
+	if (chunkSize > PARCHUNKMAX) chunkSize = PARCHUNKMAX;
+	if (chunkSize < PARCHUNKMIN) chunkSize = PARCHUNKMIN;
+	splitMappedEpochs(chunkSize, bounds);
+	if (bounds.size() < 3) return false;	//only one chunk
+	parReader = new ParallelReader;
+	parReader->chunks.resize(bounds.size() - 1);
+	for (size_t i = 0; i < parReader->chunks.size(); i++) {
+		parReader->chunks[i].begin = bounds[i];
+		parReader->chunks[i].end = bounds[i+1];
+		parReader->chunks[i].done = parReader->chunks[i].stopped = false;
+		parReader->chunks[i].resumePos = bounds[i+1];
+	}
+	parReader->systems = systems;
+	parReader->nextChunk = parReader->readChunk = parReader->readEpoch = 0;
+	if ((size_t) nWorkers > parReader->chunks.size()) nWorkers = (int) parReader->chunks.size();
+	parReader->maxAhead = nWorkers * PARCHUNKSAHEAD;
+	parReader->abort = false;
+	for (int i = 0; i < nWorkers; i++) parReader->workers.push_back(thread(&RinexData::parseChunks, this));
+	plog->fine("Parallel parsing of epochs. Chunks:" + to_string((long long) parReader->chunks.size())
+		+ " Workers:" + to_string((long long) nWorkers));
+	return true;
+}
+
 /**readObsEpoch reads from a RINEX observation file one epoch (data and observables) and store them into the RinexData object.
  * Observable storage in the RinexData object is cleared before storing new data.
  * Stored epoch time and time tags (the same for epoch and observables) are set from epoch time read.
+ * When the parallel parsing of epochs is active (see setParallelRead), data are taken from the epochs already parsed.
  *
  * @param input the already open print stream where RINEX epoch will be read
  * @return the status of the RINEX data read, which can can be:
@@ -1940,6 +2404,9 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
  *		- (9)	Unknown input file version
  */
 int RinexData::readObsEpoch(FILE* input) {
+	PERF_SCOPE("RinexData::readObsEpoch");
+	int status;
+	if ((parReader != NULL) && ((status = readParallelEpoch()) >= 0)) return status;
 	epochObs.clear();
 	switch(inFileVer) {
 	case V210:
@@ -1965,6 +2432,7 @@ int RinexData::readObsEpoch(FILE* input) {
  *		- (9)	Unknown input file version
  */
 int RinexData::readNavEpoch(FILE* input) {
+	PERF_SCOPE("RinexData::readNavEpoch");
 ///a macro to log the given error and return
 #define RETURN_WITH_ERROR(ERROR_STR, ERROR_CODE) \
 		{ \
@@ -2048,10 +2516,10 @@ int RinexData::readNavEpoch(FILE* input) {
 			retCode = 2;
 			msgPrfx += "New epoch.";
 		}
-		msgPrfx += "Stored.";
-		epochNav.push_back(SatNavData(attag, sysSat, prnSat, bo));
+		if (insertNavData(SatNavData(attag, sysSat, prnSat, bo))) msgPrfx += "Stored.";
+		else msgPrfx += "Duplicated.";
 	}
-	plog->fine(msgPrfx);
+	LOG_FINE(plog, msgPrfx);
 	return retCode;
 #undef RETURN_WITH_ERROR
 #undef GET_BO
@@ -2077,66 +2545,107 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
 	epochWeek = 0;
 	epochTOW = epochTimeTag = epochClkOffset = 0.0;
 	epochFlag = 0;
-	//fill vector with label definitions. Order is relevant.
-	labelDef.push_back(LABELdata(VERSION,	"RINEX VERSION / TYPE",	VALL, OBSOBL + NAVOBL));
-	labelDef.push_back(LABELdata(RUNBY,		"PGM / RUN BY / DATE",	VALL, OBSOBL + NAVOBL));
-	labelDef.push_back(LABELdata(COMM,		"COMMENT",				VALL, OBSOPT + NAVOPT));
-	labelDef.push_back(LABELdata(MRKNAME,	"MARKER NAME",			VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(MRKNUMBER,	"MARKER NUMBER",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(MRKTYPE,	"MARKER TYPE",			V302, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(AGENCY,	"OBSERVER / AGENCY",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(RECEIVER,	"REC # / TYPE / VERS",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(ANTTYPE,	"ANT # / TYPE",			VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(APPXYZ,	"APPROX POSITION XYZ",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(ANTHEN,	"ANTENNA: DELTA H/E/N",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(ANTXYZ,	"ANTENNA: DELTA X/Y/Z",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTPHC,	"ANTENNA: PHASECENTER",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTBS,		"ANTENNA: B.SIGHT XYZ",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTZDAZI,	"ANTENNA: ZERODIR AZI",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(ANTZDXYZ,	"ANTENNA: ZERODIR XYZ",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(COFM,		"CENTER OF MASS XYZ",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(WVLEN,		"WAVELENGTH FACT L1/2",	V210, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(TOBS,		"# / TYPES OF OBSERV",	V210, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(SYS,		"SYS / # / OBS TYPES",	V302, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(SIGU,		"SIGNAL STRENGTH UNIT",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(INT,		"INTERVAL",				VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(TOFO,		"TIME OF FIRST OBS",	VALL, OBSOBL + NAVNAP));
-	labelDef.push_back(LABELdata(TOLO,		"TIME OF LAST OBS",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(CLKOFFS,	"RCV CLOCK OFFS APPL",	VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(DCBS,		"SYS / DCBS APPLIED",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(PCVS,		"SYS / PCVS APPLIED",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(SCALE,		"SYS / SCALE FACTOR",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(PHSH,		"SYS / PHASE SHIFTS",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(GLSLT,		"GLONASS SLOT / FRQ #",	V302, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(LEAP,		"LEAP SECONDS",			VALL, OBSOPT + NAVOPT));
-	labelDef.push_back(LABELdata(SATS,		"# OF SATELLITES",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(PRNOBS,	"PRN / # OF OBS",		VALL, OBSOPT + NAVNAP));
-	labelDef.push_back(LABELdata(IONA,		"ION ALPHA",			V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(IONB,		"ION BETA",				V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(DUTC,		"DELTA-UTC: A0,A1,T,W",	V210, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(IONC,		"IONOSPHERIC CORR",		V302, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(TIMC,		"TIME SYSTEM CORR",		V302, OBSNAP + NAVOPT));
-	labelDef.push_back(LABELdata(EOH,		"END OF HEADER",		VALL, OBSOBL + NAVOBL));
-
-	labelDef.push_back(LABELdata(NOLABEL,	"No label detected",	VALL, NAP));
-	labelDef.push_back(LABELdata(DONTMATCH,	"Incorrect label for this RINEX version", VALL, NAP));
-	labelDef.push_back(LABELdata(LASTONE,	"Last item",	VALL, NAP));
+	//input records are read from the input stream
+	inMapBase = NULL;
+	inMapSize = inMapPos = inMapEnd = 0;
+	inMapOwned = false;
+	parReader = NULL;
+	//input and output files are RINEX, not Compact RINEX
+	crxIn = crxOut = NULL;
+	crxCheck = false;
+	//lookup tables are empty
+	for (int i=0; i<128; i++) sysInxTbl[i] = -1;
+	sysTblSize = 0;
+	v2TblValid = colTblValid = false;
+	copyInxSrc = NULL;
+	//copy label definitions from the shared defaults
+	labelDef = labelDefaults();
 	labelIdIdx = 0;
 	setLabelFlag(EOH);	//END OF HEADER record shall allways be printed
-	//fill observable type names equivalence vector
-	obsNamEq.push_back(EQUIVobs("L1", "L1C"));
-	obsNamEq.push_back(EQUIVobs("L2", "L2P"));
-	obsNamEq.push_back(EQUIVobs("C1", "C1C"));
-	obsNamEq.push_back(EQUIVobs("P1", "C1P"));
-	obsNamEq.push_back(EQUIVobs("P2", "C2P"));
-	obsNamEq.push_back(EQUIVobs("D1", "D1C"));
-	obsNamEq.push_back(EQUIVobs("D2", "D2P"));
-	obsNamEq.push_back(EQUIVobs("S1", "S1C"));
-	obsNamEq.push_back(EQUIVobs("S2", "S2P"));
 	//by default, do not filter data
 	applyObsFilter = applyNavFilter = false;
 }
 
+/**labelDefaults gives the default label definitions, used to initialize the labelDef of each object.
+ * They are built once, at the first call, and shared by all objects.
+ *
+ * @return the vector with the definitions of all RINEX header labels, without data
+ */
+const vector <RinexData::LABELdata>& RinexData::labelDefaults() {
+	static const vector<LABELdata> defaults = [] {
+		vector<LABELdata> labels;
+		//fill vector with label definitions. Order is relevant.
+		labels.push_back(LABELdata(VERSION,	"RINEX VERSION / TYPE",	VALL, OBSOBL + NAVOBL));
+		labels.push_back(LABELdata(RUNBY,		"PGM / RUN BY / DATE",	VALL, OBSOBL + NAVOBL));
+		labels.push_back(LABELdata(COMM,		"COMMENT",				VALL, OBSOPT + NAVOPT));
+		labels.push_back(LABELdata(MRKNAME,	"MARKER NAME",			VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(MRKNUMBER,	"MARKER NUMBER",		VALL, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(MRKTYPE,	"MARKER TYPE",			V302, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(AGENCY,	"OBSERVER / AGENCY",	VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(RECEIVER,	"REC # / TYPE / VERS",	VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(ANTTYPE,	"ANT # / TYPE",			VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(APPXYZ,	"APPROX POSITION XYZ",	VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(ANTHEN,	"ANTENNA: DELTA H/E/N",	VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(ANTXYZ,	"ANTENNA: DELTA X/Y/Z",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(ANTPHC,	"ANTENNA: PHASECENTER",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(ANTBS,		"ANTENNA: B.SIGHT XYZ",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(ANTZDAZI,	"ANTENNA: ZERODIR AZI",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(ANTZDXYZ,	"ANTENNA: ZERODIR XYZ",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(COFM,		"CENTER OF MASS XYZ",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(WVLEN,		"WAVELENGTH FACT L1/2",	V210, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(TOBS,		"# / TYPES OF OBSERV",	V210, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(SYS,		"SYS / # / OBS TYPES",	V302, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(SIGU,		"SIGNAL STRENGTH UNIT",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(INT,		"INTERVAL",				VALL, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(TOFO,		"TIME OF FIRST OBS",	VALL, OBSOBL + NAVNAP));
+		labels.push_back(LABELdata(TOLO,		"TIME OF LAST OBS",		VALL, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(CLKOFFS,	"RCV CLOCK OFFS APPL",	VALL, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(DCBS,		"SYS / DCBS APPLIED",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(PCVS,		"SYS / PCVS APPLIED",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(SCALE,		"SYS / SCALE FACTOR",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(PHSH,		"SYS / PHASE SHIFTS",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(GLSLT,		"GLONASS SLOT / FRQ #",	V302, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(LEAP,		"LEAP SECONDS",			VALL, OBSOPT + NAVOPT));
+		labels.push_back(LABELdata(SATS,		"# OF SATELLITES",		VALL, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(PRNOBS,	"PRN / # OF OBS",		VALL, OBSOPT + NAVNAP));
+		labels.push_back(LABELdata(IONA,		"ION ALPHA",			V210, OBSNAP + NAVOPT));
+		labels.push_back(LABELdata(IONB,		"ION BETA",				V210, OBSNAP + NAVOPT));
+		labels.push_back(LABELdata(DUTC,		"DELTA-UTC: A0,A1,T,W",	V210, OBSNAP + NAVOPT));
+		labels.push_back(LABELdata(IONC,		"IONOSPHERIC CORR",		V302, OBSNAP + NAVOPT));
+		labels.push_back(LABELdata(TIMC,		"TIME SYSTEM CORR",		V302, OBSNAP + NAVOPT));
+		labels.push_back(LABELdata(EOH,		"END OF HEADER",		VALL, OBSOBL + NAVOBL));
+
+		labels.push_back(LABELdata(NOLABEL,	"No label detected",	VALL, NAP));
+		labels.push_back(LABELdata(DONTMATCH,	"Incorrect label for this RINEX version", VALL, NAP));
+		labels.push_back(LABELdata(LASTONE,	"Last item",	VALL, NAP));
+		return labels;
+	}();
+	return defaults;
+}
+
+/**obsNamEq gives the equivalence table between observable type names in RINEX V2 and V3.
+ * It is built once, at the first call, and shared by all objects.
+ *
+ * @return the vector with the equivalent names
+ */
+const vector <RinexData::EQUIVobs>& RinexData::obsNamEq() {
+	static const vector<EQUIVobs> equivalences = [] {
+		vector<EQUIVobs> table;
+		//fill observable type names equivalence vector
+		table.push_back(EQUIVobs("L1", "L1C"));
+		table.push_back(EQUIVobs("L2", "L2P"));
+		table.push_back(EQUIVobs("C1", "C1C"));
+		table.push_back(EQUIVobs("P1", "C1P"));
+		table.push_back(EQUIVobs("P2", "C2P"));
+		table.push_back(EQUIVobs("D1", "D1C"));
+		table.push_back(EQUIVobs("D2", "D2P"));
+		table.push_back(EQUIVobs("S1", "S1C"));
+		table.push_back(EQUIVobs("S2", "S2P"));
+		return table;
+	}();
+	return equivalences;
+}
+
 /**fmtRINEXv2name format a standard RINEX V2.10 file name from the given prefix, GPS week and TOW, and for the given type.
  *
  * @param designator the file name prefix with a 4-character station name designator
@@ -2147,16 +2656,9 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
  */
 string RinexData::fmtRINEXv2name(string designator, int week, double tow, char ftype) {
 	char buffer[30];
-	//set GPS ephemeris 6/1/1980 adding given week and tow increment
+	//compute calendar data for the GPS ephemeris 6/1/1980 adding given week and tow increment
 	struct tm gpsEphe = { 0 };
-	gpsEphe.tm_year = 80;
-	gpsEphe.tm_mon = 0;
-	gpsEphe.tm_mday = 6 + week * 7;
-	gpsEphe.tm_hour = 0;
-	gpsEphe.tm_min = 0;
-	gpsEphe.tm_sec = 0 + (int) tow;
-	//recompute time
-	mktime(&gpsEphe);
+	gpsTimeToTm(week, (int) tow, gpsEphe);
 	//format file name
 	sprintf(buffer, "%4.4s%03d%1c%02d.%02d%c",
 		(designator + "----").c_str(),
@@ -2190,16 +2692,9 @@ string RinexData::fmtRINEXv3name(string designator, int week, double tow, char f
 	int rcvNum = 0;
 	if (getLabelFlag(RECEIVER)) rcvNum = atoi(rxNumber.c_str());
 	//set value for field <START TIME>
-	//set GPS ephemeris 6/1/1980 adding given week and tow increment
+	//compute calendar data for the GPS ephemeris 6/1/1980 adding given week and tow increment
 	struct tm gpsEphe = { 0 };
-	gpsEphe.tm_year = 80;
-	gpsEphe.tm_mon = 0;
-	gpsEphe.tm_mday = 6 + week * 7;
-	gpsEphe.tm_hour = 0;
-	gpsEphe.tm_min = 0;
-	gpsEphe.tm_sec = (int) tow;
-	//recompute time
-	mktime(&gpsEphe);
+	gpsTimeToTm(week, (int) tow, gpsEphe);
 	//set value for field <FILE PERIOD> (period value and unit from TOFO, TOLO)
 	int period = 0;
 	char periodUnit = 'U';
@@ -2364,10 +2859,9 @@ string RinexData::errorLabel(RINEXlabel labelId) {
  * @throws error string with the related message
  */
 size_t RinexData::getSysIndex(char sysId) {
-	size_t index, slen;
-	for (index = 0, slen = systems.size(); (index < slen) && (sysId != systems[index].system); index++);
-	if (index >= slen) throw string("Unknown system ") + string(1, sysId);
-	return index;
+	int index = sysInx(sysId);
+	if (index < 0) throw string("Unknown system ") + string(1, sysId);
+	return (size_t) index;
 }
 
 /**readV2ObsEpoch reads from the RINEX version 2.1 observation file data lines of an epoch.
@@ -2388,7 +2882,16 @@ size_t RinexData::getSysIndex(char sysId) {
  *		- (8)	Error in event flag number
  */
 int RinexData::readV2ObsEpoch(FILE* input) {
+///a macro to get the pointer and width of the field at POS having WIDTH chars in the current record, clipped to the record length
+#define FIELD(POS, WIDTH) rec + (POS), ((POS) + (WIDTH) <= recLen? (WIDTH) : recLen - (POS))
+///a macro to get the char at POS in the current record, or a blank if beyond the record length
+#define CHAR_AT(POS) ((POS) < recLen? rec[POS] : ' ')
+///a macro to build the message text for the epoch: the epoch 1st line and the errors found
+#define EPOCH_MSG (string("Epoch [") + epochLine + "]" + msgErr)
 	char lineBuffer[100];
+	char epochLine[33];
+	const char* rec;
+	int recLen;
 	int posPRN, nObs, posObs;
 	unsigned int sysInEpoch[64];
 	int prnInEpoch[64];
@@ -2397,22 +2900,27 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 	int i, j, k;
 
 	//read epoch 1st line and extract data
-	if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
-	string msgPrfx =  "Epoch [" + string(lineBuffer, 32) + "]";
+	if (getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input)) return 0;
+	//the epoch 1st line text for messages is saved, being the message built only when logged
+	memset(epochLine, ' ', 32);
+	memcpy(epochLine, rec, recLen < 32? recLen : 32);
+	epochLine[32] = 0;
+	string msgErr;
 	bool badEpoch = false;
-	if ((epochFlag = (int) (lineBuffer[28] - '0')) < 0) {
+	if ((epochFlag = (int) (CHAR_AT(28) - '0')) < 0) {
 		badEpoch = true;
-		msgPrfx  += " Missed flag.";
+		msgErr  += " Missed flag.";
 		epochFlag = 999;	//a nonexisting flag
 	}
-	if (isBlank(lineBuffer + 29, 3)) {
+	if (!getFixedInt(FIELD(29, 3), nSatsEpoch)) {
 		badEpoch = true;
-		msgPrfx += " Missed number of sats or special records.";
+		msgErr += " Missed number of sats or special records.";
 		nSatsEpoch = 0;
-	} else nSatsEpoch = stoi(string(lineBuffer+29, 3));
+	}
 	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
 	double second = 0.0;
-	bool wrongDate = sscanf(lineBuffer, " %2d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) != 6 ;
+	bool wrongDate = !(getFixedInt(FIELD(1, 2), year) && getFixedInt(FIELD(4, 2), month) && getFixedInt(FIELD(7, 2), day)
+					&& getFixedInt(FIELD(10, 2), hour) && getFixedInt(FIELD(13, 2), minute) && getFixedDouble(FIELD(15, 11), second));
 	if (year >= 80) year += 1900;
 	else year += 2000;
 	if (!wrongDate) {	//translate date read to week + tow
@@ -2425,44 +2933,44 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 	case 6:
 		if (wrongDate) {
 			badEpoch = true;
-			msgPrfx += " Wrong date.";
+			msgErr += " Wrong date.";
 		}
 		if (nSatsEpoch > 64) {
 			badEpoch = true;
-			msgPrfx += " Wrong number of sats (>64).";
+			msgErr += " Wrong number of sats (>64).";
 		}
-		if (isBlank(lineBuffer + 68, 12)) epochClkOffset = 0.0;
-		else epochClkOffset = stod(string(lineBuffer + 68, 12));
+		if (!getFixedDouble(FIELD(68, 12), epochClkOffset)) epochClkOffset = 0.0;
 		//get satellites from epoch 1st line and eventual continuation lines (max 12 sat id in each one)
-		for (i=0; i<nSatsEpoch; i+=12) {
-			for(j=0, posPRN = 32; j<12 && i+j<nSatsEpoch; j++, posPRN += 3) {
+		for (i=0; i<nSatsEpoch && i<64; i+=12) {
+			for(j=0, posPRN = 32; j<12 && i+j<nSatsEpoch && i+j<64; j++, posPRN += 3) {
 				try {
-					sysInEpoch[i+j] = getSysIndex(lineBuffer[posPRN]);
+					sysInEpoch[i+j] = getSysIndex(CHAR_AT(posPRN));
 				}  catch (string error) {
 					badEpoch = true;
-					msgPrfx += error;
+					msgErr += error;
 				}
-				if (sscanf(lineBuffer+posPRN+1, "%2d", &prnInEpoch[i+j]) !=1 ) {
+				if (!getFixedInt(FIELD(posPRN+1, 2), prnInEpoch[i+j])) {
 					badEpoch = true;
-					msgPrfx += " Wrong PRN.";
+					msgErr += " Wrong PRN.";
 				}
 			}
 			if (i+j < nSatsEpoch) {	//read continuation line
-				if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-					msgPrfx += " EOF in epoch cont. line.";
+				if (getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input)) {
+					msgErr += " EOF in epoch cont. line.";
+					recLen = 0;
 				}
 			}
 		}
 		if (badEpoch) {
 			//if any error in epoch line record, try to skip observation data lines
-			for (i=0; i<nSatsEpoch; i++) readRinexRecord(lineBuffer, sizeof lineBuffer, input);
-			plog->warning(msgPrfx);
+			for (i=0; i<nSatsEpoch; i++) getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input);
+			plog->warning(EPOCH_MSG);
 			return 4;
 		}
 		//read the observation records for each satellite in the epoch
 		for (i=0; i<nSatsEpoch; i++) {
-			if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-				plog->warning(msgPrfx + "Unexpected EOF in obs. record");
+			if (getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input)) {
+				plog->warning(EPOCH_MSG + "Unexpected EOF in obs. record");
 				return 3;
 			}
 			nObs = systems[sysInEpoch[i]].obsType.size();
@@ -2470,37 +2978,39 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 			//each record can have data for 5 observable types (or less). Continuation records are used when needed 
 			for (j=0; j<nObs; j+=5) {
 				for (k=0, posObs = 0; k<5 && j+k<nObs; k++, posObs += 16) {
-					if (isBlank(lineBuffer + posObs, 14)) {	//empty observable
-						epochObs.push_back(SatObsData(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, 0.0, 0, 0));
+					if (!getFixedDouble(FIELD(posObs, 14), valObs)) {	//empty observable
+						epochObs.put(sysInEpoch[i], prnInEpoch[i], j+k, 0.0, 0, 0);
 					} else {
-						valObs = stod(string(lineBuffer+posObs, 14));
-						if (lineBuffer[posObs+14] == ' ') lliObs = 0;
-						else lliObs = (int) (lineBuffer[posObs+14] - '0');
-						if (lineBuffer[posObs+15] == ' ') strgObs = 0;
-						else strgObs = (int) (lineBuffer[posObs+15] - '0');
-						epochObs.push_back(SatObsData(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, valObs, lliObs, strgObs ));
+						if (CHAR_AT(posObs+14) == ' ') lliObs = 0;
+						else lliObs = (int) (CHAR_AT(posObs+14) - '0');
+						if (CHAR_AT(posObs+15) == ' ') strgObs = 0;
+						else strgObs = (int) (CHAR_AT(posObs+15) - '0');
+						epochObs.put(sysInEpoch[i], prnInEpoch[i], j+k, valObs, lliObs, strgObs );
 					}
 				}
 				if (j+k < nObs) {
-					if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-						plog->warning(msgPrfx + "EOF in obs. cont. record");
+					if (getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input)) {
+						plog->warning(EPOCH_MSG + "EOF in obs. cont. record");
 						return 3;
 					}
 				}
 			}
 		}
-		plog->fine(msgPrfx);
+		LOG_FINE(plog, EPOCH_MSG);
 		return 1;
 	case 2:
 	case 3:
 	case 4:
 	case 5:
-		plog->fine(msgPrfx);
+		LOG_FINE(plog, EPOCH_MSG);
 		return readObsEpochEvent(input, wrongDate);
 	default:
-		plog->warning(msgPrfx + " Wrong flag.");
+		plog->warning(EPOCH_MSG + " Wrong flag.");
 		return 8;
 	}
+#undef FIELD
+#undef CHAR_AT
+#undef EPOCH_MSG
 }
 
 /**readV3ObsEpoch reads from the RINEX version 3.0 observation file an epoch data
@@ -2519,35 +3029,48 @@ int RinexData::readV2ObsEpoch(FILE* input) {
  * @throws error string with message describing any error detected in data format
  */
 int RinexData::readV3ObsEpoch(FILE* input) {
+///a macro to get the pointer and width of the field at POS having WIDTH chars in the current record, clipped to the record length
+#define FIELD(POS, WIDTH) rec + (POS), ((POS) + (WIDTH) <= recLen? (WIDTH) : recLen - (POS))
+///a macro to get the char at POS in the current record, or a blank if beyond the record length
+#define CHAR_AT(POS) ((POS) < recLen? rec[POS] : ' ')
+///a macro to build the message text for the epoch: the epoch 1st line and the errors found
+#define EPOCH_MSG (string("Epoch [") + epochLine + "]" + msgErr)
 	char lineBuffer[1300]; //enough big to allocate 3 + 2 + 19 x 4 measurements x 16 chars= 1221
+	const char* rec;
+	int recLen;
 	int nObs, posObs;
 	int sysSat;
 	int prnSat;
 	double valObs;
 	int lliObs, strgObs;
 	int i, j;
-	string msgPrfx, aStr;
+	char epochLine[36];
+	string msgErr;
 	//read epoch 1st line and extract data
 	for (;;) {	//synchronize start of epoch
-		if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
-		msgPrfx =  "Epoch [" + string(lineBuffer, 35) + "]";
-		if (lineBuffer[0] == '>') break;
-		plog->warning(msgPrfx + " Start of epoch not found. Line skip");
+		if (getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input)) return 0;
+		//the epoch 1st line text for messages is saved, being the message built only when logged
+		memset(epochLine, ' ', 35);
+		memcpy(epochLine, rec, recLen < 35? recLen : 35);
+		epochLine[35] = 0;
+		if (rec[0] == '>') break;
+		plog->warning(EPOCH_MSG + " Start of epoch not found. Line skip");
 	}
 	bool badEpoch = false;
-	if ((epochFlag = (int) (lineBuffer[31] - '0')) < 0) {
+	if ((epochFlag = (int) (CHAR_AT(31) - '0')) < 0) {
 		badEpoch = true;
-		msgPrfx  += " Missed flag.";
+		msgErr  += " Missed flag.";
 		epochFlag = 999;	//a nonexisting flag
 	}
-	if (isBlank(lineBuffer + 32, 3)) {
+	if (!getFixedInt(FIELD(32, 3), nSatsEpoch)) {
 		badEpoch = true;
-		msgPrfx += " Missed number of sats or special records.";
+		msgErr += " Missed number of sats or special records.";
 		nSatsEpoch = 0;
-	} else nSatsEpoch = stoi(string(lineBuffer + 32, 3));
+	}
 	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
 	double second = 0.0;
-	bool wrongDate = sscanf(lineBuffer+2, "%4d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) != 6 ;
+	bool wrongDate = !(getFixedInt(FIELD(2, 4), year) && getFixedInt(FIELD(7, 2), month) && getFixedInt(FIELD(10, 2), day)
+					&& getFixedInt(FIELD(13, 2), hour) && getFixedInt(FIELD(16, 2), minute) && getFixedDouble(FIELD(18, 11), second));
 	if (!wrongDate) {	//translate date read to week + tow
 		setWeekTow (year, month, day, hour, minute, second, epochWeek, epochTOW);
 		epochTimeTag = getSecsGPSEphe(epochWeek, epochTOW);
@@ -2558,63 +3081,64 @@ int RinexData::readV3ObsEpoch(FILE* input) {
 	case 6:
 		if (wrongDate) {
 			badEpoch = true;
-			msgPrfx += " Wrong date.";
+			msgErr += " Wrong date.";
 		}
 		if (badEpoch) {
-			plog->warning(msgPrfx);
+			plog->warning(EPOCH_MSG);
 			return 4;
 		}
-		if (isBlank(lineBuffer + 41, 15)) epochClkOffset = 0.0;
-		else epochClkOffset = stod(string(lineBuffer + 41, 15));
+		if (!getFixedDouble(FIELD(41, 15), epochClkOffset)) epochClkOffset = 0.0;
 		//get the observation record for each satellite and extract data
 		for (i = 0; i < nSatsEpoch; i++) {
-			if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-				plog->warning(msgPrfx + "EOF in obs. record");
+			if (getObsRecord(rec, recLen, lineBuffer, sizeof lineBuffer, input)) {
+				plog->warning(EPOCH_MSG + "EOF in obs. record");
 				return 3;
 			}
 			try {
-				sysSat = getSysIndex(lineBuffer[0]);
-				if (sscanf(lineBuffer+1, "%2d", &prnSat) == 1) {
+				sysSat = getSysIndex(rec[0]);
+				if (getFixedInt(FIELD(1, 2), prnSat)) {
 					//for each observable type in the system of this satellite
 					nObs = systems[sysSat].obsType.size();
 					for (j = 0, posObs = 3; j < nObs; j++, posObs += 16) {
-						if (isBlank(lineBuffer + posObs, 14)) {
+						if (!getFixedDouble(FIELD(posObs, 14), valObs)) {
 							//empty observable: values are considered 0
-							epochObs.push_back(SatObsData(epochTimeTag, sysSat, prnSat, j, 0.0, 0, 0));
+							epochObs.put(sysSat, prnSat, j, 0.0, 0, 0);
 						} else {
-							valObs = stod(string(lineBuffer+posObs, 14));
-							if (lineBuffer[posObs+14] == ' ') lliObs = 0;
-							else lliObs = stoi(string(lineBuffer+posObs+14, 1));
-							if (lineBuffer[posObs+15] == ' ') strgObs = 0;
-							else strgObs = stoi(string(lineBuffer+posObs+15, 1));
-							epochObs.push_back(SatObsData(epochTimeTag, sysSat, prnSat, j,  valObs, lliObs, strgObs));
+							if (CHAR_AT(posObs+14) == ' ') lliObs = 0;
+							else lliObs = (int) (CHAR_AT(posObs+14) - '0');
+							if (CHAR_AT(posObs+15) == ' ') strgObs = 0;
+							else strgObs = (int) (CHAR_AT(posObs+15) - '0');
+							epochObs.put(sysSat, prnSat, j,  valObs, lliObs, strgObs);
 						}
 					}
 				} else {
 					badEpoch = true;
-					msgPrfx += " Wrong PRN";
+					msgErr += " Wrong PRN";
 				}
 			}  catch (string error) {
 				badEpoch = true;
-				msgPrfx += error;
+				msgErr += error;
 			}
 		}
 		if (badEpoch) {
-			plog->warning(msgPrfx);
+			plog->warning(EPOCH_MSG);
 			return 3;
 		}
-		plog->fine(msgPrfx);
+		LOG_FINE(plog, EPOCH_MSG);
 		return 1;
 	case 2:
 	case 3:
 	case 4:
 	case 5:
-		plog->fine(msgPrfx);
+		LOG_FINE(plog, EPOCH_MSG);
 		return readObsEpochEvent(input, wrongDate);
 	default:
-		plog->warning(msgPrfx + " Wrong flag.");
+		plog->warning(EPOCH_MSG + " Wrong flag.");
 		return 8;
 	}
+#undef FIELD
+#undef CHAR_AT
+#undef EPOCH_MSG
 }
 
 /**readObsEpochEvent reads from the RINEX observation file event records
@@ -2940,52 +3464,85 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 	#undef PRINT_SYSREC
 }
 
-/**printSatObsValues prints a line with observable values of the firts satellite in "epochObs".
+/**printSatObsValues renders in the output buffer a line with observable values of the satellite at the given row in "epochObs".
  * If the number of observables to print is greather than the maximum number of observable values to be printed
  * in one line, one or several continuation lines would be necessary.
- * After printing observation data of this first satellite, they are removed from the storage.
- * It is assumed that values in the observables storage  belong to the same epoch and are be sorted by system,
- * satellite PRN and observable type.
+ * After printing observation data of this satellite, the row is advanced to the one of the next satellite.
+ * Data printed are not removed from the storage: the caller shall clear it after printing all of them.
  *
- * @param out the already open print stream where RINEX epoch data will be printed
  * @param maxPerLine the maximum number of observable values to be printed in one line
- * @return true if they remain observables belonging to the current epoch, false when no data remains to print.
+ * @param row the row in epochObs of the satellite to print. It is advanced to the next satellite after printing
+ * @return true if they remain satellites belonging to the current epoch, false when no data remains to print.
  */
-bool RinexData::printSatObsValues(FILE* out, int maxPerLine) {
+bool RinexData::printSatObsValues(int maxPerLine, int &row) {
 	double valueToPrint;
-	if (epochObs.empty()) return false;
-	//satellite data to print are those of the firts satellite in epochObs
-	int sysToPrint = epochObs[0].sysIndex;
-	int satToPrint = epochObs[0].satellite;
-	int obsToPrint = 0;
-	while (!epochObs.empty() && (epochObs[0].sysIndex == sysToPrint) && (epochObs[0].satellite == satToPrint)) {
-		if (epochObs[0].obsTypeIndex < obsToPrint) {
-			plog->warning("Epoch " + to_string((long double) epochObs[0].obsTimeTag)
-						+ " sat=" + string(1,systems[sysToPrint].system) + to_string((long long) satToPrint)
-						+ " obs=" + string(systems[sysToPrint].obsType[epochObs[0].obsTypeIndex])
-						+ " Ignored observable already printed");
-			epochObs.erase(epochObs.begin());
-		} else if (epochObs[0].obsTypeIndex == obsToPrint) {
+	if (row < 0) return false;
+	int lastToPrint = epochObs.lastObs(row);
+	for (int obsToPrint = 0; obsToPrint <= lastToPrint; obsToPrint++) {
+		if (epochObs.hasObs(row, obsToPrint)) {
 			//there are data for this type of observable
-			valueToPrint = epochObs[0].obsValue;
+			valueToPrint = epochObs.getValue(row, obsToPrint);
 			//discard measurements out of range used in the RINEX format 14.3f
 			if ((valueToPrint > MAXOBSVAL) || (valueToPrint < MINOBSVAL)) valueToPrint = 0.0;
-			fprintf(out, "%14.3lf", valueToPrint);
-			if (epochObs[0].lossOfLock == 0) fprintf(out, " ");
-			else fprintf(out, "%1d", epochObs[0].lossOfLock);
-			if (epochObs[0].strength == 0) fprintf(out, " ");
-			else fprintf(out, "%1d", epochObs[0].strength);
-			epochObs.erase(epochObs.begin());	//remove printed data
-			obsToPrint++;
+			outBuf.putFixed(valueToPrint, 14, 3);
+			if (epochObs.getLol(row, obsToPrint) == 0) outBuf.putChar(' ');
+			else outBuf.putInt(epochObs.getLol(row, obsToPrint), 1);
+			if (epochObs.getStrength(row, obsToPrint) == 0) outBuf.putChar(' ');
+			else outBuf.putInt(epochObs.getStrength(row, obsToPrint), 1);
 		} else {
 			//there are no data for this type of observable
-			fprintf(out, "%14.3lf  ", (double) 0.0);
-			obsToPrint++;
+			outBuf.putFixed(0.0, 14, 3);
+			outBuf.putChars(' ', 2);
 		}
-		if ((obsToPrint % maxPerLine) == 0) fprintf(out, "\n");
+		if (((obsToPrint + 1) % maxPerLine) == 0) outBuf.putChar('\n');
 	}
-	if ((obsToPrint % maxPerLine) != 0) fprintf(out, "\n");
-	return !epochObs.empty();
+	if (((lastToPrint + 1) % maxPerLine) != 0) outBuf.putChar('\n');
+	row = epochObs.nextSat(row);
+	return row >= 0;
+}
+
+/**printCompactEpoch prints in Compact RINEX format the current epoch observation data, already filtered and, for V2.10,
+ * having observable type indexes as per v2ObsLst. In V3.02, when observables have been filtered, their indexes are changed
+ * to the ones of the selected observable types printed in the header. Epoch data are removed after printing them.
+ *
+ * @param out the already open print stream where epoch data will be printed
+ * @param timeBuffer the epoch time formatted as per the version being printed
+ */
+void RinexData::printCompactEpoch(FILE* out, const char* timeBuffer) {
+	char epochPfx[80];
+	vector<char> sysIds;
+	vector<int> nTypes;
+	vector< vector<int> > selInx;	//for each system and observable type index, its index among the selected ones, or -1
+	int row, sx, ox, n;
+	for (sx = 0; sx < (int) systems.size(); sx++) {
+		sysIds.push_back(systems[sx].system);
+		if (version == V210) nTypes.push_back((int) v2ObsLst.size());
+		else if (!applyObsFilter) nTypes.push_back((int) systems[sx].obsType.size());
+		else {
+			selInx.push_back(vector<int>(systems[sx].obsType.size(), -1));
+			n = 0;
+			if (systems[sx].selSystem)
+				for (ox = 0; ox < (int) systems[sx].obsType.size(); ox++)
+					if (systems[sx].selObsType[ox]) selInx[sx][ox] = n++;
+			nTypes.push_back(n);
+		}
+	}
+	if (!selInx.empty()) {
+		v2Obs.clear();
+		for (row = epochObs.firstSat(); row >= 0; row = epochObs.nextSat(row)) {
+			sx = epochObs.getSys(row);
+			for (ox = 0; ox <= epochObs.lastObs(row); ox++)
+				if (epochObs.hasObs(row, ox) && (selInx[sx][ox] >= 0))
+					v2Obs.put(sx, epochObs.getSat(row), selInx[sx][ox], epochObs.getValue(row, ox), epochObs.getLol(row, ox), epochObs.getStrength(row, ox));
+		}
+		epochObs.clear();
+		epochObs.swap(v2Obs);
+	}
+	sprintf(epochPfx, "%s  %1d%3d%s", timeBuffer, epochFlag, nSatsEpoch, version == V302? "      " : "");
+	outBuf.clear();
+	crxOut->encodeEpoch(epochPfx, epochObs, sysIds, nTypes, epochClkOffset, outBuf);
+	outBuf.write(out);
+	epochObs.clear();
 }
 
 /**readHdLineData reads a line from input RINEX file identifying the header line type, extracting data contained and storing them into the class members.
@@ -3378,6 +3935,8 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 /**readRinexRecord reads a line from the RINEX input containing a header line or observation record
  * It removes the EOL, appends blanks and adds the string null delimiter.
  * Empty lines are skipped.
+ * When the first record read is the Compact RINEX one, the input file is decoded from then on, and the records provided are
+ * the RINEX ones decoded. Format errors found when decoding are logged.
  *
  * @param rinexRec a pointer to a record buffer
  * @param recSize the size in bytes of the record buffer
@@ -3385,15 +3944,375 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
  * @return true if EOF happens when reading, false otherwise
  */
 bool RinexData::readRinexRecord(char* rinexRec, int recSize, FILE* input) {
+	PERF_SCOPE("RinexData::readRinexRecord");
 	int obsLen;
+	const char* rec;
+	if (inMapBase != NULL) {	//the input file is mapped in memory: copy next record
+		if (getMappedRecord(rec, obsLen)) return true;
+		if (obsLen > recSize) obsLen = recSize;
+		memcpy(rinexRec, rec, obsLen);
+		memset(rinexRec + obsLen, ' ', recSize - obsLen);
+		return false;
+	}
+	if (crxIn != NULL) {	//the input file is Compact RINEX: copy next record decoded
+		string errMsg;
+		do {
+			if (crxIn->getRecord(input, rec, obsLen)) return true;
+			if (crxIn->getError(errMsg)) plog->warning(errMsg);
+		} while (isBlank(rec, obsLen));
+		if (obsLen > recSize - 2) obsLen = recSize - 2;
+		memcpy(rinexRec, rec, obsLen);
+		memset(rinexRec + obsLen, ' ', recSize - obsLen);
+		return false;
+	}
 	do {
 		if (fgets(rinexRec, recSize, input) == NULL) return true;
 		obsLen = strlen(rinexRec) - 1;
 		memset(rinexRec + obsLen, ' ', recSize - obsLen);
 	} while (isBlank(rinexRec, recSize-1));
+	if (crxCheck) {
+		crxCheck = false;
+		if (CompactRinex::isCompactHeader(rinexRec, obsLen)) {
+			plog->fine("Input file in Compact RINEX format");
+			crxIn = new CompactRinex();
+			crxIn->decodeLine(rinexRec, obsLen);
+			return readRinexRecord(rinexRec, recSize, input);
+		}
+	}
+	return false;
+}
+
+/**insertNavData inserts the given navigation data in the storage, keeping it ordered by time tag, system and satellite.
+ * As navigation data usually arrive nearly ordered, they are appended when they follow the last one stored. Otherwise
+ * their position is found using a binary search.
+ *
+ * @param navData the satellite navigation data to insert
+ * @return true if data have been inserted, false if data for the same time tag, system and satellite already exist
+ */
+bool RinexData::insertNavData(const SatNavData &navData) {
+	PERF_SCOPE("RinexData::insertNavData");
+	if (epochNav.empty() || epochNav.back().precedes(navData)) {
+		epochNav.push_back(navData);
+		return true;
+	}
+	vector<SatNavData>::iterator it = lower_bound(epochNav.begin(), epochNav.end(), navData,
+		[](const SatNavData &a, const SatNavData &b) {return a.precedes(b);});
+	if ((it != epochNav.end()) && !navData.precedes(*it)) return false;
+	epochNav.insert(it, navData);
+	return true;
+}
+
+/**getMappedRecord gets the next line in the input file mapped in memory containing a header line or observation record.
+ * The record is not copied: a pointer to its first char in the mapped contents and its length, excluding EOL chars, are provided.
+ * Empty lines are skipped.
+ *
+ * @param rec the pointer to the first char of the record in the mapped contents
+ * @param recLen the number of chars in the record, excluding EOL
+ * @return true if end of the mapped contents happens when reading, false otherwise
+ */
+bool RinexData::getMappedRecord(const char* &rec, int &recLen) {
+	const char* end = inMapBase + inMapEnd;
+	const char* eol;
+	do {
+		if (inMapPos >= inMapEnd) return true;
+		rec = inMapBase + inMapPos;
+		if ((eol = (const char*) memchr(rec, '\n', end - rec)) == NULL) eol = end;
+		inMapPos = eol - inMapBase + 1;
+		recLen = (int) (eol - rec);
+		if (recLen > 0 && rec[recLen-1] == '\r') recLen--;
+	} while (isBlank(rec, recLen));
+	return false;
+}
+
+/**getObsRecord gets the next observation record from the input file mapped in memory or, if it is not mapped, from the given input stream.
+ * When the file is mapped, the record is not copied to the given buffer (see getMappedRecord). Otherwise, the record read into
+ * the buffer is padded with blanks up to its size (see readRinexRecord).
+ * Chars located beyond the record length shall be considered blanks.
+ *
+ * @param rec the pointer to the first char of the record
+ * @param recLen the number of chars in the record
+ * @param buffer a record buffer to be used when data are read from the input stream
+ * @param bufSize the size in bytes of the record buffer
+ * @param input the already open input stream where the RINEX record will be read when the file is not mapped
+ * @return true if EOF happens when reading, false otherwise
+ */
+bool RinexData::getObsRecord(const char* &rec, int &recLen, char* buffer, int bufSize, FILE* input) {
+	if (inMapBase != NULL) return getMappedRecord(rec, recLen);
+	if (readRinexRecord(buffer, bufSize, input)) return true;
+	rec = buffer;
+	recLen = bufSize;
 	return false;
 }
 
+/**isMappedEpochStart checks if the record starting at the given position of the mapped contents is the first record of an epoch.
+ * In RINEX V3.02 epoch records start with '>'. In RINEX V2.10 the column layout of the epoch record is checked: date and time fields
+ * separated by blanks, the decimal point of seconds, and the epoch flag. Observation records cannot satisfy it, because their
+ * decimal points are placed in other columns, and continuation records of satellites in the epoch start with 32 blanks.
+ *
+ * @param pos the offset in the mapped contents of the first char of a record
+ * @return true if the record is the first one of an epoch, false otherwise
+ */
+bool RinexData::isMappedEpochStart(size_t pos) {
+	const unsigned char* rec = (const unsigned char*) inMapBase + pos;
+	const void* eol;
+	size_t recLen = inMapEnd - pos;
+	if (inFileVer == V302) return (recLen > 0) && (rec[0] == '>');
+	if (recLen > 32) recLen = 32;
+	if ((eol = memchr(rec, '\n', recLen)) != NULL) recLen = (const unsigned char*) eol - rec;
+	if (recLen < 32) return false;
+	for (int i = 3; i <= 12; i += 3) if (rec[i] != ' ') return false;
+	return (rec[0] == ' ') && isdigit(rec[2]) && isdigit(rec[5]) && isdigit(rec[8]) && (rec[18] == '.')
+		&& (rec[26] == ' ') && (rec[27] == ' ') && (rec[28] >= '0') && (rec[28] <= '6') && isdigit(rec[31]);
+}
+
+/**splitMappedEpochs computes the boundaries of chunks of the mapped contents, from the current position to the end, having the given
+ * approximate size. Each boundary is placed at the first epoch record found after the chunk size is reached.
+ *
+ * @param chunkSize the approximate size in bytes of each chunk
+ * @param bounds the offsets in the mapped contents of the start of each chunk, followed by the offset of the end of contents
+ */
+void RinexData::splitMappedEpochs(size_t chunkSize, vector<size_t> &bounds) {
+	const char* eol;
+	size_t pos = inMapPos;
+	bounds.clear();
+	bounds.push_back(pos);
+	while ((pos += chunkSize) < inMapEnd) {
+		//search the start of the next epoch from the next record
+		do {
+			if ((eol = (const char*) memchr(inMapBase + pos, '\n', inMapEnd - pos)) == NULL) pos = inMapEnd;
+			else pos = eol - inMapBase + 1;
+		} while ((pos < inMapEnd) && !isMappedEpochStart(pos));
+		if (pos >= inMapEnd) break;
+		bounds.push_back(pos);
+	}
+	bounds.push_back(inMapEnd);
+}
+
+//@cond DUMMY
+///The size in bytes of the mapped contents below which seeking an epoch scans them sequentially
+#define SEEKSCANMAX 16384
+//@endcond
+
+/**seekObsEpoch positions the input file mapped in memory at the first observation epoch having a time tag equal or after the given one,
+ * so that the next readObsEpoch will read it.
+ * The epoch is searched using a binary search over the mapped contents, and only the first record of the epochs found is parsed,
+ * being the cost of seeking proportional to the logarithm of the file size. It assumes epochs in the file are in time order.
+ * Header records included in special event epochs skipped are not taken into account.
+ * Seeking is not possible when the file is not mapped, its version is unknown, or the parallel parsing of epochs is active: it shall be
+ * used after mapInputFile and before setParallelRead.
+ *
+ * @param tTag the time tag (seconds from the GPS ephemeris) of the epoch to seek
+ * @return true if the input position has been set, false otherwise (epochs will be read from the current position)
+ */
+bool RinexData::seekObsEpoch(double tTag) {
+	if ((inMapBase == NULL) || (parReader != NULL) || ((inFileVer != V210) && (inFileVer != V302))) return false;
+	size_t pos = findMappedEpoch(tTag, false);
+	plog->fine("Epoch seek skipped bytes:" + to_string((long long) (pos - inMapPos)));
+	inMapPos = pos;
+	return true;
+}
+
+/**limitObsEpochs sets the end of the observation epochs to be read from the input file mapped in memory at the first epoch having
+ * a time tag after the given one, so that readObsEpoch will find EOF there.
+ * As seekObsEpoch, it performs a binary search over the mapped contents, and shall be used after mapInputFile and before setParallelRead.
+ *
+ * @param tTag the time tag (seconds from the GPS ephemeris) of the last epoch to read
+ * @return true if the end of epochs to read has been set, false otherwise (epochs will be read up to the end of the file)
+ */
+bool RinexData::limitObsEpochs(double tTag) {
+	if ((inMapBase == NULL) || (parReader != NULL) || ((inFileVer != V210) && (inFileVer != V302))) return false;
+	size_t pos = findMappedEpoch(tTag, true);
+	plog->fine("Epoch limit skipped bytes:" + to_string((long long) (inMapEnd - pos)));
+	inMapEnd = pos;
+	return true;
+}
+
+/**nextMappedEpoch finds the first record of the next epoch in the mapped contents, starting from the record at the given position,
+ * and gets its time tag. Epoch records without a valid date are skipped.
+ *
+ * @param pos the offset in the mapped contents of the first char of a record
+ * @param tTag the time tag of the epoch found
+ * @return the offset of the first record of the epoch found, or the end of the contents to read if none found
+ */
+size_t RinexData::nextMappedEpoch(size_t pos, double &tTag) {
+///a macro to get the pointer and width parameters of a field in POS having the given WIDTH, for the current record
+#define FIELD(POS, WIDTH) rec + (POS), ((POS) + (WIDTH) <= recLen? (WIDTH) : recLen - (POS))
+	const char* rec;
+	const char* eol;
+	int recLen, week, year, month, day, hour, minute;
+	double tow, second;
+	bool goodDate;
+	for (; pos < inMapEnd; pos = eol - inMapBase + 1) {
+		rec = inMapBase + pos;
+		if ((eol = (const char*) memchr(rec, '\n', inMapEnd - pos)) == NULL) eol = inMapBase + inMapEnd;
+		if (!isMappedEpochStart(pos)) continue;
+		recLen = (int) (eol - rec);
+		if (inFileVer == V302) {
+			goodDate = getFixedInt(FIELD(2, 4), year) && getFixedInt(FIELD(7, 2), month) && getFixedInt(FIELD(10, 2), day)
+					&& getFixedInt(FIELD(13, 2), hour) && getFixedInt(FIELD(16, 2), minute) && getFixedDouble(FIELD(18, 11), second);
+		} else {
+			goodDate = getFixedInt(FIELD(1, 2), year) && getFixedInt(FIELD(4, 2), month) && getFixedInt(FIELD(7, 2), day)
+					&& getFixedInt(FIELD(10, 2), hour) && getFixedInt(FIELD(13, 2), minute) && getFixedDouble(FIELD(15, 11), second);
+			if (year >= 80) year += 1900;
+			else year += 2000;
+		}
+		if (goodDate) {
+			setWeekTow (year, month, day, hour, minute, second, week, tow);
+			tTag = getSecsGPSEphe(week, tow);
+			return pos;
+		}
+	}
+	return inMapEnd;
+#undef FIELD
+}
+
+/**findMappedEpoch searches in the mapped contents, from the current position, the first epoch having a time tag equal or after
+ * (or only after) the given one.
+ * The range of contents where the epoch can be is halved parsing the time of the first epoch found after its middle, until it is small
+ * enough to be scanned sequentially.
+ *
+ * @param tTag the time tag to search
+ * @param after true if the epoch searched shall have a time tag after the given one, false if it can be also equal
+ * @return the offset of the first record of the epoch found, or the end of the contents to read if none found
+ */
+size_t RinexData::findMappedEpoch(double tTag, bool after) {
+	const char* eol;
+	size_t lo = inMapPos;	//the epoch searched is after lo, or in lo
+	size_t hi = inMapEnd;
+	size_t mid, pos;
+	double epochTag;
+	while ((hi > lo) && (hi - lo > SEEKSCANMAX)) {
+		mid = lo + (hi - lo) / 2;
+		if ((eol = (const char*) memchr(inMapBase + mid, '\n', hi - mid)) == NULL) {
+			hi = mid;
+			continue;
+		}
+		pos = nextMappedEpoch(eol - inMapBase + 1, epochTag);
+		if ((pos >= inMapEnd) || (after? epochTag > tTag : epochTag >= tTag)) hi = mid;
+		else lo = pos;
+	}
+	for (pos = lo; (pos = nextMappedEpoch(pos, epochTag)) < inMapEnd; ) {
+		if (after? epochTag > tTag : epochTag >= tTag) break;
+		if ((eol = (const char*) memchr(inMapBase + pos, '\n', inMapEnd - pos)) == NULL) return inMapEnd;
+		pos = eol - inMapBase + 1;
+	}
+	return pos;
+}
+
+/**parseChunks is the body of each worker thread parsing epochs. While chunks remain pending, it takes the next one and parses its epochs.
+ * Parsing is made by a RinexData object having the systems and observable types of this one, which reads records from the contents
+ * mapped by this one. Workers do not parse chunks too far ahead of the one being read, to limit memory used.
+ */
+void RinexData::parseChunks() {
+	ParallelReader &pr = *parReader;
+	RinexData parser(version, plog);
+	ParallelReader::EpochData epoch;
+	size_t n, pos;
+	int status;
+	parser.inFileVer = inFileVer;
+	parser.systems = pr.systems;
+	parser.inMapBase = inMapBase;
+	parser.inMapSize = inMapSize;
+	parser.inMapOwned = false;
+	for (;;) {
+		{	//take the next chunk to parse, waiting while it would be too far ahead
+			unique_lock<mutex> lock(pr.chunkMutex);
+			pr.chunkRead.wait(lock, [&pr] {return pr.abort || (pr.nextChunk >= pr.chunks.size()) || (pr.nextChunk < pr.readChunk + pr.maxAhead);});
+			if (pr.abort || (pr.nextChunk >= pr.chunks.size())) break;
+			n = pr.nextChunk++;
+		}
+		ParallelReader::Chunk &chunk = pr.chunks[n];
+		parser.inMapPos = chunk.begin;
+		parser.inMapEnd = chunk.end;
+		while (!pr.abort) {
+			pos = parser.inMapPos;
+			if ((status = parser.readObsEpoch(NULL)) == 0) break;
+			if ((status == 2) || ((status >= 5) && (status <= 7))) {	//an epoch event: parsing continues when read
+				chunk.stopped = true;
+				chunk.resumePos = pos;
+				break;
+			}
+			for (int row = parser.epochObs.firstSat(); row >= 0; row = parser.epochObs.nextSat(row))
+				for (int ox = 0; ox <= parser.epochObs.lastObs(row); ox++)
+					if (parser.epochObs.hasObs(row, ox))
+						chunk.obs.push_back(SatObsData(parser.epochObs.getSys(row), parser.epochObs.getSat(row), ox,
+							parser.epochObs.getValue(row, ox), parser.epochObs.getLol(row, ox), parser.epochObs.getStrength(row, ox)));
+			epoch.status = status;
+			epoch.week = parser.epochWeek;
+			epoch.tow = parser.epochTOW;
+			epoch.timeTag = parser.epochTimeTag;
+			epoch.clkOffset = parser.epochClkOffset;
+			epoch.flag = parser.epochFlag;
+			epoch.nSats = parser.nSatsEpoch;
+			epoch.obsEnd = chunk.obs.size();
+			chunk.epochs.push_back(epoch);
+		}
+		lock_guard<mutex> lock(pr.chunkMutex);
+		chunk.done = true;
+		pr.chunkDone.notify_all();
+	}
+}
+
+/**readParallelEpoch gets the next epoch parsed by the workers, and stores its data in this object in the same way readObsEpoch would do.
+ * When all epochs have been read, or an epoch event is reached, the parallel parsing is stopped, and the current position in the mapped
+ * contents is set after the last epoch read.
+ *
+ * @return the status of the epoch read (see readObsEpoch), or -1 if the parallel parsing has finished and epochs shall be parsed sequentially
+ */
+int RinexData::readParallelEpoch() {
+	ParallelReader &pr = *parReader;
+	size_t resumePos = inMapEnd;
+	unique_lock<mutex> lock(pr.chunkMutex);
+	while (pr.readChunk < pr.chunks.size()) {
+		ParallelReader::Chunk &chunk = pr.chunks[pr.readChunk];
+		pr.chunkDone.wait(lock, [&chunk] {return chunk.done;});
+		if (pr.readEpoch < chunk.epochs.size()) {
+			ParallelReader::EpochData &epoch = chunk.epochs[pr.readEpoch];
+			epochObs.clear();
+			for (size_t i = (pr.readEpoch == 0? 0 : chunk.epochs[pr.readEpoch-1].obsEnd); i < epoch.obsEnd; i++) {
+				SatObsData &obs = chunk.obs[i];
+				epochObs.put(obs.sysIndex, obs.satellite, obs.obsTypeIndex, obs.obsValue, obs.lossOfLock, obs.strength);
+			}
+			epochWeek = epoch.week;
+			epochTOW = epoch.tow;
+			epochTimeTag = epoch.timeTag;
+			epochClkOffset = epoch.clkOffset;
+			epochFlag = epoch.flag;
+			nSatsEpoch = epoch.nSats;
+			pr.readEpoch++;
+			return epoch.status;
+		}
+		if (chunk.stopped) {
+			resumePos = chunk.resumePos;
+			break;
+		}
+		//all epochs in this chunk have been read: release its memory and continue with the next one
+		vector<ParallelReader::EpochData>().swap(chunk.epochs);
+		vector<SatObsData>().swap(chunk.obs);
+		pr.readChunk++;
+		pr.readEpoch = 0;
+		pr.chunkRead.notify_all();
+	}
+	lock.unlock();
+	stopParallelRead();
+	inMapPos = resumePos;
+	return -1;
+}
+
+/**stopParallelRead stops the parallel parsing of epochs, if active, waiting for the workers to finish and releasing its resources.
+ */
+void RinexData::stopParallelRead() {
+	if (parReader == NULL) return;
+	{
+		lock_guard<mutex> lock(parReader->chunkMutex);
+		parReader->abort = true;
+		parReader->chunkRead.notify_all();
+	}
+	for (vector<thread>::iterator it = parReader->workers.begin(); it != parReader->workers.end(); it++) it->join();
+	delete parReader;
+	parReader = NULL;
+}
+
 /**obsV3toV2 provides the observable type name in RINEX V2 of a given system and observable
  * The observable type name returned is empty when:
  * - The system is not GPS, GLONASS or SBAS (the only ones RINEX V210 can cope with)
@@ -3411,7 +4330,7 @@ string RinexData::obsV3toV2(int si, int oi) {
 	string obsTypeName = systems[si].obsType[oi];
 	//if system is not GPS, SBAS, or GLONASS, V2 cannot cope with it
 	if(strchr("GRS", sys) != NULL) {
-		for (vector<EQUIVobs>::iterator it = obsNamEq.begin(); it != obsNamEq.end(); ++it)
+		for (vector<EQUIVobs>::const_iterator it = obsNamEq().begin(); it != obsNamEq().end(); ++it)
 			if(it->v3name.compare(obsTypeName) == 0) return it->v2name;
 	}
 	return string();
@@ -3437,9 +4356,7 @@ int RinexData::v2ObsInx(const string &obsId) {
  */
 bool RinexData::isSatSelected(int sysIx, int sat) {
 	if (systems[sysIx].selSat.empty()) return true;
-	for (vector<int>::iterator its = systems[sysIx].selSat.begin(); its != systems[sysIx].selSat.end(); its++)
-		if ((*its) == sat) return true;
-	return false;
+	return (sat >= 0) && (sat < (int) systems[sysIx].selSatMap.size()) && systems[sysIx].selSatMap[sat];
 }
 
 /**sysInx provides the system index in the systems vector for a given system code
@@ -3448,9 +4365,52 @@ bool RinexData::isSatSelected(int sysIx, int sat) {
  * @return the index of the given system code in the systems vector, or -1 if it is not in the vector
  */
 int RinexData::sysInx(char sysCode) {
-	for (int i = 0; i < (int) systems.size(); i++)
-		if (systems[i].system == sysCode) return i;
-	return -1;
+	if (sysTblSize != systems.size()) buildSysInxTbl();
+	if ((sysCode & 0x80) != 0) return -1;
+	return sysInxTbl[(int) sysCode];
+}
+
+/**buildSysInxTbl builds the table giving for each system code its index in the systems vector.
+ * When a system code is several times in the vector, its first index is used.
+ */
+void RinexData::buildSysInxTbl() {
+	for (int i = 0; i < 128; i++) sysInxTbl[i] = -1;
+	for (int i = (int) systems.size() - 1; i >= 0; i--)
+		if ((systems[i].system & 0x80) == 0) sysInxTbl[(int) systems[i].system] = i;
+	sysTblSize = systems.size();
+}
+
+/**buildV2InxTbl builds the table giving for each system and observable type its index in the v2ObsLst list of
+ * RINEX V2 observables, taking into account the current filtering data (see obsV3toV2 and v2ObsInx).
+ */
+void RinexData::buildV2InxTbl() {
+	v2InxTbl.resize(systems.size());
+	for (unsigned int i = 0; i < systems.size(); i++) {
+		v2InxTbl[i].resize(systems[i].obsType.size());
+		for (unsigned int j = 0; j < systems[i].obsType.size(); j++) v2InxTbl[i][j] = v2ObsInx(obsV3toV2(i, j));
+	}
+	v2TblValid = true;
+}
+
+/**buildColInxTbl builds the table giving for each system and column of saveObsColumns the index of the column observable type
+ * in the ones defined for the system, or -1 if it is not defined.
+ *
+ * @param nObs the number of columns
+ * @param obsTypes the observable type of each column
+ */
+void RinexData::buildColInxTbl(unsigned int nObs, const string* obsTypes) {
+	colObsTypes.assign(obsTypes, obsTypes + nObs);
+	colInxTbl.resize(systems.size());
+	for (unsigned int i = 0; i < systems.size(); i++) {
+		colInxTbl[i].assign(nObs, -1);
+		for (unsigned int j = 0; j < nObs; j++)
+			for (unsigned int k = 0; k < systems[i].obsType.size(); k++)
+				if (obsTypes[j].compare(systems[i].obsType[k]) == 0) {
+					colInxTbl[i][j] = k;
+					break;
+				}
+	}
+	colTblValid = true;
 }
 
 /**nSysSel provides the number of systems currently selected
@@ -25,6 +25,23 @@
  *<p>				|-#	For filtering observation and navigation epoch data according to selected systems/satellites/observables (useful before printing or getting data).
  *<p>				|Removed functionalities not related to RINEX file processing.
  *<p>V2.1	|2/2018	|Reviewed to run on Linux
+ *<p>V2.2	|10/2026	|Added functionality:
+ *<p>				|-#	For reading observation epochs from input files mapped in memory.
+ *<p>				|-#	Lookup tables for systems, V2 observables and selected satellites, and saving observation data using indexes.
+ *<p>				|-#	Epoch data filtering and printing without removing items one by one, and sorting taking into account data are nearly ordered.
+ *<p>				|-#	Epoch data are rendered in an output buffer and printed at once.
+ *<p>				|-#	For parsing in parallel observation epochs from input files mapped in memory.
+ *<p>				|-#	For updating in place header records of observation files printed while data are being acquired.
+ *<p>				|-#	Navigation data are kept ordered and without duplicates when saved, and can be printed up to a given time.
+ *<p>				|-#	Epoch observation data stored in a satellites x observables matrix, iterated in order without sorting them.
+ *<p>				|-#	For reading and printing observation files in Compact RINEX format.
+ *<p>				|-#	Performance timers (see PerfCounters) in filtering, printing and reading methods.
+ *<p>				|-#	Observable types of a system already defined can be extended, to merge the ones of several files.
+ *<p>				|-#	For seeking epochs of a time window in input files mapped in memory.
+ *<p>				|-#	For copying epoch data from other object, to print several files from epochs read once.
+ *<p>				|-#	For saving at once columns of observation data with the values of several observables for several satellites.
+ *<p>				|-#	Label definitions and observable names equivalences built once and shared by all objects.
+ *<p>				|-#	Comments can be inserted just after the last header record set.
  */
 #ifndef RINEXDATA_H
 #define RINEXDATA_H
@@ -34,6 +51,9 @@
 #include <algorithm>
 
 #include "Logger.h"	//from CommonClasses
+#include "OutputBuffer.h"	//from CommonClasses
+#include "EpochObsMatrix.h"	//from CommonClasses
+#include "CompactRinex.h"	//from CommonClasses
 
 using namespace std;
 
@@ -78,9 +98,17 @@ const string msgNotNav("Cannot generate V2.10 navigation file for system ");
  * -# Set observation data for the epoch to be printed using setEpochTime first and saveObsData repeatedly for each system/satellite/observable for this epoch.
  * -# Print the RINEX epoch data using the printObsEpoch method.
  * -# Repeat former steps 4 & 5 while epoch data exist.
+ *<p>When epochs are printed as they are acquired (i.e. in real time), header records known only later (INTERVAL, TIME OF LAST OBS)
+ * can be printed with provisional data, and updated with the final ones using updateObsHeader before closing the file.
  *<p>Alternatively input data can be obtained from another RINEX observation file. In this case:
  * - The method readRinexHeader is used in step 2 to read from another RINEX file header records data and store them into the RinexData object.
  * - The method readObsEpoch is used in step 4 to read an epoch data from another RINEX observation file.
+ * - Optionally, the method mapInputFile can be used after readRinexHeader to map in memory the input file, speeding up epoch reading.
+ *	After mapping it, setParallelRead can be used to parse epochs using several worker threads, and seekObsEpoch / limitObsEpochs
+ *	can be used before to read only the epochs in a given time window.
+ *<p>Observation files in Compact RINEX format (Hatanaka) are detected when reading the header, and decoded on the fly: the methods
+ * to read data are used as per RINEX files, but the input file cannot be mapped in memory. Using setCompactOutput, observation files
+ * can be printed in Compact RINEX format instead of RINEX.
  *<p>When it is necessary to print a special event epoch in the epochs processing cycle, already existing header records data shall be cleared before processing
  *any special event epoch having header records, that is, special events having flag values 2, 3, 4 or 5. The reason is that when printing such events,
  *after the epoch line they are printed all header line records having data. In sumary, to process a special event it will be encessary to perform
@@ -97,6 +125,9 @@ const string msgNotNav("Cannot generate V2.10 navigation file for system ");
  * -# Set navigation data for the epoch to be printed using setEpochTime first and saveNavData repeatedly for each system/satellite for this epoch
  * -# Print the RINEX epoch data using the printNavEpoch method.
  * -# Repeat steps 5 & 6 while epoch data exist.
+ *<p>Navigation data saved are kept ordered by time tag, system and satellite, and data already saved for the same time tag, system and
+ * satellite are discarded. When data are acquired during long periods, printNavEpoch can be used with a time tag limit to print
+ * the ephemeris already received for a finished time window, removing them from the storage.
  *<p>As per above case, input data can be obtained from another RINEX navigation file. In this case:
  * - The method readRinexHeader is used in step 3 to read from another RINEX file header records data and store them into the RinexData object.
  * - The method readNavEpoch is used in step 5 to read an epoch data from another RINEX navigation file.
@@ -228,26 +259,39 @@ public:
 	//methods to process and collect epoch data
 	double setEpochTime(int weeks, double secs, double bias=0.0, int eFlag=0);
 	bool saveObsData(char sys, int sat, string obsType, double value, int lol, int strg, double tTag);
+	bool getObsIndex(char sys, const string &obsType, int &sysIx, int &obsIx);
+	bool saveObsData(int sysIx, int sat, int obsIx, double value, int lol, int strg, double tTag);
+	bool saveObsColumns(unsigned int nSats, const char* sys, const int* sats, const int* lols, const int* strgs, const double* tTags,
+		unsigned int nObs, const string* obsTypes, const double* const* values);
 	double getEpochTime(int &weeks, double &secs, double &bias, int &eFlag);
 	bool getObsData(char &sys, int &sat, string &obsType, double &value, int &lol, int &strg, double &tTag, unsigned int index = 0);
 //	bool setFilter(vector<string>& selSat, vector<string>& selObs);
 	bool setFilter(vector<string> selSat, vector<string> selObs);
 	bool filterObsData();
 	void clearObsData();
+	bool copyObsEpoch(RinexData &from);
 	bool saveNavData(char sys, int sat, double bo[8][4], double tTag);
 	bool getNavData(char& sys, int &sat, double (&bo)[8][4], double &tTag, unsigned int index = 0);
 	bool filterNavData();
 	void clearNavData();
 	//methods to print RINEX files
+	void setCompactOutput(bool compact);
 	string getObsFileName(string prefix, string country = "---"); 
 	string getNavFileName(string prefix, char suffix = 'N', string country = "---");
 	void printObsHeader(FILE* out);
 	void printObsEpoch(FILE* out);
 	void printObsEOF(FILE* out);
+	bool updateObsHeader(FILE* out);
 	void printNavHeader(FILE* out);
 	void printNavEpoch(FILE* out);
+	void printNavEpoch(FILE* out, double tTagLimit);
 	//methods to collect data from existing RINEX files
 	RINEXlabel readRinexHeader(FILE* input);
+	bool mapInputFile(FILE* input);
+	void unmapInputFile();
+	bool setParallelRead(int nWorkers);
+	bool seekObsEpoch(double tTag);
+	bool limitObsEpochs(double tTag);
 	int readObsEpoch(FILE* input);
 	int readNavEpoch(FILE* input);
 
@@ -373,6 +417,7 @@ private:
 		vector <string> obsType;	//identifier of each obsType type: C1C, L1C, D1C, S1C... (see RINEX V302 document: 5.1 Observation codes)
 		vector <bool> selObsType;	//a flag stating if the corresponding obsType is selected (will pass filtering or not)
 		vector <int> selSat;
+		vector <bool> selSatMap;	//a flag for each satellite number stating if it is in selSat (when selSat is not empty)
 		//constructor
 		GNSSsystem (char sys, const vector<string> &obsT) {
 			system = sys;
@@ -521,8 +566,7 @@ private:
 	//Epoch observable data
 	int epochFlag;		//The type of data following this epoch record (observation, event, ...). See RINEX definition
 	int nSatsEpoch;		//Number of satellites or special records in current epoch
-	struct SatObsData {	//defines data storage for a satellite observable (pseudorrange, phase, ...) in an epoch.
-		double obsTimeTag;	//A tag to identify the epoch of this measurement. Could be the estimated time of current epoch before fix (f.e in Sirf from MID28)
+	struct SatObsData {	//defines a record with data of a satellite observable (pseudorrange, phase, ...) in an epoch, used to pass epoch data between threads
 		int sysIndex;		//the system this observable belongs: its index in systems vector (see above)
 		int satellite;		//the satellite this observable belongs: PRN of satellite
 		int obsTypeIndex;	//the observable type: its index in obsType vector (inside the GNSSsystem object referred by sysIndex)
@@ -530,8 +574,7 @@ private:
 		int lossOfLock;		//if loss of lock happened when observable was taken
 		int strength;		//the signal strength when observable was taken
 		//constructor
-		SatObsData (double obsTag, int sysIdx, int sat, int obsIdx, double obsVal, int lol, int str) {
-			obsTimeTag = obsTag;
+		SatObsData (int sysIdx, int sat, int obsIdx, double obsVal, int lol, int str) {
 			sysIndex = sysIdx;
 			satellite = sat;
 			obsTypeIndex = obsIdx;
@@ -539,22 +582,9 @@ private:
 			lossOfLock = lol;
 			strength = str;
 		};
-		//define operator for comparisons and sorting
-		bool operator < (const SatObsData &param) {
-			if (obsTimeTag > param.obsTimeTag) return false;
-			if (obsTimeTag < param.obsTimeTag) return true;
-			//same time tag
-			if (sysIndex > param.sysIndex) return false;
-			if (this->sysIndex < param.sysIndex) return true;
-			//same time tag and system
-			if (satellite > param.satellite) return false;
-			if (satellite < param.satellite) return true;
-			//same time tag, system and satellite
-			if (obsTypeIndex > param.obsTypeIndex) return false;
-			return true;
-		};
 	};
-	vector <SatObsData> epochObs;	//A place to store observable data (pseudorange, phase, ...) for one epoch
+	EpochObsMatrix epochObs;	//A place to store observable data (pseudorange, phase, ...) for one epoch, as a matrix of satellites x observable types
+	EpochObsMatrix v2Obs;		//A place to rearrange epoch observable data with V2.10 observable type indexes before printing them
 	//Epoch navigation data
 	struct SatNavData {	//defines storage for navigation data for a given GNSS satellite
 		double navTimeTag;	//a tag to identify the epoch of this data
@@ -581,8 +611,14 @@ private:
 			if (satellite > param.satellite) return false;
 			return true;
 		};
+		//strict ordering by the key time tag, system and satellite, used to keep data ordered without duplicates
+		bool precedes(const SatNavData &param) const {
+			if (navTimeTag != param.navTimeTag) return navTimeTag < param.navTimeTag;
+			if (systemId != param.systemId) return systemId < param.systemId;
+			return satellite < param.satellite;
+		};
 	};
-	vector <SatNavData> epochNav;		//A place to store navigation data for one epoch
+	vector <SatNavData> epochNav;		//A place to store navigation data, ordered by time tag, system and satellite, without duplicates
 	//A state variable used to store reference to the label of the last record which data has been modified
 	vector<LABELdata>::iterator lastRecordSet;
 	//A equivalence table between observable type names in RINEX V2 and V3 
@@ -595,7 +631,7 @@ private:
 			v3name = v3;
 		}
 	};
-	vector <EQUIVobs> obsNamEq;
+	static const vector <EQUIVobs>& obsNamEq();	//the table, shared by all objects
 	//Logger
 	Logger* plog;		//the place to send logging messages
 	bool dynamicLog;	//true when created dynamically here, false when provided externally
@@ -603,9 +639,36 @@ private:
 	bool applyObsFilter;	//when true, parameters has been stated to filter observation data 
 	bool applyNavFilter;	//when true, parameters has been stated to filter navigation data 
 	vector<string> selectedSats;	//list of selected systems-satellites that would pass navigation data filter
+	//Input file mapped in memory
+	const char* inMapBase;	//the start of the input file contents in memory, or NULL when records are read from the input stream
+	size_t inMapSize;		//the size in bytes of the input file contents
+	size_t inMapPos;		//the offset in the contents of the next record to read
+	size_t inMapEnd;		//the offset in the contents where records to read end
+	bool inMapOwned;		//true when the mapping was made by this object, false when it is borrowed from other one
+	//Parallel parsing of observation epochs
+	struct ParallelReader;		//the state of the parallel parsing (defined in RinexData.cpp)
+	ParallelReader* parReader;	//the current parallel parsing state, or NULL if epochs are parsed when read
+	//Compact RINEX input and output
+	CompactRinex* crxIn;	//the decoder of the Compact RINEX input file, or NULL if the input file is RINEX
+	CompactRinex* crxOut;	//the encoder of Compact RINEX observation files printed, or NULL if they are printed in RINEX
+	bool crxCheck;			//true when the next record read shall be checked to detect Compact RINEX input files
+	//Output buffer where epoch data are rendered before printing them
+	OutputBuffer outBuf;
+	//Lookup tables (rebuilt when systems are added or filtering data are stated)
+	int sysInxTbl[128];		//for each system code, its index in the systems vector, or -1 if not defined
+	size_t sysTblSize;		//the number of systems when sysInxTbl was built
+	vector < vector <int> > v2InxTbl;	//for each system and observable type index, its index in v2ObsLst, or a negative value if not printable in V210
+	bool v2TblValid;		//true when v2InxTbl is coherent with systems, v2ObsLst and filtering data
+	vector <string> colObsTypes;	//the observable types of the columns colInxTbl was built for (see saveObsColumns)
+	vector < vector <int> > colInxTbl;	//for each system index and column, the index of its observable type in the system, or -1 if not defined
+	bool colTblValid;		//true when colInxTbl is coherent with systems and colObsTypes
+	const RinexData* copyInxSrc;	//the object epochs are copied from by copyObsEpoch, or NULL if none
+	vector <int> copySysTbl;		//for each system in copyInxSrc, its index in systems, or -1 if not defined
+	vector < vector <int> > copyObsTbl;	//for each system and observable type index in copyInxSrc, its index in this object, or -1 if not defined
 
 	//private methods
 	void setDefValues(RINEXversion v, Logger* p);
+	static const vector <LABELdata>& labelDefaults();
 	string fmtRINEXv2name(string designator, int week, double tow, char ftype);
 	string fmtRINEXv3name(string designator, int week, double tow, char ftype, string country);
 	void setLabelFlag(RINEXlabel label, bool flagVal=true);
@@ -618,13 +681,27 @@ private:
 	int readV3ObsEpoch(FILE* input);
 	int readObsEpochEvent(FILE* input, bool wrongDate);
 	void printHdLineData (FILE* out, vector<LABELdata>::iterator lbIter);
-	bool printSatObsValues(FILE* out, int maxPerLine);
+	bool printSatObsValues(int maxPerLine, int &row);
+	void printCompactEpoch(FILE* out, const char* timeBuffer);
 	RINEXlabel readHdLineData(FILE* input);
 	bool readRinexRecord(char* rinexRec, int recSize, FILE* input);
+	bool insertNavData(const SatNavData &navData);
+	bool getMappedRecord(const char* &rec, int &recLen);
+	bool getObsRecord(const char* &rec, int &recLen, char* buffer, int bufSize, FILE* input);
+	bool isMappedEpochStart(size_t pos);
+	void splitMappedEpochs(size_t chunkSize, vector<size_t> &bounds);
+	size_t nextMappedEpoch(size_t pos, double &tTag);
+	size_t findMappedEpoch(double tTag, bool after);
+	void parseChunks();
+	int readParallelEpoch();
+	void stopParallelRead();
 	string obsV3toV2(int, int);
 	int v2ObsInx(const string&);
 	bool isSatSelected(int sysIx, int sat);
 	int sysInx(char sysCode);
+	void buildSysInxTbl();
+	void buildV2InxTbl();
+	void buildColInxTbl(unsigned int nObs, const string* obsTypes);
 	int nSysSel();
 	string getSysDes(char s);
 };
@@ -5,8 +5,19 @@
 #include <sstream>
 #include <algorithm>
 #include <ctype.h>
+#include <stdio.h>
 #include <time.h>
 #include <math.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <map>
+#include <mutex>
+#include <unistd.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
 
 /**getTokens gets tokens from a string separated by the given separator
  *
@@ -29,11 +40,165 @@ vector<string> getTokens (string source, char separator) {
  * @param n the length to check
  * @return true if all n chars are blanks, false otherwise
  */
-bool isBlank (char* buffer, int n) {
+bool isBlank (const char* buffer, int n) {
 	while (n-- > 0) if (*(buffer++) != ' ')  return false;
 	return true;
 }
 
+/**getFixedInt parses an integer value from a fixed width text field, like the ones in RINEX records.
+ * Leading blanks and an optional sign are accepted before digits. Parsing stops at the first non digit char.
+ *
+ * @param field a pointer to the first char of the field
+ * @param width the field width in chars. Zero or negative values mean an empty field
+ * @param value the integer parsed from the field
+ * @return true if at least one digit exist in the field, false otherwise (value is not modified)
+ */
+bool getFixedInt (const char* field, int width, int &value) {
+	const char* end = field + width;
+	while (field < end && *field == ' ') field++;
+	bool negative = false;
+	if (field < end && (*field == '-' || *field == '+')) negative = *(field++) == '-';
+	if (field >= end || *field < '0' || *field > '9') return false;
+	int n = 0;
+	while (field < end && *field >= '0' && *field <= '9') n = n * 10 + (*(field++) - '0');
+	value = negative? -n : n;
+	return true;
+}
+
+/**getFixedDouble parses a floating point value from a fixed width text field, like the ones in RINEX records.
+ * The common case of fields having a sign, digits and a decimal point (as F14.3 observables) is converted directly
+ * to the nearest double, which is the same value strtod gives. Fields having exponents (like the D19.12 ones) or
+ * too many digits to be converted exactly are passed to strtod.
+ *
+ * @param field a pointer to the first char of the field
+ * @param width the field width in chars. Zero or negative values mean an empty field
+ * @param value the value parsed from the field
+ * @return true if a number was parsed from the field, false otherwise (value is not modified)
+ */
+bool getFixedDouble (const char* field, int width, double &value) {
+	static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+	const char* end = field + width;
+	const char* p;
+	while (field < end && *field == ' ') field++;
+	if (field >= end) return false;
+	p = field;
+	bool negative = false;
+	if (*p == '-' || *p == '+') negative = *(p++) == '-';
+	unsigned long long mantissa = 0;
+	int nDigits = 0, nDecimals = 0;
+	bool point = false;
+	for (; p < end; p++) {
+		if (*p >= '0' && *p <= '9') {
+			mantissa = mantissa * 10 + (*p - '0');
+			nDigits++;
+			if (point) nDecimals++;
+		} else if (*p == '.' && !point) point = true;
+		else break;
+	}
+	if (nDigits == 0) return false;
+	while (p < end && *p == ' ') p++;
+	if (p < end || nDigits > 15) {
+		//not a plain decimal number: use strtod on a null terminated copy with Fortran exponents (D) changed to E
+		char buffer[64];
+		char* endConv;
+		int n = 0;
+		for (p = field; p < end && n < (int) sizeof buffer - 1; p++, n++) buffer[n] = (*p == 'D' || *p == 'd')? 'E' : *p;
+		buffer[n] = 0;
+		double d = strtod(buffer, &endConv);
+		if (endConv == buffer) return false;
+		value = d;
+		return true;
+	}
+	value = (double) mantissa / POW10[nDecimals];
+	if (negative) value = -value;
+	return true;
+}
+
+//@cond DUMMY
+///The days from 1/1/1970 to the GPS ephemeris 6/1/1980
+#define GPSEPHEDAYS 3657L
+///The seconds in a day and in a week
+#define DAYSECS 86400LL
+#define WEEKSECS 604800LL
+//@endcond
+
+/**daysFromCivil computes the number of days from 1/1/1970 to the given date of the proleptic Gregorian calendar.
+ * Computations use only integer arithmetic (see the days_from_civil algorithm by H. Hinnant).
+ * Values of month and day out of their ranges are normalized as mktime does (f.e. month 0 is december of the previous year,
+ * and day 32 of january is 1st of february).
+ *
+ * @param year of the date
+ * @param month of the date
+ * @param day of the date
+ * @return the days from 1/1/1970 to the given date (negative for dates before it)
+ */
+long daysFromCivil (int year, int month, int day) {
+	//normalize month to the range 0 to 11, adjusting the year
+	int mIndex = month - 1;
+	year += mIndex / 12;
+	mIndex %= 12;
+	if (mIndex < 0) {
+		mIndex += 12;
+		year--;
+	}
+	//compute days for a year starting in march, to have the leap day at the end of the year
+	if (mIndex < 2) year--;
+	long era = (year >= 0 ? year : year - 399) / 400;
+	long yearOfEra = year - era * 400;			//0 to 399
+	long dayOfYear = (153 * (mIndex < 2 ? mIndex + 10 : mIndex - 2) + 2) / 5;	//for the 1st day of the month: 0 to 365
+	long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;	//0 to 146096
+	return era * 146097L + dayOfEra - 719468L + (day - 1);
+}
+
+/**civilFromDays computes the date of the proleptic Gregorian calendar for the given number of days from 1/1/1970.
+ * It is the inverse of daysFromCivil, and uses only integer arithmetic (see the civil_from_days algorithm by H. Hinnant).
+ *
+ * @param days the days from 1/1/1970 (negative for dates before it)
+ * @param year of the date computed
+ * @param month of the date computed (1 to 12)
+ * @param day of the date computed (1 to 31)
+ */
+void civilFromDays (long days, int &year, int &month, int &day) {
+	days += 719468L;		//days from 1/3/0000
+	long era = (days >= 0 ? days : days - 146096L) / 146097L;
+	long dayOfEra = days - era * 146097L;		//0 to 146096
+	long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;	//0 to 399
+	long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);	//0 to 365, from 1st of march
+	long mp = (5 * dayOfYear + 2) / 153;		//0 to 11, from march
+	day = (int) (dayOfYear - (153 * mp + 2) / 5 + 1);
+	month = (int) (mp < 10 ? mp + 3 : mp - 9);
+	year = (int) (yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+/**gpsTimeToTm computes the calendar data for the given GPS week and seconds of week.
+ * The tm structure is filled as mktime would do after normalizing a date set to 6/1/1980 plus the given weeks and seconds.
+ *
+ * @param week the GPS week from 6/1/1980
+ * @param secs the seconds from the beginning of the week (could be negative, or greater than the week length)
+ * @param date the tm structure where calendar data are set
+ */
+void gpsTimeToTm (int week, long long secs, struct tm &date) {
+	int year, month, day;
+	long long totalSecs = (long long) week * WEEKSECS + secs;
+	long long days = totalSecs / DAYSECS;
+	long long secsOfDay = totalSecs % DAYSECS;
+	if (secsOfDay < 0) {
+		secsOfDay += DAYSECS;
+		days--;
+	}
+	days += GPSEPHEDAYS;
+	civilFromDays((long) days, year, month, day);
+	date.tm_year = year - 1900;
+	date.tm_mon = month - 1;
+	date.tm_mday = day;
+	date.tm_hour = (int) (secsOfDay / 3600);
+	date.tm_min = (int) (secsOfDay % 3600) / 60;
+	date.tm_sec = (int) (secsOfDay % 60);
+	date.tm_wday = (int) ((days % 7 + 11) % 7);		//1/1/1970 was thursday
+	date.tm_yday = (int) (days - daysFromCivil(year, 1, 1));
+	date.tm_isdst = 0;
+}
+
 /**formatGPStime format a GPS time point giving text GPS calendar data using time formats provided. 
  *
  * @param buffer the text buffer where calendar data are placed
@@ -48,24 +213,16 @@ void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec,
 	double intTow;
 	double modTow;
 	modTow = modf(tow, &intTow);
-	//set GPS ephemeris 6/1/1980 adding given week and sec increment
+	//compute calendar data for the GPS ephemeris 6/1/1980 adding given week and sec increment
 	struct tm gpsEphe = { 0 };
-	gpsEphe.tm_year = 80;
-	gpsEphe.tm_mon = 0;
-	gpsEphe.tm_mday = 6 + week * 7;
-	gpsEphe.tm_hour = 0;
-	gpsEphe.tm_min = 0;
-	gpsEphe.tm_sec = 0 + (int) intTow;
-	//recompute time
-	mktime(&gpsEphe);
+	gpsTimeToTm(week, (int) intTow, gpsEphe);
 	//format data
-	strftime (buffer, bufferSize, fmtYtoM, &gpsEphe);
-	string yTOm = string(buffer);
-	string fmt = "%s" + string(fmtSec);
-	sprintf(buffer, fmt.c_str(), yTOm.c_str(), ((double) gpsEphe.tm_sec + modTow)); 
+	size_t n = strftime (buffer, bufferSize, fmtYtoM, &gpsEphe);
+	snprintf(buffer + n, bufferSize - n, fmtSec, ((double) gpsEphe.tm_sec + modTow));
 }
 
 /**formatLocalTime gives text calendar data of local time using the format provided (as per strftime). 
+ * It can be called from several threads at the same time.
  *
  * @param buffer the text buffer where calendar data are placed
  * @param bufferSize of the text buffer in bytes
@@ -74,10 +231,14 @@ void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec,
 void formatLocalTime (char* buffer, int bufferSize, char* fmt) {
 	//get local time and format it as needed
 	time_t rawtime;
-	struct tm * timeinfo;
+	struct tm timeinfo;
 	time (&rawtime);
-	timeinfo = localtime (&rawtime);
-	strftime (buffer, bufferSize, fmt, timeinfo);
+#ifdef _WIN32
+	localtime_s(&timeinfo, &rawtime);
+#else
+	localtime_r(&rawtime, &timeinfo);
+#endif
+	strftime (buffer, bufferSize, fmt, &timeinfo);
 }
 
 /**getGPSweek compute number of weeks from the GPS ephemeris (6/1/1980) to a given GPS date and time
@@ -143,24 +304,9 @@ void setWeekTow (int year, int month, int day, int hour, int min, double sec, in
 	double intSec;
 	double modSec;
 	modSec = modf(sec, &intSec);
-	//set GPS ephemeris 6/1/1980
-	struct tm gpsEphe = { 0 };
-	gpsEphe.tm_year = 80;
-	gpsEphe.tm_mon = 0;
-	gpsEphe.tm_mday = 6;
-	gpsEphe.tm_hour = 0;
-	gpsEphe.tm_min = 0;
-	gpsEphe.tm_sec = 0;
-	//set given date
-	struct tm date = { 0 };
-	date.tm_year = year - 1900;
-	date.tm_mon = month - 1;
-	date.tm_mday = day;
-	date.tm_hour = hour;
-	date.tm_min = min;
-	date.tm_sec = 0 + (int) intSec;
-	//compute time difference in integer seconds
-	intSec = difftime(mktime(&date), mktime(&gpsEphe));
+	//compute time difference in integer seconds from the GPS ephemeris 6/1/1980
+	intSec = (double) ((daysFromCivil(year, month, day) - GPSEPHEDAYS) * DAYSECS
+			+ hour * 3600LL + min * 60LL + (int) intSec);
 	week = int (intSec / 604800.0);
 	tow = fmod (intSec, 604800.0) + modSec;
 }
@@ -176,24 +322,9 @@ void setWeekTow (int year, int month, int day, int hour, int min, double sec, in
  * @return the seconds from 0h of 6/1/1980 to the given date 
  */
 double getSecsGPSEphe (int year, int month, int day, int hour, int min, float sec) {
-	//set GPS ephemeris 6/1/1980
-	struct tm gpsEphe = { 0 };
-	gpsEphe.tm_year = 80;
-	gpsEphe.tm_mon = 0;
-	gpsEphe.tm_mday = 6;
-	gpsEphe.tm_hour = 0;
-	gpsEphe.tm_min = 0;
-	gpsEphe.tm_sec = 0;
-	//set given date
-	struct tm date = { 0 };
-	date.tm_year = year - 1900;
-	date.tm_mon = month - 1;
-	date.tm_mday = day;
-	date.tm_hour = hour;
-	date.tm_min = min;
-	date.tm_sec = 0 + (int) sec;
-	//compute time difference
-	return difftime(mktime(&date), mktime(&gpsEphe));
+	//compute time difference in integer seconds
+	return (double) ((daysFromCivil(year, month, day) - GPSEPHEDAYS) * DAYSECS
+			+ hour * 3600LL + min * 60LL + (int) sec);
 }
 
 /**getSecsGPSEphe compute instant in seconds from the GPS ephemeris (6/1/1980) to a given date stated in GPS week and tow
@@ -288,3 +419,102 @@ unsigned int getBits(unsigned int *stream, int bitpos, int len) {
 	return bits;
 }
 
+
+//@cond DUMMY
+#ifndef _WIN32
+//The gzip processes attached to the streams opened with openStream, to wait for them when streams are closed
+static map<FILE*, pid_t> gzipProcesses;
+static mutex gzipMutex;
+#endif
+//@endcond
+
+/**openStream opens a file stream to read or write the given file. When the file name ends with ".gz", data are
+ * decompressed when read, or compressed when written, on the fly using a pipe to the gzip utility. Otherwise the file
+ * is opened as usual. Streams to compressed files cannot be positioned.
+ *<p>The file is opened by this process and given to gzip as its standard input or output, and gzip is started without using
+ * the shell: file names are never interpreted as commands. In Windows, where the command processor is used, names
+ * containing characters it would interpret (" and %) are rejected.
+ *
+ * @param fileName the name of the file to open
+ * @param toWrite true to open the file for writing (creating or truncating it), false to open it for reading
+ * @return the stream opened, or NULL if it cannot be opened
+ */
+FILE* openStream(const string &fileName, bool toWrite) {
+	FILE* stream;
+	if ((fileName.size() > 3) && (fileName.compare(fileName.size() - 3, 3, ".gz") == 0)) {
+#ifdef _WIN32
+		string command;
+		if (fileName.find_first_of("\"%") != string::npos) return NULL;
+		if (!toWrite) {		//check the file can be read, as errors in the pipe would not be reported to the caller
+			if ((stream = fopen(fileName.c_str(), "r")) == NULL) return NULL;
+			fclose(stream);
+		}
+		command = (toWrite? "gzip -c > \"" : "gzip -dc < \"") + fileName + "\"";
+		return _popen(command.c_str(), toWrite? "w" : "r");
+#else
+		int fileFd, pipeFds[2], ownFd, status;
+		pid_t pid;
+		posix_spawn_file_actions_t actions;
+		char* argv[] = {(char*) "gzip", (char*) (toWrite? "-c" : "-dc"), NULL};
+		//descriptors are not inherited by other processes started at the same time (i.e. by other jobs)
+		fileFd = toWrite? open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666) : open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fileFd < 0) return NULL;
+		if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+			close(fileFd);
+			return NULL;
+		}
+		//gzip reads from the pipe and writes to the file, or reads from the file and writes to the pipe
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, toWrite? pipeFds[0] : fileFd, 0);
+		posix_spawn_file_actions_adddup2(&actions, toWrite? fileFd : pipeFds[1], 1);
+		status = posix_spawnp(&pid, "gzip", &actions, NULL, argv, environ);
+		posix_spawn_file_actions_destroy(&actions);
+		close(fileFd);
+		close(toWrite? pipeFds[0] : pipeFds[1]);
+		ownFd = toWrite? pipeFds[1] : pipeFds[0];
+		if (status != 0) {
+			close(ownFd);
+			return NULL;
+		}
+		if ((stream = fdopen(ownFd, toWrite? "w" : "r")) == NULL) {
+			close(ownFd);
+			waitpid(pid, &status, 0);
+			return NULL;
+		}
+		lock_guard<mutex> lock(gzipMutex);
+		gzipProcesses[stream] = pid;
+		return stream;
+#endif
+	}
+	return fopen(fileName.c_str(), toWrite? "w" : "r");
+}
+
+/**closeStream closes a file stream opened with openStream. For compressed files, it waits until gzip finishes.
+ *
+ * @param stream the stream to close
+ * @param fileName the name of the file given when opening the stream
+ * @return 0 if the stream was closed without errors (and gzip ended without errors), other value otherwise
+ */
+int closeStream(FILE* stream, const string &fileName) {
+	if ((fileName.size() > 3) && (fileName.compare(fileName.size() - 3, 3, ".gz") == 0)) {
+#ifdef _WIN32
+		return _pclose(stream);
+#else
+		pid_t pid = -1;
+		int result, status;
+		{
+			lock_guard<mutex> lock(gzipMutex);
+			map<FILE*, pid_t>::iterator it = gzipProcesses.find(stream);
+			if (it != gzipProcesses.end()) {
+				pid = it->second;
+				gzipProcesses.erase(it);
+			}
+		}
+		result = fclose(stream);
+		if (pid < 0) return result;
+		if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) return -1;
+		return result;
+#endif
+	}
+	return fclose(stream);
+}
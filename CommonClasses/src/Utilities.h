@@ -16,17 +16,29 @@
  *<p>---------------------------------
  *<p>V1.0	|2/2015	|First release
  *<p>V2.0	|2/2016	|Added functions
+ *<p>V2.1	|10/2026	|Added fixed column field parsers
+ *<p>				|Added calendar arithmetic to convert dates and GPS time without using mktime
+ *<p>				|formatLocalTime made thread safe
+ *<p>				|Added opening and closing of file streams compressed with gzip
+ *<p>				|gzip is started without using the shell, with the file opened as its standard input or output
  */
 #ifndef UTILITIES_H
 #define UTILITIES_H
 
 #include <string>
 #include <vector>
+#include <time.h>
+#include <stdio.h>
 
 using namespace std;
 
 vector<string> getTokens (string source, char separator);			//extract tokens from a string
-bool isBlank (char* buffer, int n);		//checks if all chars in the buffer are spaces
+bool isBlank (const char* buffer, int n);		//checks if all chars in the buffer are spaces
+bool getFixedInt (const char* field, int width, int &value);		//parses an integer from a fixed width text field
+bool getFixedDouble (const char* field, int width, double &value);	//parses a floating point number from a fixed width text field
+long daysFromCivil (int year, int month, int day);	//computes days from 1/1/1970 to a given date
+void civilFromDays (long days, int &year, int &month, int &day);	//computes the date for given days from 1/1/1970
+void gpsTimeToTm (int week, long long secs, struct tm &date);	//computes calendar data for a given GPS week and seconds of week
 void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec, int week, double tow); //convert to printable format the given GPS time
 void formatLocalTime (char* buffer, int bufferSize, char* fmt);		//convert to printable format the computer current local time
 int getGPSweek (int year, int month, int day, int hour, int min, float sec); //computes GPS weeks from the GPS ephemeris (6/1/1980) to a given date
@@ -41,4 +53,6 @@ int getTwosComplement(unsigned int number, unsigned int nbits);
 int getSigned(unsigned int number, int nbits);
 unsigned int reverseWord(unsigned int wordToReverse, int nBits=32);
 unsigned int getBits(unsigned int *stream, int bitpos, int len);
+FILE* openStream(const string &fileName, bool toWrite);	//opens a file stream, compressed with gzip if its name ends with .gz
+int closeStream(FILE* stream, const string &fileName);	//closes a file stream opened with openStream
 #endif
\ No newline at end of file
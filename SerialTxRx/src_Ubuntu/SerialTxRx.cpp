@@ -12,8 +12,6 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
-//needed to compute type limits
-#include <limits.h>
 
 CBRrate::CBRrate(int r, DWORD CBRr) {
 	baudR = r;
@@ -24,6 +22,7 @@ CBRrate::CBRrate(int r, DWORD CBRr) {
   */
 SerialTxRx::SerialTxRx(void) {
 	payloadLen = 0;
+	inPos = inEnd = 0;
 	addCBRrate (50, B50);
 	addCBRrate (75, B75);
 	addCBRrate (110, B110);
@@ -42,7 +41,6 @@ SerialTxRx::SerialTxRx(void) {
 	addCBRrate (57600, B57600);
 	addCBRrate (115200, B115200);
 	addCBRrate (230400, B230400);
-	readLimit = ((unsigned long)1 << (sizeof(tio.c_cc[0]) * CHAR_BIT)) - 1;
 }
 
 /**Destructs SerialTxRx objects.
@@ -101,11 +99,14 @@ void SerialTxRx::openPort(string portName) {
 	hSerial = open(portName.c_str(), O_RDWR|O_NOCTTY); //|O_NDELAY);
 	if (hSerial == -1) throw string(MSG_OpenError) + string(strerror(errno));
 	hName = portName;
+	inPos = inEnd = 0;
 	if (tcgetattr(hSerial, &tio) == -1) throw string(MSG_InitState) + string(strerror(errno));
 }
 
 /**setPortParams sets port baud rate and timeout in the currently open serial port.
  * Other relevant port parameters are set for allowing transfer of OSP and NEMEA messages.
+ * Read calls return as soon as any byte is available, with all bytes received until the timeout between bytes elapses
+ * or the space requested is filled, allowing reading input data in chunks.
  *
  * @param baudRate the value of the baud rate to be set, if different from 0 bps
  * @param timeout the limit for a timer in tenths of a second to wait for input data
@@ -121,10 +122,11 @@ void SerialTxRx::setPortParams(int baudRate, int timeout) {
 	//set raw mode parameters
 	cfmakeraw(&tio);
 	//set circumstances for read completion
-	tio.c_cc[VMIN] = readLimit;
+	tio.c_cc[VMIN] = 1;
 	tio.c_cc[VTIME] = timeout;
 	//program port with parameters set
 	if (tcsetattr(hSerial, TCSAFLUSH, &tio) == -1) throw string(MSG_SetState);
+	inPos = inEnd = 0;	//data buffered were received with the former parameters
 }
 
 /**getPortParams gets current port parameters: baud rate, timeout and mode.
@@ -153,51 +155,211 @@ void SerialTxRx::closePort() {
 	hName.clear();
 }
 
+/**fillInput reads from the port into the input buffer the bytes available, in one read call.
+ * Bytes pending to be processed are moved to the beginning of the buffer before reading.
+ *
+ * @return true if any byte has been read, false otherwise (timeout, EOF or read error)
+ */
+bool SerialTxRx::fillInput() {
+	ssize_t nBytesRead;
+	if (inPos > 0) {
+		memmove(inBuff, inBuff + inPos, inEnd - inPos);
+		inEnd -= inPos;
+		inPos = 0;
+	}
+	if (inEnd >= INBUFFERSIZE) return false;
+	nBytesRead = read(hSerial, inBuff + inEnd, INBUFFERSIZE - inEnd);
+	if (nBytesRead <= 0) return false;
+	DBGRPT("fillInput:%d bytes\n", (int) nBytesRead)
+	inEnd += (unsigned int) nBytesRead;
+	return true;
+}
+
+/**ospChecksum computes the checksum of the given OSP payload: the 15 bits sum of its bytes.
+ * As the sum is truncated to 15 bits, it is computed using four partial sums, truncated at the end.
+ *
+ * @param payload the payload bytes
+ * @param length the payload length
+ * @return the checksum value
+ */
+static unsigned int ospChecksum(const unsigned char* payload, unsigned int length) {
+	unsigned int sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+	unsigned int i = 0;
+	for (; i + 4 <= length; i += 4) {
+		sum0 += payload[i];
+		sum1 += payload[i+1];
+		sum2 += payload[i+2];
+		sum3 += payload[i+3];
+	}
+	for (; i < length; i++) sum0 += payload[i];
+	return (sum0 + sum1 + sum2 + sum3) & 0x7FFF;
+}
+
+/**takeOSPmsg takes from the input buffer a whole OSP message, without reading from the port.
+ * Bytes before the start of the message (START1 START2) are skipped, and its end sequence (END1 END2) is also taken.
+ * If the input buffer does not contain the whole message, its bytes are kept in the buffer to be taken in a next call,
+ * after reading more data with fillInput.
+ *
+ * @param skipped the counter of input bytes skipped, to be increased with the ones skipped in this call
+ * @return the status according to the following values and meaning:
+ *		- (-1) when the input buffer does not contain a whole message
+ *		- (0) when a correct formatted OSP message has been taken
+ *		- (1) if the message has incorrect checksum
+ *		- (3) if the payload length is out of margin (>MAXBUFFERSIZE). The message start is skipped
+ */
+int SerialTxRx::takeOSPmsg(unsigned long &skipped) {
+	unsigned char* start;
+	//skip bytes until beginning of a message (START1 START2)
+	for (;;) {
+		start = (unsigned char*) memchr(inBuff + inPos, START1, inEnd - inPos);
+		if (start == NULL) {
+			skipped += inEnd - inPos;
+			inPos = inEnd;
+			return -1;
+		}
+		skipped += (unsigned long) (start - (inBuff + inPos));
+		inPos = (unsigned int) (start - inBuff);
+		if (inEnd - inPos < 2) return -1;	//the byte after START1 is not yet read
+		if (inBuff[inPos + 1] == START2) break;
+		inPos++;
+		skipped++;
+	}
+	//get payload length and check that the whole message is in the buffer
+	if (inEnd - inPos < 4) return -1;
+	paylenBuff[0] = inBuff[inPos + 2];
+	paylenBuff[1] = inBuff[inPos + 3];
+	payloadLen = (paylenBuff[0] << 8) | paylenBuff[1];	//numbers in OSP msg are big endians
+	if (!((payloadLen > 0) && (payloadLen < MAXBUFFERSIZE-1-2))) {
+		inPos += 2;
+		skipped += 2;
+		return 3;
+	}
+	if (inEnd - inPos < 4 + payloadLen + 4) return -1;	//the message and its end sequence (END1 END2) are not yet read
+	memcpy(payBuff, inBuff + inPos + 4, payloadLen + 2);
+	inPos += 4 + payloadLen + 2;
+	if ((inBuff[inPos] == END1) && (inBuff[inPos + 1] == END2)) inPos += 2;
+	//compare computed checksum with the one received after message payload
+	if (ospChecksum(payBuff, payloadLen) != (unsigned int) ((payBuff[payloadLen] << 8) | payBuff[payloadLen+1])) return 1;
+	return 0;
+}
+
+/**takeNMEAmsg takes from the input buffer a whole NMEA message, without reading from the port.
+ * Chars before the start of the message (<LineFeed>$) are skipped. If the input buffer does not contain the whole message
+ * (up to its CR), its chars are kept in the buffer to be taken in a next call, after reading more data with fillInput.
+ *
+ * @param skipped the counter of input bytes skipped, to be increased with the ones skipped in this call
+ * @return the status according to the following values and meaning:
+ *		- (-1) when the input buffer does not contain a whole message
+ *		- (0) when a correct message has been taken
+ *		- (1) if the message has incorrect checksum
+ *		- (2) if message has less than five chars. Minimum NMEA message is $XXX*SS
+ *		- (3) if the message is too long (>MAXBUFFERSIZE). The message start is skipped
+ */
+int SerialTxRx::takeNMEAmsg(unsigned long &skipped) {
+	unsigned char* start;
+	unsigned char* end;
+	unsigned int computedCheck = 0;
+	unsigned int messageCheck = 0;
+	//skip chars until beginning of a message (<LF><DOLLAR>)
+	for (;;) {
+		start = (unsigned char*) memchr(inBuff + inPos, LF, inEnd - inPos);
+		if (start == NULL) {
+			skipped += inEnd - inPos;
+			inPos = inEnd;
+			return -1;
+		}
+		skipped += (unsigned long) (start - (inBuff + inPos));
+		inPos = (unsigned int) (start - inBuff);
+		if (inEnd - inPos < 2) return -1;	//the char after LF is not yet read
+		if (inBuff[inPos + 1] == DOLAR) break;
+		inPos++;
+		skipped++;
+	}
+	//search the CR ending the message
+	end = (unsigned char*) memchr(inBuff + inPos + 2, CR, inEnd - inPos - 2);
+	payloadLen = (end == NULL? inEnd : (unsigned int) (end - inBuff)) - inPos - 2;
+	if (payloadLen > MAXBUFFERSIZE-1) {	//message too long
+		inPos += 2;
+		skipped += 2;
+		return 3;
+	}
+	if (end == NULL) return -1;
+	memcpy(payBuff, inBuff + inPos + 2, payloadLen);
+	inPos += 2 + payloadLen + 1;
+	payBuff[payloadLen] = 0;	//convert chars received to a C-string
+	if (payloadLen < 5) return 2;	//minimum NMEA message is $XXX*SS<CR>
+	payloadLen -= 3;	//last three bytes are the checksum: *SS
+	payBuff[payloadLen] = 0;	//mark end of message
+	//compute and verfy its checksum
+	computedCheck = payBuff[0];
+	for (unsigned int i=1; i<payloadLen; i++) computedCheck ^= payBuff[i];
+	sscanf((char *) (payBuff+payloadLen+1), "%x", &messageCheck);
+	if (computedCheck != messageCheck) return 1;	//checksum does not match
+	return 0;
+}
+
+/**getHandle gives the handle of the currently open serial port.
+ * It can be used to wait for data available in several ports before calling fillInput.
+ *
+ * @return the port handle
+ */
+int SerialTxRx::getHandle() {
+	return hSerial;
+}
+
+/**getInput gets from the input buffer the given number of bytes, reading from the port when needed.
+ *
+ * @param dest the place where bytes will be copied
+ * @param n the number of bytes to get
+ * @return true if the n bytes have been got, false otherwise (timeout, EOF or read error)
+ */
+bool SerialTxRx::getInput(unsigned char* dest, unsigned int n) {
+	unsigned int nBytes;
+	while (n > 0) {
+		if ((inPos == inEnd) && !fillInput()) return false;
+		nBytes = inEnd - inPos < n? inEnd - inPos : n;
+		memcpy(dest, inBuff + inPos, nBytes);
+		inPos += nBytes;
+		dest += nBytes;
+		n -= nBytes;
+	}
+	return true;
+}
+
 /**synchroOSPmsg skips bytes from input until start of OSP message is reached.
  * Note that start of OSP message is preceded by the sequence of the two bytes START1 (A0) START2 (A2)
+ *<p>START1 bytes are searched in the input buffer, and more data are read from the port when needed.
  *
  * @param patience is the maximum number of bytes to skip or unsuccessful reads from the serial port before returning a false value
  * @return true if the sequence START1 START2 has been detected, false otherwise
  */
 bool SerialTxRx::synchOSPmsg(int patience) {
-	ssize_t  nBytesRead;
-	unsigned char inData;
-	#if defined (_DEBUG)
-	int n0read = 0;
-	#endif
+	unsigned char* start;
 	DBGRPT("synchOSPmsg: ")
-
-	//A state machine automata is used to skip bytes from input until START1 START2 appears
-	//States: 1=is waiting to START1; 2=is waiting for STAR2; 3=START1+START2 detected
-	int state = 1;
-	while (state!=3 && patience>0) {
-		nBytesRead = read(hSerial, &inData, 1);
-		if (nBytesRead == 1) {
-			DBGRPT ("%02X ", (unsigned int) inData)
-			switch (state) {
-			case 1:
-				switch (inData) {
-				case START1:	state = 2; break;
-				case START2:	break;
-				default:		patience--; break;
-				}
-				break;
-			case 2:
-				switch (inData) {
-				case START1:	break;
-				case START2:	state = 3; break;
-				default:		state = 1; patience--; break;
-				}
-			}
-		} else {
-			#if defined (_DEBUG)
-			n0read++;
-			#endif
+	while (patience > 0) {
+		if ((inEnd - inPos < 2) && !fillInput()) {
 			patience--;
+			continue;
+		}
+		start = (unsigned char*) memchr(inBuff + inPos, START1, inEnd - inPos);
+		if (start == NULL) {
+			patience -= (int) (inEnd - inPos);
+			inPos = inEnd;
+			continue;
+		}
+		patience -= (int) (start - (inBuff + inPos));
+		inPos = (unsigned int) (start - inBuff);
+		if (inEnd - inPos < 2) continue;	//the byte after START1 is not yet read
+		if (inBuff[inPos + 1] == START2) {
+			inPos += 2;
+			DBGRPT("patience=%d\n", patience)
+			return true;
 		}
+		inPos++;
+		if (inBuff[inPos] != START1) patience--;
 	}
-	DBGRPT("state=%d;patience=%d;n0read=%d\n", state, patience, n0read)
-	return state == 3;
+	DBGRPT("patience exhausted\n")
+	return false;
 }
 
 /**readOSPmsg reads a OSP message from the serial port.
@@ -213,14 +375,11 @@ bool SerialTxRx::synchOSPmsg(int patience) {
  *		- (6) if OSP start bytes have not been received before "exhaust patience"
  */
 int SerialTxRx::readOSPmsg(int patience) {
-	ssize_t nBytesRead;
-
 	//skip bytes until beginning of a message
 	if (!synchOSPmsg(patience)) return 6;
 	//read payload length field (2 bytes)
 	DBGRPT("readOSPmsg:")
-	nBytesRead = read(hSerial, paylenBuff, 2);
-	if (nBytesRead != 2) {
+	if (!getInput(paylenBuff, 2)) {
 		DBGRPT("error 4\n")
 		return 4;
 	}
@@ -231,28 +390,19 @@ int SerialTxRx::readOSPmsg(int patience) {
 		return 3;
 	}
 	//read payload data plus 2 checksum bytes
-	ssize_t nBytesStored = 0;
-	do {
-		nBytesRead = read(hSerial, payBuff+nBytesStored, payloadLen+2 - nBytesStored);
-		nBytesStored += nBytesRead;
-	} while ((nBytesRead != 0) && (nBytesStored < payloadLen+2));
+	if (!getInput(payBuff, payloadLen+2)) {
+		DBGRPT("error 2\n")
+		return 2;
+	}
 	DBGRPT("pl [")
 	#if defined (_DEBUG)
-	for(int i=0; i<(int) nBytesStored; i++) DBGRPT ("%02X ", (unsigned int) payBuff[i])
+	for(int i=0; i<(int) payloadLen+2; i++) DBGRPT ("%02X ", (unsigned int) payBuff[i])
 	#endif
-	DBGRPT("] %d bytes; ", (int) nBytesStored)
-	if (nBytesStored < payloadLen+2) return (2);
-	//compute checksum of payload contents
-	unsigned int computedCheck;
-	computedCheck = payBuff[0];
-	for (unsigned int i=1; i<payloadLen; i++) {
-		computedCheck += payBuff[i];
-		computedCheck &= 0x7FFF;
-	}
-	//get checksum received after message payload
+	DBGRPT("]; ")
+	//compute checksum of payload contents and compare with the one received after message payload
 	unsigned int messageCheck;
 	messageCheck = (payBuff[payloadLen] << 8) | payBuff[payloadLen+1];
-	if (computedCheck != messageCheck) {
+	if (ospChecksum(payBuff, payloadLen) != messageCheck) {
 		DBGRPT("error 1\n")
 		return 1;	//checksum does not match!
 	}
@@ -333,49 +483,41 @@ void SerialTxRx::writeOSPcmd(int mid, string cmdArgs, int base) {
 
 /**synchroNMEAmsg skips bytes until start of NMEA message is reached.
  *The NMEA message is preceded by the sequence <LineFeed><$> in the input stream of ASCII chars.
+ *<p>LineFeed chars are searched in the input buffer, and more data are read from the port when needed.
  *
  * @param patience the maximum number of skipped bytes or unsuccessful reads before returning 
  * @return true if the sequence <LineFeed>$ has been detected in the ASCII input sequence, false otherwise
  */
 bool SerialTxRx::synchNMEAmsg(int patience) {
-	ssize_t nBytesRead;
-	unsigned char inData;
-	#if defined (_DEBUG)
-	int n0read = 0;
-	#endif
-	//A state machine automata is used to skip bytes from input until <LineFeed><Dolar> appears
-	//States: 1=is waiting to <LineFeed>; 2=is waiting for <$>; 3=<LineFeed><$> detected
-	int state = 1;
-	while (state!=3 && patience>0) {
-		nBytesRead = read(hSerial, &inData, 1);
-		if (nBytesRead == 1) {
-			switch (state) {
-			case 1:
-				switch (inData) {
-				case LF:	state = 2; break;
-				case DOLAR:	break;
-				default:	patience--; break;
-				}
-				break;
-			case 2:
-				switch (inData) {
-				case LF:	break;
-				case DOLAR:	state = 3; break;
-				default:	state = 1; patience--; break;
-				}
-			}
-		} else {
-			#if defined (_DEBUG)
-			n0read++;
-			#endif
+	unsigned char* start;
+	while (patience > 0) {
+		if ((inEnd - inPos < 2) && !fillInput()) {
 			patience--;
+			continue;
 		}
+		start = (unsigned char*) memchr(inBuff + inPos, LF, inEnd - inPos);
+		if (start == NULL) {
+			patience -= (int) (inEnd - inPos);
+			inPos = inEnd;
+			continue;
+		}
+		patience -= (int) (start - (inBuff + inPos));
+		inPos = (unsigned int) (start - inBuff);
+		if (inEnd - inPos < 2) continue;	//the char after LF is not yet read
+		if (inBuff[inPos + 1] == DOLAR) {
+			inPos += 2;
+			DBGRPT("synchNMEA:patience=%d\n", patience);
+			return true;
+		}
+		inPos++;
+		if (inBuff[inPos] != LF) patience--;
 	}
-	DBGRPT("synchNMEA:state=%d;patience=%d;n0read=%d\n", state, patience, n0read);
-	return state == 3;
+	DBGRPT("synchNMEA:patience exhausted\n");
+	return false;
 }
 
 /**readNMEAmsg reads a NMEA message from the serial port.
+ *<p>The CR char ending the message is searched in the input buffer, and more data are read from the port when needed.
  *
  * @param patience the maximum number of skipped chars or unsuccessful reads before returning 
  * @return the exit status according to the following values and meaning:
@@ -386,30 +528,41 @@ bool SerialTxRx::synchNMEAmsg(int patience) {
  *		- (4) if NMEA start bytes have not been received before "exhaust patience"
  */
 int SerialTxRx::readNMEAmsg(int patience) {
-	ssize_t nBytesRead = 0;
 	unsigned int computedCheck = 0;
 	unsigned int messageCheck = 0;
 	int returnValue = 3;
+	unsigned char* end;
+	unsigned int nBytes;
 	payloadLen = 0;
 	//skip bytes until beginning of a message found (<LF><DOLLAR>)
 	if (!synchNMEAmsg(patience)) return 4;
 	//read NMEA message bytes (up to CR) and put them into payBuff
 	DBGRPT("readNMEAmsg:")
-	//TBD
-	while ((nBytesRead = read(hSerial, (payBuff+payloadLen), 1) == 1)) {
-		if (*(payBuff+payloadLen) == CR) {	//is the last char in a NMEA message
-			*(payBuff+payloadLen) = 0;	//convert chars received to a C-string
+	for (;;) {
+		if ((inPos == inEnd) && !fillInput()) break;
+		end = (unsigned char*) memchr(inBuff + inPos, CR, inEnd - inPos);
+		nBytes = (end == NULL? inEnd : (unsigned int) (end - inBuff)) - inPos;
+		if (payloadLen + nBytes > MAXBUFFERSIZE-1) {	//message too long
+			memcpy(payBuff + payloadLen, inBuff + inPos, MAXBUFFERSIZE-1 - payloadLen);
+			inPos += MAXBUFFERSIZE-1 - payloadLen;
+			payloadLen = MAXBUFFERSIZE-1;
+			break;
+		}
+		memcpy(payBuff + payloadLen, inBuff + inPos, nBytes);
+		payloadLen += nBytes;
+		inPos += nBytes;
+		if (end != NULL) {	//CR is the last char in a NMEA message
+			inPos++;
+			payBuff[payloadLen] = 0;	//convert chars received to a C-string
 			if (payloadLen < 5) {		//minimum NMEA message is $XXX*SS<CR>
 				returnValue = 2;
 				break;
 			}
 			payloadLen -= 3;	//last three bytes are the checksum: *SS
-			*(payBuff+payloadLen) = 0;	//mark end of message
+			payBuff[payloadLen] = 0;	//mark end of message
 			returnValue = 0;
 			break;
 		}
-		if (payloadLen < MAXBUFFERSIZE-1) payloadLen++;
-		else break;
 	}
 	DBGRPT("pllen=%d", payloadLen)
 	if (returnValue == 0) {	//a NMEA message has been receive
@@ -18,6 +18,8 @@
  *Ver.	|Date	|Reason for change
  *------+-------+------------------
  *V1.0  |2/2018 |Linux implementation derived from Windows implementation of this class
+ *V1.1  |10/2026|Input data are read in chunks into an input buffer where messages are framed
+ *      |       |Added methods to take messages already buffered, for event driven reading
  */
 #ifndef SERIALTXRX_H
 #define SERIALTXRX_H
@@ -40,6 +42,7 @@
 using namespace std;
 
 #define MAXBUFFERSIZE 2052	//Maximum payload size (2048) + length (2) + checksum (2)
+#define INBUFFERSIZE 8192	//Size of the buffer where input data are read in chunks
 //@cond DUMMY
 #define START1 160	//0xA0	//OSP messages from/to receiver are preceded by the synchro
 #define START2 162	//0xA2	//sequence of two bytes with values START1, START2
@@ -69,6 +72,10 @@ friend class SerialTxRx;
  * -# To skip input bytes / chars until appears the start of an OSP or NMEA message
  * -# To read or write OSP or NMEA messages
  * -# To close the port
+ *<p>Input data are read from the port in chunks as big as possible into an input buffer, where start of messages are
+ * searched and message bytes are taken from. It reduces the number of read calls to about one per chunk.
+ *<p>For event driven reading of several ports, fillInput can be called when the port has data available, and then
+ * takeOSPmsg or takeNMEAmsg to take the whole messages already in the input buffer.
  */
 class SerialTxRx {
 //@cond DUMMY
@@ -77,16 +84,19 @@ class SerialTxRx {
 	int hSerial;		//the handler for the serial port
 	string hName;		//the name of the currently open serial port
 	struct termios tio;	//the termios place for their parameters
-	unsigned long readLimit;	//maximum number of bytes that can be read in one read call
 	forward_list<CBRrate> CBRrateLst;
 	string baudRate;	//the baud rate used
 	string portName;	//the device port name (like /dev/ttyUSB0)
+	unsigned char inBuff[INBUFFERSIZE];	//the buffer where input data are read in chunks
+	unsigned int inPos;	//the position in inBuff of the next byte to process
+	unsigned int inEnd;	//the position in inBuff after the last byte read
 
 	void addCBRrate(int rate, DWORD CBRrt);
 	DWORD getCBRrate(int);	//get the baud rate identifier as per termios for a given baud rate
 	int getBaudRate(DWORD);	//get the baud rate in bps for a given baud rate identifier as per termios
 	bool synchOSPmsg(int patience = MAXBUFFERSIZE*2);	//skip bytes until start of OSP message is reached
 	bool synchNMEAmsg(int patience = MAXBUFFERSIZE);	//skip bytes until start of NMEA message is reached
+	bool getInput(unsigned char* dest, unsigned int n);	//get from the input buffer the given number of bytes
 
 public:
 	unsigned char paylenBuff[2];		///< a 2 bytes buffer for the payload length bytes
@@ -100,6 +110,10 @@ public:
 	void getPortParams(int& baudRate, int& timeout, bool& rawMode);	//get port params in the current open port
 	int readOSPmsg(int patience = MAXBUFFERSIZE*2);		//read a OSP message from the serial port
 	int readNMEAmsg(int patience = MAXBUFFERSIZE);		//read a NMEA message from the serial port
+	bool fillInput();		//read from the port the bytes available into the input buffer
+	int takeOSPmsg(unsigned long &skipped);		//take a OSP message from the input buffer, without reading the port
+	int takeNMEAmsg(unsigned long &skipped);	//take a NMEA message from the input buffer, without reading the port
+	int getHandle();		//get the handle of the currently open serial port
 	void writeOSPcmd(int mid, string cmdArgs, int base = 16);	//generate and send a OSPMessage object containing a command to the receiver
 	void writeNMEAcmd(int mid, string cmdArgs);	//generate and send a NMEA message object containing a command to the receiver
 	void closePort();						//close the currently open serial port